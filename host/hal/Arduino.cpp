@@ -0,0 +1,946 @@
+#include <Arduino.h>
+#include <ctype.h>
+#include <freertos/task.h>
+#include <soc/gpio_reg.h>
+#include <soc/soc.h>
+#include <sys/time.h>
+#include <string>
+#include "host_hal.h"
+#include "host_panel.h"
+
+HardwareSerial Serial;
+EspClass ESP;
+
+// ---------------------------------------------------------------------------
+// String
+
+String::String(const char *value) : buffer(nullptr), capacity(0), len(0) {
+  if (value) {
+    assign(value, strlen(value));
+  }
+}
+
+String::String(const String &value) : buffer(nullptr), capacity(0), len(0) {
+  assign(value.c_str(), value.len);
+}
+
+String::String(String &&value) : buffer(value.buffer), capacity(value.capacity), len(value.len) {
+  value.buffer = nullptr;
+  value.capacity = 0;
+  value.len = 0;
+}
+
+String::String(const __FlashStringHelper *value) : String(reinterpret_cast<const char *>(value)) {
+}
+
+String::String(char c) : buffer(nullptr), capacity(0), len(0) {
+  assign(&c, 1);
+}
+
+static void formatInteger(char *out, size_t size, unsigned long long value, bool negative,
+                          unsigned char base) {
+  char digits[66];
+  int n = 0;
+  if (base < 2 || base > 36) {
+    base = 10;
+  }
+  do {
+    unsigned d = value % base;
+    digits[n++] = d < 10 ? '0' + d : 'a' + d - 10;
+    value /= base;
+  } while (value > 0);
+  size_t pos = 0;
+  if (negative && pos + 1 < size) {
+    out[pos++] = '-';
+  }
+  while (n > 0 && pos + 1 < size) {
+    out[pos++] = digits[--n];
+  }
+  out[pos] = '\0';
+}
+
+static void formatSigned(char *out, size_t size, long long value, unsigned char base) {
+  if (base == 10 && value < 0) {
+    formatInteger(out, size, 0ULL - (unsigned long long)value, true, base);
+  } else if (value < 0) {
+    // Arduino prints negative non-decimal values as their 32-bit pattern
+    formatInteger(out, size, (uint32_t)value, false, base);
+  } else {
+    formatInteger(out, size, value, false, base);
+  }
+}
+
+String::String(int value, unsigned char base) : String((long long)value) {
+  if (base != 10) {
+    char text[66];
+    formatSigned(text, sizeof(text), value, base);
+    *this = text;
+  }
+}
+
+String::String(unsigned int value, unsigned char base) : buffer(nullptr), capacity(0), len(0) {
+  char text[66];
+  formatInteger(text, sizeof(text), value, false, base);
+  assign(text, strlen(text));
+}
+
+String::String(long value, unsigned char base) : buffer(nullptr), capacity(0), len(0) {
+  char text[66];
+  formatSigned(text, sizeof(text), value, base);
+  assign(text, strlen(text));
+}
+
+String::String(unsigned long value, unsigned char base) : buffer(nullptr), capacity(0), len(0) {
+  char text[66];
+  formatInteger(text, sizeof(text), value, false, base);
+  assign(text, strlen(text));
+}
+
+String::String(long long value) : buffer(nullptr), capacity(0), len(0) {
+  char text[66];
+  formatSigned(text, sizeof(text), value, 10);
+  assign(text, strlen(text));
+}
+
+String::String(unsigned long long value) : buffer(nullptr), capacity(0), len(0) {
+  char text[66];
+  formatInteger(text, sizeof(text), value, false, 10);
+  assign(text, strlen(text));
+}
+
+String::String(float value, unsigned int decimals) : String((double)value, decimals) {
+}
+
+String::String(double value, unsigned int decimals) : buffer(nullptr), capacity(0), len(0) {
+  char text[64];
+  snprintf(text, sizeof(text), "%.*f", (int)decimals, value);
+  assign(text, strlen(text));
+}
+
+String::~String() {
+  free(buffer);
+}
+
+void String::invalidate() {
+  free(buffer);
+  buffer = nullptr;
+  capacity = 0;
+  len = 0;
+}
+
+bool String::reserve(unsigned int size) {
+  if (buffer && capacity >= size) {
+    return true;
+  }
+  char *grown = (char *)realloc(buffer, size + 1);
+  if (!grown) {
+    return false;
+  }
+  if (!buffer) {
+    grown[0] = '\0';
+  }
+  buffer = grown;
+  capacity = size;
+  return true;
+}
+
+bool String::assign(const char *value, unsigned int length) {
+  if (!reserve(length)) {
+    invalidate();
+    return false;
+  }
+  memmove(buffer, value, length);
+  len = length;
+  buffer[len] = '\0';
+  return true;
+}
+
+String &String::operator=(const String &value) {
+  if (this != &value) {
+    assign(value.c_str(), value.len);
+  }
+  return *this;
+}
+
+String &String::operator=(String &&value) {
+  if (this != &value) {
+    free(buffer);
+    buffer = value.buffer;
+    capacity = value.capacity;
+    len = value.len;
+    value.buffer = nullptr;
+    value.capacity = 0;
+    value.len = 0;
+  }
+  return *this;
+}
+
+String &String::operator=(const char *value) {
+  if (value) {
+    assign(value, strlen(value));
+  } else {
+    invalidate();
+  }
+  return *this;
+}
+
+String &String::operator=(const __FlashStringHelper *value) {
+  return *this = reinterpret_cast<const char *>(value);
+}
+
+bool String::concat(const char *value, unsigned int length) {
+  if (!value) {
+    return false;
+  }
+  if (length == 0) {
+    return true;
+  }
+  // value may point into our own buffer, which reserve() can move
+  unsigned int offset = 0;
+  bool self = buffer && value >= buffer && value < buffer + len;
+  if (self) {
+    offset = value - buffer;
+  }
+  if (!reserve(len + length)) {
+    return false;
+  }
+  memmove(buffer + len, self ? buffer + offset : value, length);
+  len += length;
+  buffer[len] = '\0';
+  return true;
+}
+
+bool String::concat(const String &value) {
+  return concat(value.c_str(), value.len);
+}
+
+bool String::concat(const char *value) {
+  return value && concat(value, strlen(value));
+}
+
+bool String::concat(char c) {
+  return concat(&c, 1);
+}
+
+bool String::concat(int value) {
+  return concat(String(value));
+}
+
+bool String::concat(unsigned int value) {
+  return concat(String(value));
+}
+
+bool String::concat(long value) {
+  return concat(String(value));
+}
+
+bool String::concat(unsigned long value) {
+  return concat(String(value));
+}
+
+bool String::concat(long long value) {
+  return concat(String(value));
+}
+
+bool String::concat(unsigned long long value) {
+  return concat(String(value));
+}
+
+bool String::concat(double value) {
+  return concat(String(value));
+}
+
+bool String::concat(const __FlashStringHelper *value) {
+  return concat(reinterpret_cast<const char *>(value));
+}
+
+String operator+(const String &a, const String &b) {
+  String out(a);
+  out.concat(b);
+  return out;
+}
+
+String operator+(const String &a, const char *b) {
+  String out(a);
+  out.concat(b);
+  return out;
+}
+
+String operator+(const char *a, const String &b) {
+  String out(a);
+  out.concat(b);
+  return out;
+}
+
+String operator+(const String &a, char b) {
+  String out(a);
+  out.concat(b);
+  return out;
+}
+
+String operator+(const String &a, int b) {
+  String out(a);
+  out.concat(b);
+  return out;
+}
+
+String operator+(const String &a, unsigned int b) {
+  String out(a);
+  out.concat(b);
+  return out;
+}
+
+String operator+(const String &a, long b) {
+  String out(a);
+  out.concat(b);
+  return out;
+}
+
+String operator+(const String &a, unsigned long b) {
+  String out(a);
+  out.concat(b);
+  return out;
+}
+
+String operator+(const String &a, long long b) {
+  String out(a);
+  out.concat(b);
+  return out;
+}
+
+String operator+(const String &a, unsigned long long b) {
+  String out(a);
+  out.concat(b);
+  return out;
+}
+
+String operator+(const String &a, double b) {
+  String out(a);
+  out.concat(b);
+  return out;
+}
+
+String operator+(const String &a, const __FlashStringHelper *b) {
+  String out(a);
+  out.concat(b);
+  return out;
+}
+
+bool String::equals(const String &other) const {
+  return len == other.len && strcmp(c_str(), other.c_str()) == 0;
+}
+
+bool String::equals(const char *other) const {
+  return strcmp(c_str(), other ? other : "") == 0;
+}
+
+bool String::equalsIgnoreCase(const String &other) const {
+  return len == other.len && strcasecmp(c_str(), other.c_str()) == 0;
+}
+
+bool String::startsWith(const String &prefix) const {
+  return prefix.len <= len && strncmp(c_str(), prefix.c_str(), prefix.len) == 0;
+}
+
+bool String::endsWith(const String &suffix) const {
+  return suffix.len <= len && strcmp(c_str() + len - suffix.len, suffix.c_str()) == 0;
+}
+
+char String::charAt(unsigned int index) const {
+  return index < len ? buffer[index] : 0;
+}
+
+char &String::operator[](unsigned int index) {
+  static char dummy;
+  if (index >= len) {
+    dummy = 0;
+    return dummy;
+  }
+  return buffer[index];
+}
+
+void String::toCharArray(char *out, unsigned int size, unsigned int index) const {
+  if (!out || size == 0) {
+    return;
+  }
+  if (index >= len) {
+    out[0] = '\0';
+    return;
+  }
+  unsigned int n = len - index;
+  if (n > size - 1) {
+    n = size - 1;
+  }
+  memcpy(out, buffer + index, n);
+  out[n] = '\0';
+}
+
+int String::indexOf(char c, unsigned int from) const {
+  if (from >= len) {
+    return -1;
+  }
+  const char *found = strchr(buffer + from, c);
+  return found ? found - buffer : -1;
+}
+
+int String::indexOf(const String &value, unsigned int from) const {
+  if (from > len) {
+    return -1;
+  }
+  const char *found = strstr(c_str() + from, value.c_str());
+  return found ? found - c_str() : -1;
+}
+
+int String::lastIndexOf(char c) const {
+  return len == 0 ? -1 : lastIndexOf(c, len - 1);
+}
+
+int String::lastIndexOf(char c, unsigned int from) const {
+  if (len == 0) {
+    return -1;
+  }
+  if (from >= len) {
+    from = len - 1;
+  }
+  for (int i = from; i >= 0; i--) {
+    if (buffer[i] == c) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+String String::substring(unsigned int from) const {
+  return substring(from, len);
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+  if (from > to) {
+    unsigned int swap = from;
+    from = to;
+    to = swap;
+  }
+  String out;
+  if (from >= len) {
+    return out;
+  }
+  if (to > len) {
+    to = len;
+  }
+  out.assign(buffer + from, to - from);
+  return out;
+}
+
+void String::replace(char find, char with) {
+  for (unsigned int i = 0; i < len; i++) {
+    if (buffer[i] == find) {
+      buffer[i] = with;
+    }
+  }
+}
+
+void String::replace(const String &find, const String &with) {
+  if (len == 0 || find.len == 0) {
+    return;
+  }
+  String out;
+  unsigned int pos = 0;
+  int hit;
+  while ((hit = indexOf(find, pos)) >= 0) {
+    out.concat(buffer + pos, hit - pos);
+    out.concat(with);
+    pos = hit + find.len;
+  }
+  out.concat(buffer + pos, len - pos);
+  *this = static_cast<String &&>(out);
+}
+
+void String::remove(unsigned int index) {
+  remove(index, (unsigned int)-1);
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+  if (index >= len) {
+    return;
+  }
+  if (count > len - index) {
+    count = len - index;
+  }
+  memmove(buffer + index, buffer + index + count, len - index - count + 1);
+  len -= count;
+}
+
+void String::toLowerCase() {
+  for (unsigned int i = 0; i < len; i++) {
+    buffer[i] = tolower((unsigned char)buffer[i]);
+  }
+}
+
+void String::toUpperCase() {
+  for (unsigned int i = 0; i < len; i++) {
+    buffer[i] = toupper((unsigned char)buffer[i]);
+  }
+}
+
+void String::trim() {
+  if (len == 0) {
+    return;
+  }
+  unsigned int start = 0;
+  while (start < len && isspace((unsigned char)buffer[start])) {
+    start++;
+  }
+  unsigned int end = len;
+  while (end > start && isspace((unsigned char)buffer[end - 1])) {
+    end--;
+  }
+  len = end - start;
+  memmove(buffer, buffer + start, len);
+  buffer[len] = '\0';
+}
+
+long String::toInt() const {
+  return atol(c_str());
+}
+
+float String::toFloat() const {
+  return (float)atof(c_str());
+}
+
+double String::toDouble() const {
+  return atof(c_str());
+}
+
+// ---------------------------------------------------------------------------
+// Print / Stream
+
+size_t Print::write(const uint8_t *data, size_t size) {
+  size_t n = 0;
+  while (size--) {
+    n += write(*data++);
+  }
+  return n;
+}
+
+size_t Print::print(const __FlashStringHelper *value) {
+  return write(reinterpret_cast<const char *>(value));
+}
+
+size_t Print::print(const String &value) {
+  return write(value.c_str(), value.length());
+}
+
+size_t Print::print(const char *value) {
+  return write(value);
+}
+
+size_t Print::print(char value) {
+  return write((uint8_t)value);
+}
+
+size_t Print::print(unsigned char value, int base) {
+  return print((unsigned long)value, base);
+}
+
+size_t Print::print(int value, int base) {
+  return print((long)value, base);
+}
+
+size_t Print::print(unsigned int value, int base) {
+  return print((unsigned long)value, base);
+}
+
+size_t Print::print(long value, int base) {
+  char text[66];
+  formatSigned(text, sizeof(text), value, base);
+  return write(text);
+}
+
+size_t Print::print(unsigned long value, int base) {
+  char text[66];
+  formatInteger(text, sizeof(text), value, false, base);
+  return write(text);
+}
+
+size_t Print::print(long long value, int base) {
+  char text[66];
+  formatSigned(text, sizeof(text), value, base);
+  return write(text);
+}
+
+size_t Print::print(unsigned long long value, int base) {
+  char text[66];
+  formatInteger(text, sizeof(text), value, false, base);
+  return write(text);
+}
+
+size_t Print::print(double value, int digits) {
+  char text[64];
+  snprintf(text, sizeof(text), "%.*f", digits, value);
+  return write(text);
+}
+
+size_t Print::println() {
+  return write("\r\n");
+}
+
+size_t Print::printf(const char *format, ...) {
+  char text[256];
+  va_list args;
+  va_start(args, format);
+  int n = vsnprintf(text, sizeof(text), format, args);
+  va_end(args);
+  if (n < 0) {
+    return 0;
+  }
+  return write(text, (size_t)n < sizeof(text) ? n : sizeof(text) - 1);
+}
+
+size_t Stream::readBytes(char *out, size_t size) {
+  size_t n = 0;
+  while (n < size) {
+    int c = read();
+    if (c < 0) {
+      break;
+    }
+    out[n++] = (char)c;
+  }
+  return n;
+}
+
+String Stream::readString() {
+  String out;
+  int c;
+  while ((c = read()) >= 0) {
+    out.concat((char)c);
+  }
+  return out;
+}
+
+String Stream::readStringUntil(char terminator) {
+  String out;
+  int c;
+  while ((c = read()) >= 0 && c != terminator) {
+    out.concat((char)c);
+  }
+  return out;
+}
+
+// ---------------------------------------------------------------------------
+// Serial capture
+
+#define SERIAL_CAPTURE_MAX (1u << 20)
+
+static std::string *serialCapture = nullptr;
+static int serialEcho = -1;
+
+static std::string &capture() {
+  if (!serialCapture) {
+    HostSystemAlloc system;
+    serialCapture = new std::string();
+  }
+  return *serialCapture;
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t *data, size_t size) {
+  if (serialEcho < 0) {
+    const char *env = getenv("HOST_SERIAL");
+    serialEcho = env && env[0] == '1';
+  }
+  if (serialEcho) {
+    fwrite(data, 1, size, stdout);
+  }
+  HostSystemAlloc system;
+  std::string &out = capture();
+  // Long soaks print a lot; keep the most recent half
+  if (out.size() + size > SERIAL_CAPTURE_MAX) {
+    out.erase(0, out.size() / 2);
+  }
+  out.append((const char *)data, size);
+  return size;
+}
+
+const char *hostSerialOutput() {
+  return capture().c_str();
+}
+
+void hostSerialClear() {
+  HostSystemAlloc system;
+  capture().clear();
+}
+
+// ---------------------------------------------------------------------------
+// Clock, random, pins
+
+static uint64_t clockUs = 0;  // Since hostReset(); runs on through deep sleep
+static uint64_t bootUs = 0;   // clockUs when this boot's millis() started
+static uint32_t randomState = 1;
+static int pinLevels[64];
+
+// Inputs idle HIGH (the buttons have pull-ups) even before hostReset()
+static struct PinDefaults {
+  PinDefaults() {
+    for (int &level : pinLevels) {
+      level = HIGH;
+    }
+  }
+} pinDefaults;
+
+uint64_t hostNowUs() {
+  return clockUs;
+}
+
+void hostAdvanceUs(uint64_t us) {
+  clockUs += us;
+}
+
+void hostAdvanceMs(uint32_t ms) {
+  clockUs += (uint64_t)ms * 1000;
+}
+
+// A deep-sleep wake (esp_sleep.cpp) restarts millis() from zero
+void hostClockBoot() {
+  bootUs = clockUs;
+}
+
+// The chip's counters are 32 bits wide and wrap; keep that on 64-bit hosts
+unsigned long millis() {
+  return (uint32_t)((clockUs - bootUs) / 1000);
+}
+
+unsigned long micros() {
+  return (uint32_t)(clockUs - bootUs);
+}
+
+// The RTC-backed system clock, which doesn't restart on a deep-sleep wake
+extern "C" int gettimeofday(struct timeval *tv, void *tz) {
+  (void)tz;
+  tv->tv_sec = (time_t)(clockUs / 1000000);
+  tv->tv_usec = (suseconds_t)(clockUs % 1000000);
+  return 0;
+}
+
+// Both let the other tasks run, as on the chip
+void delay(unsigned long ms) {
+  vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+void delayMicroseconds(unsigned int us) {
+  hostAdvanceUs(us);
+}
+
+void yield() {
+  taskYIELD();
+}
+
+// xorshift32: cheap, and the same sequence on every host
+uint32_t esp_random() {
+  uint32_t x = randomState;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  randomState = x;
+  return x;
+}
+
+void randomSeed(unsigned long seed) {
+  if (seed != 0) {
+    randomState = (uint32_t)seed;
+  }
+}
+
+long random(long howBig) {
+  if (howBig <= 0) {
+    return 0;
+  }
+  return esp_random() % howBig;
+}
+
+long random(long howSmall, long howBig) {
+  if (howSmall >= howBig) {
+    return howSmall;
+  }
+  return howSmall + random(howBig - howSmall);
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  (void)pin;
+  (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+  if (pin < 64) {
+    pinLevels[pin] = level;
+  }
+}
+
+int digitalRead(uint8_t pin) {
+  return pin < 64 ? pinLevels[pin] : LOW;
+}
+
+// attachInterrupt() handlers, run from hostSetPinLevel() on a matching edge
+struct PinInterrupt {
+  void (*handler)();
+  int mode;
+};
+static PinInterrupt pinInterrupts[64];
+
+void hostSetPinLevel(uint8_t pin, int level) {
+  if (pin >= 64) {
+    return;
+  }
+  int was = pinLevels[pin];
+  pinLevels[pin] = level;
+  const PinInterrupt &irq = pinInterrupts[pin];
+  bool edge = level != was && (irq.mode == CHANGE || (irq.mode == RISING && level == HIGH) ||
+                               (irq.mode == FALLING && level == LOW));
+  if (edge && irq.handler) {
+    irq.handler();
+  }
+}
+
+int digitalPinToInterrupt(uint8_t pin) {
+  return pin;
+}
+
+void attachInterrupt(uint8_t interrupt, void (*handler)(), int mode) {
+  if (interrupt < 64) {
+    pinInterrupts[interrupt] = {handler, mode};
+  }
+}
+
+void detachInterrupt(uint8_t interrupt) {
+  if (interrupt < 64) {
+    pinInterrupts[interrupt] = {nullptr, 0};
+  }
+}
+
+// GPIO_IN_REG: the input levels of GPIO0-31
+uint32_t hostRegRead(uint32_t reg) {
+  uint32_t value = 0;
+  if (reg == GPIO_IN_REG) {
+    for (int pin = 0; pin < 32; pin++) {
+      value |= (uint32_t)(pinLevels[pin] != LOW) << pin;
+    }
+  }
+  return value;
+}
+
+uint16_t analogRead(uint8_t pin) {
+  (void)pin;
+  return 2048;
+}
+
+// A full LiPo through the V3's 390k/100k divider
+uint32_t analogReadMilliVolts(uint8_t pin) {
+  (void)pin;
+  return 860;
+}
+
+void analogReadResolution(uint8_t bits) {
+  (void)bits;
+}
+
+void analogSetAttenuation(int attenuation) {
+  (void)attenuation;
+}
+
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration) {
+  (void)pin;
+  (void)frequency;
+  (void)duration;
+}
+
+void noTone(uint8_t pin) {
+  (void)pin;
+}
+
+// No SNTP on the host: wall time is the virtual clock from the epoch
+bool getLocalTime(struct tm *info, uint32_t ms) {
+  (void)ms;
+  time_t now = (time_t)(clockUs / 1000000);
+  gmtime_r(&now, info);
+  return true;
+}
+
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char *server1,
+                const char *server2, const char *server3) {
+  (void)gmtOffsetSec;
+  (void)daylightOffsetSec;
+  (void)server1;
+  (void)server2;
+  (void)server3;
+}
+
+// ---------------------------------------------------------------------------
+// ESP
+
+uint32_t EspClass::getHeapSize() {
+  return hostHeapStats().sizeBytes;
+}
+
+uint32_t EspClass::getFreeHeap() {
+  return hostHeapStats().freeBytes;
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+  return hostHeapStats().minFreeBytes;
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+  return hostHeapStats().largestFreeBlock;
+}
+
+uint32_t EspClass::getCycleCount() {
+  return (uint32_t)((clockUs - bootUs) * 240);
+}
+
+uint64_t EspClass::getEfuseMac() {
+  return 0x0000A1B2C3D4E5F6ULL;
+}
+
+void EspClass::restart() {
+  fprintf(stderr, "ESP.restart() called\n");
+  abort();
+}
+
+// ---------------------------------------------------------------------------
+
+void hostPreferencesReset();
+void hostFreeRtosReset();
+void hostFreeRtosReboot();
+void hostHeapReboot();
+void hostNetReset();
+void hostNetReboot();
+void hostSleepReset();
+
+void hostReset() {
+  clockUs = 0;
+  bootUs = 0;
+  randomState = 1;
+  for (int &level : pinLevels) {
+    level = HIGH;
+  }
+  for (PinInterrupt &irq : pinInterrupts) {
+    irq = {nullptr, 0};
+  }
+  hostSerialClear();
+  hostPreferencesReset();
+  hostFreeRtosReset();
+  hostNetReset();
+  hostSleepReset();
+  hostPanelReset();
+}
+
+void hostReboot() {
+  for (PinInterrupt &irq : pinInterrupts) {
+    irq = {nullptr, 0};
+  }
+  hostFreeRtosReboot();
+  hostNetReboot();
+  hostHeapReboot();
+}
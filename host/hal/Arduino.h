@@ -0,0 +1,317 @@
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+// Host stand-in for the parts of the ESP32 Arduino core the firmware uses.
+// Strings allocate through malloc, so they land in the simulated heap; time
+// comes from the virtual clock in host_hal.h.
+
+#include <ctype.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define PROGMEM
+#define IRAM_ATTR
+// RTC memory: kept apart so a reboot that wipes the firmware's other RAM
+// (tests/sketch_harness.h) leaves it be
+#define RTC_DATA_ATTR __attribute__((section(".rtc.data")))
+#define RTC_NOINIT_ATTR __attribute__((section(".rtc_noinit")))
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_ptr(p) (*(void *const *)(p))
+#define strcpy_P strcpy
+#define memcpy_P memcpy
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define INPUT_PULLDOWN 0x09
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+#define ADC_11db 3
+
+// Heltec V3 board pins, declared the way the board variant does (so a
+// sketch's own #define of one wins without a redefinition warning)
+static const uint8_t SDA_OLED = 17;
+static const uint8_t SCL_OLED = 18;
+static const uint8_t RST_OLED = 21;
+static const uint8_t Vext = 36;
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+
+// Arduino's min()/max() take mixed types (int vs unsigned long is common);
+// these keep that without std::min's "same type" rule
+template <typename A, typename B>
+inline auto min(A a, B b) -> decltype(a < b ? a : b) {
+  return b < a ? b : a;
+}
+
+template <typename A, typename B>
+inline auto max(A a, B b) -> decltype(a < b ? a : b) {
+  return a < b ? b : a;
+}
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+class String {
+ public:
+  String(const char *value = "");
+  String(const String &value);
+  String(String &&value);
+  String(const __FlashStringHelper *value);
+  explicit String(char c);
+  explicit String(int value, unsigned char base = 10);
+  explicit String(unsigned int value, unsigned char base = 10);
+  explicit String(long value, unsigned char base = 10);
+  explicit String(unsigned long value, unsigned char base = 10);
+  explicit String(long long value);
+  explicit String(unsigned long long value);
+  explicit String(float value, unsigned int decimals = 2);
+  explicit String(double value, unsigned int decimals = 2);
+  ~String();
+
+  String &operator=(const String &value);
+  String &operator=(String &&value);
+  String &operator=(const char *value);
+  String &operator=(const __FlashStringHelper *value);
+
+  bool reserve(unsigned int size);
+  unsigned int length() const {
+    return len;
+  }
+  bool isEmpty() const {
+    return len == 0;
+  }
+  const char *c_str() const {
+    return buffer ? buffer : "";
+  }
+
+  bool concat(const String &value);
+  bool concat(const char *value);
+  bool concat(const char *value, unsigned int length);
+  bool concat(char c);
+  bool concat(int value);
+  bool concat(unsigned int value);
+  bool concat(long value);
+  bool concat(unsigned long value);
+  bool concat(long long value);
+  bool concat(unsigned long long value);
+  bool concat(double value);
+  bool concat(const __FlashStringHelper *value);
+
+  template <typename T>
+  String &operator+=(const T &value) {
+    concat(value);
+    return *this;
+  }
+
+  friend String operator+(const String &a, const String &b);
+  friend String operator+(const String &a, const char *b);
+  friend String operator+(const char *a, const String &b);
+  friend String operator+(const String &a, char b);
+  friend String operator+(const String &a, int b);
+  friend String operator+(const String &a, unsigned int b);
+  friend String operator+(const String &a, long b);
+  friend String operator+(const String &a, unsigned long b);
+  friend String operator+(const String &a, long long b);
+  friend String operator+(const String &a, unsigned long long b);
+  friend String operator+(const String &a, double b);
+  friend String operator+(const String &a, const __FlashStringHelper *b);
+
+  bool equals(const String &other) const;
+  bool equals(const char *other) const;
+  bool equalsIgnoreCase(const String &other) const;
+  bool operator==(const String &other) const {
+    return equals(other);
+  }
+  bool operator==(const char *other) const {
+    return equals(other);
+  }
+  bool operator!=(const String &other) const {
+    return !equals(other);
+  }
+  bool operator!=(const char *other) const {
+    return !equals(other);
+  }
+  bool operator<(const String &other) const {
+    return strcmp(c_str(), other.c_str()) < 0;
+  }
+  bool startsWith(const String &prefix) const;
+  bool endsWith(const String &suffix) const;
+
+  char charAt(unsigned int index) const;
+  char operator[](unsigned int index) const {
+    return charAt(index);
+  }
+  char &operator[](unsigned int index);
+  void toCharArray(char *out, unsigned int size, unsigned int index = 0) const;
+
+  int indexOf(char c, unsigned int from = 0) const;
+  int indexOf(const String &value, unsigned int from = 0) const;
+  int lastIndexOf(char c) const;
+  int lastIndexOf(char c, unsigned int from) const;
+  String substring(unsigned int from) const;
+  String substring(unsigned int from, unsigned int to) const;
+
+  void replace(char find, char with);
+  void replace(const String &find, const String &with);
+  void remove(unsigned int index);
+  void remove(unsigned int index, unsigned int count);
+  void toLowerCase();
+  void toUpperCase();
+  void trim();
+
+  long toInt() const;
+  float toFloat() const;
+  double toDouble() const;
+
+ private:
+  bool assign(const char *value, unsigned int length);
+  void invalidate();
+
+  char *buffer;
+  unsigned int capacity;
+  unsigned int len;
+};
+
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t *data, size_t size);
+  size_t write(const char *str) {
+    return str ? write((const uint8_t *)str, strlen(str)) : 0;
+  }
+  size_t write(const char *data, size_t size) {
+    return write((const uint8_t *)data, size);
+  }
+  virtual void flush() {}
+
+  size_t print(const __FlashStringHelper *value);
+  size_t print(const String &value);
+  size_t print(const char *value);
+  size_t print(char value);
+  size_t print(unsigned char value, int base = 10);
+  size_t print(int value, int base = 10);
+  size_t print(unsigned int value, int base = 10);
+  size_t print(long value, int base = 10);
+  size_t print(unsigned long value, int base = 10);
+  size_t print(long long value, int base = 10);
+  size_t print(unsigned long long value, int base = 10);
+  size_t print(double value, int digits = 2);
+
+  template <typename T>
+  size_t println(const T &value) {
+    size_t n = print(value);
+    return n + println();
+  }
+  template <typename T>
+  size_t println(const T &value, int format) {
+    size_t n = print(value, format);
+    return n + println();
+  }
+  size_t println();
+
+  size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class Stream : public Print {
+ public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  void setTimeout(unsigned long ms) {
+    timeoutMs = ms;
+  }
+  size_t readBytes(char *out, size_t size);
+  size_t readBytes(uint8_t *out, size_t size) {
+    return readBytes((char *)out, size);
+  }
+  String readString();
+  String readStringUntil(char terminator);
+
+ protected:
+  unsigned long timeoutMs = 1000;
+};
+
+// Output is captured for hostSerialOutput(); input is always empty
+class HardwareSerial : public Stream {
+ public:
+  void begin(unsigned long baud) {
+    (void)baud;
+  }
+  operator bool() const {
+    return true;
+  }
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *data, size_t size) override;
+  using Print::write;
+  int available() override {
+    return 0;
+  }
+  int read() override {
+    return -1;
+  }
+  int peek() override {
+    return -1;
+  }
+};
+
+extern HardwareSerial Serial;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+long random(long howBig);
+long random(long howSmall, long howBig);
+void randomSeed(unsigned long seed);
+uint32_t esp_random();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t level);
+int digitalRead(uint8_t pin);
+int digitalPinToInterrupt(uint8_t pin);
+void attachInterrupt(uint8_t interrupt, void (*handler)(), int mode);
+void detachInterrupt(uint8_t interrupt);
+uint16_t analogRead(uint8_t pin);
+uint32_t analogReadMilliVolts(uint8_t pin);
+void analogReadResolution(uint8_t bits);
+void analogSetAttenuation(int attenuation);
+void tone(uint8_t pin, unsigned int frequency, unsigned long duration = 0);
+void noTone(uint8_t pin);
+
+bool getLocalTime(struct tm *info, uint32_t ms = 5000);
+void configTime(long gmtOffsetSec, int daylightOffsetSec, const char *server1,
+                const char *server2 = nullptr, const char *server3 = nullptr);
+
+// Heap figures come from the simulated heap
+class EspClass {
+ public:
+  uint32_t getHeapSize();
+  uint32_t getFreeHeap();
+  uint32_t getMinFreeHeap();
+  uint32_t getMaxAllocHeap();
+  uint32_t getCycleCount();
+  uint64_t getEfuseMac();
+  void restart();
+};
+
+extern EspClass ESP;
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef HTTPCLIENT_H
+#define HTTPCLIENT_H
+
+#include <Arduino.h>
+#include "WiFiClient.h"
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_NO_STREAM (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM (-8)
+#define HTTPC_ERROR_ENCODING (-9)
+#define HTTPC_ERROR_STREAM_WRITE (-10)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+typedef enum {
+  HTTP_CODE_OK = 200,
+  HTTP_CODE_NO_CONTENT = 204,
+  HTTP_CODE_NOT_MODIFIED = 304,
+  HTTP_CODE_BAD_REQUEST = 400,
+  HTTP_CODE_NOT_FOUND = 404,
+  HTTP_CODE_METHOD_NOT_ALLOWED = 405,
+  HTTP_CODE_INTERNAL_SERVER_ERROR = 500
+} t_http_codes;
+
+typedef enum {
+  HTTPC_DISABLE_FOLLOW_REDIRECTS,
+  HTTPC_STRICT_FOLLOW_REDIRECTS,
+  HTTPC_FORCE_FOLLOW_REDIRECTS
+} followRedirects_t;
+
+struct HostHttpExchange;
+
+// Talks to the stand-in server (host_net.h) over the given client. The
+// response body is left in the client's receive buffer, chunk framing and
+// all, so getStream() readers see what they'd see on the chip.
+class HTTPClient {
+ public:
+  HTTPClient();
+  ~HTTPClient();
+  HTTPClient(const HTTPClient &) = delete;
+  HTTPClient &operator=(const HTTPClient &) = delete;
+
+  bool begin(WiFiClient &client, const String &url);
+  void end();
+
+  void setTimeout(uint16_t timeoutMs) {
+    (void)timeoutMs;
+  }
+  void setReuse(bool reuse) {
+    this->reuse = reuse;
+  }
+  void setFollowRedirects(followRedirects_t follow) {
+    (void)follow;
+  }
+  void useHTTP10(bool http10) {
+    (void)http10;
+  }
+  void collectHeaders(const char *headerKeys[], const size_t count);
+  void addHeader(const String &name, const String &value);
+
+  int GET();
+  int POST(const String &payload);
+  int POST(const uint8_t *payload, size_t size);
+
+  String header(const char *name);
+  int getSize() {
+    return size;
+  }
+  WiFiClient &getStream() {
+    return *client;
+  }
+  String getString();
+
+ private:
+  int send(const char *method, const char *payload, size_t length);
+
+  WiFiClient *client;
+  HostHttpExchange *exchange;  // Request headers and the collected response headers
+  bool reuse;
+  int size;
+  bool chunked;
+};
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef HT_SSD1306WIRE_H
+#define HT_SSD1306WIRE_H
+
+#include <Arduino.h>
+
+// Host stand-in for the Heltec/ThingPulse SSD1306 driver: the same
+// framebuffer layout (page-major, as the panel stores it) and the same I2C
+// traffic to the panel (host_panel.h). Drawing is simplified: fonts are
+// fixed-width cells the size of the real fonts, and each character is a
+// pattern of its own within its cell rather than a real glyph, so text
+// changes the pixels it should without shipping the font data.
+
+typedef enum {
+  GEOMETRY_128_64 = 0,
+  GEOMETRY_128_32,
+  GEOMETRY_64_48,
+  GEOMETRY_64_32,
+  GEOMETRY_RAWMODE
+} DISPLAY_GEOMETRY;
+
+typedef enum {
+  TEXT_ALIGN_LEFT = 0,
+  TEXT_ALIGN_RIGHT = 1,
+  TEXT_ALIGN_CENTER = 2,
+  TEXT_ALIGN_CENTER_BOTH = 3
+} OLEDDISPLAY_TEXT_ALIGNMENT;
+
+// Header of the real fonts: max glyph width, height, first char, char count
+extern const uint8_t ArialMT_Plain_10[];
+extern const uint8_t ArialMT_Plain_16[];
+extern const uint8_t ArialMT_Plain_24[];
+
+class OLEDDisplay {
+ public:
+  explicit OLEDDisplay(DISPLAY_GEOMETRY g = GEOMETRY_128_64);
+  virtual ~OLEDDisplay();
+  OLEDDisplay(const OLEDDisplay &) = delete;
+  OLEDDisplay &operator=(const OLEDDisplay &) = delete;
+
+  uint16_t width() const {
+    return displayWidth;
+  }
+  uint16_t height() const {
+    return displayHeight;
+  }
+
+  // Allocates the framebuffer (on the heap, as the library does) the first
+  // time, sends the panel's init sequence and a blank frame
+  bool init();
+  virtual void display() = 0;
+  void displayOn();
+  void displayOff();
+  void setContrast(uint8_t contrast, uint8_t precharge = 241, uint8_t comdetect = 64);
+
+  void clear();
+  void setPixel(int16_t x, int16_t y);
+  void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1);
+  void drawRect(int16_t x, int16_t y, int16_t width, int16_t height);
+  void fillRect(int16_t x, int16_t y, int16_t width, int16_t height);
+  void drawXbm(int16_t x, int16_t y, int16_t width, int16_t height, const uint8_t *xbm);
+
+  void setFont(const uint8_t *fontData);
+  void setTextAlignment(OLEDDISPLAY_TEXT_ALIGNMENT alignment);
+  // Lines split at '\n'; returns the width of the widest
+  uint16_t drawString(int16_t x, int16_t y, const String &text);
+  uint16_t getStringWidth(const String &text);
+
+  uint8_t *buffer = nullptr;
+
+ protected:
+  virtual void connect() = 0;
+  virtual void sendCommand(uint8_t command) = 0;
+
+  uint16_t displayWidth;
+  uint16_t displayHeight;
+
+ private:
+  void drawChar(int16_t x, int16_t y, uint8_t c);
+
+  const uint8_t *font = ArialMT_Plain_10;
+  OLEDDISPLAY_TEXT_ALIGNMENT textAlignment = TEXT_ALIGN_LEFT;
+};
+
+class SSD1306Wire : public OLEDDisplay {
+ public:
+  SSD1306Wire(uint8_t address, uint32_t freq, int sda, int scl,
+              DISPLAY_GEOMETRY g = GEOMETRY_128_64, int8_t rst = -1);
+
+  // The whole framebuffer, in 16-byte transmissions
+  void display() override;
+
+ protected:
+  void connect() override;
+  void sendCommand(uint8_t command) override;
+
+ private:
+  uint8_t address;
+  uint32_t freq;
+  int sda;
+  int scl;
+};
+
+#endif
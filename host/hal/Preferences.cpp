@@ -0,0 +1,289 @@
+#include <Preferences.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "host_hal.h"
+
+// NVS limits: 15-character namespace and key names
+#define NVS_NAME_MAX 15
+
+enum ValueType : uint8_t {
+  TYPE_U8,
+  TYPE_I32,
+  TYPE_U32,
+  TYPE_FLOAT,
+  TYPE_STRING,
+  TYPE_BLOB
+};
+
+struct StoredValue {
+  uint8_t type;
+  std::vector<uint8_t> bytes;
+};
+
+typedef std::map<std::string, StoredValue> Namespace;
+
+static std::map<std::string, Namespace> *store = nullptr;
+static HostNvsStats nvsStats;
+static uint32_t failingWrites = 0;
+
+// Call with a HostSystemAlloc alive: flash isn't heap on the chip
+static std::map<std::string, Namespace> &flash() {
+  if (!store) {
+    store = new std::map<std::string, Namespace>();
+  }
+  return *store;
+}
+
+void hostPreferencesReset() {
+  HostSystemAlloc system;
+  flash().clear();
+  nvsStats = HostNvsStats();
+  failingWrites = 0;
+}
+
+void hostNvsFailWrites(uint32_t count) {
+  failingWrites = count;
+}
+
+HostNvsStats hostNvsStats() {
+  return nvsStats;
+}
+
+Preferences::Preferences() : opened(false), readOnly(false) {
+  ns[0] = '\0';
+}
+
+Preferences::~Preferences() {
+  end();
+}
+
+bool Preferences::begin(const char *name, bool readOnlyMode, const char *partition) {
+  (void)partition;
+  if (opened || !name || strlen(name) > NVS_NAME_MAX) {
+    return false;
+  }
+  nvsStats.opens++;
+  HostSystemAlloc system;
+  // Like nvs_open(): a read-only open of a namespace that was never written fails
+  if (readOnlyMode && flash().count(name) == 0) {
+    return false;
+  }
+  if (!readOnlyMode) {
+    flash()[name];
+  }
+  strcpy(ns, name);
+  opened = true;
+  readOnly = readOnlyMode;
+  return true;
+}
+
+void Preferences::end() {
+  opened = false;
+}
+
+bool Preferences::writable(const char *key) const {
+  return opened && !readOnly && key && strlen(key) <= NVS_NAME_MAX;
+}
+
+bool Preferences::clear() {
+  if (!opened || readOnly) {
+    return false;
+  }
+  HostSystemAlloc system;
+  flash()[ns].clear();
+  nvsStats.writes++;
+  return true;
+}
+
+bool Preferences::remove(const char *key) {
+  if (!writable(key)) {
+    return false;
+  }
+  HostSystemAlloc system;
+  bool removed = flash()[ns].erase(key) > 0;
+  if (removed) {
+    nvsStats.writes++;
+  }
+  return removed;
+}
+
+bool Preferences::isKey(const char *key) {
+  if (!opened || !key) {
+    return false;
+  }
+  HostSystemAlloc system;
+  Namespace &values = flash()[ns];
+  return values.find(key) != values.end();
+}
+
+size_t Preferences::put(const char *key, uint8_t type, const void *value, size_t len) {
+  if (!writable(key)) {
+    return 0;
+  }
+  if (failingWrites > 0) {
+    failingWrites--;
+    return 0;  // Nothing stored, as when nvs_set_* fails
+  }
+  HostSystemAlloc system;
+  StoredValue &stored = flash()[ns][key];
+  stored.type = type;
+  stored.bytes.assign((const uint8_t *)value, (const uint8_t *)value + len);
+  nvsStats.writes++;
+  nvsStats.bytesWritten += len;
+  return len;
+}
+
+bool Preferences::get(const char *key, uint8_t type, void *out, size_t len) {
+  if (!opened || !key) {
+    return false;
+  }
+  HostSystemAlloc system;
+  Namespace &values = flash()[ns];
+  Namespace::iterator it = values.find(key);
+  if (it == values.end() || it->second.type != type || it->second.bytes.size() != len) {
+    return false;
+  }
+  memcpy(out, it->second.bytes.data(), len);
+  return true;
+}
+
+size_t Preferences::putBool(const char *key, bool value) {
+  uint8_t v = value ? 1 : 0;
+  return put(key, TYPE_U8, &v, 1);
+}
+
+size_t Preferences::putInt(const char *key, int32_t value) {
+  return put(key, TYPE_I32, &value, 4);
+}
+
+size_t Preferences::putUInt(const char *key, uint32_t value) {
+  return put(key, TYPE_U32, &value, 4);
+}
+
+size_t Preferences::putLong(const char *key, int32_t value) {
+  return put(key, TYPE_I32, &value, 4);
+}
+
+size_t Preferences::putULong(const char *key, uint32_t value) {
+  return put(key, TYPE_U32, &value, 4);
+}
+
+size_t Preferences::putFloat(const char *key, float value) {
+  return put(key, TYPE_FLOAT, &value, 4);
+}
+
+size_t Preferences::putString(const char *key, const char *value) {
+  if (!value) {
+    return 0;
+  }
+  return put(key, TYPE_STRING, value, strlen(value));
+}
+
+size_t Preferences::putString(const char *key, const String &value) {
+  return put(key, TYPE_STRING, value.c_str(), value.length());
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t len) {
+  if (!value || len == 0) {
+    return 0;
+  }
+  return put(key, TYPE_BLOB, value, len);
+}
+
+bool Preferences::getBool(const char *key, bool defaultValue) {
+  uint8_t v;
+  return get(key, TYPE_U8, &v, 1) ? v != 0 : defaultValue;
+}
+
+int32_t Preferences::getInt(const char *key, int32_t defaultValue) {
+  int32_t v;
+  return get(key, TYPE_I32, &v, 4) ? v : defaultValue;
+}
+
+uint32_t Preferences::getUInt(const char *key, uint32_t defaultValue) {
+  uint32_t v;
+  return get(key, TYPE_U32, &v, 4) ? v : defaultValue;
+}
+
+int32_t Preferences::getLong(const char *key, int32_t defaultValue) {
+  return getInt(key, defaultValue);
+}
+
+uint32_t Preferences::getULong(const char *key, uint32_t defaultValue) {
+  return getUInt(key, defaultValue);
+}
+
+float Preferences::getFloat(const char *key, float defaultValue) {
+  float v;
+  return get(key, TYPE_FLOAT, &v, 4) ? v : defaultValue;
+}
+
+String Preferences::getString(const char *key, const String &defaultValue) {
+  if (!opened || !key) {
+    return defaultValue;
+  }
+  const StoredValue *stored = nullptr;
+  {
+    HostSystemAlloc system;
+    Namespace &values = flash()[ns];
+    Namespace::iterator it = values.find(key);
+    if (it == values.end() || it->second.type != TYPE_STRING) {
+      return defaultValue;
+    }
+    stored = &it->second;
+  }
+  // The returned String is device heap, like on the chip
+  String out;
+  out.concat((const char *)stored->bytes.data(), stored->bytes.size());
+  return out;
+}
+
+size_t Preferences::getString(const char *key, char *value, size_t maxLen) {
+  if (!opened || !key) {
+    return 0;
+  }
+  HostSystemAlloc system;
+  Namespace &values = flash()[ns];
+  Namespace::iterator it = values.find(key);
+  if (it == values.end() || it->second.type != TYPE_STRING) {
+    return 0;
+  }
+  size_t len = it->second.bytes.size();
+  if (!value) {
+    return len + 1;
+  }
+  if (len + 1 > maxLen) {
+    return 0;
+  }
+  memcpy(value, it->second.bytes.data(), len);
+  value[len] = '\0';
+  return len + 1;
+}
+
+size_t Preferences::getBytesLength(const char *key) {
+  if (!opened || !key) {
+    return 0;
+  }
+  HostSystemAlloc system;
+  Namespace &values = flash()[ns];
+  Namespace::iterator it = values.find(key);
+  if (it == values.end() || it->second.type != TYPE_BLOB) {
+    return 0;
+  }
+  return it->second.bytes.size();
+}
+
+size_t Preferences::getBytes(const char *key, void *buf, size_t maxLen) {
+  if (!opened || !key || !buf) {
+    return 0;
+  }
+  HostSystemAlloc system;
+  Namespace &values = flash()[ns];
+  Namespace::iterator it = values.find(key);
+  if (it == values.end() || it->second.type != TYPE_BLOB || it->second.bytes.size() > maxLen) {
+    return 0;
+  }
+  memcpy(buf, it->second.bytes.data(), it->second.bytes.size());
+  return it->second.bytes.size();
+}
@@ -0,0 +1,51 @@
+#ifndef PREFERENCES_H
+#define PREFERENCES_H
+
+#include <Arduino.h>
+
+// Host stand-in for the NVS-backed Preferences library. Values live in
+// memory until hostReset(), typed like NVS: reading a key back as a
+// different type returns the default.
+class Preferences {
+ public:
+  Preferences();
+  ~Preferences();
+
+  bool begin(const char *name, bool readOnly = false, const char *partition = nullptr);
+  void end();
+  bool clear();
+  bool remove(const char *key);
+  bool isKey(const char *key);
+
+  size_t putBool(const char *key, bool value);
+  size_t putInt(const char *key, int32_t value);
+  size_t putUInt(const char *key, uint32_t value);
+  size_t putLong(const char *key, int32_t value);
+  size_t putULong(const char *key, uint32_t value);
+  size_t putFloat(const char *key, float value);
+  size_t putString(const char *key, const char *value);
+  size_t putString(const char *key, const String &value);
+  size_t putBytes(const char *key, const void *value, size_t len);
+
+  bool getBool(const char *key, bool defaultValue = false);
+  int32_t getInt(const char *key, int32_t defaultValue = 0);
+  uint32_t getUInt(const char *key, uint32_t defaultValue = 0);
+  int32_t getLong(const char *key, int32_t defaultValue = 0);
+  uint32_t getULong(const char *key, uint32_t defaultValue = 0);
+  float getFloat(const char *key, float defaultValue = NAN);
+  String getString(const char *key, const String &defaultValue = String());
+  size_t getString(const char *key, char *value, size_t maxLen);
+  size_t getBytesLength(const char *key);
+  size_t getBytes(const char *key, void *buf, size_t maxLen);
+
+ private:
+  bool writable(const char *key) const;
+  size_t put(const char *key, uint8_t type, const void *value, size_t len);
+  bool get(const char *key, uint8_t type, void *out, size_t len);
+
+  char ns[16];
+  bool opened;
+  bool readOnly;
+};
+
+#endif
@@ -0,0 +1,270 @@
+// Framebuffer drawing and the SSD1306 I2C protocol (HT_SSD1306Wire.h).
+
+#include <Wire.h>
+#include "HT_SSD1306Wire.h"
+
+#define SSD1306_COLUMNADDR 0x21
+#define SSD1306_PAGEADDR 0x22
+#define SSD1306_SETCONTRAST 0x81
+#define SSD1306_SETPRECHARGE 0xD9
+#define SSD1306_SETVCOMDETECT 0xDB
+#define SSD1306_DISPLAYOFF 0xAE
+#define SSD1306_DISPLAYON 0xAF
+#define DATA_CHUNK 16
+
+const uint8_t ArialMT_Plain_10[] = {0x0A, 0x0D, 0x20, 0xE0};
+const uint8_t ArialMT_Plain_16[] = {0x10, 0x13, 0x20, 0xE0};
+const uint8_t ArialMT_Plain_24[] = {0x18, 0x1C, 0x20, 0xE0};
+
+// A cell is about the real font's average glyph: 3/5 of the widest
+static int16_t cellWidth(const uint8_t *font) {
+  return font[0] * 3 / 5;
+}
+
+OLEDDisplay::OLEDDisplay(DISPLAY_GEOMETRY g) {
+  switch (g) {
+    case GEOMETRY_128_32:
+      displayWidth = 128;
+      displayHeight = 32;
+      break;
+    case GEOMETRY_64_48:
+      displayWidth = 64;
+      displayHeight = 48;
+      break;
+    case GEOMETRY_64_32:
+      displayWidth = 64;
+      displayHeight = 32;
+      break;
+    default:
+      displayWidth = 128;
+      displayHeight = 64;
+      break;
+  }
+}
+
+OLEDDisplay::~OLEDDisplay() {
+  free(buffer);
+}
+
+bool OLEDDisplay::init() {
+  if (!buffer) {
+    buffer = (uint8_t *)malloc(displayWidth * displayHeight / 8);
+    if (!buffer) {
+      return false;
+    }
+  }
+  connect();
+  static const uint8_t initSequence[] = {
+    SSD1306_DISPLAYOFF,
+    0xD5, 0xF0,        // Clock divide
+    0xA8, 0x3F,        // Multiplex: 64 rows
+    0xD3, 0x00,        // No display offset
+    0x40,              // Start line 0
+    0x8D, 0x14,        // Charge pump on
+    0x20, 0x00,        // Horizontal addressing
+    0xA1, 0xC8,        // Segment remap, COM scan down
+    0xDA, 0x12,        // COM pins
+    SSD1306_SETCONTRAST, 0xCF,
+    SSD1306_SETPRECHARGE, 0xF1,
+    SSD1306_SETVCOMDETECT, 0x40,
+    0xA4, 0xA6, 0x2E,  // Show RAM, not inverted, no scroll
+    SSD1306_DISPLAYON
+  };
+  for (uint8_t command : initSequence) {
+    sendCommand(command);
+  }
+  clear();
+  display();
+  return true;
+}
+
+void OLEDDisplay::displayOn() {
+  sendCommand(SSD1306_DISPLAYON);
+}
+
+void OLEDDisplay::displayOff() {
+  sendCommand(SSD1306_DISPLAYOFF);
+}
+
+void OLEDDisplay::setContrast(uint8_t contrast, uint8_t precharge, uint8_t comdetect) {
+  sendCommand(SSD1306_SETPRECHARGE);
+  sendCommand(precharge);
+  sendCommand(SSD1306_SETCONTRAST);
+  sendCommand(contrast);
+  sendCommand(SSD1306_SETVCOMDETECT);
+  sendCommand(comdetect);
+}
+
+void OLEDDisplay::clear() {
+  if (buffer) {
+    memset(buffer, 0, displayWidth * displayHeight / 8);
+  }
+}
+
+void OLEDDisplay::setPixel(int16_t x, int16_t y) {
+  if (buffer && x >= 0 && x < displayWidth && y >= 0 && y < displayHeight) {
+    buffer[x + (y / 8) * displayWidth] |= 1 << (y & 7);
+  }
+}
+
+void OLEDDisplay::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1) {
+  int16_t dx = abs(x1 - x0);
+  int16_t dy = -abs(y1 - y0);
+  int16_t sx = x0 < x1 ? 1 : -1;
+  int16_t sy = y0 < y1 ? 1 : -1;
+  int16_t err = dx + dy;
+  for (;;) {
+    setPixel(x0, y0);
+    if (x0 == x1 && y0 == y1) {
+      return;
+    }
+    int16_t e2 = 2 * err;
+    if (e2 >= dy) {
+      err += dy;
+      x0 += sx;
+    }
+    if (e2 <= dx) {
+      err += dx;
+      y0 += sy;
+    }
+  }
+}
+
+void OLEDDisplay::drawRect(int16_t x, int16_t y, int16_t width, int16_t height) {
+  if (width <= 0 || height <= 0) {
+    return;
+  }
+  drawLine(x, y, x + width - 1, y);
+  drawLine(x, y + height - 1, x + width - 1, y + height - 1);
+  drawLine(x, y, x, y + height - 1);
+  drawLine(x + width - 1, y, x + width - 1, y + height - 1);
+}
+
+void OLEDDisplay::fillRect(int16_t x, int16_t y, int16_t width, int16_t height) {
+  for (int16_t row = y; row < y + height; row++) {
+    for (int16_t column = x; column < x + width; column++) {
+      setPixel(column, row);
+    }
+  }
+}
+
+// XBM rows, least significant bit leftmost; clear bits are left alone
+void OLEDDisplay::drawXbm(int16_t x, int16_t y, int16_t width, int16_t height,
+                          const uint8_t *xbm) {
+  int16_t rowBytes = (width + 7) / 8;
+  for (int16_t row = 0; row < height; row++) {
+    for (int16_t column = 0; column < width; column++) {
+      if (pgm_read_byte(xbm + column / 8 + row * rowBytes) & (1 << (column & 7))) {
+        setPixel(x + column, y + row);
+      }
+    }
+  }
+}
+
+void OLEDDisplay::setFont(const uint8_t *fontData) {
+  font = fontData;
+}
+
+void OLEDDisplay::setTextAlignment(OLEDDISPLAY_TEXT_ALIGNMENT alignment) {
+  textAlignment = alignment;
+}
+
+// A pattern that differs from character to character, inside the cell's
+// glyph area (a column and the top and bottom rows stay clear)
+void OLEDDisplay::drawChar(int16_t x, int16_t y, uint8_t c) {
+  if (c == ' ') {
+    return;
+  }
+  int16_t cell = cellWidth(font);
+  int16_t rows = font[1];
+  for (int16_t row = 2; row < rows - 2; row++) {
+    for (int16_t column = 0; column < cell - 1; column++) {
+      uint32_t bits = (c * 2654435761u) ^ ((uint32_t)(row * 31 + column) * 40503u);
+      if ((bits >> 7) & 1) {
+        setPixel(x + column, y + row);
+      }
+    }
+  }
+}
+
+uint16_t OLEDDisplay::getStringWidth(const String &text) {
+  uint16_t widest = 0;
+  uint16_t length = 0;
+  for (unsigned int i = 0; i <= text.length(); i++) {
+    if (i == text.length() || text.charAt(i) == '\n') {
+      widest = max(widest, (uint16_t)(length * cellWidth(font)));
+      length = 0;
+    } else {
+      length++;
+    }
+  }
+  return widest;
+}
+
+uint16_t OLEDDisplay::drawString(int16_t x, int16_t y, const String &text) {
+  int16_t lineHeight = font[1];
+  int16_t cell = cellWidth(font);
+  int lines = 1;
+  for (unsigned int i = 0; i < text.length(); i++) {
+    lines += text.charAt(i) == '\n';
+  }
+  if (textAlignment == TEXT_ALIGN_CENTER_BOTH) {
+    y -= lines * lineHeight / 2;
+  }
+
+  unsigned int start = 0;
+  for (int line = 0; line < lines; line++) {
+    unsigned int end = start;
+    while (end < text.length() && text.charAt(end) != '\n') {
+      end++;
+    }
+    int16_t width = (end - start) * cell;
+    int16_t left = x;
+    if (textAlignment == TEXT_ALIGN_RIGHT) {
+      left -= width;
+    } else if (textAlignment != TEXT_ALIGN_LEFT) {
+      left -= width / 2;
+    }
+    for (unsigned int i = start; i < end; i++) {
+      drawChar(left + (i - start) * cell, y + line * lineHeight, (uint8_t)text.charAt(i));
+    }
+    start = end + 1;
+  }
+  return getStringWidth(text);
+}
+
+// ---------------------------------------------------------------------------
+// SSD1306Wire
+
+SSD1306Wire::SSD1306Wire(uint8_t address, uint32_t freq, int sda, int scl, DISPLAY_GEOMETRY g,
+                         int8_t rst)
+    : OLEDDisplay(g), address(address), freq(freq), sda(sda), scl(scl) {
+  (void)rst;
+}
+
+void SSD1306Wire::connect() {
+  Wire.begin(sda, scl, freq);
+}
+
+void SSD1306Wire::sendCommand(uint8_t command) {
+  Wire.beginTransmission(address);
+  Wire.write(0x80);
+  Wire.write(command);
+  Wire.endTransmission();
+}
+
+void SSD1306Wire::display() {
+  sendCommand(SSD1306_COLUMNADDR);
+  sendCommand(0);
+  sendCommand(displayWidth - 1);
+  sendCommand(SSD1306_PAGEADDR);
+  sendCommand(0);
+  sendCommand(displayHeight / 8 - 1);
+  size_t bytes = displayWidth * displayHeight / 8;
+  for (size_t at = 0; at < bytes; at += DATA_CHUNK) {
+    Wire.beginTransmission(address);
+    Wire.write(0x40);
+    Wire.write(buffer + at, min((size_t)DATA_CHUNK, bytes - at));
+    Wire.endTransmission();
+  }
+}
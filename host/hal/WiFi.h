@@ -0,0 +1,40 @@
+#ifndef WIFI_H
+#define WIFI_H
+
+#include <Arduino.h>
+#include "IPAddress.h"
+#include "WiFiClient.h"
+
+typedef enum {
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 } wifi_mode_t;
+
+// Station mode against the access point in host_net.h: begin() connects at
+// once when hostWiFiSetAvailable(true) (the default), otherwise it fails
+class WiFiClass {
+ public:
+  wl_status_t begin();
+  wl_status_t begin(const char *ssid, const char *passphrase = nullptr);
+  bool disconnect(bool wifiOff = false);
+  wl_status_t status();
+  bool mode(wifi_mode_t mode);
+  wifi_mode_t getMode();
+  bool setSleep(bool enabled);
+  bool setAutoReconnect(bool enabled);
+  IPAddress localIP();
+  int8_t RSSI();
+  String SSID();
+  String macAddress();
+  int hostByName(const char *host, IPAddress &result);
+};
+
+extern WiFiClass WiFi;
+
+#endif
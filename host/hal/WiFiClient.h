@@ -0,0 +1,47 @@
+#ifndef WIFICLIENT_H
+#define WIFICLIENT_H
+
+#include <Arduino.h>
+#include "IPAddress.h"
+
+struct HostConnection;
+
+// A socket to the stand-in server in host_net.h. Reads return whatever the
+// server's responses left in the receive buffer; an empty buffer reads as
+// -1 straight away instead of waiting out the timeout.
+class WiFiClient : public Stream {
+ public:
+  WiFiClient();
+  virtual ~WiFiClient();
+  WiFiClient(const WiFiClient &) = delete;
+  WiFiClient &operator=(const WiFiClient &) = delete;
+
+  virtual int connect(IPAddress ip, uint16_t port);
+  virtual int connect(const char *host, uint16_t port);
+  virtual void stop();
+  virtual uint8_t connected();
+  operator bool() {
+    return connected();
+  }
+
+  int available() override;
+  int read() override;
+  int peek() override;
+  int read(uint8_t *out, size_t size);
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *data, size_t size) override;
+  using Print::write;
+
+  // Host side: the connection the HTTPClient stand-in exchanges requests on
+  HostConnection *hostConnection() {
+    return connection;
+  }
+
+ protected:
+  bool open(IPAddress ip, bool secure);
+  bool openByName(const char *host, bool secure);
+
+  HostConnection *connection;
+};
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef WIFICLIENTSECURE_H
+#define WIFICLIENTSECURE_H
+
+#include "WiFiClient.h"
+
+// Certificates aren't checked on the host. A connection holds a block of
+// device heap the size of an mbedTLS session (HOST_TLS_SESSION_BYTES in
+// host_net.h) for as long as it is open, as the chip's does.
+class WiFiClientSecure : public WiFiClient {
+ public:
+  void setInsecure() {}
+  void setCACert(const char *cert) {
+    (void)cert;
+  }
+  void setHandshakeTimeout(unsigned long seconds) {
+    (void)seconds;
+  }
+
+  int connect(IPAddress ip, uint16_t port) override;
+  int connect(const char *host, uint16_t port) override;
+  int connect(IPAddress ip, uint16_t port, const char *host, const char *rootCa,
+              const char *cliCert, const char *cliKey);
+};
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef WIFIMANAGER_H
+#define WIFIMANAGER_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+// Host stand-in for tzapu's WiFiManager. There is no captive portal: both
+// connect calls join the access point in host_net.h the way a saved network
+// would, and fail when it's unavailable (hostWiFiSetAvailable(false)).
+class WiFiManager {
+ public:
+  void setCustomHeadElement(const char *) {}
+  void setTitle(const String &) {}
+  void setConnectTimeout(unsigned long) {}
+  void setConfigPortalTimeout(unsigned long) {}
+  void setWiFiAutoReconnect(bool) {}
+
+  bool autoConnect(const char *) {
+    return join();
+  }
+
+  bool startConfigPortal(const char *) {
+    return join();
+  }
+
+ private:
+  bool join() {
+    WiFi.mode(WIFI_STA);
+    return WiFi.begin() == WL_CONNECTED;
+  }
+};
+
+#endif
@@ -0,0 +1,207 @@
+// I2C and the SSD1306 panel behind it (host_panel.h).
+
+#include <Wire.h>
+#include "host_hal.h"
+#include "host_panel.h"
+
+#define PANEL_ADDRESS 0x3c
+#define SSD1306_COLUMNADDR 0x21
+#define SSD1306_PAGEADDR 0x22
+#define SSD1306_SETCONTRAST 0x81
+#define SSD1306_DISPLAYOFF 0xAE
+#define SSD1306_DISPLAYON 0xAF
+
+TwoWire Wire;
+
+struct Panel {
+  uint8_t ram[HOST_PANEL_WIDTH * HOST_PANEL_PAGES];
+  bool on;
+  uint8_t contrast;
+  uint8_t columnStart, columnEnd, pageStart, pageEnd;
+  uint8_t column, page;
+  // A command still waiting for its argument bytes
+  uint8_t command;
+  uint8_t args[2];
+  uint8_t argsWanted, argsHave;
+  HostPanelStats stats;
+};
+
+static Panel panel;
+
+void hostPanelReset() {
+  memset(&panel, 0, sizeof(panel));
+  panel.contrast = 0x7F;
+  panel.columnEnd = HOST_PANEL_WIDTH - 1;
+  panel.pageEnd = HOST_PANEL_PAGES - 1;
+}
+
+static struct PanelDefaults {
+  PanelDefaults() {
+    hostPanelReset();
+  }
+} panelDefaults;
+
+// Argument bytes that follow a command byte
+static uint8_t argumentCount(uint8_t command) {
+  switch (command) {
+    case SSD1306_COLUMNADDR:
+    case SSD1306_PAGEADDR:
+      return 2;
+    case 0x20:  // Memory addressing mode
+    case SSD1306_SETCONTRAST:
+    case 0x8D:  // Charge pump
+    case 0xA8:  // Multiplex ratio
+    case 0xD3:  // Display offset
+    case 0xD5:  // Clock divide
+    case 0xD9:  // Precharge
+    case 0xDA:  // COM pins
+    case 0xDB:  // VCOMH deselect level
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+static void runCommand() {
+  switch (panel.command) {
+    case SSD1306_COLUMNADDR:
+      panel.columnStart = panel.args[0] & 0x7F;
+      panel.columnEnd = panel.args[1] & 0x7F;
+      panel.column = panel.columnStart;
+      break;
+    case SSD1306_PAGEADDR:
+      panel.pageStart = panel.args[0] & 0x07;
+      panel.pageEnd = panel.args[1] & 0x07;
+      panel.page = panel.pageStart;
+      break;
+    case SSD1306_SETCONTRAST:
+      panel.contrast = panel.args[0];
+      break;
+    case SSD1306_DISPLAYOFF:
+      panel.on = false;
+      break;
+    case SSD1306_DISPLAYON:
+      panel.on = true;
+      break;
+    default:
+      break;
+  }
+}
+
+static void commandByte(uint8_t value) {
+  if (panel.argsHave < panel.argsWanted) {
+    panel.args[panel.argsHave++] = value;
+  } else {
+    panel.command = value;
+    panel.argsWanted = argumentCount(value);
+    panel.argsHave = 0;
+  }
+  if (panel.argsHave == panel.argsWanted) {
+    runCommand();
+  }
+}
+
+// Horizontal addressing: across the column window, then down a page
+static void dataByte(uint8_t value) {
+  panel.ram[panel.column + panel.page * HOST_PANEL_WIDTH] = value;
+  panel.stats.dataBytes++;
+  if (panel.column < panel.columnEnd) {
+    panel.column++;
+    return;
+  }
+  panel.column = panel.columnStart;
+  panel.page = panel.page < panel.pageEnd ? panel.page + 1 : panel.pageStart;
+}
+
+// A control byte with Co set covers one byte, and another control byte
+// follows; without it, the rest of the transmission
+static void receive(const uint8_t *bytes, size_t length) {
+  size_t at = 0;
+  while (at < length) {
+    uint8_t control = bytes[at++];
+    bool data = control & 0x40;
+    size_t end = (control & 0x80) ? min(at + 1, length) : length;
+    for (; at < end; at++) {
+      if (data) {
+        dataByte(bytes[at]);
+      } else {
+        commandByte(bytes[at]);
+      }
+    }
+  }
+}
+
+const uint8_t *hostPanelRam() {
+  return panel.ram;
+}
+
+bool hostPanelPixel(int x, int y) {
+  if (x < 0 || x >= HOST_PANEL_WIDTH || y < 0 || y >= HOST_PANEL_PAGES * 8) {
+    return false;
+  }
+  return (panel.ram[x + (y / 8) * HOST_PANEL_WIDTH] >> (y & 7)) & 1;
+}
+
+bool hostPanelOn() {
+  return panel.on;
+}
+
+uint8_t hostPanelContrast() {
+  return panel.contrast;
+}
+
+HostPanelStats hostPanelStats() {
+  return panel.stats;
+}
+
+// ---------------------------------------------------------------------------
+// TwoWire
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency) {
+  (void)sda;
+  (void)scl;
+  if (frequency) {
+    setClock(frequency);
+  }
+  return true;
+}
+
+void TwoWire::setClock(uint32_t frequency) {
+  this->frequency = frequency;
+}
+
+void TwoWire::beginTransmission(uint16_t address) {
+  this->address = address;
+  txLength = 0;
+}
+
+size_t TwoWire::write(uint8_t data) {
+  if (txLength >= I2C_BUFFER_LENGTH) {
+    return 0;
+  }
+  txBuffer[txLength++] = data;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t length) {
+  size_t written = 0;
+  while (written < length && write(data[written])) {
+    written++;
+  }
+  return written;
+}
+
+// Nine clocks a byte (eight bits and the ack), address byte included
+uint8_t TwoWire::endTransmission(bool sendStop) {
+  (void)sendStop;
+  uint64_t busUs = (uint64_t)(txLength + 1) * 9 * 1000000 / frequency;
+  hostAdvanceUs(busUs);
+  if (address != PANEL_ADDRESS) {
+    return 2;
+  }
+  receive(txBuffer, txLength);
+  panel.stats.transmissions++;
+  panel.stats.bytes += txLength;
+  panel.stats.busUs += busUs;
+  return 0;
+}
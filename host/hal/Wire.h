@@ -0,0 +1,35 @@
+#ifndef WIRE_H
+#define WIRE_H
+
+#include <Arduino.h>
+
+#define I2C_BUFFER_LENGTH 128
+
+// I2C master. The only device on the bus is the SSD1306 panel at 0x3c
+// (host_panel.h); a transmission to any other address is not acknowledged.
+// Each transmission moves the virtual clock by its time on the bus.
+class TwoWire {
+ public:
+  bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+  void setClock(uint32_t frequency);
+
+  void beginTransmission(uint16_t address);
+  // 0 on success, 2 when the address isn't acknowledged
+  uint8_t endTransmission(bool sendStop = true);
+  // Bytes past the 128-byte transmit buffer are dropped, as on the chip
+  size_t write(uint8_t data);
+  size_t write(const uint8_t *data, size_t length);
+  size_t write(int data) {
+    return write((uint8_t)data);
+  }
+
+ private:
+  uint32_t frequency = 100000;
+  uint16_t address = 0;
+  uint8_t txBuffer[I2C_BUFFER_LENGTH];
+  size_t txLength = 0;
+};
+
+extern TwoWire Wire;
+
+#endif
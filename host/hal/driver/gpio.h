@@ -0,0 +1,51 @@
+#ifndef DRIVER_GPIO_H
+#define DRIVER_GPIO_H
+
+#include "esp_err.h"
+
+typedef int gpio_num_t;
+
+typedef enum {
+  GPIO_INTR_DISABLE = 0,
+  GPIO_INTR_POSEDGE,
+  GPIO_INTR_NEGEDGE,
+  GPIO_INTR_ANYEDGE,
+  GPIO_INTR_LOW_LEVEL,
+  GPIO_INTR_HIGH_LEVEL
+} gpio_int_type_t;
+
+// Interrupt and wake-up configuration has nothing to drive on the host
+inline esp_err_t gpio_intr_enable(gpio_num_t pin) {
+  (void)pin;
+  return ESP_OK;
+}
+inline esp_err_t gpio_intr_disable(gpio_num_t pin) {
+  (void)pin;
+  return ESP_OK;
+}
+inline esp_err_t gpio_set_intr_type(gpio_num_t pin, gpio_int_type_t type) {
+  (void)pin;
+  (void)type;
+  return ESP_OK;
+}
+inline esp_err_t gpio_wakeup_enable(gpio_num_t pin, gpio_int_type_t type) {
+  (void)pin;
+  (void)type;
+  return ESP_OK;
+}
+inline esp_err_t gpio_wakeup_disable(gpio_num_t pin) {
+  (void)pin;
+  return ESP_OK;
+}
+inline esp_err_t gpio_hold_en(gpio_num_t pin) {
+  (void)pin;
+  return ESP_OK;
+}
+inline esp_err_t gpio_hold_dis(gpio_num_t pin) {
+  (void)pin;
+  return ESP_OK;
+}
+inline void gpio_deep_sleep_hold_en() {
+}
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef DRIVER_RTC_IO_H
+#define DRIVER_RTC_IO_H
+
+#include "driver/gpio.h"
+
+inline esp_err_t rtc_gpio_pullup_en(gpio_num_t pin) {
+  (void)pin;
+  return ESP_OK;
+}
+inline esp_err_t rtc_gpio_pulldown_dis(gpio_num_t pin) {
+  (void)pin;
+  return ESP_OK;
+}
+inline esp_err_t rtc_gpio_deinit(gpio_num_t pin) {
+  (void)pin;
+  return ESP_OK;
+}
+
+#endif
@@ -0,0 +1,101 @@
+#include <Arduino.h>
+#include <esp_sleep.h>
+#include "host_hal.h"
+
+static uint64_t timerWakeUs = 0;
+static esp_sleep_wakeup_cause_t wakeCause = ESP_SLEEP_WAKEUP_UNDEFINED;
+static bool pressPending = false;
+static uint8_t pressPin = 0;
+static uint64_t pressAtUs = 0;
+static uint64_t ext1Status = 0;
+static HostSleepStats stats = {};
+
+void hostClockBoot();
+
+// Time from now to the wake-up; a pending press that comes first is used up
+static uint64_t sleepFor(bool &byButton) {
+  uint64_t startUs = hostNowUs();
+  uint64_t wakeUs = startUs + timerWakeUs;
+  byButton = pressPending && pressAtUs <= wakeUs;
+  if (byButton) {
+    wakeUs = pressAtUs > startUs ? pressAtUs : startUs;
+    pressPending = false;
+    stats.buttonWakes++;
+  }
+  return wakeUs - startUs;
+}
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t timeUs) {
+  timerWakeUs = timeUs;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup() {
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_ext1_wakeup(uint64_t mask, esp_sleep_ext1_wakeup_mode_t mode) {
+  (void)mask;
+  (void)mode;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_disable_wakeup_source(esp_sleep_source_t source) {
+  (void)source;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_pd_config(esp_sleep_pd_domain_t domain, esp_sleep_pd_option_t option) {
+  (void)domain;
+  (void)option;
+  return ESP_OK;
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() {
+  return wakeCause;
+}
+
+uint64_t esp_sleep_get_ext1_wakeup_status() {
+  return ext1Status;
+}
+
+// The timer wakes it, unless a hostSleepPressAt() press comes first
+esp_err_t esp_light_sleep_start() {
+  bool byButton;
+  uint64_t sleptUs = sleepFor(byButton);
+  hostAdvanceUs(sleptUs);
+  wakeCause = byButton ? ESP_SLEEP_WAKEUP_GPIO : ESP_SLEEP_WAKEUP_TIMER;
+  stats.lightSleeps++;
+  stats.lightSleepUs += sleptUs;
+  return ESP_OK;
+}
+
+void esp_deep_sleep_start() {
+  bool byButton;
+  uint64_t sleptUs = sleepFor(byButton);
+  hostAdvanceUs(sleptUs);
+  hostClockBoot();
+  wakeCause = byButton ? ESP_SLEEP_WAKEUP_EXT1 : ESP_SLEEP_WAKEUP_TIMER;
+  ext1Status = byButton ? 1ULL << pressPin : 0;
+  stats.deepSleeps++;
+  stats.deepSleepUs += sleptUs;
+  throw HostDeepSleep();
+}
+
+void hostSleepPressAt(uint8_t pin, uint64_t atUs) {
+  pressPending = true;
+  pressPin = pin;
+  pressAtUs = atUs;
+}
+
+HostSleepStats hostSleepStats() {
+  return stats;
+}
+
+void hostSleepReset() {
+  timerWakeUs = 0;
+  wakeCause = ESP_SLEEP_WAKEUP_UNDEFINED;
+  pressPending = false;
+  ext1Status = 0;
+  stats = {};
+}
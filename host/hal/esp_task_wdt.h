@@ -0,0 +1,38 @@
+#ifndef ESP_TASK_WDT_H
+#define ESP_TASK_WDT_H
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// The host has no watchdog; feeding and (re)configuring it always succeeds
+typedef struct {
+  uint32_t timeout_ms;
+  uint32_t idle_core_mask;
+  bool trigger_panic;
+} esp_task_wdt_config_t;
+
+inline esp_err_t esp_task_wdt_init(const esp_task_wdt_config_t *config) {
+  (void)config;
+  return ESP_OK;
+}
+
+inline esp_err_t esp_task_wdt_reconfigure(const esp_task_wdt_config_t *config) {
+  (void)config;
+  return ESP_OK;
+}
+
+inline esp_err_t esp_task_wdt_add(void *task) {
+  (void)task;
+  return ESP_OK;
+}
+
+inline esp_err_t esp_task_wdt_delete(void *task) {
+  (void)task;
+  return ESP_OK;
+}
+
+inline esp_err_t esp_task_wdt_reset(void) {
+  return ESP_OK;
+}
+
+#endif
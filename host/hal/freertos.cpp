@@ -0,0 +1,427 @@
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <stdio.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "host_hal.h"
+
+#define LOOP_TASK_STACK 8192
+#define NEVER UINT64_MAX
+
+struct HostQueue;
+
+struct HostTask {
+  char name[16];
+  uint32_t stackBytes;
+  uint32_t headroom;
+  uint8_t *stack;       // Allocated like the chip does, so heap figures match
+  uint32_t notifications;
+  TaskFunction_t code;
+  void *param;
+  HostTask *next;       // Every task, in the order they were created
+  bool deleted;
+  // What the task is blocked on: the clock reaching wakeUs, or sooner
+  uint64_t wakeUs;
+  const HostQueue *waitQueue;  // ...an item (or a free slot) in this queue
+  bool waitForSpace;
+  bool waitForNotify;          // ...a notification
+  std::condition_variable *turn;  // Signalled when the baton comes to it
+};
+
+struct HostQueue {
+  uint8_t *items;       // Ring of length * itemSize bytes
+  UBaseType_t length;
+  UBaseType_t itemSize;
+  UBaseType_t head;
+  UBaseType_t count;
+};
+
+static HostTask loopTask = {"loopTask", LOOP_TASK_STACK, LOOP_TASK_STACK / 4, nullptr, 0,
+                            nullptr, nullptr, nullptr, false, 0, nullptr, false, false, nullptr};
+
+// One task runs at a time, on its own thread; the others wait for the
+// baton, each on its own condition so that passing it wakes only the task
+// that gets it - the threads of tasks a reboot dropped stay asleep. Never
+// destroyed, so task threads still parked at exit stay valid.
+static std::mutex *batonLock = nullptr;
+static HostTask *running = &loopTask;
+
+void hostFreeRtosReset() {
+  loopTask.headroom = LOOP_TASK_STACK / 4;
+  loopTask.notifications = 0;
+}
+
+// Called from the loop task. The dropped tasks' stacks and queues went with
+// the device heap; their TCBs stay, as their parked threads still look at
+// them.
+void hostFreeRtosReboot() {
+  for (HostTask *task = loopTask.next; task; task = task->next) {
+    task->deleted = true;
+    task->stack = nullptr;
+  }
+  loopTask.next = nullptr;
+  hostFreeRtosReset();
+}
+
+static void batonBegin() {
+  if (!batonLock) {
+    HostSystemAlloc system;
+    batonLock = new std::mutex;
+    loopTask.turn = new std::condition_variable;
+  }
+}
+
+static bool canRun(const HostTask *task) {
+  if (task->deleted) {
+    return false;
+  }
+  if (hostNowUs() >= task->wakeUs) {
+    return true;
+  }
+  const HostQueue *queue = task->waitQueue;
+  if (queue) {
+    return task->waitForSpace ? queue->count < queue->length : queue->count > 0;
+  }
+  return task->waitForNotify && task->notifications > 0;
+}
+
+// The next task after self that can run, round robin. If none can yet, the
+// clock moves to the earliest wake-up, as the idle task would sleep to it.
+static HostTask *pickNext(HostTask *self) {
+  HostTask *task = self;
+  do {
+    task = task->next ? task->next : &loopTask;
+    if (canRun(task)) {
+      return task;
+    }
+  } while (task != self);
+
+  HostTask *earliest = nullptr;
+  do {
+    task = task->next ? task->next : &loopTask;
+    if (!task->deleted && (!earliest || task->wakeUs < earliest->wakeUs)) {
+      earliest = task;
+    }
+  } while (task != self);
+  if (!earliest || earliest->wakeUs == NEVER) {
+    fprintf(stderr, "FreeRTOS stand-in: every task is blocked for good\n");
+    abort();
+  }
+  hostAdvanceUs(earliest->wakeUs - hostNowUs());
+  return earliest;
+}
+
+// Hand the baton on and wait for it to come back
+static void passBaton(HostTask *self) {
+  batonBegin();
+  std::unique_lock<std::mutex> lock(*batonLock);
+  running = pickNext(self);
+  if (running != self) {
+    running->turn->notify_one();
+    self->turn->wait(lock, [self] { return running == self; });
+  }
+}
+
+// Block the running task until the clock has moved by ticks (portMAX_DELAY:
+// never) or, sooner, until what it waits on is there
+static void block(TickType_t ticks, const HostQueue *queue, bool forSpace, bool forNotify) {
+  HostTask *self = running;
+  self->wakeUs = ticks == portMAX_DELAY ? NEVER : hostNowUs() + (uint64_t)ticks * portTICK_PERIOD_MS * 1000;
+  self->waitQueue = queue;
+  self->waitForSpace = forSpace;
+  self->waitForNotify = forNotify;
+  passBaton(self);
+  self->wakeUs = 0;
+  self->waitQueue = nullptr;
+  self->waitForNotify = false;
+}
+
+static void taskMain(HostTask *task) {
+  {
+    std::unique_lock<std::mutex> lock(*batonLock);
+    task->turn->wait(lock, [task] { return running == task; });
+  }
+  task->code(task->param);
+  // A task function must not return; treat it as deleting itself
+  vTaskDelete(nullptr);
+}
+
+// ---------------------------------------------------------------------------
+// Tasks
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char *name, uint32_t stackBytes,
+                                   void *param, UBaseType_t priority, TaskHandle_t *handle,
+                                   BaseType_t core) {
+  (void)priority;
+  (void)core;
+  HostTask *task;
+  {
+    HostSystemAlloc system;  // Outlives a reboot, see hostFreeRtosReboot()
+    task = (HostTask *)malloc(sizeof(HostTask));
+  }
+  uint8_t *stack = (uint8_t *)malloc(stackBytes);
+  if (!task || !stack) {
+    free(task);
+    free(stack);
+    return pdFAIL;
+  }
+  memset(task, 0, sizeof(HostTask));
+  strncpy(task->name, name ? name : "", sizeof(task->name) - 1);
+  task->stackBytes = stackBytes;
+  task->headroom = stackBytes / 4;
+  task->stack = stack;
+  task->code = code;
+  task->param = param;
+
+  // Last in the round robin; it first runs when the creator blocks
+  HostTask *last = &loopTask;
+  while (last->next) {
+    last = last->next;
+  }
+  last->next = task;
+  batonBegin();
+  {
+    HostSystemAlloc system;
+    task->turn = new std::condition_variable;
+    std::thread(taskMain, task).detach();
+  }
+  if (handle) {
+    *handle = task;
+  }
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t code, const char *name, uint32_t stackBytes, void *param,
+                       UBaseType_t priority, TaskHandle_t *handle) {
+  return xTaskCreatePinnedToCore(code, name, stackBytes, param, priority, handle, tskNO_AFFINITY);
+}
+
+// The task's thread stays parked; its stack goes back to the heap
+void vTaskDelete(TaskHandle_t task) {
+  HostTask *self = running;
+  if (!task) {
+    task = self;
+  }
+  if (task == &loopTask || task->deleted) {
+    return;
+  }
+  task->deleted = true;
+  free(task->stack);
+  task->stack = nullptr;
+  if (task == self) {
+    passBaton(self);  // Never comes back
+  }
+}
+
+void vTaskDelay(TickType_t ticks) {
+  block(ticks, nullptr, false, false);
+}
+
+void vTaskDelayUntil(TickType_t *previousWake, TickType_t period) {
+  TickType_t wake = *previousWake + period;
+  TickType_t now = xTaskGetTickCount();
+  if ((int32_t)(wake - now) > 0) {
+    vTaskDelay(wake - now);
+  }
+  *previousWake = wake;
+}
+
+void taskYIELD() {
+  block(0, nullptr, false, false);
+}
+
+TickType_t xTaskGetTickCount() {
+  return (TickType_t)millis();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  return running;
+}
+
+const char *pcTaskGetName(TaskHandle_t task) {
+  return (task ? task : running)->name;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+  return (task ? task : running)->headroom;
+}
+
+void hostSetStackHeadroom(TaskHandle_t task, uint32_t bytes) {
+  (task ? task : running)->headroom = bytes;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+  HostTask *self = running;
+  if (self->notifications == 0 && ticks > 0) {
+    block(ticks, nullptr, false, true);
+  }
+  uint32_t count = self->notifications;
+  if (count > 0) {
+    self->notifications = clearOnExit ? 0 : count - 1;
+  }
+  return count;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  if (task) {
+    task->notifications++;
+  }
+  return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken) {
+  xTaskNotifyGive(task);
+  if (woken) {
+    *woken = pdFALSE;
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Queues
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+  if (length == 0) {
+    return nullptr;
+  }
+  HostQueue *queue = (HostQueue *)malloc(sizeof(HostQueue) + (size_t)length * itemSize);
+  if (!queue) {
+    return nullptr;
+  }
+  queue->items = (uint8_t *)(queue + 1);
+  queue->length = length;
+  queue->itemSize = itemSize;
+  queue->head = 0;
+  queue->count = 0;
+  return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+  free(queue);
+}
+
+static uint8_t *slot(QueueHandle_t queue, UBaseType_t index) {
+  return queue->items + (size_t)((queue->head + index) % queue->length) * queue->itemSize;
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void *item, TickType_t ticks) {
+  if (!queue) {
+    return pdFAIL;
+  }
+  if (queue->count == queue->length && ticks > 0) {
+    block(ticks, queue, true, false);
+  }
+  if (queue->count == queue->length) {
+    return pdFAIL;
+  }
+  if (queue->itemSize > 0) {
+    memcpy(slot(queue, queue->count), item, queue->itemSize);
+  }
+  queue->count++;
+  return pdPASS;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks) {
+  return xQueueSendToBack(queue, item, ticks);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void *item, TickType_t ticks) {
+  if (!queue) {
+    return pdFAIL;
+  }
+  if (queue->count == queue->length && ticks > 0) {
+    block(ticks, queue, true, false);
+  }
+  if (queue->count == queue->length) {
+    return pdFAIL;
+  }
+  queue->head = (queue->head + queue->length - 1) % queue->length;
+  queue->count++;
+  if (queue->itemSize > 0) {
+    memcpy(slot(queue, 0), item, queue->itemSize);
+  }
+  return pdPASS;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *woken) {
+  if (woken) {
+    *woken = pdFALSE;
+  }
+  return xQueueSendToBack(queue, item, 0);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void *item) {
+  if (queue && queue->count == queue->length) {
+    queue->count--;
+  }
+  return xQueueSendToBack(queue, item, 0);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void *item, TickType_t ticks) {
+  if (!queue) {
+    return pdFAIL;
+  }
+  if (queue->count == 0 && ticks > 0) {
+    block(ticks, queue, false, false);
+  }
+  if (queue->count == 0) {
+    return pdFAIL;
+  }
+  if (queue->itemSize > 0) {
+    memcpy(item, slot(queue, 0), queue->itemSize);
+  }
+  return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks) {
+  if (xQueuePeek(queue, item, ticks) != pdPASS) {
+    return pdFAIL;
+  }
+  queue->head = (queue->head + 1) % queue->length;
+  queue->count--;
+  return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+  return queue ? queue->count : 0;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue) {
+  return queue ? queue->length - queue->count : 0;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue) {
+  if (queue) {
+    queue->head = 0;
+    queue->count = 0;
+  }
+  return pdPASS;
+}
+
+// ---------------------------------------------------------------------------
+// Semaphores: a full queue slot is a token
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+  return xQueueCreate(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+  SemaphoreHandle_t mutex = xQueueCreate(1, 0);
+  xSemaphoreGive(mutex);
+  return mutex;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks) {
+  return xQueueReceive(semaphore, nullptr, ticks);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+  return xQueueSendToBack(semaphore, nullptr, 0);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+  vQueueDelete(semaphore);
+}
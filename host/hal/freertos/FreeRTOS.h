@@ -0,0 +1,61 @@
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+#include <stdint.h>
+
+// Host stand-in for the FreeRTOS API the firmware uses. Each task gets a
+// thread (and a stack from the simulated heap), but only one runs at a
+// time: a task keeps the CPU until it blocks - vTaskDelay(), delay(),
+// yield(), or a queue, semaphore or notification wait with a timeout - and
+// the next task that can run takes over, round robin, with no regard for
+// priority or core. When none can, the virtual clock moves to the earliest
+// wake-up. The main thread is loopTask. Critical sections are no-ops, which
+// holds because nothing is preempted.
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+struct HostTask;
+struct HostQueue;
+typedef HostTask *TaskHandle_t;
+typedef HostQueue *QueueHandle_t;
+typedef HostQueue *SemaphoreHandle_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL 0
+#define pdPASS 1
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms) * configTICK_RATE_HZ / 1000)
+#define tskNO_AFFINITY 0x7fffffff
+
+typedef struct {
+  uint32_t owner;
+  uint32_t count;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED {0, 0}
+
+// Nesting is counted so an unbalanced enter/exit still shows up
+inline void portENTER_CRITICAL(portMUX_TYPE *mux) {
+  mux->count++;
+}
+
+inline void portEXIT_CRITICAL(portMUX_TYPE *mux) {
+  mux->count--;
+}
+
+inline void portENTER_CRITICAL_ISR(portMUX_TYPE *mux) {
+  mux->count++;
+}
+
+inline void portEXIT_CRITICAL_ISR(portMUX_TYPE *mux) {
+  mux->count--;
+}
+
+#define portYIELD_FROM_ISR(woken) ((void)(woken))
+
+#endif
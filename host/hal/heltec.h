@@ -0,0 +1,10 @@
+#ifndef HELTEC_H
+#define HELTEC_H
+
+// The Heltec board library's umbrella header; the firmware only needs what
+// it pulls in
+#include <Arduino.h>
+#include <Wire.h>
+#include "HT_SSD1306Wire.h"
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef HOST_HAL_H
+#define HOST_HAL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Controls for the host stand-ins of the Arduino core, Preferences and
+// FreeRTOS. Tests use these to move the clock, look at what the firmware
+// printed or stored, and size the simulated heap (host_heap.cpp).
+
+// Put everything back the way a fresh boot would see it: clock at zero,
+// NVS erased, serial capture empty, pins idle, random sequence reseeded,
+// WiFi down with no server (host_net.h), no sleep recorded.
+// The heap is left alone (see hostHeapBegin).
+void hostReset();
+
+// Virtual clock behind millis()/micros() and gettimeofday(). delay(),
+// vTaskDelay(), sleep and I2C transfers (Wire.h) move it; nothing else
+// does, so runs are repeatable.
+// hostNowUs() counts from hostReset(); millis() and micros() restart from
+// zero on a deep-sleep wake, the way they do on the chip.
+uint64_t hostNowUs();
+void hostAdvanceUs(uint64_t us);
+void hostAdvanceMs(uint32_t ms);
+
+// Everything written to Serial since the last hostReset()/hostSerialClear().
+// Set HOST_SERIAL=1 in the environment to also echo it to stdout.
+const char *hostSerialOutput();
+void hostSerialClear();
+
+// Level digitalRead() returns for a pin (inputs idle HIGH, like the buttons).
+// A change runs the pin's attachInterrupt() handler if the edge matches its
+// mode, on the calling thread, as the GPIO interrupt would.
+void hostSetPinLevel(uint8_t pin, int level);
+
+// Sleep entered since the last hostReset() (esp_sleep.h), measured here
+// rather than trusted from the firmware's own accounting
+struct HostSleepStats {
+  uint32_t lightSleeps;
+  uint32_t deepSleeps;
+  uint32_t buttonWakes;   // Sleeps a hostSleepPressAt() press cut short
+  uint64_t lightSleepUs;
+  uint64_t deepSleepUs;
+};
+HostSleepStats hostSleepStats();
+
+// Thrown by esp_deep_sleep_start() once the clock has moved to the wake-up
+// and millis() has restarted. The test catches it where the chip would
+// reboot and runs what setup() does. Nothing is reset by the throw itself:
+// see hostReboot() and tests/sketch_harness.h for a reboot that loses RAM.
+struct HostDeepSleep {};
+
+// The RAM a reboot loses, on the HAL's side: every task but the loop task
+// is dropped (its thread stays parked for good), the device heap starts
+// over empty, the radio is off and no pin interrupts are attached. The
+// firmware's statics are the caller's to put back; anything still pointing
+// into the device heap dangles. Call it from the loop task.
+void hostReboot();
+
+// A button press at hostNowUs() time atUs. A sleep still running then wakes
+// there with the GPIO cause; one press is pending at a time. The pin's
+// level isn't touched (see hostSetPinLevel).
+void hostSleepPressAt(uint8_t pin, uint64_t atUs);
+
+// NVS traffic since the last hostReset()
+struct HostNvsStats {
+  uint32_t writes;        // put*/remove/clear calls that reached flash
+  uint32_t bytesWritten;  // Value bytes of those writes
+  uint32_t opens;         // Namespaces opened (begin()), read-only ones too
+};
+HostNvsStats hostNvsStats();
+
+// Make the next count put*() calls fail without storing anything, like a
+// full partition or a flash error
+void hostNvsFailWrites(uint32_t count);
+
+// Switch malloc over to a device-sized arena. Allocations made before this
+// (static constructors, the test's own setup) stay in the system arena.
+// Only the first call counts: firmware statics keep pointers into the arena
+// (hostReboot() empties it once they've been thrown away).
+void hostHeapBegin(size_t bytes);
+
+struct HostHeapStats {
+  size_t sizeBytes;
+  size_t freeBytes;         // Free block bytes, headers included
+  size_t minFreeBytes;      // Low-water mark of freeBytes
+  size_t liveBytes;         // Payload bytes handed out
+  uint32_t allocations;
+  uint32_t failures;        // Requests that didn't fit
+  uint32_t freeBlocks;
+  size_t largestFreeBlock;  // Biggest single allocation that would succeed
+};
+HostHeapStats hostHeapStats();
+
+// Restart minFreeBytes from the current free bytes, to find the peak use
+// of one call
+void hostHeapResetLowWater();
+
+// While one of these is alive, malloc uses the system arena even after
+// hostHeapBegin(), so harness bookkeeping doesn't show up as device heap.
+class HostSystemAlloc {
+ public:
+  HostSystemAlloc();
+  ~HostSystemAlloc();
+  HostSystemAlloc(const HostSystemAlloc &) = delete;
+  HostSystemAlloc &operator=(const HostSystemAlloc &) = delete;
+};
+
+#endif
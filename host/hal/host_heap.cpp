@@ -0,0 +1,449 @@
+// Simulated device heap.
+//
+// Replaces malloc/free for the whole test process (glibc supports this, see
+// "Replacing malloc" in its manual) so that everything the firmware allocates
+// - Strings, JSON documents, new/delete - goes through one first-fit
+// allocator with boundary tags, like the ESP-IDF heap. Until hostHeapBegin()
+// allocations come from a large system arena; after it they come from a
+// device arena of the given size, and fail once it is full, so free heap,
+// the largest free block and fragmentation behave like they do on the chip.
+
+#include "host_hal.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <atomic>
+
+#define HEAP_ALIGN 16
+#define HEADER_SIZE 16
+#define MIN_BLOCK 32
+#define USED_BIT ((size_t)1)
+#define SYSTEM_ARENA_BYTES (64u << 20)
+#define DEVICE_ARENA_MAX_BYTES (4u << 20)
+
+// Header in front of every block. size includes the header and is a multiple
+// of HEAP_ALIGN; its low bit marks the block as used. prevSize is the size of
+// the block just below, so a freed block can merge with it.
+struct BlockHeader {
+  size_t size;
+  size_t prevSize;
+};
+
+// Free blocks keep their list links in the payload
+struct FreeLinks {
+  BlockHeader *next;
+  BlockHeader *prev;
+};
+
+struct Arena {
+  uint8_t *start;
+  uint8_t *end;          // Past the last block
+  BlockHeader *freeList;
+  size_t freeBytes;      // Sum of free block sizes (headers included)
+  size_t minFreeBytes;
+  size_t liveBytes;      // Payload bytes handed out
+  uint32_t allocations;
+  uint32_t failures;
+};
+
+alignas(HEAP_ALIGN) static uint8_t systemMemory[SYSTEM_ARENA_BYTES];
+alignas(HEAP_ALIGN) static uint8_t deviceMemory[DEVICE_ARENA_MAX_BYTES];
+static Arena systemArena;
+static Arena deviceArena;
+static bool deviceActive = false;
+static int systemDepth = 0;
+static std::atomic_flag heapLock = ATOMIC_FLAG_INIT;
+
+static void lock() {
+  while (heapLock.test_and_set(std::memory_order_acquire)) {
+  }
+}
+
+static void unlock() {
+  heapLock.clear(std::memory_order_release);
+}
+
+static size_t blockSize(const BlockHeader *block) {
+  return block->size & ~USED_BIT;
+}
+
+static bool isUsed(const BlockHeader *block) {
+  return (block->size & USED_BIT) != 0;
+}
+
+static FreeLinks *links(BlockHeader *block) {
+  return (FreeLinks *)(block + 1);
+}
+
+static BlockHeader *nextBlock(Arena &arena, BlockHeader *block) {
+  uint8_t *next = (uint8_t *)block + blockSize(block);
+  return next < arena.end ? (BlockHeader *)next : nullptr;
+}
+
+static void listInsert(Arena &arena, BlockHeader *block) {
+  // Address order keeps first-fit packing allocations low, like the chip
+  BlockHeader *prev = nullptr;
+  BlockHeader *cur = arena.freeList;
+  while (cur && cur < block) {
+    prev = cur;
+    cur = links(cur)->next;
+  }
+  links(block)->next = cur;
+  links(block)->prev = prev;
+  if (cur) {
+    links(cur)->prev = block;
+  }
+  if (prev) {
+    links(prev)->next = block;
+  } else {
+    arena.freeList = block;
+  }
+}
+
+static void listRemove(Arena &arena, BlockHeader *block) {
+  FreeLinks *l = links(block);
+  if (l->prev) {
+    links(l->prev)->next = l->next;
+  } else {
+    arena.freeList = l->next;
+  }
+  if (l->next) {
+    links(l->next)->prev = l->prev;
+  }
+}
+
+static void arenaInit(Arena &arena, uint8_t *memory, size_t bytes) {
+  bytes &= ~(size_t)(HEAP_ALIGN - 1);
+  arena.start = memory;
+  arena.end = memory + bytes;
+  arena.freeList = nullptr;
+  arena.liveBytes = 0;
+  arena.allocations = 0;
+  arena.failures = 0;
+  BlockHeader *block = (BlockHeader *)memory;
+  block->size = bytes;
+  block->prevSize = 0;
+  listInsert(arena, block);
+  arena.freeBytes = bytes;
+  arena.minFreeBytes = bytes;
+}
+
+static bool contains(const Arena &arena, const void *ptr) {
+  return arena.start && (const uint8_t *)ptr >= arena.start && (const uint8_t *)ptr < arena.end;
+}
+
+static size_t blockFor(size_t bytes) {
+  if (bytes > ((size_t)1 << 40)) {
+    return 0;
+  }
+  size_t size = (bytes + HEADER_SIZE + HEAP_ALIGN - 1) & ~(size_t)(HEAP_ALIGN - 1);
+  return size < MIN_BLOCK ? MIN_BLOCK : size;
+}
+
+// Cut block down to size, returning the tail to the free list
+static void split(Arena &arena, BlockHeader *block, size_t size) {
+  size_t total = blockSize(block);
+  if (total - size < MIN_BLOCK) {
+    return;
+  }
+  BlockHeader *rest = (BlockHeader *)((uint8_t *)block + size);
+  rest->size = total - size;
+  rest->prevSize = size;
+  block->size = size | (block->size & USED_BIT);
+  BlockHeader *after = nextBlock(arena, rest);
+  if (after) {
+    after->prevSize = rest->size;
+  }
+  listInsert(arena, rest);
+}
+
+static void *arenaAlloc(Arena &arena, size_t bytes) {
+  size_t size = blockFor(bytes);
+  if (size == 0) {
+    arena.failures++;
+    return nullptr;
+  }
+  for (BlockHeader *block = arena.freeList; block; block = links(block)->next) {
+    if (blockSize(block) >= size) {
+      listRemove(arena, block);
+      split(arena, block, size);
+      block->size |= USED_BIT;
+      arena.freeBytes -= blockSize(block);
+      if (arena.freeBytes < arena.minFreeBytes) {
+        arena.minFreeBytes = arena.freeBytes;
+      }
+      arena.liveBytes += blockSize(block) - HEADER_SIZE;
+      arena.allocations++;
+      return block + 1;
+    }
+  }
+  arena.failures++;
+  return nullptr;
+}
+
+static void arenaFree(Arena &arena, void *ptr) {
+  BlockHeader *block = (BlockHeader *)ptr - 1;
+  if (!isUsed(block)) {
+    abort();  // Double free
+  }
+  block->size &= ~USED_BIT;
+  arena.freeBytes += block->size;
+  arena.liveBytes -= block->size - HEADER_SIZE;
+
+  BlockHeader *after = nextBlock(arena, block);
+  if (after && !isUsed(after)) {
+    listRemove(arena, after);
+    block->size += after->size;
+  }
+  if (block->prevSize > 0) {
+    BlockHeader *before = (BlockHeader *)((uint8_t *)block - block->prevSize);
+    if (!isUsed(before)) {
+      listRemove(arena, before);
+      before->size += block->size;
+      block = before;
+    }
+  }
+  after = nextBlock(arena, block);
+  if (after) {
+    after->prevSize = block->size;
+  }
+  listInsert(arena, block);
+}
+
+// Shrinking hands the tail back in place, as multi_heap does, so a
+// shrinkToFit() really frees memory
+static void arenaShrink(Arena &arena, void *ptr, size_t bytes) {
+  BlockHeader *block = (BlockHeader *)ptr - 1;
+  size_t size = blockFor(bytes);
+  size_t total = blockSize(block);
+  if (total - size < MIN_BLOCK) {
+    return;
+  }
+  BlockHeader *rest = (BlockHeader *)((uint8_t *)block + size);
+  rest->size = (total - size) | USED_BIT;
+  rest->prevSize = size;
+  block->size = size | USED_BIT;
+  BlockHeader *after = nextBlock(arena, rest);
+  if (after) {
+    after->prevSize = total - size;
+  }
+  arena.liveBytes -= HEADER_SIZE;  // arenaFree() only takes back the tail's payload
+  arenaFree(arena, rest + 1);
+}
+
+static Arena &arenaFor(const void *ptr) {
+  return contains(deviceArena, ptr) ? deviceArena : systemArena;
+}
+
+static void *allocate(size_t bytes) {
+  lock();
+  if (!systemArena.start) {
+    arenaInit(systemArena, systemMemory, sizeof(systemMemory));
+  }
+  void *ptr = (deviceActive && systemDepth == 0) ? arenaAlloc(deviceArena, bytes)
+                                                 : arenaAlloc(systemArena, bytes);
+  unlock();
+  if (!ptr) {
+    errno = ENOMEM;
+  }
+  return ptr;
+}
+
+static size_t usableSize(void *ptr) {
+  return blockSize((BlockHeader *)ptr - 1) - HEADER_SIZE;
+}
+
+extern "C" {
+
+void *malloc(size_t bytes) {
+  return allocate(bytes);
+}
+
+void free(void *ptr) {
+  if (!ptr) {
+    return;
+  }
+  lock();
+  arenaFree(arenaFor(ptr), ptr);
+  unlock();
+}
+
+void *calloc(size_t count, size_t size) {
+  if (size != 0 && count > (size_t)-1 / size) {
+    errno = ENOMEM;
+    return nullptr;
+  }
+  void *ptr = allocate(count * size);
+  if (ptr) {
+    memset(ptr, 0, count * size);
+  }
+  return ptr;
+}
+
+void *realloc(void *ptr, size_t bytes) {
+  if (!ptr) {
+    return allocate(bytes);
+  }
+  if (bytes == 0) {
+    free(ptr);
+    return nullptr;
+  }
+  size_t old = usableSize(ptr);
+  if (bytes <= old) {
+    lock();
+    arenaShrink(arenaFor(ptr), ptr, bytes);
+    unlock();
+    return ptr;
+  }
+  void *grown = allocate(bytes);
+  if (grown) {
+    memcpy(grown, ptr, old);
+    free(ptr);
+  }
+  return grown;
+}
+
+size_t malloc_usable_size(void *ptr) {
+  return ptr ? usableSize(ptr) : 0;
+}
+
+// Over-allocate, then give the space in front of the aligned address back
+void *memalign(size_t alignment, size_t bytes) {
+  if (alignment <= HEAP_ALIGN) {
+    return allocate(bytes);
+  }
+  if ((alignment & (alignment - 1)) != 0) {
+    errno = EINVAL;
+    return nullptr;
+  }
+  uint8_t *raw = (uint8_t *)allocate(bytes + alignment + MIN_BLOCK);
+  if (!raw) {
+    return nullptr;
+  }
+  uintptr_t aligned = ((uintptr_t)raw + MIN_BLOCK + alignment - 1) & ~(uintptr_t)(alignment - 1);
+  lock();
+  Arena &arena = arenaFor(raw);
+  BlockHeader *block = (BlockHeader *)raw - 1;
+  BlockHeader *moved = (BlockHeader *)aligned - 1;
+  size_t front = (uint8_t *)moved - (uint8_t *)block;
+  size_t total = blockSize(block);
+  moved->size = (total - front) | USED_BIT;
+  moved->prevSize = front;
+  block->size = front | USED_BIT;
+  BlockHeader *after = nextBlock(arena, moved);
+  if (after) {
+    after->prevSize = total - front;
+  }
+  arena.liveBytes -= HEADER_SIZE;
+  arenaFree(arena, block + 1);
+  unlock();
+  return moved + 1;
+}
+
+void *aligned_alloc(size_t alignment, size_t bytes) {
+  return memalign(alignment, bytes);
+}
+
+int posix_memalign(void **out, size_t alignment, size_t bytes) {
+  if (alignment < sizeof(void *) || (alignment & (alignment - 1)) != 0) {
+    return EINVAL;
+  }
+  void *ptr = memalign(alignment, bytes);
+  if (!ptr) {
+    return ENOMEM;
+  }
+  *out = ptr;
+  return 0;
+}
+
+void *valloc(size_t bytes) {
+  return memalign(4096, bytes);
+}
+
+void *pvalloc(size_t bytes) {
+  return memalign(4096, (bytes + 4095) & ~(size_t)4095);
+}
+
+}  // extern "C"
+
+void hostHeapBegin(size_t bytes) {
+  if (bytes > DEVICE_ARENA_MAX_BYTES) {
+    bytes = DEVICE_ARENA_MAX_BYTES;
+  }
+  // stdout's buffer is allocated on first use; keep it out of the arena.
+  // So is the C library's time zone, which mktime() loads again on every
+  // call while TZ is unset, freeing the last copy - a copy that would be
+  // gone with the arena after a reboot. UTC, as on the chip.
+  static char stdoutBuffer[BUFSIZ];
+  if (!deviceActive) {
+    setvbuf(stdout, stdoutBuffer, isatty(STDOUT_FILENO) ? _IOLBF : _IOFBF, sizeof(stdoutBuffer));
+    setenv("TZ", "UTC0", 0);
+    tzset();
+  }
+  lock();
+  if (!systemArena.start) {
+    arenaInit(systemArena, systemMemory, sizeof(systemMemory));
+  }
+  // Firmware statics may hold blocks from the device arena, so it can't be
+  // started over
+  if (!deviceActive) {
+    arenaInit(deviceArena, deviceMemory, bytes);
+    deviceActive = true;
+  }
+  unlock();
+}
+
+// hostReboot(): whatever the arena held is gone
+void hostHeapReboot() {
+  lock();
+  if (deviceActive) {
+    arenaInit(deviceArena, deviceMemory, deviceArena.end - deviceArena.start);
+  }
+  unlock();
+}
+
+void hostHeapResetLowWater() {
+  lock();
+  Arena &arena = deviceActive ? deviceArena : systemArena;
+  arena.minFreeBytes = arena.freeBytes;
+  unlock();
+}
+
+HostHeapStats hostHeapStats() {
+  HostHeapStats stats = {};
+  lock();
+  const Arena &arena = deviceActive ? deviceArena : systemArena;
+  if (arena.start) {
+    stats.sizeBytes = arena.end - arena.start;
+    stats.freeBytes = arena.freeBytes;
+    stats.minFreeBytes = arena.minFreeBytes;
+    stats.liveBytes = arena.liveBytes;
+    stats.allocations = arena.allocations;
+    stats.failures = arena.failures;
+    for (BlockHeader *block = arena.freeList; block; block = links(block)->next) {
+      stats.freeBlocks++;
+      size_t payload = blockSize(block) - HEADER_SIZE;
+      if (payload > stats.largestFreeBlock) {
+        stats.largestFreeBlock = payload;
+      }
+    }
+  }
+  unlock();
+  return stats;
+}
+
+HostSystemAlloc::HostSystemAlloc() {
+  lock();
+  systemDepth++;
+  unlock();
+}
+
+HostSystemAlloc::~HostSystemAlloc() {
+  lock();
+  systemDepth--;
+  unlock();
+}
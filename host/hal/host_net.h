@@ -0,0 +1,70 @@
+#ifndef HOST_NET_H
+#define HOST_NET_H
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+#include "IPAddress.h"
+
+// The access point and API server the WiFi/HTTPClient stand-ins talk to.
+// Tests install a handler that plays the server and look at the traffic
+// afterwards. Handler code runs with HostSystemAlloc in effect, so the
+// std::strings here never show up as device heap.
+
+// Device heap an open WiFiClientSecure holds (mbedTLS in/out buffers and
+// contexts on the chip)
+#define HOST_TLS_SESSION_BYTES (20 * 1024)
+
+struct HostHttpRequest {
+  std::string method;
+  std::string path;  // After the host, with the query string
+  std::string body;
+  std::vector<std::pair<std::string, std::string>> headers;
+
+  std::string header(const char *name) const;  // "" if absent
+};
+
+struct HostHttpResponse {
+  int status = 200;
+  std::string body;
+  std::string etag;     // Sent as an ETag header when not empty
+  bool chunked = false; // Transfer-Encoding: chunked instead of Content-Length
+  bool close = false;   // Server closes the connection after this response
+  bool stream = false;  // Body is the start of a stream (see hostStreamSend)
+  uint32_t delayMs = 0; // Time the server takes to answer; other tasks run meanwhile
+};
+
+typedef std::function<HostHttpResponse(const HostHttpRequest &)> HostHttpHandler;
+
+// Serve every request with handler. An empty handler refuses connections.
+void hostHttpServe(HostHttpHandler handler);
+
+// More of the last stream response's body, as the server would send it
+// later on the same connection (Server-Sent Events). False if that
+// connection has been closed by either end.
+bool hostStreamSend(const std::string &text);
+
+// The server hangs up on the stream; the client reads out what's buffered
+void hostStreamClose();
+
+// Address the server's name resolves to and the only one it answers on
+// (default 192.0.2.10). Moving it leaves connections to the old address
+// failing, like a server that changed hosts; 0 makes lookups fail.
+void hostDnsSetAddress(IPAddress address);
+
+// Whether WiFi.begin() finds the access point (default true)
+void hostWiFiSetAvailable(bool available);
+
+struct HostNetStats {
+  uint32_t connections;  // Sockets opened (a TLS handshake each)
+  uint32_t requests;     // Requests that reached the handler
+  uint32_t wifiJoins;    // Successful WiFi.begin() calls
+  uint32_t lookups;      // Name lookups, connecting by name included
+};
+HostNetStats hostNetStats();
+
+// Back to no handler, WiFi off, the default address and zeroed stats (hostReset() calls this)
+void hostNetReset();
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef HOST_PANEL_H
+#define HOST_PANEL_H
+
+#include <stdint.h>
+
+// The SSD1306 OLED at I2C address 0x3c, as its controller sees the bus:
+// commands are parsed (addressing window, contrast, on/off) and data bytes
+// land in its display RAM. Tests read the RAM to see what is on screen.
+
+#define HOST_PANEL_WIDTH 128
+#define HOST_PANEL_PAGES 8
+
+// Display RAM, page-major: byte x + page * 128 holds rows page*8..page*8+7
+// of column x, lowest bit on top
+const uint8_t *hostPanelRam();
+
+// Pixel at (x, y) as last sent to the panel
+bool hostPanelPixel(int x, int y);
+
+// Display ON (0xAF) last rather than OFF (0xAE)
+bool hostPanelOn();
+
+uint8_t hostPanelContrast();
+
+struct HostPanelStats {
+  uint32_t transmissions;  // To the panel's address, acknowledged
+  uint32_t bytes;          // Their bytes, control bytes included
+  uint32_t dataBytes;      // Of those, bytes written to display RAM
+  uint64_t busUs;          // Time the bus spent on them
+};
+HostPanelStats hostPanelStats();
+
+// Blank RAM, display off, counts zeroed (hostReset() calls this)
+void hostPanelReset();
+
+#endif
@@ -0,0 +1,514 @@
+// WiFi, sockets and HTTPClient against an in-process server (host_net.h).
+//
+// Requests are handed to the test's handler synchronously; the response is
+// written into the client's receive buffer as it would arrive off the wire
+// (chunk framing included), so code reading the raw stream is exercised the
+// way it is on the chip. Everything the harness keeps - buffers, header
+// lists, the handler's strings - lives in the system arena.
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <WiFi.h>
+#include <WiFiClientSecure.h>
+#include <base64.h>
+#include "host_hal.h"
+#include "host_net.h"
+
+#define CHUNK_BYTES 256  // Chunk size for Transfer-Encoding: chunked replies
+
+struct HostConnection {
+  bool open = false;
+  bool closing = false;  // Server hangs up once the buffered bytes are read
+  void *tls = nullptr;   // Device heap held by a secure session
+  std::string rx;
+  size_t rxPos = 0;
+};
+
+struct HostHttpExchange {
+  std::string host;
+  std::string path;
+  std::vector<std::pair<std::string, std::string>> requestHeaders;
+  std::vector<std::string> collect;
+  std::vector<std::pair<std::string, std::string>> responseHeaders;
+};
+
+static HostHttpHandler *serverHandler = nullptr;
+static bool wifiAvailable = true;
+static bool wifiConnected = false;
+static wifi_mode_t wifiMode = WIFI_OFF;
+static uint32_t serverAddress = IPAddress(192, 0, 2, 10);
+static HostNetStats netStats = {};
+static HostConnection *streamConnection = nullptr;  // Last stream response's
+
+WiFiClass WiFi;
+
+std::string HostHttpRequest::header(const char *name) const {
+  for (const auto &h : headers) {
+    if (strcasecmp(h.first.c_str(), name) == 0) {
+      return h.second;
+    }
+  }
+  return std::string();
+}
+
+void hostHttpServe(HostHttpHandler handler) {
+  HostSystemAlloc system;
+  delete serverHandler;
+  serverHandler = handler ? new HostHttpHandler(std::move(handler)) : nullptr;
+}
+
+void hostDnsSetAddress(IPAddress address) {
+  serverAddress = address;
+}
+
+void hostWiFiSetAvailable(bool available) {
+  wifiAvailable = available;
+  if (!available) {
+    wifiConnected = false;
+  }
+}
+
+HostNetStats hostNetStats() {
+  return netStats;
+}
+
+void hostNetReset() {
+  hostHttpServe(nullptr);
+  wifiAvailable = true;
+  wifiConnected = false;
+  wifiMode = WIFI_OFF;
+  serverAddress = IPAddress(192, 0, 2, 10);
+  netStats = {};
+  streamConnection = nullptr;
+}
+
+// The radio comes up off after a reboot
+void hostNetReboot() {
+  wifiConnected = false;
+  wifiMode = WIFI_OFF;
+  streamConnection = nullptr;
+}
+
+bool hostStreamSend(const std::string &text) {
+  if (!streamConnection) {
+    return false;
+  }
+  HostSystemAlloc system;
+  streamConnection->rx += text;
+  return true;
+}
+
+void hostStreamClose() {
+  if (streamConnection) {
+    streamConnection->closing = true;
+    streamConnection = nullptr;
+  }
+}
+
+// ---------------------------------------------------------------------------
+// IPAddress, WiFi
+
+String IPAddress::toString() const {
+  char text[16];
+  snprintf(text, sizeof(text), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+  return String(text);
+}
+
+wl_status_t WiFiClass::begin() {
+  if (wifiMode == WIFI_OFF) {
+    wifiMode = WIFI_STA;
+  }
+  if (!wifiAvailable) {
+    return WL_DISCONNECTED;
+  }
+  if (!wifiConnected) {
+    wifiConnected = true;
+    netStats.wifiJoins++;
+  }
+  return WL_CONNECTED;
+}
+
+wl_status_t WiFiClass::begin(const char *ssid, const char *passphrase) {
+  (void)ssid;
+  (void)passphrase;
+  return begin();
+}
+
+bool WiFiClass::disconnect(bool wifiOff) {
+  wifiConnected = false;
+  if (wifiOff) {
+    wifiMode = WIFI_OFF;
+  }
+  return true;
+}
+
+wl_status_t WiFiClass::status() {
+  return wifiConnected ? WL_CONNECTED : WL_DISCONNECTED;
+}
+
+bool WiFiClass::mode(wifi_mode_t mode) {
+  wifiMode = mode;
+  if (mode == WIFI_OFF) {
+    wifiConnected = false;
+  }
+  return true;
+}
+
+wifi_mode_t WiFiClass::getMode() {
+  return wifiMode;
+}
+
+bool WiFiClass::setSleep(bool enabled) {
+  (void)enabled;
+  return true;
+}
+
+bool WiFiClass::setAutoReconnect(bool enabled) {
+  (void)enabled;
+  return true;
+}
+
+IPAddress WiFiClass::localIP() {
+  return wifiConnected ? IPAddress(192, 168, 4, 2) : IPAddress();
+}
+
+int8_t WiFiClass::RSSI() {
+  return wifiConnected ? -60 : 0;
+}
+
+String WiFiClass::SSID() {
+  return wifiConnected ? String("host") : String();
+}
+
+String WiFiClass::macAddress() {
+  return String("F6:E5:D4:C3:B2:A1");
+}
+
+// Every name resolves to the server's address (hostDnsSetAddress)
+int WiFiClass::hostByName(const char *host, IPAddress &result) {
+  (void)host;
+  if (!wifiConnected) {
+    return 0;
+  }
+  netStats.lookups++;
+  if (serverAddress == 0) {
+    return 0;
+  }
+  result = serverAddress;
+  return 1;
+}
+
+// ---------------------------------------------------------------------------
+// Sockets
+
+WiFiClient::WiFiClient() : connection(nullptr) {
+  HostSystemAlloc system;
+  connection = new HostConnection;
+}
+
+WiFiClient::~WiFiClient() {
+  stop();
+  HostSystemAlloc system;
+  delete connection;
+}
+
+bool WiFiClient::open(IPAddress ip, bool secure) {
+  stop();
+  if (!wifiConnected || !serverHandler || (uint32_t)ip == 0 || (uint32_t)ip != serverAddress) {
+    return false;  // Nothing listening there
+  }
+  netStats.connections++;
+  if (secure) {
+    connection->tls = malloc(HOST_TLS_SESSION_BYTES);
+    if (!connection->tls) {
+      return false;  // mbedTLS couldn't get its buffers
+    }
+  }
+  connection->open = true;
+  return true;
+}
+
+// Resolves first, as the core does
+bool WiFiClient::openByName(const char *host, bool secure) {
+  IPAddress ip;
+  return WiFi.hostByName(host, ip) && open(ip, secure);
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+  (void)port;
+  return open(ip, false);
+}
+
+int WiFiClient::connect(const char *host, uint16_t port) {
+  (void)port;
+  return openByName(host, false);
+}
+
+void WiFiClient::stop() {
+  if (connection == streamConnection) {
+    streamConnection = nullptr;
+  }
+  free(connection->tls);
+  connection->tls = nullptr;
+  connection->open = false;
+  connection->closing = false;
+  HostSystemAlloc system;
+  connection->rx.clear();
+  connection->rxPos = 0;
+}
+
+uint8_t WiFiClient::connected() {
+  if (!connection->open || !wifiConnected) {
+    return 0;
+  }
+  // Like lwIP: a closed socket still reads out what it had buffered
+  return !connection->closing || available() > 0;
+}
+
+int WiFiClient::available() {
+  return (int)(connection->rx.size() - connection->rxPos);
+}
+
+int WiFiClient::read() {
+  int c = peek();
+  if (c >= 0) {
+    connection->rxPos++;
+  }
+  return c;
+}
+
+int WiFiClient::peek() {
+  if (connection->rxPos >= connection->rx.size()) {
+    return -1;
+  }
+  return (uint8_t)connection->rx[connection->rxPos];
+}
+
+int WiFiClient::read(uint8_t *out, size_t size) {
+  size_t n = min(size, (size_t)available());
+  memcpy(out, connection->rx.data() + connection->rxPos, n);
+  connection->rxPos += n;
+  return (int)n;
+}
+
+size_t WiFiClient::write(uint8_t c) {
+  return write(&c, 1);
+}
+
+size_t WiFiClient::write(const uint8_t *data, size_t size) {
+  (void)data;
+  return connected() ? size : 0;
+}
+
+int WiFiClientSecure::connect(IPAddress ip, uint16_t port) {
+  (void)port;
+  return open(ip, true);
+}
+
+int WiFiClientSecure::connect(const char *host, uint16_t port) {
+  (void)port;
+  return openByName(host, true);
+}
+
+int WiFiClientSecure::connect(IPAddress ip, uint16_t port, const char *host, const char *rootCa,
+                              const char *cliCert, const char *cliKey) {
+  (void)host;  // SNI only: the socket goes to ip
+  (void)port;
+  (void)rootCa;
+  (void)cliCert;
+  (void)cliKey;
+  return open(ip, true);
+}
+
+// ---------------------------------------------------------------------------
+// HTTPClient
+
+HTTPClient::HTTPClient() : client(nullptr), exchange(nullptr), reuse(true), size(-1), chunked(false) {
+  HostSystemAlloc system;
+  exchange = new HostHttpExchange;
+}
+
+HTTPClient::~HTTPClient() {
+  HostSystemAlloc system;
+  delete exchange;
+}
+
+bool HTTPClient::begin(WiFiClient &client, const String &url) {
+  const char *rest = strstr(url.c_str(), "://");
+  rest = rest ? rest + 3 : url.c_str();
+  const char *slash = strchr(rest, '/');
+
+  HostSystemAlloc system;
+  this->client = &client;
+  exchange->host.assign(rest, slash ? (size_t)(slash - rest) : strlen(rest));
+  exchange->path = slash ? slash : "/";
+  exchange->requestHeaders.clear();
+  exchange->responseHeaders.clear();
+  size = -1;
+  chunked = false;
+  return true;
+}
+
+void HTTPClient::end() {
+  if (!client) {
+    return;
+  }
+  HostConnection *connection = client->hostConnection();
+  // Unread body bytes are flushed; the socket stays open only if asked to
+  while (client->available() > 0) {
+    client->read();
+  }
+  if (!reuse || connection->closing) {
+    client->stop();
+  }
+  HostSystemAlloc system;
+  exchange->requestHeaders.clear();
+  client = nullptr;
+}
+
+void HTTPClient::collectHeaders(const char *headerKeys[], const size_t count) {
+  HostSystemAlloc system;
+  exchange->collect.assign(headerKeys, headerKeys + count);
+}
+
+void HTTPClient::addHeader(const String &name, const String &value) {
+  HostSystemAlloc system;
+  exchange->requestHeaders.emplace_back(name.c_str(), value.c_str());
+}
+
+int HTTPClient::GET() {
+  return send("GET", nullptr, 0);
+}
+
+int HTTPClient::POST(const String &payload) {
+  return send("POST", payload.c_str(), payload.length());
+}
+
+int HTTPClient::POST(const uint8_t *payload, size_t size) {
+  return send("POST", (const char *)payload, size);
+}
+
+int HTTPClient::send(const char *method, const char *payload, size_t length) {
+  if (!client) {
+    return HTTPC_ERROR_NOT_CONNECTED;
+  }
+  if (!client->connected() && !client->connect(exchange->host.c_str(), 443)) {
+    return HTTPC_ERROR_CONNECTION_REFUSED;
+  }
+  HostConnection *connection = client->hostConnection();
+  int status;
+  uint32_t delayMs;
+  {
+    HostSystemAlloc system;
+    HostHttpRequest request;
+    request.method = method;
+    request.path = exchange->path;
+    request.body.assign(payload ? payload : "", length);
+    request.headers = exchange->requestHeaders;
+    netStats.requests++;
+    HostHttpResponse response = (*serverHandler)(request);
+
+    // Anything the last caller left unread is gone
+    connection->rx.clear();
+    connection->rxPos = 0;
+    connection->closing = response.close;
+    exchange->responseHeaders.clear();
+    if (!response.etag.empty()) {
+      exchange->responseHeaders.emplace_back("ETag", response.etag);
+    }
+
+    chunked = response.chunked;
+    if (chunked) {
+      exchange->responseHeaders.emplace_back("Transfer-Encoding", "chunked");
+      for (size_t at = 0; at < response.body.size(); at += CHUNK_BYTES) {
+        size_t n = std::min((size_t)CHUNK_BYTES, response.body.size() - at);
+        char line[16];
+        snprintf(line, sizeof(line), "%zx\r\n", n);
+        connection->rx += line;
+        connection->rx.append(response.body, at, n);
+        connection->rx += "\r\n";
+      }
+      connection->rx += "0\r\n\r\n";
+      size = -1;
+    } else {
+      connection->rx = response.body;
+      size = (int)response.body.size();
+    }
+    if (response.stream) {
+      streamConnection = connection;
+      size = -1;
+    }
+    status = response.status;
+    delayMs = response.delayMs;
+  }
+  if (delayMs) {
+    delay(delayMs);
+  }
+  return status;
+}
+
+String HTTPClient::header(const char *name) {
+  for (const auto &h : exchange->responseHeaders) {
+    if (strcasecmp(h.first.c_str(), name) != 0) {
+      continue;
+    }
+    for (const auto &key : exchange->collect) {
+      if (strcasecmp(key.c_str(), name) == 0) {
+        return String(h.second.c_str());
+      }
+    }
+  }
+  return String();
+}
+
+String HTTPClient::getString() {
+  String body;
+  if (!client) {
+    return body;
+  }
+  if (!chunked) {
+    body.reserve(size > 0 ? size : 0);
+    while (client->available() > 0) {
+      body.concat((char)client->read());
+    }
+    return body;
+  }
+  for (;;) {
+    long left = strtol(client->readStringUntil('\n').c_str(), nullptr, 16);
+    if (left <= 0) {
+      client->readStringUntil('\n');
+      return body;
+    }
+    while (left-- > 0 && client->available() > 0) {
+      body.concat((char)client->read());
+    }
+    client->readStringUntil('\n');
+  }
+}
+
+// ---------------------------------------------------------------------------
+// base64
+
+String base64::encode(const uint8_t *data, size_t length) {
+  static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  String out;
+  out.reserve((length + 2) / 3 * 4);
+  for (size_t i = 0; i < length; i += 3) {
+    uint32_t v = (uint32_t)data[i] << 16;
+    if (i + 1 < length) {
+      v |= (uint32_t)data[i + 1] << 8;
+    }
+    if (i + 2 < length) {
+      v |= data[i + 2];
+    }
+    out.concat(alphabet[(v >> 18) & 63]);
+    out.concat(alphabet[(v >> 12) & 63]);
+    out.concat(i + 1 < length ? alphabet[(v >> 6) & 63] : '=');
+    out.concat(i + 2 < length ? alphabet[v & 63] : '=');
+  }
+  return out;
+}
+
+String base64::encode(const String &text) {
+  return encode((const uint8_t *)text.c_str(), text.length());
+}
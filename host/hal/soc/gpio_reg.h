@@ -0,0 +1,7 @@
+#ifndef SOC_GPIO_REG_H
+#define SOC_GPIO_REG_H
+
+// Input levels of GPIO0-31, one bit per pin (ESP32-S3 address)
+#define GPIO_IN_REG 0x6000403C
+
+#endif
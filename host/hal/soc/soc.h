@@ -0,0 +1,10 @@
+#ifndef SOC_SOC_H
+#define SOC_SOC_H
+
+#include <stdint.h>
+
+// Register reads go to the host's pin model (see soc/gpio_reg.h)
+uint32_t hostRegRead(uint32_t reg);
+#define REG_READ(reg) hostRegRead(reg)
+
+#endif
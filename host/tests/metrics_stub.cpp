@@ -0,0 +1,16 @@
+// Counters and gauges for tests built without metrics.cpp (which needs
+// ArduinoJson). Nothing is uploaded; the values are kept for inspection.
+
+#include "metrics.h"
+#include "metrics_stub.h"
+
+uint32_t stubCounters[METRIC_COUNTER_COUNT];
+int32_t stubGauges[METRIC_GAUGE_COUNT];
+
+void metricIncrement(MetricCounter counter, uint32_t by) {
+  stubCounters[counter] += by;
+}
+
+void metricSet(MetricGauge gauge, int32_t value) {
+  stubGauges[gauge] = value;
+}
@@ -0,0 +1,11 @@
+#ifndef METRICS_STUB_H
+#define METRICS_STUB_H
+
+#include "metrics.h"
+
+// What metricIncrement()/metricSet() recorded, in tests linked against
+// metrics_stub instead of firmware_net
+extern uint32_t stubCounters[METRIC_COUNTER_COUNT];
+extern int32_t stubGauges[METRIC_GAUGE_COUNT];
+
+#endif
@@ -0,0 +1,20 @@
+// The sketch itself, compiled as C++. The Arduino IDE turns a .ino into a
+// .cpp by adding prototypes for the functions it defines; the ones the sketch
+// calls before their definition are listed here instead.
+
+#include <Arduino.h>
+#include "HT_SSD1306Wire.h"
+
+void handleSerialCommands();
+void playButtonChirp();
+void playMenuSelectTone();
+bool isQuietHours();
+void playLowBatterySound();
+void renderLowBatteryWarning(SSD1306Wire &display, int batteryPercent);
+void renderDeathWarning(SSD1306Wire &display, String petName);
+void renderHungerWarning(SSD1306Wire &display, String petName, int fullness);
+void renderSadnessWarning(SSD1306Wire &display, String petName, int happiness);
+void renderOnboardingStep(SSD1306Wire &display, int step, String petName);
+void handleFactoryReset();
+
+#include "satoshi_pet_heltec.ino"
@@ -0,0 +1,118 @@
+// setup()/loop() driver for the host tests (sketch_harness.h).
+
+#include <Arduino.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+#include "host_hal.h"
+#include "sketch_harness.h"
+
+void setup();
+void loop();
+
+// Where the build put the firmware's RAM and constructors (host/CMakeLists.txt)
+extern "C" {
+extern char __start_firmware_data[], __stop_firmware_data[];
+extern char __start_firmware_bss[], __stop_firmware_bss[];
+extern void (*__start_firmware_init[])(), (*__stop_firmware_init[])();
+int __real___cxa_atexit(void (*destructor)(void *), void *object, void *dso);
+}
+
+static char *dataImage = nullptr;  // firmware_data as the program loaded it
+static bool constructing = false;
+static uint32_t reboots = 0;
+
+static void construct() {
+  constructing = true;
+  for (void (**init)() = __start_firmware_init; init < __stop_firmware_init; init++) {
+    (*init)();
+  }
+  constructing = false;
+}
+
+// The chip never runs the firmware's destructors, and each boot would
+// register them again
+extern "C" int __wrap___cxa_atexit(void (*destructor)(void *), void *object, void *dso) {
+  char *at = (char *)object;
+  if (constructing || (at >= __start_firmware_data && at < __stop_firmware_data) ||
+      (at >= __start_firmware_bss && at < __stop_firmware_bss)) {
+    return 0;
+  }
+  return __real___cxa_atexit(destructor, object, dso);
+}
+
+// Power-on, before main(): the firmware's statics are constructed here
+// rather than from .init_array. None of them reach the HAL's objects.
+__attribute__((constructor)) static void powerOn() {
+  size_t bytes = __stop_firmware_data - __start_firmware_data;
+  dataImage = (char *)malloc(bytes);
+  memcpy(dataImage, __start_firmware_data, bytes);
+  construct();
+}
+
+// Everything but RTC memory and flash goes back to how the program loaded
+static void reboot() {
+  hostReboot();
+  memcpy(__start_firmware_data, dataImage, __stop_firmware_data - __start_firmware_data);
+  memset(__start_firmware_bss, 0, __stop_firmware_bss - __start_firmware_bss);
+  construct();
+}
+
+void sketchSetup() {
+  setup();
+}
+
+void sketchSavePairing(const char *deviceId) {
+  ganamosConfig.deviceId = deviceId;
+  ganamosConfig.petName = "Satoshi";
+  ganamosConfig.petType = "cat";
+  pairingCode = "K7M2QX";
+  saveDeviceConfig();
+  reboot();
+}
+
+static void runPass() {
+  uint64_t startUs = hostNowUs();
+  bool slept = false;
+  try {
+    loop();
+  } catch (const HostDeepSleep &) {
+    slept = true;
+  }
+  // Once the exception is freed: the heap is about to start over
+  if (slept) {
+    reboots++;
+    reboot();
+    setup();
+    return;
+  }
+  if (hostNowUs() - startUs < 1000) {
+    delay(1);
+  }
+}
+
+void sketchRunMs(uint32_t ms) {
+  uint64_t endUs = hostNowUs() + (uint64_t)ms * 1000;
+  while (hostNowUs() < endUs) {
+    runPass();
+  }
+}
+
+bool sketchRunUntil(bool (*done)(), uint32_t ms) {
+  uint64_t endUs = hostNowUs() + (uint64_t)ms * 1000;
+  while (!done() && hostNowUs() < endUs) {
+    runPass();
+  }
+  return done();
+}
+
+void sketchPress(uint8_t pin, uint32_t ms) {
+  hostSetPinLevel(pin, LOW);
+  sketchRunMs(ms);
+  hostSetPinLevel(pin, HIGH);
+  sketchRunMs(100);
+}
+
+uint32_t sketchReboots() {
+  return reboots;
+}
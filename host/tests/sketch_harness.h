@@ -0,0 +1,54 @@
+#ifndef SKETCH_HARNESS_H
+#define SKETCH_HARNESS_H
+
+#include <Arduino.h>
+#include "display_flush.h"
+
+// Runs the sketch (tests/sketch.cpp) the way the Arduino core's loop task
+// does: setup() once, then loop() pass after pass on the virtual clock.
+// loop() sleeps on its own between passes (power_manager.h); a pass that
+// took less than a millisecond is charged one, which also gives the other
+// tasks their turn.
+//
+// A deep sleep reboots the sketch: the HostDeepSleep it throws is caught,
+// the RAM the chip loses is lost - the firmware's statics, loop()'s too, go
+// back to their initial values and are constructed again, the other tasks
+// are dropped and the heap starts over (hostReboot()) - and setup() runs
+// again. RTC_DATA_ATTR data, NVS and the HAL's own state are kept. Statics
+// of inline functions and templates the firmware shares with its headers
+// are the exception and carry over. A test must not hold heap blocks across
+// a reboot.
+
+void sketchSetup();
+
+// Stores a pairing in NVS the way the sketch does once the app pairs it,
+// then reboots, so the next setup() boots as an already-paired device
+void sketchSavePairing(const char *deviceId);
+
+// Loop passes until at least ms of virtual time have gone by
+void sketchRunMs(uint32_t ms);
+
+// Loop passes until done() holds, for at most ms. Returns done().
+bool sketchRunUntil(bool (*done)(), uint32_t ms);
+
+// A press of ms on a button, then 100 ms of passes with it let go
+void sketchPress(uint8_t pin, uint32_t ms);
+
+// Deep-sleep reboots so far
+uint32_t sketchReboots();
+
+// Sketch state the tests look at (defined in satoshi_pet_heltec.ino)
+extern DirtyTrackingDisplay display;
+extern bool isPaired;
+extern bool isDisplayOff;
+extern bool isScreensaverActive;
+extern bool isBitcoinFactsActive;
+extern bool configPollInFlight;
+extern bool configPollAgain;
+extern int onboardingStep;
+extern unsigned long lastUpdate;
+extern unsigned long lastDecayCheck;
+extern unsigned long lastButtonPress;
+extern String lastSeenRejectionId;
+
+#endif
@@ -0,0 +1,17 @@
+// Stand-ins for what the API modules call back into from the sketch (.ino)
+// and pet_blob.cpp. They only count the calls.
+
+#include <Arduino.h>
+#include "sketch_stubs.h"
+
+SketchCalls sketchCalls = {0, 0};
+
+void triggerNewJobNotification(String title, int reward) {
+  (void)title;
+  (void)reward;
+  sketchCalls.newJobNotifications++;
+}
+
+void playNewJobChirp() {
+  sketchCalls.newJobChirps++;
+}
@@ -0,0 +1,14 @@
+#ifndef SKETCH_STUBS_H
+#define SKETCH_STUBS_H
+
+#include <stdint.h>
+
+// Calls the API modules made into the sketch (.ino / pet_blob.cpp), which
+// aren't part of the host build
+struct SketchCalls {
+  uint32_t newJobNotifications;
+  uint32_t newJobChirps;
+};
+extern SketchCalls sketchCalls;
+
+#endif
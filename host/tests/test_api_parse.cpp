@@ -0,0 +1,191 @@
+// Benchmark: peak heap and parse time of the API responses, on payloads
+// recorded from the server (tests/payloads). Each response goes through the
+// firmware's own request function (filtered, parsed off the socket) and
+// through the buffered path it replaced (getString() then an unfiltered
+// parse), and the table is printed. Fails if the filtered path stops using
+// less heap than the buffered one or goes over its budget. Times are host
+// times: compare the two columns, not against the chip.
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <chrono>
+#include <stdio.h>
+#include <string>
+#include "api_client.h"
+#include "config.h"
+#include "host_hal.h"
+#include "host_net.h"
+#include "test_support.h"
+
+#define DEVICE_ID "0b5f2c1e-7a43-4d2e-9c1b-8e6f5a4d3c21"
+#define JOB_ID "7c2e0001-5f1a-4b3c-9d8e-1a2b3c4d5e6f"
+#define ROUNDS 50
+
+static std::string readPayload(const char *name) {
+  std::string path = std::string(PAYLOAD_DIR "/") + name + ".json";
+  std::string text;
+  FILE *file = fopen(path.c_str(), "rb");
+  CHECK(file != nullptr);
+  if (file) {
+    char block[512];
+    size_t got;
+    while ((got = fread(block, 1, sizeof(block), file)) > 0) {
+      text.append(block, got);
+    }
+    fclose(file);
+  }
+  return text;
+}
+
+struct Endpoint {
+  const char *name;
+  const char *path;  // Request path without the query
+  bool post;
+  size_t budgetBytes;  // Peak heap allowed for the firmware's request (64-bit host)
+  // The firmware's request: true if it parsed a successful response
+  bool (*request)(size_t &docBytes);
+};
+
+static bool requestConfig(size_t &docBytes) {
+  forgetConfigValidator();  // Every round is a full 200
+  DynamicJsonDocument *doc = nullptr;
+  int code = requestGanamosConfig(DEVICE_ID, "", doc);
+  docBytes = doc ? doc->memoryUsage() : 0;
+  bool ok = code == 200 && doc && (*doc)["config"]["balance"].as<int>() == 12850;
+  delete doc;
+  return ok;
+}
+
+static bool requestJobList(size_t &docBytes) {
+  DynamicJsonDocument *doc = nullptr;
+  int code = requestJobs(DEVICE_ID, doc);
+  docBytes = doc ? doc->memoryUsage() : 0;
+  bool ok = code == 200 && doc && (*doc)["jobs"].size() == 6;
+  delete doc;
+  return ok;
+}
+
+static bool requestScore(size_t &docBytes) {
+  DynamicJsonDocument *doc = nullptr;
+  int code = requestGameScore(DEVICE_ID, 42, nullptr, doc);
+  docBytes = doc ? doc->memoryUsage() : 0;
+  bool ok = code == 200 && doc && (*doc)["leaderboard"].size() == 10;
+  delete doc;
+  return ok;
+}
+
+static bool requestComplete(size_t &docBytes) {
+  bool success = false;
+  int code = requestJobComplete(DEVICE_ID, JOB_ID, success);
+  docBytes = API_ACK_CAPACITY;  // Freed inside; this is what it asks for
+  return code == 200 && success;
+}
+
+static const Endpoint endpoints[] = {
+  { "config", "/api/device/config", false, 3072, requestConfig },
+  { "jobs", "/api/device/jobs", false, 4608, requestJobList },
+  { "game_score", "/api/device/game-score", true, 3584, requestScore },
+  { "job_complete", "/api/device/job-complete", true, 512, requestComplete },
+};
+#define ENDPOINT_COUNT (sizeof(endpoints) / sizeof(endpoints[0]))
+
+static void serve(const Endpoint &endpoint, const std::string &payload) {
+  std::string path = endpoint.path;
+  hostHttpServe([path, payload](const HostHttpRequest &request) {
+    HostHttpResponse response;
+    if (request.path.compare(0, path.size(), path) != 0) {
+      response.status = 404;
+      return response;
+    }
+    response.body = payload;
+    return response;
+  });
+}
+
+// What the request's peak use was, given the free bytes before it
+static size_t peakSince(size_t freeBefore) {
+  return freeBefore - hostHeapStats().minFreeBytes;
+}
+
+// The replaced path: whole body into a String, then an unfiltered parse
+// into a document sized for it
+static bool bufferedParse(const Endpoint &endpoint, size_t capacity, size_t &docBytes) {
+  HTTPClient http;
+  if (!apiBegin(http, String(endpoint.path) + "?deviceId=" DEVICE_ID)) {
+    return false;
+  }
+  int code = endpoint.post ? apiPost(http, "{}") : apiGet(http);
+  bool ok = false;
+  if (code == 200) {
+    String body = http.getString();
+    DynamicJsonDocument doc(capacity);
+    ok = !deserializeJson(doc, body) && doc["success"];
+    docBytes = doc.memoryUsage();
+  }
+  apiEnd(http, code > 0);
+  return ok;
+}
+
+static double microsPerRound(const std::chrono::steady_clock::time_point &start) {
+  std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / ROUNDS;
+}
+
+static void benchmark(const Endpoint &endpoint) {
+  std::string payload = readPayload(endpoint.name);
+  serve(endpoint, payload);
+
+  // Unfiltered size, measured outside the device heap
+  size_t capacity;
+  {
+    HostSystemAlloc system;
+    DynamicJsonDocument probe(64 * 1024);
+    deserializeJson(probe, String(payload.c_str()));
+    capacity = probe.memoryUsage();
+  }
+
+  // A first round opens the keep-alive session, which then stays up
+  size_t docBytes = 0;
+  CHECK(endpoint.request(docBytes));
+
+  size_t freeBefore = hostHeapStats().freeBytes;
+  hostHeapResetLowWater();
+  CHECK(endpoint.request(docBytes));
+  size_t filteredPeak = peakSince(freeBefore);
+  size_t filteredDoc = docBytes;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < ROUNDS; i++) {
+    endpoint.request(docBytes);
+  }
+  double filteredUs = microsPerRound(start);
+
+  freeBefore = hostHeapStats().freeBytes;
+  hostHeapResetLowWater();
+  CHECK(bufferedParse(endpoint, capacity, docBytes));
+  size_t bufferedPeak = peakSince(freeBefore);
+  size_t bufferedDoc = docBytes;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < ROUNDS; i++) {
+    bufferedParse(endpoint, capacity, docBytes);
+  }
+  double bufferedUs = microsPerRound(start);
+
+  printf("%-13s %6zu B  %6zu B %6zu B %7.1f us   %6zu B %6zu B %7.1f us\n", endpoint.name,
+         payload.size(), filteredPeak, filteredDoc, filteredUs, bufferedPeak, bufferedDoc, bufferedUs);
+  CHECK(filteredPeak < bufferedPeak);
+  CHECK(filteredPeak <= endpoint.budgetBytes);
+}
+
+int main() {
+  hostHeapBegin(160 * 1024);
+  hostReset();
+  WiFi.begin();
+
+  printf("%-13s %8s  %-29s  %-29s\n", "", "", "filtered (firmware)", "buffered (getString)");
+  printf("%-13s %8s  %8s %8s %10s   %8s %8s %10s\n", "payload", "body", "peak", "doc", "time",
+         "peak", "doc", "time");
+  for (size_t i = 0; i < ENDPOINT_COUNT; i++) {
+    benchmark(endpoints[i]);
+  }
+  TEST_EXIT();
+}
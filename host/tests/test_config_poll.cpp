@@ -0,0 +1,102 @@
+// Config polls against a stand-in server: ETag revalidation, the same-body
+// shortcut for servers that send no ETag, and the coin and job events that
+// shortcut must never swallow.
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <string>
+#include "config.h"
+#include "economy.h"
+#include "host_hal.h"
+#include "host_net.h"
+#include "net_task.h"
+#include "sketch_stubs.h"
+#include "test_support.h"
+
+#define DEVICE_ID "device-1"
+
+static std::string configBody(const std::string &events) {
+  return "{\"success\":true,\"config\":{\"deviceId\":\"" DEVICE_ID "\",\"petName\":\"Satoshi\","
+         "\"petType\":\"cat\",\"balance\":1200,\"btcPrice\":65000,\"pollInterval\":30000" +
+         events + "}}";
+}
+
+// Serves body; with etag set, answers a matching If-None-Match with a 304
+static void serve(const std::string &body, const std::string &etag = "") {
+  hostHttpServe([body, etag](const HostHttpRequest &request) {
+    HostHttpResponse response;
+    if (!etag.empty() && request.header("If-None-Match") == etag) {
+      response.status = 304;
+      return response;
+    }
+    response.body = body;
+    response.etag = etag;
+    return response;
+  });
+}
+
+// One poll as the network task runs it, then applied on the UI side
+static int poll() {
+  NetResult result = {};
+  result.type = NET_REQ_CONFIG_POLL;
+  result.httpCode = requestGanamosConfig(DEVICE_ID, "", result.doc);
+  CHECK(applyConfigResult(result));
+  netFreeResult(result);
+  return result.httpCode;
+}
+
+static void testSameBodyWithoutEtag() {
+  forgetConfigValidator();
+  ConfigPollStats before = getConfigPollStats();
+  serve(configBody(""));
+  CHECK_EQ(poll(), 200);
+  CHECK_EQ(poll(), 304);
+  CHECK(!getLastConfigChanged());
+  CHECK_EQ(getConfigPollStats().unchanged - before.unchanged, 1);
+}
+
+// The server repeats coinsEarnedSinceLastSync when more coins came in
+static void testRepeatedCoinsApplied() {
+  forgetConfigValidator();
+  int coins = getLocalCoins();
+  serve(configBody(",\"coinsEarnedSinceLastSync\":5"));
+  CHECK_EQ(poll(), 200);
+  CHECK(getLastConfigChanged());
+  CHECK_EQ(poll(), 200);
+  CHECK(getLastConfigChanged());
+  CHECK_EQ(getLocalCoins(), coins + 10);
+}
+
+static void testRepeatedJobNotified() {
+  forgetConfigValidator();
+  uint32_t notifications = sketchCalls.newJobNotifications;
+  serve(configBody(",\"hasNewJob\":true,\"newJobTitle\":\"Fix the swing\",\"newJobReward\":500"));
+  CHECK_EQ(poll(), 200);
+  CHECK_EQ(poll(), 200);
+  CHECK_EQ(sketchCalls.newJobNotifications - notifications, 2);
+  CHECK_EQ(sketchCalls.newJobChirps, sketchCalls.newJobNotifications);
+}
+
+static void testEtagRevalidates() {
+  forgetConfigValidator();
+  ConfigPollStats before = getConfigPollStats();
+  serve(configBody(""), "\"v1\"");
+  CHECK_EQ(poll(), 200);
+  CHECK_EQ(poll(), 304);
+  CHECK_EQ(getConfigPollStats().notModified - before.notModified, 1);
+  CHECK_EQ(getConfigPollStats().unchanged, before.unchanged);
+}
+
+int main() {
+  hostHeapBegin(160 * 1024);
+  hostReset();
+  WiFi.begin();
+  initEconomy();
+  setLocalCoins(100);
+
+  testSameBodyWithoutEtag();
+  testRepeatedCoinsApplied();
+  testRepeatedJobNotified();
+  testEtagRevalidates();
+  TEST_EXIT();
+}
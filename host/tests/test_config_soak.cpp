@@ -0,0 +1,107 @@
+// 100k config polls against a stand-in server whose text fields change
+// length on every poll, applied the way the UI task applies them. Once the
+// TLS session and the first documents are up, a poll must hand back every
+// byte it took and leave the free space in no more pieces than it found it.
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <string>
+#include "config.h"
+#include "economy.h"
+#include "host_hal.h"
+#include "host_net.h"
+#include "net_task.h"
+#include "test_support.h"
+
+#define DEVICE_ID "0b5f2c1e-7a43-4d2e-9c1b-8e6f5a4d3c21"
+#define POLLS 100000
+#define WARMUP_POLLS 100
+#define REPORT_EVERY 20000
+
+// Up to maxLength characters, sometimes past the field's capacity
+static std::string text(const char *prefix, long maxLength) {
+  std::string value = prefix;
+  long length = random(maxLength + 1);
+  while ((long)value.size() < length) {
+    value += (char)('a' + random(26));
+  }
+  return value;
+}
+
+static std::string configBody(int poll) {
+  std::string body = "{\"success\":true,\"config\":{\"deviceId\":\"" DEVICE_ID "\"";
+  body += ",\"petName\":\"" + text("Pet", 40) + "\"";
+  body += ",\"petType\":\"cat\",\"userName\":\"" + text("", 40) + "\"";
+  body += ",\"balance\":" + std::to_string(1000 + poll % 97);
+  body += ",\"btcPrice\":65000,\"pollInterval\":30000";
+  body += ",\"lastMessage\":\"" + text("Thanks", 120) + "\"";
+  body += ",\"lastMessageType\":\"fix\",\"lastPostTitle\":\"" + text("", 80) + "\"";
+  body += ",\"lastSenderName\":\"" + text("", 40) + "\"";
+  if (poll % 3 == 0) {
+    body += ",\"lastRejectionId\":\"rej-" + std::to_string(poll) + "\"";
+    body += ",\"rejectionMessage\":\"" + text("Blurry", 120) + "\"";
+    body += ",\"rejectionPostTitle\":\"" + text("", 80) + "\"";
+  }
+  body += "}}";
+  return body;
+}
+
+static void poll(int index) {
+  {
+    HostSystemAlloc system;  // The server's copy isn't device heap
+    std::string body = configBody(index);
+    hostHttpServe([body](const HostHttpRequest &) {
+      HostHttpResponse response;
+      response.body = body;
+      return response;
+    });
+  }
+  NetResult result = {};
+  result.type = NET_REQ_CONFIG_POLL;
+  result.httpCode = requestGanamosConfig(DEVICE_ID, "", result.doc);
+  CHECK(applyConfigResult(result));
+  netFreeResult(result);
+  hostSerialClear();
+}
+
+int main() {
+  hostHeapBegin(160 * 1024);
+  hostReset();
+  WiFi.begin();
+  initEconomy();
+  randomSeed(18);
+
+  for (int i = 0; i < WARMUP_POLLS; i++) {
+    poll(i);
+  }
+  HostHeapStats start = hostHeapStats();
+  {
+    HostSystemAlloc system;  // stdout's buffer
+    printf("%7s %8s %7s %9s\n", "polls", "free", "blocks", "largest");
+    printf("%7d %8zu %7u %9zu\n", 0, start.freeBytes, (unsigned)start.freeBlocks,
+           start.largestFreeBlock);
+  }
+
+  uint32_t leaks = 0;
+  size_t worstLargest = start.largestFreeBlock;
+  for (int i = 1; i <= POLLS; i++) {
+    poll(WARMUP_POLLS + i);
+    HostHeapStats heap = hostHeapStats();
+    if (heap.freeBytes != start.freeBytes) {
+      leaks++;
+    }
+    worstLargest = min(worstLargest, heap.largestFreeBlock);
+    if (i % REPORT_EVERY == 0) {
+      printf("%7d %8zu %7u %9zu\n", i, heap.freeBytes, (unsigned)heap.freeBlocks,
+             heap.largestFreeBlock);
+    }
+  }
+
+  HostHeapStats end = hostHeapStats();
+  CHECK_EQ(leaks, 0);
+  CHECK_EQ(end.failures, 0);
+  CHECK(end.freeBlocks <= start.freeBlocks);
+  CHECK_EQ(worstLargest, start.largestFreeBlock);
+  CHECK_EQ(getConfigPollStats().full, POLLS + WARMUP_POLLS);
+  TEST_EXIT();
+}
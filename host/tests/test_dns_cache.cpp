@@ -0,0 +1,185 @@
+// The API host's cached address against a stand-in server: resolved on
+// the network task's idle passes and again once DNS_CACHE_TTL_MS is up, a
+// failed lookup keeping the old address, an address that stops answering
+// dropped in favour of connecting by name, the NVS copy a boot starts
+// from, and the RTC copy a deep-sleep wake keeps.
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <WiFi.h>
+#include "api_client.h"
+#include "dns_cache.h"
+#include "host_hal.h"
+#include "host_net.h"
+#include "power_manager.h"
+#include "test_support.h"
+
+#define SERVER_A IPAddress(192, 0, 2, 10)
+#define SERVER_B IPAddress(198, 51, 100, 7)
+
+static HostHttpResponse server(const HostHttpRequest &) {
+  HostHttpResponse response;
+  response.body = "{\"success\":true}";
+  return response;
+}
+
+static IPAddress cached() {
+  IPAddress ip;
+  return dnsCacheLookup(ip) ? ip : IPAddress();
+}
+
+static IPAddress saved() {
+  Preferences prefs;
+  if (!prefs.begin("dns-cache", true)) {
+    return IPAddress();
+  }
+  uint32_t ip = prefs.getUInt("ip", 0);
+  prefs.end();
+  return IPAddress(ip);
+}
+
+// One API request the way the network task makes it
+static int request() {
+  HTTPClient http;
+  if (!apiBegin(http, "/api/device/config?deviceId=device-1")) {
+    return 0;
+  }
+  int code = apiGet(http);
+  apiEnd(http, code > 0);
+  return code;
+}
+
+static void testFirstBootAndNvs() {
+  // Nothing saved: connect by name until the first idle pass resolves
+  dnsCacheBegin();
+  CHECK_EQ((uint32_t)cached(), 0);
+  dnsCacheMaintain();
+  CHECK(cached() == SERVER_A);
+  CHECK(saved() == SERVER_A);
+  CHECK_EQ(hostNetStats().lookups, 1);
+  CHECK_EQ(hostNvsStats().writes, 1);
+
+  // Fresh: no lookup until the TTL is up
+  hostAdvanceMs(DNS_CACHE_TTL_MS - 1000);
+  dnsCacheMaintain();
+  CHECK_EQ(hostNetStats().lookups, 1);
+
+  // A boot serves the saved address at once, as stale, and resolves on the
+  // first idle pass; the same answer doesn't write flash again
+  dnsCacheBegin();
+  CHECK(cached() == SERVER_A);
+  CHECK_EQ(hostNetStats().lookups, 1);
+  dnsCacheMaintain();
+  CHECK_EQ(hostNetStats().lookups, 2);
+  CHECK_EQ(hostNvsStats().writes, 1);
+}
+
+static void testTtlExpiry() {
+  uint32_t lookups = hostNetStats().lookups;
+  hostAdvanceMs(DNS_CACHE_TTL_MS);
+  dnsCacheMaintain();
+  CHECK_EQ(hostNetStats().lookups, lookups);  // Exactly the TTL: still fresh
+  hostAdvanceMs(1);
+  dnsCacheMaintain();
+  CHECK_EQ(hostNetStats().lookups, lookups + 1);
+
+  // A lookup that fails keeps serving the old address, and waits
+  // DNS_CACHE_RETRY_MS before the next try
+  hostDnsSetAddress(IPAddress());
+  hostAdvanceMs(DNS_CACHE_TTL_MS + 1);
+  dnsCacheMaintain();
+  CHECK_EQ(hostNetStats().lookups, lookups + 2);
+  CHECK(cached() == SERVER_A);
+  dnsCacheMaintain();
+  hostAdvanceMs(DNS_CACHE_RETRY_MS - 1);
+  dnsCacheMaintain();
+  CHECK_EQ(hostNetStats().lookups, lookups + 2);
+  hostDnsSetAddress(SERVER_A);
+  hostAdvanceMs(1);
+  dnsCacheMaintain();
+  CHECK_EQ(hostNetStats().lookups, lookups + 3);
+  CHECK(cached() == SERVER_A);
+
+  // Offline: nothing to ask
+  WiFi.disconnect();
+  hostAdvanceMs(DNS_CACHE_TTL_MS + 1);
+  dnsCacheMaintain();
+  CHECK_EQ(hostNetStats().lookups, lookups + 3);
+  WiFi.begin();
+}
+
+static void testServerMoved() {
+  // Connecting to the cached address saves the lookup
+  uint32_t lookups = hostNetStats().lookups;
+  dnsCacheMaintain();
+  CHECK_EQ(request(), 200);
+  CHECK_EQ(hostNetStats().lookups, lookups + 1);  // The maintain pass only
+  apiDisconnect();
+
+  // The server moves: the cached address doesn't answer, so it's dropped
+  // and the request goes out by name instead
+  hostDnsSetAddress(SERVER_B);
+  hostSerialClear();
+  uint32_t connections = hostNetStats().connections;
+  CHECK_EQ(request(), 200);
+  CHECK_EQ((uint32_t)cached(), 0);
+  CHECK_EQ(hostNetStats().lookups, lookups + 2);
+  CHECK_EQ(hostNetStats().connections, connections + 1);
+  CHECK(strstr(hostSerialOutput(), "not answering") != nullptr);
+
+  // The next idle pass resolves straight away, not after the retry delay,
+  // and the new address is what a boot starts from
+  uint32_t writes = hostNvsStats().writes;
+  dnsCacheMaintain();
+  CHECK(cached() == SERVER_B);
+  CHECK(saved() == SERVER_B);
+  CHECK_EQ(hostNvsStats().writes, writes + 1);
+
+  apiDisconnect();
+  CHECK_EQ(request(), 200);
+  CHECK_EQ(hostNetStats().lookups, lookups + 3);
+}
+
+static void testDeepSleepWake() {
+  hostAdvanceMs(DNS_CACHE_TTL_MS + 1);
+  dnsCacheMaintain();
+  uint32_t lookups = hostNetStats().lookups;
+
+  // Half a TTL in deep sleep
+  powerBegin();
+  powerWakeBy(millis() + DNS_CACHE_TTL_MS / 2);
+  powerAllowDeepSleep();
+  bool slept = false;
+  try {
+    powerIdle();
+  } catch (const HostDeepSleep &) {
+    slept = true;
+  }
+  CHECK(slept);
+
+  // The entry comes back from RTC memory, not NVS, and is still fresh
+  uint32_t opens = hostNvsStats().opens;
+  CHECK(powerResume());
+  dnsCacheResume();
+  CHECK_EQ(hostNvsStats().opens, opens);
+  CHECK(cached() == SERVER_B);
+  dnsCacheMaintain();
+  CHECK_EQ(hostNetStats().lookups, lookups);
+
+  // Its age carried over the sleep
+  hostAdvanceMs(DNS_CACHE_TTL_MS / 2 + 1000);
+  dnsCacheMaintain();
+  CHECK_EQ(hostNetStats().lookups, lookups + 1);
+}
+
+int main() {
+  hostReset();
+  WiFi.begin();
+  hostHttpServe(server);
+
+  testFirstBootAndNvs();
+  testTtlExpiry();
+  testServerMoved();
+  testDeepSleepWake();
+  TEST_EXIT();
+}
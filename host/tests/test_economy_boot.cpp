@@ -0,0 +1,111 @@
+// Loading the spend queue at boot: first boot, migration from the old
+// spend_N keys, a snapshot that can't be read, and a record that can't be
+// written.
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <string.h>
+#include <vector>
+#include "economy.h"
+#include "host_hal.h"
+#include "test_support.h"
+
+static std::vector<uint8_t> readSnapshot() {
+  Preferences prefs;
+  prefs.begin("economy", true);
+  std::vector<uint8_t> bytes(prefs.getBytesLength("jsnap"));
+  prefs.getBytes("jsnap", bytes.data(), bytes.size());
+  prefs.end();
+  return bytes;
+}
+
+static void writeLegacyKeys() {
+  Preferences prefs;
+  prefs.begin("economy", false);
+  prefs.putInt("spendCount", 1);
+  prefs.putString("spend_0", "6f1c2a9e-0b7d-4c3e-8f21-5a6b7c8d9e0f|5|20|game|0");
+  prefs.putInt("localCoins", 300);
+  prefs.end();
+}
+
+static void testFirstBoot() {
+  hostReset();
+  initEconomy();
+  CHECK_EQ(getLocalCoins(), 0);
+  CHECK_EQ(getPendingSpendCount(), 0);
+  CHECK(readSnapshot().size() > 0);  // Later records have a snapshot to sit on
+  CHECK(strstr(hostSerialOutput(), "Migrated") == nullptr);
+}
+
+static void testMigration() {
+  hostReset();
+  writeLegacyKeys();
+  initEconomy();
+  CHECK_EQ(getLocalCoins(), 300);
+  CHECK_EQ(getPendingSpendCount(), 1);
+  CHECK(strstr(hostSerialOutput(), "Migrated 1 spends") != nullptr);
+
+  Preferences prefs;
+  prefs.begin("economy", true);
+  CHECK(!prefs.isKey("spendCount"));
+  CHECK(!prefs.isKey("spend_0"));
+  prefs.end();
+
+  // Next boot reads the journal
+  hostSerialClear();
+  initEconomy();
+  CHECK_EQ(getLocalCoins(), 300);
+  CHECK_EQ(getPendingSpendCount(), 1);
+  CHECK(strstr(hostSerialOutput(), "Migrated") == nullptr);
+}
+
+static void testUnreadableSnapshotKept() {
+  hostReset();
+  initEconomy();
+  setLocalCoins(750);
+
+  // A snapshot from newer firmware, next to stray legacy keys
+  std::vector<uint8_t> snapshot = readSnapshot();
+  snapshot[4] = 99;
+  Preferences prefs;
+  prefs.begin("economy", false);
+  prefs.putBytes("jsnap", snapshot.data(), snapshot.size());
+  prefs.end();
+  writeLegacyKeys();
+
+  hostSerialClear();
+  initEconomy();
+  CHECK(strstr(hostSerialOutput(), "Migrated") == nullptr);
+  CHECK_EQ(getLocalCoins(), 0);
+  setLocalCoins(500);  // Server balance on the next poll
+  CHECK(spendCoinsLocal(10, SPEND_ACTION_FEED));
+  CHECK(readSnapshot() == snapshot);
+
+  // Clearing the data is the one way past it
+  clearEconomyData();
+  initEconomy();
+  CHECK_EQ(getLocalCoins(), 0);
+  CHECK(readSnapshot() != snapshot);
+}
+
+static void testFailedAppendCompacts() {
+  hostReset();
+  initEconomy();
+  setLocalCoins(100);
+
+  hostNvsFailWrites(1);  // The record for this spend
+  CHECK(spendCoinsLocal(10, SPEND_ACTION_GAME));
+
+  initEconomy();
+  CHECK_EQ(getLocalCoins(), 90);
+  CHECK_EQ(getPendingSpendCount(), 1);
+}
+
+int main() {
+  hostHeapBegin(64 * 1024);
+  testFirstBoot();
+  testMigration();
+  testUnreadableSnapshotKept();
+  testFailedAppendCompacts();
+  TEST_EXIT();
+}
@@ -0,0 +1,114 @@
+// The spend journal: replay, torn records, and snapshots it can't read.
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <vector>
+#include "economy_journal.h"
+#include "host_hal.h"
+#include "test_support.h"
+
+static PendingSpend makeSpend(uint8_t tag, int amount) {
+  PendingSpend spend = {};
+  memset(spend.id, tag, SPEND_ID_SIZE);
+  spend.timestamp = 1000u * tag;
+  spend.amount = amount;
+  spend.action = SPEND_ACTION_GAME;
+  spend.synced = false;
+  return spend;
+}
+
+static std::vector<uint8_t> readKey(const char *key) {
+  Preferences prefs;
+  prefs.begin("economy", true);
+  std::vector<uint8_t> bytes(prefs.getBytesLength(key));
+  prefs.getBytes(key, bytes.data(), bytes.size());
+  prefs.end();
+  return bytes;
+}
+
+static void writeKey(const char *key, const std::vector<uint8_t> &bytes) {
+  Preferences prefs;
+  prefs.begin("economy", false);
+  prefs.putBytes(key, bytes.data(), bytes.size());
+  prefs.end();
+}
+
+static void testReplay() {
+  hostReset();
+  PendingSpend spends[MAX_PENDING_SPENDS];
+  int count = -1;
+  int balance = -1;
+  CHECK_EQ(journalLoad(spends, count, balance), JOURNAL_EMPTY);
+  CHECK_EQ(count, 0);
+  CHECK_EQ(balance, 0);
+
+  CHECK(journalCompact(spends, 0, 500));
+  PendingSpend a = makeSpend(1, 100);
+  PendingSpend b = makeSpend(2, 15);
+  CHECK(journalAppend(JOURNAL_SPEND_APPENDED, &a, 400));
+  CHECK(journalAppend(JOURNAL_SPEND_APPENDED, &b, 385));
+  CHECK(journalAppend(JOURNAL_SPEND_ACKED, &a, 385));
+
+  CHECK_EQ(journalLoad(spends, count, balance), JOURNAL_LOADED);
+  CHECK_EQ(count, 2);
+  CHECK_EQ(balance, 385);
+  CHECK(spends[0].synced);
+  CHECK(!spends[1].synced);
+  CHECK_EQ(spends[1].amount, 15);
+
+  // A record torn by a power cut is where replay stops
+  std::vector<uint8_t> last = readKey("j2");
+  last[last.size() - 1] ^= 0xFF;
+  writeKey("j2", last);
+  CHECK_EQ(journalLoad(spends, count, balance), JOURNAL_LOADED);
+  CHECK_EQ(count, 2);
+  CHECK(!spends[0].synced);
+}
+
+// Snapshot bytes the journal must never overwrite
+static void checkLocked(const std::vector<uint8_t> &snapshot) {
+  PendingSpend spends[MAX_PENDING_SPENDS];
+  int count = -1;
+  int balance = -1;
+  CHECK_EQ(journalLoad(spends, count, balance), JOURNAL_UNREADABLE);
+  CHECK_EQ(count, 0);
+  CHECK_EQ(balance, 0);
+
+  PendingSpend spend = makeSpend(3, 10);
+  CHECK(!journalAppend(JOURNAL_SPEND_APPENDED, &spend, 0));
+  CHECK(!journalCompact(spends, 0, 0));
+  CHECK(readKey("jsnap") == snapshot);
+
+  journalUnlock();
+  CHECK(journalCompact(spends, 0, 0));
+  CHECK_EQ(journalLoad(spends, count, balance), JOURNAL_LOADED);
+}
+
+static void testUnreadableSnapshot() {
+  hostReset();
+  PendingSpend spends[MAX_PENDING_SPENDS] = {makeSpend(1, 100)};
+  CHECK(journalCompact(spends, 1, 900));
+  std::vector<uint8_t> good = readKey("jsnap");
+
+  std::vector<uint8_t> corrupt = good;
+  corrupt[20] ^= 0x01;  // Inside the spend, so only the CRC notices
+  writeKey("jsnap", corrupt);
+  checkLocked(corrupt);
+
+  // A layout from newer firmware is kept for it, not replaced
+  std::vector<uint8_t> newer = good;
+  newer[4] = 99;
+  writeKey("jsnap", newer);
+  checkLocked(newer);
+
+  std::vector<uint8_t> truncated(good.begin(), good.begin() + 8);
+  writeKey("jsnap", truncated);
+  checkLocked(truncated);
+}
+
+int main() {
+  hostHeapBegin(64 * 1024);
+  testReplay();
+  testUnreadableSnapshot();
+  TEST_EXIT();
+}
@@ -0,0 +1,154 @@
+// Spend sync against a stand-in server: the batch endpoint, its acks, and
+// the per-item fallback when the server doesn't have it.
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <string>
+#include <vector>
+#include "economy.h"
+#include "host_hal.h"
+#include "host_net.h"
+#include "test_support.h"
+
+#define DEVICE_ID "device-1"
+
+static uint32_t batchRequests = 0;
+static uint32_t singleRequests = 0;
+
+static bool startsWith(const std::string &text, const char *prefix) {
+  return text.compare(0, strlen(prefix), prefix) == 0;
+}
+
+// Every "spendId":"..." in a request body, in order
+static std::vector<std::string> spendIds(const std::string &body) {
+  static const char key[] = "\"spendId\":\"";
+  std::vector<std::string> ids;
+  for (size_t at = body.find(key); at != std::string::npos; at = body.find(key, at)) {
+    at += sizeof(key) - 1;
+    ids.push_back(body.substr(at, body.find('"', at) - at));
+  }
+  return ids;
+}
+
+// Padding the server may add to a reply; none of it is read by the device
+static std::string extraFields() {
+  return "\"ledgerEntryId\":\"0c1d6a52-4f0e-4b7f-9a51-3f1de5b0c2aa\","
+         "\"note\":\"" + std::string(120, 'x') + "\",\"tags\":[\"a\",\"b\",\"c\"]";
+}
+
+// Batch endpoint that acks everything except rejectId, with extra fields
+// everywhere (the response no longer fits an exactly-sized document)
+static HostHttpHandler batchServer(std::string rejectId = "") {
+  return [rejectId](const HostHttpRequest &request) {
+    HostHttpResponse response;
+    if (!startsWith(request.path, "/api/device/economy/sync-batch?deviceId=" DEVICE_ID)) {
+      response.status = 404;
+      return response;
+    }
+    batchRequests++;
+    std::string results;
+    for (const std::string &id : spendIds(request.body)) {
+      results += results.empty() ? "" : ",";
+      results += "{\"spendId\":\"" + id + "\",\"success\":" + (id == rejectId ? "false" : "true") +
+                 ",\"newCoinBalance\":900," + extraFields() + "}";
+    }
+    response.body = "{\"success\":true,\"serverTime\":\"2026-01-01T00:00:00Z\",\"results\":[" + results +
+                    "],\"newCoinBalance\":900,\"debug\":{" + extraFields() + "}}";
+    response.chunked = true;
+    return response;
+  };
+}
+
+// Old server: no batch endpoint, one spend per request
+static HostHttpResponse legacyServer(const HostHttpRequest &request) {
+  HostHttpResponse response;
+  if (startsWith(request.path, "/api/device/economy/sync?deviceId=" DEVICE_ID)) {
+    singleRequests++;
+    response.body = "{\"success\":true,\"newCoinBalance\":900}";
+  } else {
+    if (startsWith(request.path, "/api/device/economy/sync-batch")) {
+      batchRequests++;
+    }
+    response.status = 404;
+    response.body = "{\"error\":\"Not found\"}";
+  }
+  return response;
+}
+
+static void spend(int count) {
+  for (int i = 0; i < count; i++) {
+    CHECK(spendCoinsLocal(10, SPEND_ACTION_FEED));
+  }
+}
+
+static void testBatchWithExtraFields() {
+  batchRequests = singleRequests = 0;
+  hostHttpServe(batchServer());
+  spend(12);
+  CHECK_EQ(getPendingSpendCount(), 12);
+
+  CHECK_EQ(syncPendingSpends(DEVICE_ID, true), 12);
+  CHECK_EQ(getPendingSpendCount(), 0);
+  CHECK_EQ(batchRequests, 1);
+  CHECK_EQ(singleRequests, 0);
+  clearSyncedSpends();
+}
+
+static void testBatchKeepsRejected() {
+  batchRequests = 0;
+  spend(3);
+  // The second spend is the one the server turns down
+  std::vector<std::string> queued;
+  hostHttpServe([&queued](const HostHttpRequest &request) {
+    queued = spendIds(request.body);
+    HostHttpResponse response;
+    response.status = 503;
+    return response;
+  });
+  CHECK_EQ(syncPendingSpends(DEVICE_ID, true), 0);
+  CHECK_EQ(queued.size(), 3);
+
+  hostHttpServe(batchServer(queued[1]));
+  CHECK_EQ(syncPendingSpends(DEVICE_ID, true), 2);
+  CHECK_EQ(getPendingSpendCount(), 1);
+
+  hostHttpServe(batchServer());
+  CHECK_EQ(syncPendingSpends(DEVICE_ID, true), 1);
+  CHECK_EQ(getPendingSpendCount(), 0);
+  CHECK_EQ(batchRequests, 2);
+  clearSyncedSpends();
+}
+
+static void testFallbackToPerItem() {
+  batchRequests = singleRequests = 0;
+  hostHttpServe(legacyServer);
+  spend(3);
+  CHECK_EQ(syncPendingSpends(DEVICE_ID, true), 3);
+  CHECK_EQ(getPendingSpendCount(), 0);
+  CHECK_EQ(batchRequests, 1);
+  CHECK_EQ(singleRequests, 3);
+  clearSyncedSpends();
+
+  // The missing endpoint is remembered: no second batch attempt
+  spend(2);
+  CHECK_EQ(syncPendingSpends(DEVICE_ID, true), 2);
+  CHECK_EQ(batchRequests, 1);
+  CHECK_EQ(singleRequests, 5);
+  clearSyncedSpends();
+}
+
+int main() {
+  hostHeapBegin(160 * 1024);
+  hostReset();
+  WiFi.begin();
+  initEconomy();
+  setLocalCoins(1000);
+
+  testBatchWithExtraFields();
+  testBatchKeepsRejected();
+  testFallbackToPerItem();
+
+  // One keep-alive session carried every request
+  CHECK_EQ(hostNetStats().connections, 1);
+  TEST_EXIT();
+}
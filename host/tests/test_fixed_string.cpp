@@ -0,0 +1,67 @@
+// FixedString: truncation on a whole UTF-8 character, aliasing, comparisons,
+// and assignment that never touches the heap.
+
+#include <Arduino.h>
+#include "fixed_string.h"
+#include "host_hal.h"
+#include "test_support.h"
+
+static void testTruncation() {
+  FixedString<8> s = "Satoshi";
+  CHECK_STR(s.c_str(), "Satoshi");
+  s = "Satoshi Nakamoto";
+  CHECK_STR(s.c_str(), "Satoshi ");
+  CHECK_EQ(s.length(), 8);
+
+  // "Pet " then a 4-byte emoji at bytes 4..7 fits exactly; one byte less
+  // backs off to before it instead of keeping half
+  s = "Pet \xF0\x9F\x90\xB1";
+  CHECK_EQ(s.length(), 8);
+  FixedString<7> cut = "Pet \xF0\x9F\x90\xB1";
+  CHECK_STR(cut.c_str(), "Pet ");
+  FixedString<5> accent = "Zo\xC3\xAB\xC3\xAB";  // "Zoëë" cut inside the second ë
+  CHECK_STR(accent.c_str(), "Zo\xC3\xAB");
+
+  s = (const char *)nullptr;
+  CHECK_STR(s.c_str(), "");
+  CHECK_EQ(FixedString<8>::capacity(), 8);
+}
+
+static void testAssignAndCompare() {
+  FixedString<20> name = "Whiskers";
+  FixedString<8> shorter;
+  shorter = name;
+  CHECK(shorter == "Whiskers");
+  CHECK(shorter == name);
+  CHECK(name == String("Whiskers"));
+  CHECK(name != "whiskers");
+  CHECK(name != (const char *)nullptr);
+  CHECK(FixedString<4>() == (const char *)nullptr);
+
+  // Assigning from its own tail moves the text down
+  name = name.c_str() + 4;
+  CHECK_STR(name.c_str(), "kers");
+  name = String("Satoshi");
+  CHECK_STR((const char *)name, "Satoshi");
+}
+
+static void testNoAllocation() {
+  FixedString<32> field;
+  String source = "A pet name that is far too long for the slot";
+  uint32_t allocations = hostHeapStats().allocations;
+  for (int i = 0; i < 1000; i++) {
+    field = source;
+    field = "Satoshi";
+    field = source.c_str();
+  }
+  CHECK_EQ(hostHeapStats().allocations, allocations);
+  CHECK_STR(field.c_str(), "A pet name that is far too long ");
+}
+
+int main() {
+  hostHeapBegin(16 * 1024);
+  testTruncation();
+  testAssignAndCompare();
+  testNoAllocation();
+  TEST_EXIT();
+}
@@ -0,0 +1,164 @@
+// Flappy Pet's fixed-step simulation: a seed and the ticks the player flapped
+// on decide the run, whatever the frame rate the game loop drew it at.
+
+#include <Arduino.h>
+#include <vector>
+#include "flappy_engine.h"
+#include "host_hal.h"
+#include "test_support.h"
+
+// A player that flaps when it is about to fall below the gap of the next
+// wall, so runs get past the early game
+static bool autopilot(const FlappyState &state) {
+  const FlappyWall *next = nullptr;
+  for (int i = 0; i < FLAPPY_WALL_COUNT; i++) {
+    const FlappyWall &wall = state.walls[i];
+    if (wall.x / FLAPPY_SUBPX + FLAPPY_WALL_WIDTH < FLAPPY_PET_X) {
+      continue;
+    }
+    if (!next || wall.x < next->x) {
+      next = &wall;
+    }
+  }
+  int32_t floor = FLAPPY_SCREEN_HEIGHT - (next ? next->wallHeight : 0) - FLAPPY_PET_SIZE - 4;
+  int32_t ceiling = next ? next->topWallHeight + 2 : 0;
+  int32_t target = next && next->wallHeight > 0 ? floor : (ceiling + floor) / 2;
+  if (next && next->topWallHeight > 0 && next->wallHeight > 0) {
+    target = (ceiling + floor) / 2 + 4;
+  }
+  return state.petVelocity >= 0 && state.petY / FLAPPY_SUBPX > target;
+}
+
+struct Run {
+  FlappyState end;
+  std::vector<uint32_t> flaps;  // Ticks flapped on
+};
+
+// The autopilot plays one game, one decision per tick
+static Run play(uint32_t seed) {
+  Run run;
+  flappyInit(run.end, seed);
+  while (!run.end.gameOver && run.end.ticks < 120 * FLAPPY_TICK_HZ) {
+    bool flap = autopilot(run.end);
+    flappyStep(run.end, flap);
+    if (flap) {
+      run.flaps.push_back(run.end.ticks);
+    }
+  }
+  return run;
+}
+
+// The same flaps fed through the game loop's accumulator (pet_blob.cpp),
+// with each pass taking frameUs(pass) of real time
+static FlappyState replay(uint32_t seed, const std::vector<uint32_t> &flaps,
+                          unsigned long (*frameUs)(uint32_t pass)) {
+  FlappyState game;
+  flappyInit(game, seed);
+  size_t nextFlap = 0;
+  unsigned long pendingUs = 0;
+  for (uint32_t pass = 0; !game.gameOver; pass++) {
+    pendingUs += frameUs(pass);
+    if (pendingUs > FLAPPY_MAX_CATCHUP_US) {
+      pendingUs = FLAPPY_MAX_CATCHUP_US;
+    }
+    while (pendingUs >= FLAPPY_TICK_US && !game.gameOver) {
+      bool flap = nextFlap < flaps.size() && flaps[nextFlap] == game.ticks + 1;
+      flappyStep(game, flap);
+      nextFlap += flap;
+      pendingUs -= FLAPPY_TICK_US;
+    }
+  }
+  return game;
+}
+
+static unsigned long steadyFrame(uint32_t) {
+  return 16667;  // 60 fps
+}
+
+static unsigned long slowFrame(uint32_t) {
+  return 45000;  // A panel flush that takes most of a 22 fps frame
+}
+
+// 1 to 90 ms, the spread a busy loop pass shows
+static unsigned long jitteryFrame(uint32_t pass) {
+  return 1000 + (pass * 2654435761UL) % 89000;
+}
+
+static bool sameState(const FlappyState &a, const FlappyState &b) {
+  if (a.petY != b.petY || a.petVelocity != b.petVelocity || a.wallSpeed != b.wallSpeed ||
+      a.score != b.score || a.gameOver != b.gameOver || a.ticks != b.ticks ||
+      a.rngState != b.rngState) {
+    return false;
+  }
+  for (int i = 0; i < FLAPPY_WALL_COUNT; i++) {
+    if (a.walls[i].x != b.walls[i].x || a.walls[i].wallHeight != b.walls[i].wallHeight ||
+        a.walls[i].topWallHeight != b.walls[i].topWallHeight || a.walls[i].passed != b.walls[i].passed) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void testSameInputsSameRun() {
+  int best = 0;
+  for (uint32_t seed = 1; seed <= 20; seed++) {
+    Run run = play(seed);
+    CHECK(run.end.gameOver);
+    best = max(best, run.end.score);
+
+    Run again = play(seed);
+    CHECK(sameState(again.end, run.end));
+    CHECK(again.flaps == run.flaps);
+
+    CHECK(sameState(replay(seed, run.flaps, steadyFrame), run.end));
+    CHECK(sameState(replay(seed, run.flaps, slowFrame), run.end));
+    CHECK(sameState(replay(seed, run.flaps, jitteryFrame), run.end));
+  }
+  // Far enough to reach the upper walls and the faster speeds
+  printf("best autopilot score over 20 seeds: %d\n", best);
+  CHECK(best >= 15);
+}
+
+static void testSeedDecidesWalls() {
+  FlappyState a, b, c;
+  flappyInit(a, 7);
+  flappyInit(b, 7);
+  flappyInit(c, 8);
+  CHECK(sameState(a, b));
+  CHECK(!sameState(a, c));
+
+  // Seed 0 would stick the generator; it's replaced, not kept
+  flappyInit(a, 0);
+  CHECK(a.rngState != 0);
+}
+
+static void testFinishedGameStays() {
+  FlappyState game;
+  flappyInit(game, 3);
+  while (!game.gameOver) {
+    flappyStep(game, false);
+  }
+  FlappyState over = game;
+  flappyStep(game, true);
+  CHECK(sameState(game, over));
+  CHECK_EQ(game.score, 0);  // Never flapped: the first walls take it down
+}
+
+// Passes of a second: each is cut to FLAPPY_MAX_CATCHUP_US of ticks
+static unsigned long stallFrame(uint32_t) {
+  return 1000000;
+}
+
+// A stalled loop slows the game down but plays the same game
+static void testStallsSlowTheGame() {
+  std::vector<uint32_t> none;
+  CHECK(sameState(replay(5, none, stallFrame), replay(5, none, steadyFrame)));
+}
+
+int main() {
+  testSameInputsSameRun();
+  testSeedDecidesWalls();
+  testFinishedGameStays();
+  testStallsSlowTheGame();
+  TEST_EXIT();
+}
@@ -0,0 +1,122 @@
+// Flap logs: LEB128 encoding, replaying a recorded run back to its score,
+// and refusing logs that ran out of room, were cut short or don't match.
+
+#include <Arduino.h>
+#include "flappy_engine.h"
+#include "game_replay.h"
+#include "host_hal.h"
+#include "test_support.h"
+
+// Flaps whenever the pet sinks past the middle of the screen, recording
+// the run the way the game loop does
+static int playAndRecord(uint32_t seed, FlapLog &log) {
+  FlappyState game;
+  flappyInit(game, seed);
+  flapLogBegin(log, seed);
+  while (!game.gameOver) {
+    bool flap = game.petVelocity >= 0 && game.petY > 30 * FLAPPY_SUBPX;
+    flappyStep(game, flap);
+    if (flap) {
+      flapLogAdd(log, game.ticks);
+    }
+  }
+  flapLogEnd(log, game.ticks);
+  return game.score;
+}
+
+static void testEncoding() {
+  static FlapLog log;
+  flapLogBegin(log, 1);
+  flapLogAdd(log, 5);       // 5
+  flapLogAdd(log, 300);     // 295 = 0x127: two bytes
+  flapLogAdd(log, 300);     // Same tick again: 0
+  flapLogAdd(log, 70300);   // 70000 = 0x11170: three bytes
+  const uint8_t expected[] = {0x05, 0xA7, 0x02, 0x00, 0xF0, 0xA2, 0x04};
+  CHECK_EQ(log.length, sizeof(expected));
+  CHECK(memcmp(log.data, expected, sizeof(expected)) == 0);
+  CHECK_EQ(log.flaps, 4);
+  CHECK_EQ(log.lastTick, 70300);
+}
+
+static void testRoundTrip() {
+  static FlapLog log;
+  int scored = 0;
+  for (uint32_t seed = 1; seed <= 10; seed++) {
+    int score = playAndRecord(seed, log);
+    CHECK_EQ(flapLogReplay(log), score);
+    CHECK(log.flaps > 0);
+    CHECK(log.length < 2 * log.flaps);  // Mostly one byte per flap
+    scored += score;
+  }
+  CHECK(scored > 0);
+}
+
+static void testTampered() {
+  static FlapLog log;
+  playAndRecord(4, log);
+  int score = flapLogReplay(log);
+
+  FlapLog altered = log;
+  altered.endTick += 30;  // Claims to have lasted longer
+  CHECK_EQ(flapLogReplay(altered), -1);
+
+  altered = log;
+  altered.seed ^= 1;  // Different walls
+  CHECK(flapLogReplay(altered) != score);
+
+  altered = log;
+  altered.data[altered.length - 1] = 0x00;  // Last flap moved
+  CHECK(flapLogReplay(altered) != score);
+}
+
+static void testTruncatedVarint() {
+  static FlapLog log;
+  flapLogBegin(log, 2);
+  flapLogAdd(log, 40);
+  flapLogAdd(log, 400);  // Two bytes, the first with the continuation bit
+  flapLogEnd(log, 1000);
+
+  FlapLog cut = log;
+  cut.length--;  // Ends inside the second flap
+  CHECK_EQ(flapLogReplay(cut), -1);
+
+  // Continuation bits past 32 bits of delta
+  flapLogBegin(cut, 2);
+  for (int i = 0; i < 6; i++) {
+    cut.data[cut.length++] = 0xFF;
+  }
+  cut.data[cut.length++] = 0x01;
+  flapLogEnd(cut, 1000);
+  CHECK_EQ(flapLogReplay(cut), -1);
+}
+
+static void testOverflow() {
+  static FlapLog log;
+  flapLogBegin(log, 3);
+  for (uint32_t tick = 1; tick <= FLAP_LOG_MAX_BYTES + 10; tick++) {
+    flapLogAdd(log, tick);
+  }
+  CHECK(log.overflow);
+  CHECK_EQ(log.length, FLAP_LOG_MAX_BYTES);
+  CHECK_EQ(log.flaps, FLAP_LOG_MAX_BYTES);
+
+  // A multi-byte delta that doesn't fit isn't split across the end
+  flapLogBegin(log, 3);
+  for (uint32_t tick = 1; tick < FLAP_LOG_MAX_BYTES; tick++) {
+    flapLogAdd(log, tick);
+  }
+  flapLogAdd(log, FLAP_LOG_MAX_BYTES + 1000);
+  CHECK(log.overflow);
+  CHECK_EQ(log.length, FLAP_LOG_MAX_BYTES - 1);
+  flapLogEnd(log, FLAP_LOG_MAX_BYTES + 2000);
+  CHECK_EQ(flapLogReplay(log), -1);
+}
+
+int main() {
+  testEncoding();
+  testRoundTrip();
+  testTampered();
+  testTruncatedVarint();
+  testOverflow();
+  TEST_EXIT();
+}
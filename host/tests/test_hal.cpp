@@ -0,0 +1,246 @@
+// The stand-ins the other tests stand on: String, the virtual clock,
+// Preferences, queues, tasks, pin interrupts, the display and the simulated
+// heap.
+
+#include <Arduino.h>
+#include <HT_SSD1306Wire.h>
+#include <Preferences.h>
+#include <Wire.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include "host_panel.h"
+#include "test_support.h"
+
+static void testString() {
+  String s = "pet";
+  s += ':';
+  s += 42;
+  s += F(" sats");
+  CHECK_STR(s.c_str(), "pet:42 sats");
+  CHECK_EQ(s.indexOf(':'), 3);
+  CHECK_STR(s.substring(4, 6).c_str(), "42");
+  CHECK_EQ(s.substring(4).toInt(), 42);
+  CHECK_STR(String(-7).c_str(), "-7");
+  CHECK_STR(String(255, 16).c_str(), "ff");
+  CHECK_STR(String(2.5, 1).c_str(), "2.5");
+
+  String padded = "  hi \r\n";
+  padded.trim();
+  CHECK_STR(padded.c_str(), "hi");
+
+  s.concat(s);  // Appending to itself survives the realloc
+  CHECK_STR(s.c_str(), "pet:42 satspet:42 sats");
+  s.remove(11);
+  CHECK_STR(s.c_str(), "pet:42 sats");
+}
+
+static void testClock() {
+  hostReset();
+  CHECK_EQ(millis(), 0);
+  delay(1500);
+  CHECK_EQ(millis(), 1500);
+  CHECK_EQ(micros(), 1500000);
+  vTaskDelay(pdMS_TO_TICKS(500));
+  CHECK_EQ(millis(), 2000);
+
+  // 32-bit wrap, like the chip
+  hostAdvanceMs(UINT32_MAX - 1999);
+  CHECK_EQ(millis(), 0);
+}
+
+static void testPreferences() {
+  hostReset();
+  Preferences prefs;
+  CHECK(!prefs.begin("fresh", true));  // Never written: read-only open fails
+  CHECK(prefs.begin("fresh", false));
+  prefs.putInt("count", -3);
+  prefs.putString("name", "Satoshi");
+  uint8_t blob[3] = {1, 2, 3};
+  prefs.putBytes("blob", blob, sizeof(blob));
+  prefs.end();
+
+  CHECK(prefs.begin("fresh", true));
+  CHECK_EQ(prefs.getInt("count", 0), -3);
+  CHECK_EQ(prefs.getUInt("count", 9), 9);  // Wrong type reads the default
+  CHECK_STR(prefs.getString("name", "").c_str(), "Satoshi");
+  CHECK_EQ(prefs.getBytesLength("blob"), 3);
+  CHECK(prefs.isKey("blob"));
+  CHECK(!prefs.isKey("missing"));
+  CHECK_EQ(prefs.putInt("count", 1), 0);  // Read-only
+  prefs.end();
+
+  CHECK_EQ(hostNvsStats().writes, 3);
+  CHECK_EQ(hostNvsStats().bytesWritten, 4 + 7 + 3);
+
+  hostReset();
+  CHECK(!prefs.begin("fresh", true));
+}
+
+static void testQueue() {
+  QueueHandle_t queue = xQueueCreate(2, sizeof(int));
+  int value = 1;
+  CHECK_EQ(xQueueSend(queue, &value, 0), pdPASS);
+  value = 2;
+  CHECK_EQ(xQueueSend(queue, &value, 0), pdPASS);
+  value = 3;
+  unsigned long before = millis();
+  CHECK_EQ(xQueueSend(queue, &value, pdMS_TO_TICKS(50)), pdFAIL);
+  CHECK_EQ(millis() - before, 50);  // A full queue waits out the timeout
+  CHECK_EQ(uxQueueMessagesWaiting(queue), 2);
+  CHECK_EQ(xQueueReceive(queue, &value, 0), pdPASS);
+  CHECK_EQ(value, 1);
+  CHECK_EQ(xQueueReceive(queue, &value, 0), pdPASS);
+  CHECK_EQ(value, 2);
+  CHECK_EQ(xQueueReceive(queue, &value, 0), pdFAIL);
+  vQueueDelete(queue);
+}
+
+static QueueHandle_t taskQueue;
+static int taskSum = 0;
+
+static void adderTask(void *) {
+  int value;
+  while (xQueueReceive(taskQueue, &value, portMAX_DELAY) == pdPASS && value >= 0) {
+    taskSum += value;
+    vTaskDelay(pdMS_TO_TICKS(10));
+  }
+  vTaskDelete(NULL);
+}
+
+// One task runs at a time: another task gets the CPU when the running one
+// blocks, and the clock jumps when all of them are waiting
+static void testTasks() {
+  taskQueue = xQueueCreate(4, sizeof(int));
+  TaskHandle_t adder = NULL;
+  xTaskCreatePinnedToCore(adderTask, "adder", 4096, NULL, 1, &adder, 0);
+  CHECK(adder != NULL);
+  size_t withTask = hostHeapStats().freeBytes;
+  unsigned long start = millis();
+  for (int value = 1; value <= 3; value++) {
+    xQueueSend(taskQueue, &value, 0);
+  }
+  CHECK_EQ(taskSum, 0);  // Not until the loop task blocks
+  delay(5);
+  CHECK_EQ(taskSum, 1);  // Then asleep for 10 ms after each item
+  delay(30);
+  CHECK_EQ(taskSum, 6);
+  CHECK_EQ(millis() - start, 35);
+
+  int stop = -1;
+  xQueueSend(taskQueue, &stop, 0);
+  yield();
+  CHECK(hostHeapStats().freeBytes >= withTask + 4096);  // Stack freed on delete
+  vQueueDelete(taskQueue);
+}
+
+static int edges = 0;
+
+static void onEdge() {
+  edges++;
+}
+
+static void testPinInterrupt() {
+  attachInterrupt(digitalPinToInterrupt(2), onEdge, FALLING);
+  hostSetPinLevel(2, LOW);
+  hostSetPinLevel(2, LOW);  // No edge
+  hostSetPinLevel(2, HIGH);
+  CHECK_EQ(edges, 1);
+  detachInterrupt(digitalPinToInterrupt(2));
+  hostSetPinLevel(2, LOW);
+  hostSetPinLevel(2, HIGH);
+  CHECK_EQ(edges, 1);
+}
+
+// What's drawn reaches the panel's RAM over I2C, taking bus time
+static void testDisplay() {
+  SSD1306Wire oled(0x3c, 500000, SDA_OLED, SCL_OLED);
+  CHECK(oled.init());
+  CHECK(hostPanelOn());
+  oled.drawRect(0, 0, 128, 64);
+  oled.fillRect(10, 10, 4, 4);
+  oled.setTextAlignment(TEXT_ALIGN_CENTER);
+  oled.drawString(64, 20, "Hi");
+  uint64_t before = hostNowUs();
+  oled.display();
+  CHECK(memcmp(hostPanelRam(), oled.buffer, HOST_PANEL_WIDTH * HOST_PANEL_PAGES) == 0);
+  CHECK(hostPanelPixel(0, 0));
+  CHECK(hostPanelPixel(127, 63));
+  CHECK(hostPanelPixel(13, 13));
+  CHECK(!hostPanelPixel(5, 5));
+  CHECK(hostNowUs() - before > 15000);  // About 1.1 kB at 500 kHz
+
+  oled.setContrast(10);
+  CHECK_EQ(hostPanelContrast(), 10);
+
+  Wire.beginTransmission(0x3d);  // Nothing else on the bus
+  Wire.write(0);
+  CHECK_EQ(Wire.endTransmission(), 2);
+}
+
+static void testHeap() {
+  HostHeapStats start = hostHeapStats();
+  CHECK_EQ(start.sizeBytes, 64 * 1024);
+
+  // Every other block freed: plenty free, but no room for a big one
+  void *blocks[64];
+  for (void *&block : blocks) {
+    block = malloc(512);
+    CHECK(block != nullptr);
+  }
+  for (int i = 0; i < 64; i += 2) {
+    free(blocks[i]);
+  }
+  HostHeapStats holes = hostHeapStats();
+  CHECK(holes.freeBytes > 16 * 1024);
+  CHECK(holes.largestFreeBlock < 33 * 1024);
+  CHECK(holes.freeBlocks > 30);
+
+  for (int i = 1; i < 64; i += 2) {
+    free(blocks[i]);
+  }
+  HostHeapStats after = hostHeapStats();
+  CHECK_EQ(after.freeBytes, start.freeBytes);
+  CHECK_EQ(after.freeBlocks, start.freeBlocks);
+  CHECK(after.minFreeBytes < start.freeBytes);
+
+  // Out of device memory is a null pointer, not a crash
+  CHECK(malloc(128 * 1024) == nullptr);
+  CHECK_EQ(hostHeapStats().failures, start.failures + 1);
+
+  void *aligned = nullptr;
+  CHECK_EQ(posix_memalign(&aligned, 256, 100), 0);
+  CHECK_EQ((uintptr_t)aligned % 256, 0);
+  free(aligned);
+  CHECK_EQ(hostHeapStats().freeBytes, start.freeBytes);
+
+  // Shrinking in place hands the tail back (shrinkToFit() relies on it)
+  void *big = malloc(4096);
+  uintptr_t bigAddress = (uintptr_t)big;
+  size_t withBig = hostHeapStats().freeBytes;
+  void *shrunk = realloc(big, 100);
+  CHECK_EQ((uintptr_t)shrunk, bigAddress);
+  CHECK(hostHeapStats().freeBytes > withBig + 3900);
+  free(shrunk);
+  CHECK_EQ(hostHeapStats().freeBytes, start.freeBytes);
+
+  // Bookkeeping inside HostSystemAlloc doesn't touch the device heap
+  {
+    HostSystemAlloc system;
+    free(malloc(1024));
+  }
+  CHECK_EQ(hostHeapStats().allocations, start.allocations + 66);
+}
+
+int main() {
+  hostHeapBegin(64 * 1024);
+  testString();
+  testClock();
+  testPreferences();
+  testQueue();
+  testTasks();
+  testPinInterrupt();
+  testDisplay();
+  testHeap();
+  TEST_EXIT();
+}
@@ -0,0 +1,281 @@
+// A week of simulated classroom use against a stand-in server, with the
+// sketch's own loop() on top. Each school day the pet is woken at the start
+// of the lesson and kept on screen. The config is polled, the pet redrawn
+// and spends synced by the loop as on the device; the pet is fed every few
+// minutes, and a game is played from the menu - its score goes up to the
+// leaderboard - every ten minutes. After class it's left alone:
+// screensaver, display off, then deep sleep between polls until the next
+// lesson. Each HeapScope the loop passes through - fetch and sync on the
+// network task, render, NVS - is counted by the heap monitor the loop
+// samples.
+//
+// A deep sleep starts the heap over, so fragmentation can only build up
+// within a session. Prints the heap every ten minutes of a lesson so that
+// growth can be charted. Fails on an alarm, on a lesson that ends with less
+// free heap or more fragmentation than it settled at, or on a day that ends
+// worse than the first did.
+//
+// Feeding goes through handleFeedPet(), as the feed menu's selection does:
+// the food menu waits for its presses inside a single loop() pass, and the
+// harness only presses between passes. A game needs none - left alone, the
+// pet falls.
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <string>
+#include "button_handler.h"
+#include "heap_monitor.h"
+#include "host_hal.h"
+#include "host_net.h"
+#include "pet_blob.h"
+#include "poll_policy.h"
+#include "sketch_harness.h"
+#include "test_support.h"
+
+#define DEVICE_ID "0b5f2c1e-7a43-4d2e-9c1b-8e6f5a4d3c21"
+#define MINUTE_US 60000000ULL
+#define HOUR_US (60 * MINUTE_US)
+#define DAY_US (24 * HOUR_US)
+#define DAYS 7
+#define LESSON_START_US (8 * HOUR_US)
+#define LESSON_MINUTES 30
+#define SAMPLE_MINUTES 10
+#define FEED_EVERY_MINUTES 10   // Halfway between games
+#define GAME_EVERY_MINUTES 10
+#define FOOD_MILK 1
+
+static std::string scoreBody;
+static int balance = 5000;
+static uint32_t scores = 0;
+static const int coins = 100000;  // Enough for the week; the server doesn't count spends
+static uint32_t alarms = 0;
+
+static bool startsWith(const std::string &text, const char *prefix) {
+  return text.compare(0, strlen(prefix), prefix) == 0;
+}
+
+// Text that changes length from poll to poll, the way messages do
+static std::string text(const char *prefix, long maxLength) {
+  std::string value = prefix;
+  long length = random(maxLength + 1);
+  while ((long)value.size() < length) {
+    value += (char)('a' + random(26));
+  }
+  return value;
+}
+
+static std::string configBody() {
+  return "{\"success\":true,\"config\":{\"deviceId\":\"" DEVICE_ID "\",\"petName\":\"Satoshi\","
+         "\"petType\":\"cat\",\"userName\":\"" + text("Ms ", 24) + "\",\"balance\":" +
+         std::to_string(balance) + ",\"coins\":" + std::to_string(coins) + ",\"btcPrice\":65000,\"pollInterval\":30000,\"metrics\":true,"
+         "\"batchSync\":true,\"lastMessage\":\"" + text("Thanks for ", 100) +
+         "\",\"lastMessageType\":\"fix\",\"lastPostTitle\":\"" + text("", 60) + "\"}}";
+}
+
+// Acks every spend in a batch
+static std::string syncBatchBody(const std::string &request) {
+  static const char key[] = "\"spendId\":\"";
+  std::string results;
+  for (size_t at = request.find(key); at != std::string::npos; at = request.find(key, at)) {
+    at += sizeof(key) - 1;
+    results += results.empty() ? "" : ",";
+    results += "{\"spendId\":\"" + request.substr(at, request.find('"', at) - at) +
+               "\",\"success\":true,\"newCoinBalance\":" + std::to_string(coins) + "}";
+  }
+  return "{\"success\":true,\"results\":[" + results + "],\"newCoinBalance\":" +
+         std::to_string(coins) + "}";
+}
+
+static HostHttpResponse server(const HostHttpRequest &request) {
+  HostHttpResponse response;
+  const std::string &path = request.path;
+  if (startsWith(path, "/api/device/config")) {
+    response.body = configBody();
+  } else if (startsWith(path, "/api/device/game-score")) {
+    scores++;
+    response.body = scoreBody;
+  } else if (startsWith(path, "/api/device/economy/sync-batch")) {
+    response.body = syncBatchBody(request.body);
+    response.chunked = true;
+  } else if (startsWith(path, "/api/device/metrics")) {
+    response.body = "{\"success\":true}";
+  } else {
+    response.status = 404;
+  }
+  return response;
+}
+
+static std::string readPayload(const char *name) {
+  std::string text;
+  FILE *file = fopen((std::string(PAYLOAD_DIR "/") + name + ".json").c_str(), "rb");
+  CHECK(file != nullptr);
+  if (file) {
+    char block[512];
+    size_t got;
+    while ((got = fread(block, 1, sizeof(block), file)) > 0) {
+      text.append(block, got);
+    }
+    fclose(file);
+  }
+  return text;
+}
+
+// Open the menu, step to Play and hold to pick it
+static void playGame() {
+  sketchPress(BUTTON_PIN_PRG, 200);
+  sketchPress(BUTTON_PIN_PRG, 200);
+  sketchPress(BUTTON_PIN_PRG, 900);
+}
+
+static bool displayOn() {
+  return !isDisplayOff;
+}
+
+// Loop passes up to hostNowUs() time atUs, counting the alarms logged on
+// the way
+static void runUntil(uint64_t atUs) {
+  if (hostNowUs() < atUs) {
+    sketchRunMs((uint32_t)((atUs - hostNowUs()) / 1000));
+  }
+  if (strstr(hostSerialOutput(), "🚨")) {
+    alarms++;
+  }
+  hostSerialClear();
+}
+
+struct HeapFigures {
+  uint32_t freeBytes;
+  uint32_t largestBlock;
+  uint8_t fragmentation;
+};
+
+static HeapFigures sample() {
+  return {ESP.getFreeHeap(), ESP.getMaxAllocHeap(), getHeapFragmentation()};
+}
+
+// Per-site figures add up over the week; the monitor's own start over at
+// each boot
+static HeapSiteStats siteTotals[HEAP_SITE_COUNT];
+
+static void addSiteStats() {
+  for (int site = 0; site < HEAP_SITE_COUNT; site++) {
+    HeapSiteStats stats = getHeapSiteStats((HeapSite)site);
+    siteTotals[site].calls += stats.calls;
+    siteTotals[site].netDelta += stats.netDelta;
+    siteTotals[site].worstDelta = min(siteTotals[site].worstDelta, stats.worstDelta);
+  }
+}
+
+static void printSample(unsigned long day, uint32_t minute, const HeapFigures &figures) {
+  HostSystemAlloc system;  // stdout's buffer
+  printf("%4lu %6u %8u %8u %8u %5u%% %6u %8ld %6u %8ld %6u %8ld %6u %8ld\n", day,
+         (unsigned)minute, (unsigned)figures.freeBytes, (unsigned)figures.largestBlock,
+         (unsigned)ESP.getMinFreeHeap(), (unsigned)figures.fragmentation,
+         (unsigned)getHeapSiteStats(HEAP_SITE_FETCH).calls,
+         (long)getHeapSiteStats(HEAP_SITE_FETCH).netDelta,
+         (unsigned)getHeapSiteStats(HEAP_SITE_SYNC).calls,
+         (long)getHeapSiteStats(HEAP_SITE_SYNC).netDelta,
+         (unsigned)getHeapSiteStats(HEAP_SITE_RENDER).calls,
+         (long)getHeapSiteStats(HEAP_SITE_RENDER).netDelta,
+         (unsigned)getHeapSiteStats(HEAP_SITE_NVS).calls,
+         (long)getHeapSiteStats(HEAP_SITE_NVS).netDelta);
+}
+
+int main() {
+  hostHeapBegin(200 * 1024);
+  {
+    HostSystemAlloc system;
+    scoreBody = readPayload("game_score");
+  }
+  hostReset();
+  hostHttpServe(server);
+  randomSeed(25);
+  sketchSavePairing(DEVICE_ID);
+  sketchSetup();
+  CHECK(isPaired);
+
+  {
+    HostSystemAlloc system;
+    printf("%4s %6s %8s %8s %8s %6s %6s %8s %6s %8s %6s %8s %6s %8s\n", "day", "minute", "free",
+           "largest", "min ever", "frag", "fetch", "net", "sync", "net", "render", "net", "nvs",
+           "net");
+  }
+  HeapFigures firstDay = {};
+  HeapFigures worst = {UINT32_MAX, UINT32_MAX, 0};
+  uint32_t feeds = 0;
+  uint32_t games = 0;
+  for (unsigned long day = 0; day < DAYS; day++) {
+    uint64_t lessonStart = day * DAY_US + LESSON_START_US;
+    runUntil(lessonStart - MINUTE_US);
+    // A press wakes it from deep sleep - or, if a poll has it up just then,
+    // from the sleep that follows
+    hostSleepPressAt(BUTTON_PIN_EXTERNAL, lessonStart);
+    runUntil(lessonStart);
+    CHECK(sketchRunUntil(displayOn, 60000));
+    lessonStart = hostNowUs();
+    HeapFigures settled = {};
+    HeapFigures figures = {};
+    for (uint32_t minute = 1; minute <= LESSON_MINUTES; minute++) {
+      // A student glances at the pet every minute or so, keeps it fed and
+      // plays with it
+      lastButtonPress = millis();
+      if (minute % FEED_EVERY_MINUTES == FEED_EVERY_MINUTES / 2) {
+        CHECK(handleFeedPet(FOOD_MILK));
+        feeds++;
+      }
+      if (minute % GAME_EVERY_MINUTES == 0) {
+        playGame();
+        games++;
+      }
+      // A fix of theirs is paid out mid-lesson
+      if (minute == LESSON_MINUTES / 2) {
+        balance += 100;
+      }
+      runUntil(lessonStart + minute * MINUTE_US);
+      CHECK(displayOn());
+      figures = sample();
+      worst.freeBytes = min(worst.freeBytes, figures.freeBytes);
+      worst.largestBlock = min(worst.largestBlock, figures.largestBlock);
+      worst.fragmentation = max(worst.fragmentation, figures.fragmentation);
+      if (minute % SAMPLE_MINUTES == 0) {
+        printSample(day + 1, minute, figures);
+        if (minute == SAMPLE_MINUTES) {
+          settled = figures;
+        }
+      }
+    }
+    // The session's caches and TLS session are up by its first sample;
+    // nothing grows after that
+    CHECK(figures.freeBytes + 256 >= settled.freeBytes);
+    CHECK(figures.fragmentation <= settled.fragmentation + 5);
+    if (day == 0) {
+      firstDay = figures;
+    } else {
+      CHECK(figures.freeBytes + 256 >= firstDay.freeBytes);
+      CHECK(figures.fragmentation <= firstDay.fragmentation + 5);
+    }
+    addSiteStats();
+    // Left alone until the screensaver, then the display goes off
+    CHECK(sketchRunUntil([] { return isDisplayOff; }, 300000));
+  }
+  runUntil(DAYS * DAY_US);
+
+  {
+    HostSystemAlloc system;
+    printf("worst: %u B free, %u B largest block, %u%% fragmentation, %u alarms\n",
+           (unsigned)worst.freeBytes, (unsigned)worst.largestBlock,
+           (unsigned)worst.fragmentation, (unsigned)alarms);
+    printf("%u requests over %u connection(s), %u reboots\n", (unsigned)hostNetStats().requests,
+           (unsigned)hostNetStats().connections, (unsigned)sketchReboots());
+  }
+
+  CHECK_EQ(alarms, 0);
+  CHECK(worst.largestBlock >= HEAP_BLOCK_ALARM_BYTES);
+  CHECK(sketchReboots() >= DAYS);
+  CHECK(siteTotals[HEAP_SITE_FETCH].calls >= DAYS * LESSON_MINUTES * 60000 / POLL_MAX_ACTIVE_MS);
+  CHECK_EQ(scores, games);
+  CHECK(siteTotals[HEAP_SITE_SYNC].calls >= (feeds + games) / 2);
+  CHECK(siteTotals[HEAP_SITE_RENDER].calls >= DAYS * LESSON_MINUTES);
+  CHECK(siteTotals[HEAP_SITE_NVS].calls >= feeds + games);
+  TEST_EXIT();
+}
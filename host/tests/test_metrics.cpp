@@ -0,0 +1,192 @@
+// Telemetry batches against a stand-in collector: what a batch carries,
+// counters sent as deltas and kept until a batch is accepted, the flush and
+// retry spacing, the battery ring, and the size and heap a batch costs.
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <WiFi.h>
+#include <string>
+#include <vector>
+#include "host_hal.h"
+#include "host_net.h"
+#include "metrics.h"
+#include "profiler.h"
+#include "test_support.h"
+
+#define DEVICE_ID "device-1"
+
+// What the collector received (kept outside the device heap)
+static std::vector<std::string> batches;
+static int collectorStatus = 200;
+static void (*duringUpload)() = nullptr;
+
+static void startCollector() {
+  hostHttpServe([](const HostHttpRequest &request) {
+    HostHttpResponse response;
+    if (request.method != "POST" || request.path != "/api/device/metrics?deviceId=" DEVICE_ID) {
+      response.status = 404;
+      return response;
+    }
+    batches.push_back(request.body);
+    if (duringUpload) {
+      duringUpload();
+    }
+    response.status = collectorStatus;
+    response.body = collectorStatus == 200 ? "{\"success\":true,\"stored\":1}" : "{\"error\":\"busy\"}";
+    return response;
+  });
+}
+
+// The last batch, parsed (static, so not on the device heap)
+static StaticJsonDocument<4096> batchDoc;
+
+static JsonDocument &lastBatch() {
+  batchDoc.clear();
+  CHECK(!batches.empty());
+  if (!batches.empty()) {
+    HostSystemAlloc system;
+    CHECK(!deserializeJson(batchDoc, String(batches.back().c_str())));
+  }
+  return batchDoc;
+}
+
+static void testFirstBatch() {
+  metricsBegin();
+  metricIncrement(METRIC_WIFI_RECONNECT_ATTEMPTS, 2);
+  metricIncrement(METRIC_CONFIG_POLLS, 5);
+  metricSet(METRIC_CONSECUTIVE_CONFIG_404S, 1);
+  metricsSampleBattery(4010, 88);
+  profileRecord(PROFILE_LOOP, 3000);
+
+  CHECK(metricsUploadIfDue(DEVICE_ID));
+  CHECK_EQ(batches.size(), 1);
+  JsonDocument &batch = lastBatch();
+  CHECK_EQ(batch["v"].as<int>(), 1);
+  CHECK_EQ(batch["c"]["boots"].as<int>(), 1);
+  CHECK_EQ(batch["c"]["wifiReconnectAttempts"].as<int>(), 2);
+  CHECK_EQ(batch["c"]["configPolls"].as<int>(), 5);
+  CHECK(!batch["c"].containsKey("spendsSynced"));  // Zero counters left out
+  CHECK_EQ(batch["g"]["consecutiveConfig404s"].as<int>(), 1);
+  CHECK_EQ(batch["g"]["batteryMv"].as<int>(), 4010);
+  CHECK(batch["g"]["heapFree"].as<int>() > 0);
+  CHECK_EQ(batch["h"]["loop"][0].as<int>(), 1);
+  CHECK_EQ(batch["battery"]["mv"].size(), 1);
+
+  // A quiet device sends well under a kilobyte
+  printf("first batch: %zu bytes\n", batches.back().size());
+  CHECK(batches.back().size() < 1024);
+}
+
+static void testDeltasAndSpacing() {
+  hostAdvanceMs(60000);
+  CHECK(metricsUploadIfDue(DEVICE_ID));  // Not due: nothing sent
+  CHECK_EQ(batches.size(), 1);
+
+  metricIncrement(METRIC_CONFIG_POLLS, 3);
+  hostAdvanceMs(METRICS_FLUSH_MS);
+  CHECK(metricsUploadIfDue(DEVICE_ID));
+  CHECK_EQ(batches.size(), 2);
+  JsonDocument &batch = lastBatch();
+  CHECK_EQ(batch["c"]["configPolls"].as<int>(), 3);  // Only what's new
+  CHECK(!batch["c"].containsKey("boots"));
+  CHECK(!batch.containsKey("battery"));  // The one sample went out already
+}
+
+static void countDuringUpload() {
+  metricIncrement(METRIC_SPENDS_SYNCED);
+}
+
+static void testFailedBatchKept() {
+  metricIncrement(METRIC_SCORES_SUBMITTED, 4);
+  hostAdvanceMs(METRICS_FLUSH_MS);
+  collectorStatus = 503;
+  CHECK(!metricsUploadIfDue(DEVICE_ID));
+  CHECK_EQ(batches.size(), 3);
+
+  // Retried sooner than a normal flush, but not on the next poll
+  hostAdvanceMs(METRICS_RETRY_MS / 2);
+  metricsUploadIfDue(DEVICE_ID);
+  CHECK_EQ(batches.size(), 3);
+
+  // Accepted: the failed batch's counts come along, plus the failure
+  collectorStatus = 200;
+  duringUpload = countDuringUpload;
+  hostAdvanceMs(METRICS_RETRY_MS / 2);
+  CHECK(metricsUploadIfDue(DEVICE_ID));
+  duringUpload = nullptr;
+  CHECK_EQ(batches.size(), 4);
+  JsonDocument &batch = lastBatch();
+  CHECK_EQ(batch["c"]["scoresSubmitted"].as<int>(), 4);
+  CHECK_EQ(batch["c"]["uploadFailures"].as<int>(), 1);
+  CHECK(!batch["c"].containsKey("spendsSynced"));
+
+  // Counted while the batch was in flight: in the next one
+  hostAdvanceMs(METRICS_FLUSH_MS);
+  CHECK(metricsUploadIfDue(DEVICE_ID));
+  lastBatch();
+  CHECK_EQ(batch["c"]["spendsSynced"].as<int>(), 1);
+  CHECK(!batch["c"].containsKey("scoresSubmitted"));
+}
+
+static void testBatteryRing() {
+  // Two hours of samples between batches: the newest hour, oldest first
+  for (int i = 0; i < 24; i++) {
+    metricsSampleBattery(4100 - i * 10, 90);
+    hostAdvanceMs(METRICS_BATTERY_SAMPLE_MS);
+  }
+  CHECK(metricsUploadIfDue(DEVICE_ID));
+  JsonDocument &batch = lastBatch();
+  JsonArray mv = batch["battery"]["mv"];
+  CHECK_EQ(mv.size(), METRICS_BATTERY_SAMPLES);
+  CHECK_EQ(mv[0].as<int>(), 4100 - 12 * 10);
+  CHECK_EQ(mv[METRICS_BATTERY_SAMPLES - 1].as<int>(), 4100 - 23 * 10);
+  CHECK_EQ(batch["battery"]["every"].as<int>(), METRICS_BATTERY_SAMPLE_MS / 1000);
+}
+
+// Everything set at once: every counter, every zone, a full battery ring.
+// The batch must fit its document and stay small on the heap.
+static void testFullBatchBudget() {
+  for (uint8_t i = 0; i < METRIC_COUNTER_COUNT; i++) {
+    metricIncrement((MetricCounter)i, 4000000000UL);
+  }
+  for (uint8_t i = 0; i < METRIC_GAUGE_COUNT; i++) {
+    metricSet((MetricGauge)i, -2000000000L);
+  }
+  for (uint8_t zone = 0; zone < PROFILE_ZONE_COUNT; zone++) {
+    profileRecord((ProfileZone)zone, 30000000);
+  }
+  for (int i = 0; i < METRICS_BATTERY_SAMPLES; i++) {
+    metricsSampleBattery(65535, 100);
+    hostAdvanceMs(METRICS_BATTERY_SAMPLE_MS);
+  }
+  hostAdvanceMs(METRICS_FLUSH_MS);
+
+  size_t freeBefore = hostHeapStats().freeBytes;
+  hostHeapResetLowWater();
+  CHECK(metricsUploadIfDue(DEVICE_ID));
+  size_t peak = freeBefore - hostHeapStats().minFreeBytes;
+  CHECK_EQ(hostHeapStats().freeBytes, freeBefore);
+
+  JsonDocument &batch = lastBatch();
+  CHECK_EQ(batch["c"].size(), METRIC_COUNTER_COUNT);
+  CHECK_EQ(batch["g"].size(), METRIC_GAUGE_COUNT + 4);
+  CHECK_EQ(batch["h"].size(), PROFILE_ZONE_COUNT);
+  CHECK_EQ(batch["battery"]["mv"].size(), METRICS_BATTERY_SAMPLES);
+  printf("full batch: %zu bytes, %zu bytes of heap at peak\n", batches.back().size(), peak);
+  CHECK(batches.back().size() < 1536);
+  CHECK(peak < 2048);
+}
+
+int main() {
+  hostHeapBegin(160 * 1024);
+  hostReset();
+  WiFi.begin();
+  startCollector();
+
+  testFirstBatch();
+  testDeltasAndSpacing();
+  testFailedBatchKept();
+  testBatteryRing();
+  testFullBatchBudget();
+  TEST_EXIT();
+}
@@ -0,0 +1,167 @@
+// The adaptive poll interval: server hint, backoff, activity and push, then
+// a simulated school day for a classroom of devices. The day prints the
+// request rate per hour so a change to the policy can be charted.
+
+#include <Arduino.h>
+#include <vector>
+#include "host_hal.h"
+#include "poll_policy.h"
+#include "test_support.h"
+
+#define SECOND_MS 1000UL
+#define HOUR_MS 3600000UL
+#define DAY_MS (24 * HOUR_MS)
+#define CLASS_START_MS (8 * HOUR_MS)
+#define CLASS_END_MS (15 * HOUR_MS)
+#define TOUCH_EVERY_MS 180000UL    // Someone presses a button during class
+#define SCREENSAVER_MS 280000UL    // No press for this long: display off
+#define CHANGE_EVERY_MS 2700000UL  // Balance changes on the server during class
+#define DEVICES 30
+#define HINT_MS 30000
+
+// Back to a freshly paired device: first poll brought the balance in
+static void startDevice(unsigned long seed) {
+  randomSeed(seed);
+  pollSetPushConnected(false);
+  pollSetServerHint(HINT_MS);
+  pollOnResult(true, true);
+}
+
+// Jitter is ±10% of the interval
+static bool near(unsigned long actual, unsigned long expected) {
+  return actual >= expected * 9 / 10 && actual <= expected * 11 / 10;
+}
+
+static void testHintAndBackoff() {
+  startDevice(1);
+  CHECK(near(pollIntervalMs(false), HINT_MS));
+  CHECK(near(pollIntervalMs(true), POLL_IDLE_MIN_MS));
+
+  // Milliseconds, clamped to the policy's floor and ceiling
+  pollSetServerHint(45000);
+  CHECK_EQ(getPollStats().baseMs, 45000);
+  pollSetServerHint(30);  // Seconds by mistake: the floor, not 30 ms
+  CHECK_EQ(getPollStats().baseMs, POLL_MIN_MS);
+  pollSetServerHint(7200000);
+  CHECK_EQ(getPollStats().baseMs, POLL_MAX_HINT_MS);
+  pollSetServerHint(0);
+  CHECK_EQ(getPollStats().baseMs, POLL_MAX_HINT_MS);
+  pollSetServerHint(HINT_MS);
+
+  // Unchanged responses double the interval up to the caps
+  for (int i = 0; i < 10; i++) {
+    pollOnResult(true, false);
+  }
+  CHECK_EQ(getPollStats().backoffLevel, POLL_MAX_BACKOFF);
+  CHECK(near(pollIntervalMs(false), POLL_MAX_ACTIVE_MS));
+  CHECK(near(pollIntervalMs(true), POLL_MAX_IDLE_MS));
+
+  // A button press or a change snaps back to the hint
+  pollOnActivity();
+  CHECK(near(pollIntervalMs(false), HINT_MS));
+  pollOnResult(false, false);
+  pollOnResult(true, false);
+  CHECK(near(pollIntervalMs(false), HINT_MS * 4));
+  pollOnResult(true, true);
+  CHECK(near(pollIntervalMs(false), HINT_MS));
+
+  // With the push stream up polls are only a safety net
+  pollSetPushConnected(true);
+  CHECK(near(pollIntervalMs(false), POLL_PUSH_MIN_MS));
+  pollSetPushConnected(false);
+  CHECK(near(pollIntervalMs(false), HINT_MS));
+}
+
+struct DayResult {
+  uint32_t perHour[24];
+  uint32_t total;
+};
+
+// One device through the day, polling the way loop() does: a press every
+// 3 minutes during class (at a different moment on each desk), screensaver
+// otherwise, and a balance change every 45 minutes. pollSeconds counts,
+// per second of the day, the devices that polled in it.
+static DayResult simulateDay(unsigned long seed, std::vector<uint8_t> &pollSeconds) {
+  DayResult result = {};
+  startDevice(seed);
+  unsigned long lastPoll = 0;
+  unsigned long lastChange = 0;
+  unsigned long touchOffset = random(TOUCH_EVERY_MS / SECOND_MS) * SECOND_MS;
+  bool touched = false;
+  unsigned long lastTouch = 0;
+  for (unsigned long now = SECOND_MS; now < DAY_MS; now += SECOND_MS) {
+    bool inClass = now >= CLASS_START_MS && now < CLASS_END_MS;
+    if (inClass && (now - CLASS_START_MS) % TOUCH_EVERY_MS == touchOffset) {
+      pollOnActivity();
+      touched = true;
+      lastTouch = now;
+    }
+    if (inClass && now - lastChange >= CHANGE_EVERY_MS) {
+      lastChange = now;
+    }
+    bool idle = !touched || now - lastTouch > SCREENSAVER_MS;
+    if (now - lastPoll > pollIntervalMs(idle)) {
+      pollOnResult(true, lastChange > lastPoll);
+      lastPoll = now;
+      result.perHour[now / HOUR_MS]++;
+      result.total++;
+      pollSeconds[now / SECOND_MS]++;
+    }
+    hostSerialClear();  // Every decision is logged
+  }
+  return result;
+}
+
+// Bars scaled so the busiest hour is 60 wide
+static void printRate(const char *name, const uint32_t perHour[24]) {
+  uint32_t busiest = 1;
+  for (int hour = 0; hour < 24; hour++) {
+    busiest = max(busiest, perHour[hour]);
+  }
+  printf("%s\n", name);
+  for (int hour = 0; hour < 24; hour++) {
+    printf("  %02d:00 %5u ", hour, (unsigned)perHour[hour]);
+    for (uint32_t i = 0; i < (perHour[hour] * 60 + busiest - 1) / busiest; i++) {
+      putchar('#');
+    }
+    putchar('\n');
+  }
+}
+
+static void testClassroomDay() {
+  std::vector<uint8_t> pollSeconds(DAY_MS / SECOND_MS);
+  uint32_t classPerHour[24] = {};
+  DayResult first = {};
+  for (unsigned long device = 0; device < DEVICES; device++) {
+    DayResult day = simulateDay(device + 1, pollSeconds);
+    for (int hour = 0; hour < 24; hour++) {
+      classPerHour[hour] += day.perHour[hour];
+    }
+    if (device == 0) {
+      first = day;
+    }
+
+    // Idle hours back off to the 20 minute cap; class hours follow the hint
+    CHECK(day.perHour[3] <= 4);
+    CHECK(day.perHour[20] <= 4);
+    CHECK(day.perHour[10] >= 30);
+    CHECK(day.perHour[10] <= HOUR_MS / HINT_MS);
+  }
+  printRate("one device, polls per hour", first.perHour);
+  printRate("classroom of 30, polls per hour", classPerHour);
+
+  // Devices booted together drift apart instead of polling in lockstep
+  uint8_t busiest = 0;
+  for (uint8_t count : pollSeconds) {
+    busiest = max(busiest, count);
+  }
+  printf("busiest second: %u of %d devices\n", (unsigned)busiest, DEVICES);
+  CHECK(busiest <= DEVICES / 5);
+}
+
+int main() {
+  hostReset();
+  testHintAndBackoff();
+  testClassroomDay();
+  TEST_EXIT();
+}
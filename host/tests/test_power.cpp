@@ -0,0 +1,273 @@
+// Light and deep sleep between loop passes. The sketch's own loop() runs
+// a day on the desk - offline first, then a night with WiFi - registering
+// its deadlines and idling; the HAL measures the sleep on its own, and the
+// simulated draw is held to a budget so a pass that stops sleeping shows
+// up here, and the wakes that follow are checked for what setup() brings
+// back from RTC memory. power_manager's limits are checked on their own
+// first.
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <string>
+#include "button_handler.h"
+#include "config.h"
+#include "host_hal.h"
+#include "host_net.h"
+#include "host_panel.h"
+#include "poll_policy.h"
+#include "power_manager.h"
+#include "sketch_harness.h"
+#include "test_support.h"
+
+#define DEVICE_ID "device-1"
+#define HOUR_MS 3600000UL
+
+static uint32_t configPolls = 0;
+
+static HostHttpResponse server(const HostHttpRequest &request) {
+  HostHttpResponse response;
+  if (request.path != "/api/device/config?deviceId=" DEVICE_ID) {
+    response.status = 404;
+    return response;
+  }
+  configPolls++;
+  response.body = "{\"success\":true,\"config\":{\"deviceId\":\"" DEVICE_ID "\",\"petName\":\"Satoshi\","
+                  "\"petType\":\"cat\",\"balance\":5000,\"btcPrice\":65000,\"pollInterval\":30000}}";
+  return response;
+}
+
+static void coldBoot() {
+  hostReset();
+  CHECK(!powerResume());
+}
+
+// A stretch of the run, measured from where it starts
+struct Window {
+  uint64_t startUs;
+  HostSleepStats sleep;
+  uint32_t polls;
+  uint32_t reboots;
+};
+
+static Window windowStart() {
+  return {hostNowUs(), hostSleepStats(), configPolls, sketchReboots()};
+}
+
+// Average draw from the HAL's own record of the sleep, with the board
+// figures from power_manager.h
+static float simulatedMa(const Window &window) {
+  HostSleepStats sleep = hostSleepStats();
+  uint64_t totalUs = hostNowUs() - window.startUs;
+  uint64_t lightUs = sleep.lightSleepUs - window.sleep.lightSleepUs;
+  uint64_t deepUs = sleep.deepSleepUs - window.sleep.deepSleepUs;
+  uint64_t awakeUs = totalUs - lightUs - deepUs;
+  return (awakeUs * POWER_ACTIVE_MA + lightUs * POWER_LIGHT_SLEEP_MA +
+          deepUs * POWER_DEEP_SLEEP_MA) / totalUs;
+}
+
+static void report(const char *name, const Window &window) {
+  HostSleepStats sleep = hostSleepStats();
+  uint32_t light = sleep.lightSleeps - window.sleep.lightSleeps;
+  uint32_t deep = sleep.deepSleeps - window.sleep.deepSleeps;
+  uint64_t asleepUs = sleep.lightSleepUs + sleep.deepSleepUs - window.sleep.lightSleepUs -
+                      window.sleep.deepSleepUs;
+  printf("%-8s %5u wakes (%3u deep)  %3u polls  %5.1f%% asleep  %.2f mA simulated\n", name,
+         (unsigned)(light + deep), (unsigned)deep, (unsigned)(configPolls - window.polls),
+         100.0 * asleepUs / (hostNowUs() - window.startUs), simulatedMa(window));
+}
+
+// Paired, on the desk with nobody pressing anything. The WiFi stays out of
+// reach for the first hour: the pet screen animates between light sleeps,
+// then the screensaver and facts run out and the display goes off.
+static void testOfflineHour() {
+  coldBoot();
+  hostHttpServe(server);
+  hostWiFiSetAvailable(false);
+  sketchSavePairing(DEVICE_ID);
+  sketchSetup();
+  CHECK(isPaired);
+
+  Window window = windowStart();
+  sketchRunMs(HOUR_MS);
+  report("offline", window);
+  HostSleepStats sleep = hostSleepStats();
+  CHECK(sleep.lightSleeps > 300);  // Between the pet's 2 fps frames
+  CHECK(sleep.deepSleeps >= 8);    // Display off: deep sleep between polls
+  CHECK_EQ(sketchReboots(), sleep.deepSleeps);
+  CHECK_EQ(configPolls, 0);
+  CHECK(isDisplayOff);
+  CHECK(simulatedMa(window) <= 1.5f);
+  CHECK_EQ(getPowerStats().deepSleeps, sleep.deepSleeps);
+}
+
+// The WiFi is back: deep sleep from one poll to the next, the radio up
+// only for the poll itself. Every wake is a reboot that has to find the
+// pairing in RTC memory; the unchanged config backs the polls off to the
+// idle cap.
+static void testNight() {
+  hostWiFiSetAvailable(true);
+  Window window = windowStart();
+  sketchRunMs(8 * HOUR_MS);
+  report("night", window);
+  HostSleepStats sleep = hostSleepStats();
+  uint32_t deep = sleep.deepSleeps - window.sleep.deepSleeps;
+  CHECK(deep >= 8 * HOUR_MS / POLL_MAX_IDLE_MS);
+  CHECK(deep <= 36);
+  CHECK((sleep.deepSleepUs - window.sleep.deepSleepUs) / deep > 900000000);
+  CHECK_EQ(sleep.lightSleeps, window.sleep.lightSleeps);
+  CHECK(configPolls - window.polls >= deep);
+  CHECK_EQ(sketchReboots() - window.reboots, deep);
+  CHECK(simulatedMa(window) <= 0.1f);
+  CHECK(isDisplayOff);
+}
+
+// What loop() had at the end of the last pass before a deep sleep; the
+// timestamps as ages, so they can be compared across the millis() restart
+struct LoopState {
+  uint64_t atMs;  // hostNowUs() time
+  unsigned long updateAge;
+  unsigned long decayCheckAge;
+  unsigned long buttonAge;
+  bool screensaver;
+  bool facts;
+  uint32_t nvsOpens;
+};
+
+static LoopState loopState() {
+  unsigned long now = millis();
+  return {hostNowUs() / 1000, now - lastUpdate, now - lastDecayCheck, now - lastButtonPress,
+          isScreensaverActive, isBitcoinFactsActive, hostNvsStats().opens};
+}
+
+static LoopState beforeSleep;
+static uint32_t rebootsBefore;
+
+static bool rebooted() {
+  if (sketchReboots() != rebootsBefore) {
+    return true;
+  }
+  beforeSleep = loopState();
+  return false;
+}
+
+static bool displayOn() {
+  return !isDisplayOff;
+}
+
+// A wake goes through the sketch's own setup(): the loop state comes back
+// from RTC memory with its timestamps rebased, nothing is read from NVS,
+// and a button wake turns the display on
+static void testWakeResume() {
+  lastSeenRejectionId = "rej-7";
+  rebootsBefore = sketchReboots();
+  CHECK(sketchRunUntil(rebooted, 2 * POLL_MAX_IDLE_MS));
+  LoopState after = loopState();
+  uint64_t sleptMs = after.atMs - beforeSleep.atMs;
+  CHECK(sleptMs > 60000);
+  CHECK(after.updateAge - beforeSleep.updateAge - sleptMs <= 1);
+  CHECK(after.decayCheckAge - beforeSleep.decayCheckAge - sleptMs <= 1);
+  CHECK(after.buttonAge - beforeSleep.buttonAge - sleptMs <= 1);
+  CHECK_EQ(after.screensaver, beforeSleep.screensaver);
+  CHECK_EQ(after.facts, beforeSleep.facts);
+  CHECK_EQ(after.nvsOpens, beforeSleep.nvsOpens);
+  CHECK(lastSeenRejectionId == "rej-7");
+  CHECK(isPaired);
+  CHECK(isDisplayOff);
+  CHECK(ganamosConfig.deviceId == DEVICE_ID);
+  CHECK(ganamosConfig.petName == "Satoshi");
+
+  rebootsBefore = sketchReboots();
+  hostSleepPressAt(BUTTON_PIN_EXTERNAL, hostNowUs() + 60000000);
+  CHECK(sketchRunUntil(rebooted, 2 * POLL_MAX_IDLE_MS));
+  CHECK_EQ(hostSleepStats().buttonWakes, 1);
+  CHECK_EQ(hostNvsStats().opens, beforeSleep.nvsOpens);
+  CHECK(sketchRunUntil(displayOn, 1000));
+  CHECK(hostPanelOn());
+}
+
+static void testDeepSleepButtonWake() {
+  coldBoot();
+  powerBegin();
+  unsigned long sleptAt = millis();
+  hostSleepPressAt(BUTTON_PIN_EXTERNAL, hostNowUs() + 100000000);
+  powerWakeBy(sleptAt + 300000);
+  powerAllowDeepSleep();
+  bool slept = false;
+  try {
+    powerIdle();
+  } catch (const HostDeepSleep &) {
+    slept = true;
+  }
+  CHECK(slept);
+  CHECK(millis() < 1000);
+  CHECK(powerResume());
+  CHECK_EQ(powerWakePins(), 1ULL << BUTTON_PIN_EXTERNAL);
+  CHECK_EQ(millis() - powerRebaseMs(sleptAt), 100000);
+  CHECK_EQ(getPowerStats().buttonWakes, 1);
+
+  // The next wake is the timer's
+  powerWakeBy(millis() + 60000);
+  powerAllowDeepSleep();
+  try {
+    powerIdle();
+  } catch (const HostDeepSleep &) {
+  }
+  CHECK(powerResume());
+  CHECK_EQ(powerWakePins(), 0);
+  CHECK_EQ(getPowerStats().timerWakes, 1);
+  CHECK_EQ(getPowerStats().deepSleeps, 2);
+}
+
+static void testButtonWake() {
+  coldBoot();
+  powerBegin();
+  hostSleepPressAt(BUTTON_PIN_PRG, hostNowUs() + 3000000);
+  powerWakeBy(millis() + 8000);
+  powerIdle();
+  CHECK_EQ(getPowerLastSleepMs(), 3000);
+  CHECK_EQ(getPowerStats().buttonWakes, 1);
+  CHECK_EQ(hostSleepStats().buttonWakes, 1);
+}
+
+static void testSleepLimits() {
+  coldBoot();
+  powerBegin();
+
+  // Capped inside the watchdog
+  powerWakeBy(millis() + 60000);
+  powerIdle();
+  CHECK_EQ(getPowerLastSleepMs(), 10000);
+
+  // Not worth it
+  powerWakeBy(millis() + 5);
+  powerIdle();
+  CHECK_EQ(getPowerLastSleepMs(), 0);
+
+  // A pass that registered nothing doesn't sleep on a guess
+  powerIdle();
+  CHECK_EQ(getPowerLastSleepMs(), 0);
+  CHECK_EQ(getPowerStats().skippedSleeps, 0);
+
+  // A held button or the radio keeps the CPU up
+  hostSetPinLevel(BUTTON_PIN_EXTERNAL, LOW);
+  powerWakeBy(millis() + 5000);
+  powerIdle();
+  hostSetPinLevel(BUTTON_PIN_EXTERNAL, HIGH);
+  WiFi.mode(WIFI_STA);
+  powerWakeBy(millis() + 5000);
+  powerIdle();
+  WiFi.mode(WIFI_OFF);
+  CHECK_EQ(getPowerStats().skippedSleeps, 2);
+  CHECK_EQ(hostSleepStats().lightSleeps, 1);
+}
+
+int main() {
+  hostHeapBegin(200 * 1024);
+  testButtonWake();
+  testSleepLimits();
+  testDeepSleepButtonWake();
+  testOfflineHour();
+  testNight();
+  testWakeResume();
+  TEST_EXIT();
+}
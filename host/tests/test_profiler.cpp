@@ -0,0 +1,169 @@
+// Zone histograms: bucket edges, percentiles against the exact values,
+// halving when a bucket fills, and the table profileDump() prints. Ends
+// with a simulated Flappy Pet session whose timings are charted the way
+// the device charts them, so a change to the game loop shows up here.
+
+#include <Arduino.h>
+#include <algorithm>
+#include <vector>
+#include "flappy_engine.h"
+#include "host_hal.h"
+#include "profiler.h"
+#include "test_support.h"
+
+// A percentile the histogram reports sits at or above the exact one and
+// within one bucket (4 per power of two) of it
+static bool withinBucket(uint32_t reported, uint32_t exact) {
+  return reported >= exact && reported <= exact + exact / 4 + 1;
+}
+
+static uint32_t exactPercentile(std::vector<uint32_t> samples, uint8_t percent) {
+  std::sort(samples.begin(), samples.end());
+  size_t rank = (samples.size() * percent + 99) / 100;
+  return samples[rank - 1];
+}
+
+static void testSmallValuesExact() {
+  profileReset();
+  for (uint32_t us = 0; us < 4; us++) {
+    profileRecord(PROFILE_INPUT, us);
+  }
+  ProfileSummary s = profileSummary(PROFILE_INPUT);
+  CHECK_EQ(s.count, 4);
+  CHECK_EQ(s.p50Us, 2);
+  CHECK_EQ(s.p99Us, 3);
+  CHECK_EQ(s.maxUs, 3);
+  CHECK_EQ(profileSummary(PROFILE_NVS).count, 0);
+}
+
+static void testPercentiles() {
+  // Frame times in µs: mostly 1-3 ms, a tail out to 40 ms, one 2 s stall
+  std::vector<uint32_t> samples;
+  randomSeed(23);
+  for (int i = 0; i < 5000; i++) {
+    uint32_t us = 1000 + random(2000);
+    if (i % 20 == 0) {
+      us = 5000 + random(35000);
+    }
+    samples.push_back(us);
+  }
+  samples.push_back(2000000);
+
+  profileReset();
+  for (uint32_t us : samples) {
+    profileRecord(PROFILE_DRAW, us);
+  }
+  ProfileSummary s = profileSummary(PROFILE_DRAW);
+  CHECK_EQ(s.count, samples.size());
+  CHECK_EQ(s.maxUs, 2000000);
+  CHECK(withinBucket(s.p50Us, exactPercentile(samples, 50)));
+  CHECK(withinBucket(s.p95Us, exactPercentile(samples, 95)));
+  CHECK(withinBucket(s.p99Us, exactPercentile(samples, 99)));
+
+  // Past the top bucket: counted, and reported no higher than the max
+  profileReset();
+  profileRecord(PROFILE_LOOP, 60000000);
+  CHECK_EQ(profileSummary(PROFILE_LOOP).p99Us, 60000000);
+}
+
+static void testFullBucketHalves() {
+  profileReset();
+  for (int i = 0; i < 70000; i++) {
+    profileRecord(PROFILE_PHYSICS, 50);
+  }
+  for (int i = 0; i < 1000; i++) {
+    profileRecord(PROFILE_PHYSICS, 5000);
+  }
+  ProfileSummary s = profileSummary(PROFILE_PHYSICS);
+  CHECK_EQ(s.count, 71000);
+  CHECK(withinBucket(s.p50Us, 50));
+  // 1000 slow samples against ~35k halved fast ones: still past p95
+  CHECK(withinBucket(s.p99Us, 5000));
+}
+
+static void testScopeAndDump() {
+  hostReset();
+  profileReset();
+  {
+    ProfileScope scope(PROFILE_FLUSH);
+    hostAdvanceUs(23500);
+  }
+  ProfileSummary s = profileSummary(PROFILE_FLUSH);
+  CHECK_EQ(s.count, 1);
+  CHECK_EQ(s.maxUs, 23500);
+
+  profileDump(Serial);
+  CHECK(strstr(hostSerialOutput(), "flush           1    23.5    23.5    23.5    23.5") != nullptr);
+  CHECK(strstr(hostSerialOutput(), "draw") == nullptr);  // No samples, no line
+}
+
+// Flappy Pet at the device's rates: a 120 Hz fixed step (~40 µs a tick on
+// the chip), a frame built in 2-4 ms and flushed over I2C in 22-26 ms, with
+// a WiFi or flash stall now and then. Times are what the device measures;
+// only the physics is run for real.
+static void testSimulatedSession() {
+  hostReset();
+  profileReset();
+  randomSeed(7);
+  FlappyState game;
+  for (uint32_t seed = 1; seed <= 5; seed++) {
+    flappyInit(game, seed);
+    unsigned long lastMicros = micros();
+    unsigned long pendingUs = 0;
+    uint32_t frames = 0;
+    while (!game.gameOver && frames < 3000) {
+      ProfileScope pass(PROFILE_LOOP);
+      pendingUs += micros() - lastMicros;
+      lastMicros = micros();
+      pendingUs = min(pendingUs, FLAPPY_MAX_CATCHUP_US);
+      {
+        ProfileScope input(PROFILE_INPUT);
+        hostAdvanceUs(20);
+      }
+      {
+        ProfileScope physics(PROFILE_PHYSICS);
+        while (pendingUs >= FLAPPY_TICK_US && !game.gameOver) {
+          flappyStep(game, game.petVelocity >= 0 && game.petY > 30 * FLAPPY_SUBPX);
+          hostAdvanceUs(40);
+          pendingUs -= FLAPPY_TICK_US;
+        }
+      }
+      {
+        ProfileScope draw(PROFILE_DRAW);
+        hostAdvanceUs(2000 + random(2000));
+      }
+      {
+        ProfileScope flush(PROFILE_FLUSH);
+        hostAdvanceUs(22000 + random(4000));
+      }
+      if (random(200) == 0) {
+        hostAdvanceMs(150 + random(300));  // Outside the zones, like a stall in another task
+      }
+      hostAdvanceMs(1);  // delay(1)
+      frames++;
+    }
+  }
+
+  profileDump(Serial);
+  printf("%s", hostSerialOutput());
+  hostSerialClear();
+
+  ProfileSummary flush = profileSummary(PROFILE_FLUSH);
+  ProfileSummary loop = profileSummary(PROFILE_LOOP);
+  ProfileSummary physics = profileSummary(PROFILE_PHYSICS);
+  CHECK_EQ(flush.count, loop.count);
+  CHECK(flush.p50Us >= 22000 && flush.p99Us <= 32500);
+  CHECK(loop.p50Us >= 25000 && loop.p95Us <= 40000);
+  // About three ticks per ~28 ms frame; a catch-up after a stall runs 12
+  CHECK(physics.p50Us <= 200);
+  CHECK(physics.maxUs <= (FLAPPY_MAX_CATCHUP_US / FLAPPY_TICK_US) * 40);
+}
+
+int main() {
+  testSmallValuesExact();
+  testPercentiles();
+  testFullBucketHalves();
+  testScopeAndDump();
+  testSimulatedSession();
+  TEST_EXIT();
+}
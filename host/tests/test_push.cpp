@@ -0,0 +1,179 @@
+// The push channel against a stand-in event server, with the sketch's own
+// loop() on top: an event polls the config within a second, one that
+// arrives while a poll is out polls again once that one is back, a stream
+// the server drops is reopened, and with the stream refused polling alone
+// still picks up a payment.
+
+#include <Arduino.h>
+#include <string>
+#include <vector>
+#include "config.h"
+#include "host_hal.h"
+#include "host_net.h"
+#include "poll_policy.h"
+#include "push_channel.h"
+#include "sketch_harness.h"
+#include "test_support.h"
+
+#define DEVICE_ID "device-1"
+#define BALANCE_EVENT "event: balance\ndata: {\"balance\":5100}\n\n"
+
+static bool streamRefused = false;
+static bool eventDuringPoll = false;  // The next poll's answer is slow, and an event arrives meanwhile
+static int balance = 5000;
+static uint32_t streamRequests = 0;
+static std::vector<uint64_t> pollTimes;  // hostNowUs(), outside the device heap
+
+static bool startsWith(const std::string &text, const char *prefix) {
+  return text.compare(0, strlen(prefix), prefix) == 0;
+}
+
+static HostHttpResponse server(const HostHttpRequest &request) {
+  HostHttpResponse response;
+  if (request.path == "/api/device/events?deviceId=" DEVICE_ID) {
+    streamRequests++;
+    if (streamRefused || request.header("Accept") != "text/event-stream") {
+      response.status = 503;
+      return response;
+    }
+    response.stream = true;
+    response.body = ": connected\n\n";
+    return response;
+  }
+  if (!startsWith(request.path, "/api/device/config?deviceId=" DEVICE_ID)) {
+    response.status = 404;
+    return response;
+  }
+  pollTimes.push_back(hostNowUs());
+  response.body = "{\"success\":true,\"config\":{\"deviceId\":\"" DEVICE_ID "\",\"petName\":\"Satoshi\","
+                  "\"petType\":\"cat\",\"balance\":" + std::to_string(balance) +
+                  ",\"btcPrice\":65000,\"pollInterval\":30000,\"pushEvents\":true}}";
+  if (eventDuringPoll) {
+    eventDuringPoll = false;
+    CHECK(hostStreamSend(BALANCE_EVENT));
+    response.delayMs = 500;
+  }
+  return response;
+}
+
+static size_t polls() {
+  return pollTimes.size();
+}
+
+static size_t pollsBefore;
+
+static bool polledAgain() {
+  return polls() > pollsBefore;
+}
+
+static bool balanceApplied() {
+  return ganamosConfig.balance == balance;
+}
+
+static bool streamUp() {
+  return pushIsConnected();
+}
+
+static bool streamDown() {
+  return !pushIsConnected();
+}
+
+// Keeps the pet on screen: no screensaver, so the display stays on and the
+// stream stays wanted
+static void touch() {
+  lastButtonPress = millis();
+}
+
+static void testConnect() {
+  hostReset();
+  hostHttpServe(server);
+  sketchSavePairing(DEVICE_ID);
+  sketchSetup();
+  CHECK(isPaired);
+  CHECK(sketchRunUntil(streamUp, 10000));
+  CHECK_EQ(streamRequests, 1);
+  CHECK(ganamosConfig.pushSupported);
+  sketchRunMs(2000);
+}
+
+static void testEventPolls() {
+  // A keep-alive comment is only a sign of life
+  pollsBefore = polls();
+  CHECK(hostStreamSend(": keep-alive\n\n"));
+  sketchRunMs(1000);
+  CHECK_EQ(polls(), pollsBefore);
+
+  balance = 5100;
+  uint64_t sentUs = hostNowUs();
+  CHECK(hostStreamSend(BALANCE_EVENT));
+  CHECK(sketchRunUntil(polledAgain, 1000));
+  CHECK(pollTimes.back() - sentUs < 1000000);
+  CHECK_EQ(getPushEventCount(), 1);
+  CHECK(sketchRunUntil(balanceApplied, 500));
+  touch();
+}
+
+static bool latched = false;
+
+static bool secondPollBack() {
+  latched |= configPollInFlight && configPollAgain;
+  return polls() >= pollsBefore + 2 && !configPollInFlight;
+}
+
+// The poll the event set off may have left before the change it announces,
+// so the event isn't dropped while that poll is out
+static void testEventDuringPoll() {
+  sketchRunMs(2000);
+  eventDuringPoll = true;
+  pollsBefore = polls();
+  CHECK(hostStreamSend(BALANCE_EVENT));
+  CHECK(sketchRunUntil(secondPollBack, 3000));
+  CHECK(latched);
+  CHECK_EQ(polls(), pollsBefore + 2);
+  CHECK(!configPollAgain);
+  CHECK_EQ(getPushEventCount(), 3);
+  touch();
+}
+
+static void testReconnect() {
+  hostStreamClose();
+  CHECK(sketchRunUntil(streamDown, 1000));
+  // Back after the first backoff step
+  CHECK(sketchRunUntil(streamUp, 10000));
+  CHECK_EQ(streamRequests, 2);
+  CHECK_EQ(getPushConnectCount(), 2);
+
+  pollsBefore = polls();
+  CHECK(hostStreamSend(BALANCE_EVENT));
+  CHECK(sketchRunUntil(polledAgain, 1000));
+  touch();
+}
+
+// With the stream refused, polling alone carries the payments, and the
+// stream is retried on a widening backoff rather than hammered
+static void testFallbackToPolling() {
+  touch();
+  streamRefused = true;
+  hostStreamClose();
+  CHECK(sketchRunUntil(streamDown, 1000));
+  uint32_t retriesBefore = streamRequests;
+
+  balance = 5200;
+  pollsBefore = polls();
+  CHECK(sketchRunUntil(polledAgain, POLL_MAX_ACTIVE_MS * 11 / 10));
+  CHECK(sketchRunUntil(balanceApplied, 500));
+  CHECK(!pushIsConnected());
+  // 5 s, 10 s, 20 s, 40 s, 80 s...
+  CHECK(streamRequests - retriesBefore <= 6);
+  CHECK(streamRequests - retriesBefore >= 1);
+}
+
+int main() {
+  hostHeapBegin(200 * 1024);
+  testConnect();
+  testEventPolls();
+  testEventDuringPoll();
+  testReconnect();
+  testFallbackToPolling();
+  TEST_EXIT();
+}
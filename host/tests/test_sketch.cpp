@@ -0,0 +1,146 @@
+// The sketch itself: setup() and loop() from satoshi_pet_heltec.ino, with
+// the network task, the button interrupts and the display's I2C traffic on
+// the stand-ins. A first boot goes through WiFi setup and pairing to the
+// pet screen, and what reaches the panel is checked against what was drawn.
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <WiFi.h>
+#include <string>
+#include "button_handler.h"
+#include "config.h"
+#include "host_hal.h"
+#include "host_net.h"
+#include "host_panel.h"
+#include "sketch_harness.h"
+#include "test_support.h"
+
+#define DEVICE_ID "device-1"
+
+static bool serverPaired = false;
+static uint32_t pairingPolls = 0;
+static uint32_t devicePolls = 0;
+
+static bool startsWith(const std::string &text, const char *prefix) {
+  return text.compare(0, strlen(prefix), prefix) == 0;
+}
+
+static HostHttpResponse server(const HostHttpRequest &request) {
+  HostHttpResponse response;
+  if (startsWith(request.path, "/api/device/config?pairingCode=")) {
+    pairingPolls++;
+  } else if (startsWith(request.path, "/api/device/config?deviceId=" DEVICE_ID)) {
+    devicePolls++;
+  } else {
+    response.status = 404;
+    return response;
+  }
+  if (!serverPaired) {
+    response.status = 404;
+    response.body = "{\"success\":false,\"error\":\"Device not found\"}";
+    return response;
+  }
+  response.body = "{\"success\":true,\"config\":{\"deviceId\":\"" DEVICE_ID "\",\"petName\":\"Satoshi\","
+                  "\"petType\":\"cat\",\"userName\":\"Ms Nakamoto\",\"balance\":5000,"
+                  "\"btcPrice\":65000,\"pollInterval\":30000}}";
+  return response;
+}
+
+// The panel shows exactly the framebuffer the sketch last drew
+static bool panelShowsFrame() {
+  return memcmp(hostPanelRam(), display.buffer, HOST_PANEL_WIDTH * HOST_PANEL_PAGES) == 0;
+}
+
+static uint32_t litPixels() {
+  uint32_t lit = 0;
+  for (int y = 0; y < HOST_PANEL_PAGES * 8; y++) {
+    for (int x = 0; x < HOST_PANEL_WIDTH; x++) {
+      lit += hostPanelPixel(x, y);
+    }
+  }
+  return lit;
+}
+
+static bool paired() {
+  return isPaired;
+}
+
+static void testFirstBoot() {
+  sketchSetup();
+  // Splash screens, then the pairing code once WiFi is up
+  CHECK(millis() >= 5000);
+  CHECK(WiFi.status() == WL_CONNECTED);
+  CHECK(!isPaired);
+  CHECK(hostPanelOn());
+  CHECK(panelShowsFrame());
+  CHECK(litPixels() > 0);
+}
+
+static void testPairing() {
+  // Polled every 5 s on the network task until the app pairs the code
+  sketchRunMs(11000);
+  CHECK(pairingPolls >= 2);
+  CHECK(!isPaired);
+
+  serverPaired = true;
+  CHECK(sketchRunUntil(paired, 6000));
+  CHECK_STR(ganamosConfig.deviceId.c_str(), DEVICE_ID);
+  Preferences prefs;
+  prefs.begin("satoshi-pet", true);
+  CHECK(prefs.getBool("isPaired", false));
+  CHECK_STR(prefs.getString("deviceId", "").c_str(), DEVICE_ID);
+  prefs.end();
+
+  // "Connected!", then the first onboarding screen
+  sketchRunMs(2500);
+  CHECK_EQ(onboardingStep, 1);
+  CHECK(panelShowsFrame());
+}
+
+static void testOnboarding() {
+  uint8_t frame[HOST_PANEL_WIDTH * HOST_PANEL_PAGES];
+  for (int step = 2; step <= 4; step++) {
+    memcpy(frame, hostPanelRam(), sizeof(frame));
+    sketchPress(BUTTON_PIN_EXTERNAL, 150);
+    CHECK_EQ(onboardingStep, step);
+    CHECK(memcmp(frame, hostPanelRam(), sizeof(frame)) != 0);
+    CHECK(panelShowsFrame());
+  }
+  sketchPress(BUTTON_PIN_EXTERNAL, 150);
+  CHECK_EQ(onboardingStep, 0);
+  CHECK(panelShowsFrame());
+  CHECK(getInputLatencyMaxUs() > 0);
+}
+
+// The pet animates and the config is polled at the server's interval, with
+// only the changed part of each frame sent to the panel
+static void testPetScreen() {
+  uint32_t flushes = getTotalFlushCount();
+  uint32_t bytes = getTotalFlushBytes();
+  uint32_t polls = devicePolls;
+  HostPanelStats before = hostPanelStats();
+  sketchRunMs(65000);
+  uint32_t frames = getTotalFlushCount() - flushes;
+  CHECK(frames >= 100);
+  CHECK(panelShowsFrame());
+  CHECK(litPixels() > 0);
+  CHECK(devicePolls - polls >= 1);  // Nothing changed, so the second waits twice as long
+  HostPanelStats after = hostPanelStats();
+  CHECK_EQ(after.bytes - before.bytes, getTotalFlushBytes() - bytes);
+  printf("%u frames, %u bytes each on average, %.1f ms of I2C per frame\n", (unsigned)frames,
+         (unsigned)((getTotalFlushBytes() - bytes) / frames),
+         (after.busUs - before.busUs) / 1000.0 / frames);
+  CHECK((getTotalFlushBytes() - bytes) / frames < HOST_PANEL_WIDTH * HOST_PANEL_PAGES);
+}
+
+int main() {
+  hostHeapBegin(200 * 1024);
+  hostReset();
+  hostHttpServe(server);
+
+  testFirstBoot();
+  testPairing();
+  testOnboarding();
+  testPetScreen();
+  TEST_EXIT();
+}
@@ -0,0 +1,52 @@
+#ifndef TEST_SUPPORT_H
+#define TEST_SUPPORT_H
+
+#include <stdio.h>
+#include <string.h>
+#include "host_hal.h"
+
+// Minimal checks for the host tests: a failed CHECK prints where and keeps
+// going, and TEST_EXIT() turns the tally into the exit status ctest reads.
+
+inline int testFailures = 0;
+
+#define CHECK(cond)                                                           \
+  do {                                                                        \
+    if (!(cond)) {                                                            \
+      fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      testFailures++;                                                         \
+    }                                                                         \
+  } while (0)
+
+#define CHECK_EQ(actual, expected)                                                  \
+  do {                                                                              \
+    long long a_ = (long long)(actual);                                             \
+    long long e_ = (long long)(expected);                                           \
+    if (a_ != e_) {                                                                 \
+      fprintf(stderr, "%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__,     \
+              #actual, a_, e_);                                                     \
+      testFailures++;                                                               \
+    }                                                                               \
+  } while (0)
+
+// Arguments are evaluated again for the message, so a temporary's c_str()
+// is still alive wherever it is read
+#define CHECK_STR(actual, expected)                                                 \
+  do {                                                                              \
+    if (strcmp((actual), (expected)) != 0) {                                        \
+      fprintf(stderr, "%s:%d: %s is \"%s\", expected \"%s\"\n", __FILE__, __LINE__, \
+              #actual, (actual), (expected));                                       \
+      testFailures++;                                                               \
+    }                                                                               \
+  } while (0)
+
+#define TEST_EXIT()                                   \
+  do {                                                \
+    if (testFailures) {                               \
+      fprintf(stderr, "%d check(s) failed\n", testFailures); \
+      return 1;                                       \
+    }                                                 \
+    return 0;                                         \
+  } while (0)
+
+#endif
@@ -0,0 +1,267 @@
+#include "api_client.h"
+#include "dns_cache.h"
+#include <WiFi.h>
+#include <WiFiClientSecure.h>
+
+static WiFiClientSecure *sharedClient = nullptr;
+static bool requestReusedSocket = false;
+static bool socketJustOpened = false;  // apiBegin() connected it for this request
+static uint32_t handshakeCount = 0;
+static uint32_t requestCount = 0;
+
+// Response headers apiParse() and the config poll need to see
+static const char *collectedHeaders[] = { "Transfer-Encoding", "ETag" };
+
+// One response body off the socket. Stops at Content-Length or the last
+// chunk, strips chunked framing (the raw client stream includes it) and
+// hashes the bytes it hands to the parser. Reads in small blocks - a TLS
+// read per byte is slow.
+class BodyStream : public Stream {
+ public:
+  BodyStream(Stream &in, int size, bool chunked)
+    : bytes(0), hash(2166136261UL), in(in), chunked(chunked), left(chunked ? 0 : size),
+      done(false), failed(false), pos(0), len(0) {}
+
+  int available() override {
+    if (pos < len) {
+      return len - pos;
+    }
+    return (left != 0 || (chunked && !done)) ? in.available() : 0;
+  }
+
+  int read() override {
+    int c = peek();
+    if (c >= 0) {
+      pos++;
+      bytes++;
+      hash = (hash ^ (uint8_t)c) * 16777619UL;  // FNV-1a
+    }
+    return c;
+  }
+
+  int peek() override {
+    if (pos < len) {
+      return (uint8_t)buffer[pos];
+    }
+    if (failed || (left == 0 && !nextChunk())) {
+      return -1;
+    }
+    // Unknown length: a byte at a time so we never wait on data that won't come
+    size_t want = left > 0 ? min(left, (long)sizeof(buffer)) : 1;
+    len = in.readBytes(buffer, want);
+    pos = 0;
+    if (len == 0) {
+      failed = true;
+      return -1;
+    }
+    if (left > 0) {
+      left -= len;
+    }
+    return (uint8_t)buffer[0];
+  }
+
+  size_t write(uint8_t) override {
+    return 0;
+  }
+
+  // Consume whatever the parser left behind. False if the body didn't end
+  // cleanly, in which case the socket can't be reused.
+  bool drain() {
+    if (left < 0) {
+      return false;  // No length: the server closes the connection to end it
+    }
+    while (read() >= 0) {
+    }
+    return !failed;
+  }
+
+  uint32_t bytes;
+  uint32_t hash;
+
+ private:
+  // Chunk size line ("1a2\r\n"), after the previous chunk's CRLF
+  bool nextChunk() {
+    if (!chunked || done) {
+      return false;
+    }
+    String line = in.readStringUntil('\n');
+    if (line.length() <= 1 && bytes > 0) {
+      line = in.readStringUntil('\n');
+    }
+    left = strtol(line.c_str(), NULL, 16);
+    if (left <= 0) {
+      // Last chunk - skip any trailers up to the blank line
+      while (in.readStringUntil('\n').length() > 1) {
+      }
+      done = true;
+      failed = line.length() == 0;
+      return false;
+    }
+    return true;
+  }
+
+  Stream &in;
+  bool chunked;
+  long left;  // Bytes not yet buffered from this chunk / body (-1 = unknown)
+  bool done;
+  bool failed;
+  char buffer[64];
+  size_t pos;
+  size_t len;
+};
+
+// Allocated once and never deleted - repeated new/delete of the TLS client
+// was a major source of heap fragmentation
+static WiFiClientSecure *getSharedClient() {
+  if (!sharedClient) {
+    sharedClient = new WiFiClientSecure;
+    if (!sharedClient) {
+      return nullptr;
+    }
+    sharedClient->setInsecure();  // Skip certificate validation
+    sharedClient->setTimeout(API_TIMEOUT_MS);
+    sharedClient->setHandshakeTimeout(API_TIMEOUT_MS);
+  }
+  return sharedClient;
+}
+
+bool apiBegin(HTTPClient &http, const String &path) {
+  WiFiClientSecure *client = getSharedClient();
+  if (!client) {
+    Serial.println(F("❌ API: Failed to allocate TLS client"));
+    return false;
+  }
+
+  // Open the socket to the cached address ourselves (SNI still carries the
+  // hostname). HTTPClient reuses an open socket, so it never resolves the
+  // name; without a cached address it connects by name as before.
+  IPAddress ip;
+  socketJustOpened = false;
+  if (!client->connected() && WiFi.status() == WL_CONNECTED && dnsCacheLookup(ip)) {
+    handshakeCount++;
+    if (client->connect(ip, 443, GANAMOS_API_HOST, NULL, NULL, NULL)) {
+      socketJustOpened = true;
+    } else {
+      dnsCacheInvalidate();
+    }
+  }
+
+  if (!http.begin(*client, String(GANAMOS_API_BASE_URL) + path)) {
+    return false;
+  }
+
+  http.setTimeout(API_TIMEOUT_MS);
+  http.setReuse(true);  // Keep the socket open after http.end()
+  http.collectHeaders(collectedHeaders, 2);
+  return true;
+}
+
+// HTTPClient reuses the socket if it is still connected, otherwise it
+// reconnects (full TLS handshake). Track which one happens.
+static void beforeSend() {
+  bool open = sharedClient && sharedClient->connected();
+  requestReusedSocket = open && !socketJustOpened;
+  if (!open) {
+    handshakeCount++;
+  }
+  socketJustOpened = false;
+  requestCount++;
+}
+
+// Negative codes are transport errors (connection refused/lost, send failed)
+static bool shouldRetry(int httpCode) {
+  if (httpCode >= 0 || !requestReusedSocket) {
+    return false;
+  }
+  Serial.println("⚠️ API: Reused connection failed (" + String(httpCode) + ") - reconnecting");
+  sharedClient->stop();
+  return true;
+}
+
+int apiGet(HTTPClient &http) {
+  beforeSend();
+  int httpCode = http.GET();
+  if (shouldRetry(httpCode)) {
+    beforeSend();
+    httpCode = http.GET();
+  }
+  return httpCode;
+}
+
+int apiPost(HTTPClient &http, const String &payload) {
+  beforeSend();
+  int httpCode = http.POST(payload);
+  if (shouldRetry(httpCode)) {
+    beforeSend();
+    httpCode = http.POST(payload);
+  }
+  return httpCode;
+}
+
+DynamicJsonDocument *apiParse(HTTPClient &http, size_t capacity, const JsonDocument &filter,
+                              ApiBodyInfo *info) {
+#ifdef DEBUG_LOGGING
+  unsigned long start = millis();
+#endif
+  bool chunked = http.header("Transfer-Encoding").equalsIgnoreCase("chunked");
+  BodyStream body(http.getStream(), http.getSize(), chunked);
+
+  DynamicJsonDocument *doc = new DynamicJsonDocument(capacity);
+  DeserializationError error = DeserializationError::NoMemory;
+  if (doc && doc->capacity() > 0) {
+    error = deserializeJson(*doc, body, DeserializationOption::Filter(filter));
+  }
+
+  if (!body.drain() && sharedClient) {
+    sharedClient->stop();
+  }
+  if (info) {
+    info->bytes = body.bytes;
+    info->hash = body.hash;
+  }
+
+  if (error) {
+    Serial.print(F("❌ API: JSON parse error: "));
+    Serial.println(error.c_str());
+    delete doc;
+    return nullptr;
+  }
+
+  doc->shrinkToFit();  // Only the filtered fields travel to the UI task
+#ifdef DEBUG_LOGGING
+  Serial.printf("📦 API: %u B body -> %u B doc in %lu ms\n", (unsigned)body.bytes,
+                (unsigned)doc->memoryUsage(), millis() - start);
+#endif
+  return doc;
+}
+
+static StaticJsonDocument<JSON_OBJECT_SIZE(2)> ackFilter;
+
+const JsonDocument &apiAckFilter() {
+  if (ackFilter.isNull()) {
+    ackFilter["success"] = true;
+    ackFilter["newCoinBalance"] = true;
+  }
+  return ackFilter;
+}
+
+void apiEnd(HTTPClient &http, bool ok) {
+  http.end();
+  if (!ok && sharedClient) {
+    sharedClient->stop();
+  }
+}
+
+void apiDisconnect() {
+  if (sharedClient) {
+    sharedClient->stop();
+  }
+}
+
+uint32_t getApiHandshakeCount() {
+  return handshakeCount;
+}
+
+uint32_t getApiRequestCount() {
+  return requestCount;
+}
@@ -0,0 +1,59 @@
+#ifndef API_CLIENT_H
+#define API_CLIENT_H
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <ArduinoJson.h>
+
+#define GANAMOS_API_HOST "www.ganamos.earth"
+#define GANAMOS_API_BASE_URL "https://www.ganamos.earth"
+#define API_TIMEOUT_MS 5000
+
+// Shared keep-alive HTTPS session for all Ganamos API calls.
+//
+// One WiFiClientSecure is allocated once and reused across requests, so a
+// poll cycle (config + spend sync + score sync) costs one TLS handshake
+// instead of one per request. The socket is only torn down after a
+// transport-level failure or when WiFi is switched off.
+
+// Begin a request for an API path (e.g. "/api/device/jobs?deviceId=...")
+// on the shared session. Returns false if the request could not be set up.
+bool apiBegin(HTTPClient &http, const String &path);
+
+// Send the request. If a reused socket turns out to be dead (server closed
+// the idle connection), reconnects and retries once.
+int apiGet(HTTPClient &http);
+int apiPost(HTTPClient &http, const String &payload);
+
+// Raw response body as it came off the socket
+struct ApiBodyInfo {
+  uint32_t bytes;  // Body bytes read (chunk framing not counted)
+  uint32_t hash;   // FNV-1a of the body, for spotting an unchanged response
+};
+
+// Parse the response body straight from the socket into a new document of
+// the given capacity, keeping only the fields present in filter. Nothing is
+// buffered as a String. Returns nullptr on an allocation or parse error.
+// Either way the body is read to its end so the keep-alive socket can be
+// reused.
+DynamicJsonDocument *apiParse(HTTPClient &http, size_t capacity, const JsonDocument &filter,
+                              ApiBodyInfo *info = nullptr);
+
+// Filter for the plain acknowledgement most POSTs get back: success and,
+// where the server sends one, newCoinBalance. API_ACK_CAPACITY holds both
+// with their keys. Network task only (built on first use).
+#define API_ACK_CAPACITY (JSON_OBJECT_SIZE(2) + 32)
+const JsonDocument &apiAckFilter();
+
+// Finish a request. Pass ok=false after a transport failure so the next
+// request starts with a fresh connection; otherwise the socket stays open.
+void apiEnd(HTTPClient &http, bool ok);
+
+// Close the shared session and free its TLS buffers (call before WiFi off)
+void apiDisconnect();
+
+// Connection stats since boot
+uint32_t getApiHandshakeCount();
+uint32_t getApiRequestCount();
+
+#endif
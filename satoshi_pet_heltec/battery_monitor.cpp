@@ -0,0 +1,188 @@
+#include "battery_monitor.h"
+#include "heap_monitor.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#define BATTERY_TASK_CORE 0         // Keep ADC settle delays off the UI core
+#define BATTERY_TASK_STACK 3072
+#define BATTERY_TASK_PRIORITY 0     // Runs only when nothing else wants core 0
+#define BATTERY_SAMPLE_MS 5000
+#define BATTERY_BURST 5             // ADC reads per sample (median taken)
+#define BATTERY_EMA_ALPHA 0.15f     // Weight of the new sample
+#define BATTERY_SLOPE_WINDOW 24     // Samples in the trend window (2 minutes)
+#define BATTERY_SLOPE_MIN_SAMPLES 6 // Need 30s of history before trusting the trend
+#define BATTERY_LOG_EVERY 12        // Log once a minute
+
+// Heltec WiFi Kit 32 V3 (ESP32-S3) voltage divider: 100kΩ/390kΩ = multiply by 4.9
+#define BATTERY_DIVIDER 4.9f
+
+static uint8_t vbatPin = 0;
+static uint8_t ctrlPin = 0;
+static TaskHandle_t batteryTaskHandle = NULL;
+
+// Sampler task only
+static float smoothedVoltage = 0;
+static float history[BATTERY_SLOPE_WINDOW];
+static uint8_t historyCount = 0;
+static uint8_t historyHead = 0;
+
+static portMUX_TYPE snapshotMux = portMUX_INITIALIZER_UNLOCKED;
+static BatterySnapshot snapshot = { 0, 0, 0, false, 0, 0, 0 };
+
+// Non-linear LiPo discharge curve (more accurate than simple linear mapping)
+// Based on typical single-cell LiPo discharge characteristics
+static int percentFromVoltage(float voltage) {
+  int percentage;
+
+  if (voltage >= 4.15) {
+    percentage = 100;  // 4.15V+ = 100%
+  } else if (voltage >= 4.0) {
+    // 4.0-4.15V = 85-100% (top 15% is rapid)
+    percentage = 85 + (int)((voltage - 4.0) / 0.15 * 15);
+  } else if (voltage >= 3.85) {
+    // 3.85-4.0V = 60-85% (gradual decline)
+    percentage = 60 + (int)((voltage - 3.85) / 0.15 * 25);
+  } else if (voltage >= 3.7) {
+    // 3.7-3.85V = 40-60% (mid range, flatter curve)
+    percentage = 40 + (int)((voltage - 3.7) / 0.15 * 20);
+  } else if (voltage >= 3.5) {
+    // 3.5-3.7V = 15-40% (steeper drop)
+    percentage = 15 + (int)((voltage - 3.5) / 0.2 * 25);
+  } else if (voltage >= 3.2) {
+    // 3.2-3.5V = 5-15% (getting low)
+    percentage = 5 + (int)((voltage - 3.2) / 0.3 * 10);
+  } else if (voltage >= 3.0) {
+    // 3.0-3.2V = 0-5% (critical low)
+    percentage = (int)((voltage - 3.0) / 0.2 * 5);
+  } else {
+    percentage = 0;  // Below 3.0V = dead
+  }
+
+  // Clamp between 0-100
+  if (percentage > 100) percentage = 100;
+  if (percentage < 0) percentage = 0;
+  return percentage;
+}
+
+static uint8_t levelFromVoltage(float voltage) {
+  if (voltage >= 3.9) return 3;      // Full
+  else if (voltage >= 3.7) return 2; // Medium
+  else if (voltage >= 3.5) return 1; // Low
+  else return 0;                     // Critical
+}
+
+// Median of a short burst - a WiFi TX spike lands in one read, not the result
+static float readVoltage() {
+  // Re-initialize ADC config (can reset after WiFi init or deep sleep)
+  analogReadResolution(12);
+  analogSetAttenuation(ADC_11db);
+  pinMode(ctrlPin, OUTPUT);
+  digitalWrite(ctrlPin, LOW);
+  vTaskDelay(pdMS_TO_TICKS(5));  // Let the divider settle
+
+  uint32_t mv[BATTERY_BURST];
+  for (int i = 0; i < BATTERY_BURST; i++) {
+    mv[i] = analogReadMilliVolts(vbatPin);
+    vTaskDelay(pdMS_TO_TICKS(1));
+  }
+
+  // Insertion sort - five values
+  for (int i = 1; i < BATTERY_BURST; i++) {
+    uint32_t v = mv[i];
+    int j = i - 1;
+    while (j >= 0 && mv[j] > v) {
+      mv[j + 1] = mv[j];
+      j--;
+    }
+    mv[j + 1] = v;
+  }
+
+  return mv[BATTERY_BURST / 2] / 1000.0f * BATTERY_DIVIDER;
+}
+
+// mV per minute between the oldest and newest filtered sample in the window
+static int16_t voltageSlope() {
+  if (historyCount < BATTERY_SLOPE_MIN_SAMPLES) {
+    return 0;
+  }
+  uint8_t newest = (historyHead + BATTERY_SLOPE_WINDOW - 1) % BATTERY_SLOPE_WINDOW;
+  uint8_t oldest = (historyHead + BATTERY_SLOPE_WINDOW - historyCount) % BATTERY_SLOPE_WINDOW;
+  float minutes = (historyCount - 1) * (BATTERY_SAMPLE_MS / 60000.0f);
+  return (int16_t)((history[newest] - history[oldest]) * 1000.0f / minutes);
+}
+
+static void takeSample() {
+  float raw = readVoltage();
+
+  // Exponential moving average: smooth but responsive
+  if (smoothedVoltage == 0) {
+    smoothedVoltage = raw;
+  } else {
+    smoothedVoltage = (1.0f - BATTERY_EMA_ALPHA) * smoothedVoltage + BATTERY_EMA_ALPHA * raw;
+  }
+
+  history[historyHead] = smoothedVoltage;
+  historyHead = (historyHead + 1) % BATTERY_SLOPE_WINDOW;
+  if (historyCount < BATTERY_SLOPE_WINDOW) {
+    historyCount++;
+  }
+
+  BatterySnapshot next;
+  next.voltage = smoothedVoltage;
+  next.percent = percentFromVoltage(smoothedVoltage);
+  next.level = levelFromVoltage(smoothedVoltage);
+  next.slopeMvPerMin = voltageSlope();
+  // Rising means a charger is connected. Near full the voltage goes flat
+  // on USB, so also count a held 4.1V+ that isn't falling.
+  next.charging = next.slopeMvPerMin >= 5 || (smoothedVoltage >= 4.1 && next.slopeMvPerMin > -2);
+  next.updatedMs = millis();
+
+  portENTER_CRITICAL(&snapshotMux);
+  next.sampleCount = snapshot.sampleCount + 1;
+  snapshot = next;
+  portEXIT_CRITICAL(&snapshotMux);
+
+  if (next.sampleCount % BATTERY_LOG_EVERY == 1) {
+    Serial.print(F("🔋 Battery: "));
+    Serial.print(next.voltage, 2);
+    Serial.print(F("V (raw "));
+    Serial.print(raw, 2);
+    Serial.print(F("V) "));
+    Serial.print(next.percent);
+    Serial.print(F("% trend "));
+    Serial.print(next.slopeMvPerMin);
+    Serial.println(next.charging ? F("mV/min charging") : F("mV/min"));
+    if (next.voltage < 0.1) {
+      Serial.println(F("⚠️  Warning: Battery read near 0 V – check cable or battery health."));
+    } else if (next.voltage < 3.0) {
+      Serial.println(F("⚠️  Warning: Voltage < 3.0V - battery critically low"));
+    }
+  }
+}
+
+static void batteryTask(void *) {
+  for (;;) {
+    vTaskDelay(pdMS_TO_TICKS(BATTERY_SAMPLE_MS));
+    takeSample();
+  }
+}
+
+void batteryMonitorBegin(uint8_t vbat, uint8_t ctrl) {
+  if (batteryTaskHandle) {
+    return;
+  }
+  vbatPin = vbat;
+  ctrlPin = ctrl;
+
+  takeSample();  // Readings are valid before the first frame renders
+  xTaskCreatePinnedToCore(batteryTask, "battery", BATTERY_TASK_STACK, NULL, BATTERY_TASK_PRIORITY,
+                          &batteryTaskHandle, BATTERY_TASK_CORE);
+  heapMonitorWatchTask(batteryTaskHandle, BATTERY_TASK_STACK);
+}
+
+BatterySnapshot getBatterySnapshot() {
+  portENTER_CRITICAL(&snapshotMux);
+  BatterySnapshot copy = snapshot;
+  portEXIT_CRITICAL(&snapshotMux);
+  return copy;
+}
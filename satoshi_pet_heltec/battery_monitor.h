@@ -0,0 +1,29 @@
+#ifndef BATTERY_MONITOR_H
+#define BATTERY_MONITOR_H
+
+#include <Arduino.h>
+
+// Background battery sampler.
+//
+// A low-priority task reads VBAT every few seconds (median of a burst of
+// ADC reads, then an EMA), works out charging from the voltage trend and
+// publishes a snapshot. Render code copies the snapshot instead of touching
+// the ADC, so reading the battery costs nothing on the UI task.
+
+struct BatterySnapshot {
+  float voltage;           // Filtered battery voltage (V)
+  uint8_t percent;         // 0-100 from the LiPo discharge curve
+  uint8_t level;           // 0-3 for the battery icon
+  bool charging;           // Voltage rising, or held near full on USB
+  int16_t slopeMvPerMin;   // Voltage trend over the last couple of minutes
+  uint32_t sampleCount;    // Samples taken since boot
+  unsigned long updatedMs; // millis() of the last sample
+};
+
+// Take a first sample (blocking, ~10 ms) and start the sampler task
+void batteryMonitorBegin(uint8_t vbatPin, uint8_t ctrlPin);
+
+// Copy of the latest published readings
+BatterySnapshot getBatterySnapshot();
+
+#endif
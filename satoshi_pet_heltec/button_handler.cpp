@@ -1,40 +1,196 @@
 #include "button_handler.h"
+#include "display_flush.h"
+#include "profiler.h"
+#include <freertos/FreeRTOS.h>
+#include <soc/soc.h>
+#include <soc/gpio_reg.h>
 
-// These are defined in satoshi_pet_heltec.ino
-extern const unsigned long SHORT_PRESS_MAX;
-extern const unsigned long HOLD_PRESS_MIN;
-extern const unsigned long VERY_LONG_PRESS;
+// Single-producer/single-consumer ring: the edge ISRs (both on the loop core,
+// so they never run concurrently) write head, loop() reads tail.
+#define BUTTON_RING_SIZE 32   // Power of two
+static ButtonEvent buttonRing[BUTTON_RING_SIZE];
+static volatile uint8_t ringHead = 0;
+static volatile uint8_t ringTail = 0;
+static volatile uint32_t droppedEvents = 0;
 
-void initButtons() {
+// Debounce state per button, owned by the ISR (index 0 = PRG, 1 = external)
+static volatile bool reportedDown[2] = { false, false };
+static volatile uint32_t lastEdgeUs[2] = { 0, 0 };
+static portMUX_TYPE buttonMux = portMUX_INITIALIZER_UNLOCKED;
+
+static const uint8_t buttonPins[2] = { BUTTON_PIN_PRG, BUTTON_PIN_EXTERNAL };
+
+// Read the pin straight from the GPIO input register - the ISR lives in IRAM
+// and must not call into flash (digitalRead) while NVS has the cache disabled
+static inline bool IRAM_ATTR isPinLow(uint8_t pin) {
+  return ((REG_READ(GPIO_IN_REG) >> pin) & 1) == 0;
+}
+
+static void IRAM_ATTR pushEvent(uint8_t pin, bool pressed, uint32_t timeUs) {
+  uint8_t head = ringHead;
+  uint8_t next = (head + 1) & (BUTTON_RING_SIZE - 1);
+  if (next == ringTail) {
+    droppedEvents++;
+    return;
+  }
+  buttonRing[head].pin = pin;
+  buttonRing[head].pressed = pressed;
+  buttonRing[head].timeUs = timeUs;
+  ringHead = next;  // Publish after the slot is written
+}
+
+static void IRAM_ATTR onButtonEdge(uint8_t index) {
+  uint32_t now = micros();
+  bool down = isPinLow(buttonPins[index]);
+
+  portENTER_CRITICAL_ISR(&buttonMux);
+  // Ignore bounces: same level as last reported, or too soon after the last edge
+  if (down != reportedDown[index] && now - lastEdgeUs[index] >= BUTTON_DEBOUNCE_US) {
+    reportedDown[index] = down;
+    lastEdgeUs[index] = now;
+    pushEvent(buttonPins[index], down, now);
+  }
+  portEXIT_CRITICAL_ISR(&buttonMux);
+}
+
+static void IRAM_ATTR onPrgEdge() {
+  onButtonEdge(0);
+}
+
+static void IRAM_ATTR onExternalEdge() {
+  onButtonEdge(1);
+}
+
+void initButtons(uint64_t wakePins) {
   pinMode(BUTTON_PIN_PRG, INPUT_PULLUP);
   pinMode(BUTTON_PIN_EXTERNAL, INPUT_PULLUP);
-  Serial.println("🔘 Buttons initialized (PRG=GPIO0, External=GPIO2)");
+  reportedDown[0] = digitalRead(BUTTON_PIN_PRG) == LOW;
+  reportedDown[1] = digitalRead(BUTTON_PIN_EXTERNAL) == LOW;
+
+  // A press that woke the chip happened before the ISRs existed. Report it
+  // as a fresh press if still held, or as a tap if already let go.
+  uint32_t now = micros();
+  for (uint8_t i = 0; i < 2; i++) {
+    if (!(wakePins & (1ULL << buttonPins[i]))) {
+      continue;
+    }
+    if (reportedDown[i]) {
+      reportedDown[i] = false;  // settleMissedEdge() reports the held level
+    } else {
+      pushEvent(buttonPins[i], true, now);
+      pushEvent(buttonPins[i], false, now);
+    }
+  }
+  attachInterrupt(digitalPinToInterrupt(BUTTON_PIN_PRG), onPrgEdge, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(BUTTON_PIN_EXTERNAL), onExternalEdge, CHANGE);
+  Serial.println("🔘 Buttons initialized (PRG=GPIO0, External=GPIO2, edge interrupts)");
+}
+
+// The ISR drops edges inside the debounce window, so a release that lands
+// within 20ms of the press (or the last bounce) is never reported. Once the
+// ring is empty and the pin has been quiet, report the level it settled at.
+static bool settleMissedEdge(ButtonEvent& event) {
+  bool levels[2] = {
+    digitalRead(BUTTON_PIN_PRG) == LOW,
+    digitalRead(BUTTON_PIN_EXTERNAL) == LOW
+  };
+  uint32_t now = micros();
+  bool found = false;
+
+  portENTER_CRITICAL(&buttonMux);
+  if (ringHead == ringTail) {
+    for (uint8_t i = 0; i < 2 && !found; i++) {
+      bool down = levels[i];
+      if (down != reportedDown[i] && now - lastEdgeUs[i] >= BUTTON_DEBOUNCE_US) {
+        reportedDown[i] = down;
+        lastEdgeUs[i] = now;
+        event.pin = buttonPins[i];
+        event.pressed = down;
+        event.timeUs = now;
+        found = true;
+      }
+    }
+  }
+  portEXIT_CRITICAL(&buttonMux);
+
+  return found;
+}
+
+bool readButtonEvent(ButtonEvent& event) {
+  uint8_t tail = ringTail;
+  if (tail == ringHead) {
+    return settleMissedEdge(event);
+  }
+  event = buttonRing[tail];
+  ringTail = (tail + 1) & (BUTTON_RING_SIZE - 1);
+  return true;
+}
+
+void clearButtonEvents() {
+  ringTail = ringHead;
+}
+
+uint32_t getDroppedButtonEvents() {
+  return droppedEvents;
 }
 
 bool updateButtonState(ButtonState& state) {
-  bool prgButtonState = digitalRead(BUTTON_PIN_PRG) == LOW;
-  bool externalButtonState = digitalRead(BUTTON_PIN_EXTERNAL) == LOW;
-  bool currentButtonState = prgButtonState || externalButtonState;
-  
+  ProfileScope scope(PROFILE_INPUT);
+  ButtonEvent event;
+  if (!readButtonEvent(event)) {
+    return false;
+  }
+
+  unsigned long eventMs = millis() - (micros() - event.timeUs) / 1000;
+  if (event.pin == BUTTON_PIN_PRG) {
+    state.prgDown = event.pressed;
+  } else {
+    state.externalDown = event.pressed;
+  }
+  bool anyDown = state.prgDown || state.externalDown;
+
   // Detect button press (transition from not pressed to pressed)
-  if (currentButtonState && !state.pressed) {
+  if (anyDown && !state.pressed) {
     state.pressed = true;
-    state.pressTime = millis();
-    state.lastPress = millis();
-    state.prgPressed = prgButtonState;
-    state.externalPressed = externalButtonState;
+    state.pressTime = eventMs;
+    state.lastPress = eventMs;
+    state.prgPressed = state.prgDown;
+    state.externalPressed = state.externalDown;
+    markInputForLatency(event.timeUs);
     return true; // State changed
   }
-  
+
+  // Second button joining a press already in progress
+  if (anyDown) {
+    state.prgPressed = state.prgPressed || state.prgDown;
+    state.externalPressed = state.externalPressed || state.externalDown;
+    return false;
+  }
+
   // Detect button release (transition from pressed to not pressed)
-  if (!currentButtonState && state.pressed) {
+  if (state.pressed) {
     state.pressed = false;
+    state.releaseTime = eventMs;
+    markInputForLatency(event.timeUs);
     return true; // State changed
   }
-  
+
   return false; // No state change
 }
 
+bool takeButtonPress() {
+  ProfileScope scope(PROFILE_INPUT);
+  bool pressed = false;
+  ButtonEvent event;
+  while (readButtonEvent(event)) {
+    if (event.pressed && !pressed) {
+      pressed = true;
+      markInputForLatency(event.timeUs);
+    }
+  }
+  return pressed;
+}
+
 bool wasButtonJustPressed(const ButtonState& state) {
   return state.pressed && (millis() - state.pressTime < 50);
 }
@@ -47,7 +203,7 @@ unsigned long getPressDuration(const ButtonState& state) {
   if (state.pressed) {
     return millis() - state.pressTime;
   } else {
-    return 0;
+    return state.releaseTime - state.pressTime;
   }
 }
 
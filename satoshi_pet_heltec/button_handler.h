@@ -11,32 +11,64 @@
 #define BUTTON_PIN_EXTERNAL 2 // External button (GPIO2)
 #endif
 
-// Press duration thresholds are defined in satoshi_pet_heltec.ino
+// Press duration thresholds, defined in satoshi_pet_heltec.ino (declared
+// here so the sketch's const definitions are visible to this module)
 // SHORT_PRESS_MAX = 600ms, HOLD_PRESS_MIN = 700ms, VERY_LONG_PRESS = 10000ms
+extern const unsigned long SHORT_PRESS_MAX;
+extern const unsigned long HOLD_PRESS_MIN;
+extern const unsigned long VERY_LONG_PRESS;
 
-// Button state tracking
+// Debounce window for the edge interrupts
+#define BUTTON_DEBOUNCE_US 20000
+
+// One debounced edge from the GPIO interrupt
+struct ButtonEvent {
+  uint8_t pin;        // BUTTON_PIN_PRG or BUTTON_PIN_EXTERNAL
+  bool pressed;       // true = went down, false = released
+  uint32_t timeUs;    // micros() when the edge happened
+};
+
+// Button state tracking (fed from the event ring, so presses that happen
+// while loop() is busy are still seen, with their real timestamps)
 struct ButtonState {
-  bool pressed;
-  unsigned long pressTime;
+  bool pressed;              // Any button down
+  unsigned long pressTime;   // millis() when the first button went down
   unsigned long lastPress;
-  bool prgPressed;
-  bool externalPressed;
+  unsigned long releaseTime; // millis() when the last button came up
+  bool prgPressed;           // PRG went down during this press
+  bool externalPressed;      // External went down during this press
+  bool prgDown;              // Current level of each button
+  bool externalDown;
 };
 
-// Initialize button pins
-void initButtons();
+// Initialize button pins and attach the edge interrupts. wakePins has a bit
+// set for each button that woke the chip from deep sleep.
+void initButtons(uint64_t wakePins = 0);
+
+// Take the next debounced edge, if any (never blocks)
+bool readButtonEvent(ButtonEvent& event);
 
-// Update button state (call every loop iteration)
-// Returns true if button state changed
+// Drop queued edges (e.g. a press left over from before a "Ready?" screen)
+void clearButtonEvents();
+
+// Edges lost because the ring was full
+uint32_t getDroppedButtonEvents();
+
+// Consume one queued edge into state.
+// Returns true when state.pressed changed (first button down / last button up).
 bool updateButtonState(ButtonState& state);
 
+// Drain queued edges; true if any button went down since the last call
+bool takeButtonPress();
+
 // Check if button was just pressed (for logging)
 bool wasButtonJustPressed(const ButtonState& state);
 
 // Check if button was just released
 bool wasButtonJustReleased(const ButtonState& state);
 
-// Get press duration in milliseconds
+// Get press duration in milliseconds (time held so far while pressed,
+// length of the finished press after release)
 unsigned long getPressDuration(const ButtonState& state);
 
 // Check press type
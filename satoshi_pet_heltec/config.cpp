@@ -1,8 +1,14 @@
 #include "config.h"
+#include "api_client.h"
+#include "net_task.h"
+#include "flappy_engine.h"
+#include "profiler.h"
+#include "heap_monitor.h"
+#include "metrics.h"
 #include <HTTPClient.h>
+#include <base64.h>
 #include <ArduinoJson.h>
 #include <WiFi.h>
-#include <WiFiClientSecure.h> 
 #include <WiFiClient.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
@@ -28,10 +34,25 @@ GanamosConfig ganamosConfig = {
   15,          // gameReward (default: 15 happiness per game)
   "",          // lastRejectionId
   "",          // rejectionMessage
-  ""           // rejectionPostTitle
+  "",          // rejectionPostTitle
+  false,       // batchSyncSupported
+  false,       // pushSupported
+  false,       // metricsSupported
+  PET_CAT      // petKind
 };
+
+PetType parsePetType(const char *petType) {
+  if (strcmp(petType, "dog") == 0) return PET_DOG;
+  if (strcmp(petType, "squirrel") == 0) return PET_SQUIRREL;
+  if (strcmp(petType, "turtle") == 0) return PET_TURTLE;
+  if (strcmp(petType, "rabbit") == 0 || strcmp(petType, "bunny") == 0) return PET_BUNNY;
+  if (strcmp(petType, "owl") == 0) return PET_OWL;
+  return PET_CAT;
+}
+
 int consecutiveFailures = 0;
 int lastHttpCode = 0; // Track last HTTP response code
+static bool lastConfigChanged = false; // Last poll brought something the user would notice
 
 // Economy configuration (0.05/min for both stats = 72 points/day)
 EconomyConfig economyConfig = {
@@ -58,71 +79,64 @@ String formatSatsShort(int sats) {
   return String(sats);
 }
 
-bool fetchJobs() {
+// Network task only: response filters, built on first use. The keys are
+// string literals, which ArduinoJson links rather than copies.
+static void filterFields(JsonObject filter, const char *const *keys, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    filter[keys[i]] = true;
+  }
+}
+
+static const char *const JOB_FIELDS[] = { "id", "title", "reward", "location", "createdAt", "groupName" };
+static StaticJsonDocument<JSON_OBJECT_SIZE(2) + JSON_ARRAY_SIZE(1) + JSON_OBJECT_SIZE(6)> jobsFilter;
+
+static const JsonDocument &getJobsFilter() {
+  if (jobsFilter.isNull()) {
+    jobsFilter["success"] = true;
+    filterFields(jobsFilter.createNestedArray("jobs").createNestedObject(), JOB_FIELDS,
+                 sizeof(JOB_FIELDS) / sizeof(JOB_FIELDS[0]));
+  }
+  return jobsFilter;
+}
+
+// Network task side: GET the jobs list for deviceId and parse it into doc
+int requestJobs(const char* deviceId, DynamicJsonDocument *&doc) {
   // Check WiFi status first
   if (WiFi.status() != WL_CONNECTED) {
     Serial.println("fetchJobs: WiFi not connected");
-    return false;
+    return NET_NO_WIFI;
   }
   
-  if (ganamosConfig.deviceId.length() == 0) {
+  if (strlen(deviceId) == 0) {
     Serial.println("fetchJobs: No deviceId");
-    return false;
-  }
-  
-  WiFiClientSecure *client = new WiFiClientSecure;
-  if (!client) {
-    return false;
+    return 0;
   }
   
   HTTPClient http;
   
-  client->setInsecure();
-  client->setTimeout(5000);
-  client->setHandshakeTimeout(5000);
-  
-  String url = "https://www.ganamos.earth/api/device/jobs?deviceId=" + ganamosConfig.deviceId;
-  
-  delay(100);
-  if (!http.begin(*client, url)) {
-    delete client;
-    return false;
+  if (!apiBegin(http, "/api/device/jobs?deviceId=" + String(deviceId))) {
+    return 0;
   }
   
-  http.setTimeout(5000);
   http.setFollowRedirects(HTTPC_FORCE_FOLLOW_REDIRECTS);
-  http.setReuse(false);
-  http.addHeader("Connection", "close");
   
-  int httpCode = http.GET();
+  int httpCode = apiGet(http);
   
   if (httpCode != 200) {
     Serial.println("fetchJobs: HTTP error " + String(httpCode));
-    http.end();
-    client->stop();
-    delete client;
-    return false;
-  }
-  
-  String payload = http.getString();
-  
-  // Use DynamicJsonDocument for larger response
-  DynamicJsonDocument doc(4096);
-  DeserializationError error = deserializeJson(doc, payload);
-  
-  if (error) {
-    Serial.println("fetchJobs: JSON parse error");
-    http.end();
-    client->stop();
-    delete client;
-    return false;
+    apiEnd(http, httpCode > 0);
+    return httpCode;
   }
   
+  doc = apiParse(http, 4096, getJobsFilter());
+  apiEnd(http, true);
+  return httpCode;
+}
+
+// UI task side: copy a parsed jobs response into cachedJobs
+static bool applyJobs(JsonDocument &doc) {
   if (!doc["success"]) {
     Serial.println("fetchJobs: API returned success=false");
-    http.end();
-    client->stop();
-    delete client;
     return false;
   }
   
@@ -134,12 +148,12 @@ bool fetchJobs() {
     if (cachedJobCount >= MAX_JOBS) break;
     
     JsonObject job = jobVar.as<JsonObject>();
-    cachedJobs[cachedJobCount].id = job["id"].as<String>();
-    cachedJobs[cachedJobCount].title = job["title"].as<String>();
+    cachedJobs[cachedJobCount].id = job["id"].as<const char*>();
+    cachedJobs[cachedJobCount].title = job["title"].as<const char*>();
     cachedJobs[cachedJobCount].reward = job["reward"] | 0;
-    cachedJobs[cachedJobCount].location = job["location"].as<String>();
-    cachedJobs[cachedJobCount].createdAt = job["createdAt"].as<String>();
-    cachedJobs[cachedJobCount].groupName = job["groupName"].as<String>();
+    cachedJobs[cachedJobCount].location = job["location"].as<const char*>();
+    cachedJobs[cachedJobCount].createdAt = job["createdAt"].as<const char*>();
+    cachedJobs[cachedJobCount].groupName = job["groupName"].as<const char*>();
     cachedJobCount++;
   }
   
@@ -150,166 +164,192 @@ bool fetchJobs() {
     lastSeenJobId = cachedJobs[0].id;
   }
   
-  http.end();
-  client->stop();
-  delete client;
   return true;
 }
 
-bool fetchGanamosConfig() {
-  // Check WiFi status first
-  if (WiFi.status() != WL_CONNECTED) {
-    Serial.println(F("fetchGanamosConfig: WiFi not connected, skipping"));
+bool fetchJobs() {
+  NetRequest req;
+  NetResult result;
+  netRequestInit(req, NET_REQ_FETCH_JOBS);
+  if (!netTransact(req, result)) {
     return false;
   }
   
-  // Try DNS first, fall back to cached IP if DNS fails
-  // (Common pattern for IoT devices on unreliable networks)
-  IPAddress serverIP;
-  
-  if (!WiFi.hostByName("www.ganamos.earth", serverIP) || serverIP[0] == 0) {
-    // DNS failed - use fallback IP
-    serverIP = IPAddress(66, 33, 60, 35);
+  bool success = result.doc && applyJobs(*result.doc);
+  netFreeResult(result);
+  return success;
+}
+
+// Network task only: validator of the last config body. It goes back as
+// If-None-Match so an unchanged config costs a 304 and no parse. Kept in
+// RAM only - the first poll after a boot or deep-sleep wake is a full one.
+static String configEtag;
+static String configEtagPath;        // Query the validator belongs to
+static uint32_t configBodyHash = 0;  // Fallback when the server sends no ETag
+static bool configBodyHashed = false;
+static ConfigPollStats configStats = { 0, 0, 0, 0 };
+
+static const char *const CONFIG_FIELDS[] = {
+  "deviceId", "petName", "petType", "userName", "balance", "coins", "btcPrice", "pollInterval",
+  "serverUrl", "lastMessage", "lastMessageType", "lastPostTitle", "lastSenderName", "gameCost",
+  "gameReward", "lastRejectionId", "rejectionMessage", "rejectionPostTitle", "batchSync",
+  "pushEvents", "metrics", "hungerDecayPer24h", "happinessDecayPer24h", "coinsEarnedSinceLastSync", "hasNewJob",
+  "newJobTitle", "newJobReward"
+};
+#define CONFIG_FIELD_COUNT (sizeof(CONFIG_FIELDS) / sizeof(CONFIG_FIELDS[0]))
+// Keys are copied off the stream too (~350 B), hence the string allowance
+#define CONFIG_DOC_CAPACITY (JSON_OBJECT_SIZE(2) + JSON_OBJECT_SIZE(CONFIG_FIELD_COUNT) + 1024)
+static StaticJsonDocument<JSON_OBJECT_SIZE(2) + JSON_OBJECT_SIZE(CONFIG_FIELD_COUNT)> configFilter;
+
+static const JsonDocument &getConfigFilter() {
+  if (configFilter.isNull()) {
+    configFilter["success"] = true;
+    filterFields(configFilter.createNestedObject("config"), CONFIG_FIELDS, CONFIG_FIELD_COUNT);
   }
-  
-  WiFiClientSecure *client = new WiFiClientSecure;
-  if (!client) {
-    return false;
+  return configFilter;
+}
+
+// GET a config path that apiBegin() has set up. A 200 carrying the same body
+// as last time (no ETag from the server, same hash) is reported as a 304,
+// unless it carries events (coins earned, a new job): the server repeating
+// one of those means it happened again.
+static int getConfig(HTTPClient &http, const String &path, DynamicJsonDocument *&doc) {
+  if (path != configEtagPath) {
+    forgetConfigValidator();
+    configEtagPath = path;
+  }
+
+  http.setFollowRedirects(HTTPC_FORCE_FOLLOW_REDIRECTS);
+  if (configEtag.length() > 0) {
+    http.addHeader("If-None-Match", configEtag);
+  }
+
+  int httpCode = apiGet(http);
+  if (httpCode == HTTP_CODE_NOT_MODIFIED) {
+    configStats.notModified++;
+  } else if (httpCode == 200) {
+    ApiBodyInfo body;
+    doc = apiParse(http, CONFIG_DOC_CAPACITY, getConfigFilter(), &body);
+    configStats.full++;
+    configStats.bytes += body.bytes;
+    if (!doc) {
+      forgetConfigValidator();  // Unparseable - don't let a 304 pin it
+      return httpCode;
+    }
+    configEtag = http.header("ETag");
+
+    JsonObject config = (*doc)["config"];
+    bool hasEvents = (config["coinsEarnedSinceLastSync"] | 0) > 0 || (config["hasNewJob"] | false);
+    if (configEtag.length() == 0 && !hasEvents && configBodyHashed && body.hash == configBodyHash) {
+      configStats.unchanged++;
+      delete doc;
+      doc = nullptr;
+      httpCode = HTTP_CODE_NOT_MODIFIED;
+    }
+    configBodyHash = body.hash;
+    configBodyHashed = true;
+  }
+  return httpCode;
+}
+
+void forgetConfigValidator() {
+  configEtag = "";
+  configBodyHashed = false;
+}
+
+ConfigPollStats getConfigPollStats() {
+  return configStats;
+}
+
+// Network task side: GET /api/device/config and parse it into doc, returns the
+// last HTTP code (304 and no doc when nothing changed since the last poll)
+int requestGanamosConfig(const char* deviceId, const char* pairingCode, DynamicJsonDocument *&doc) {
+  // Check WiFi status first
+  if (WiFi.status() != WL_CONNECTED) {
+    Serial.println(F("fetchGanamosConfig: WiFi not connected, skipping"));
+    return NET_NO_WIFI;
   }
   
+  // Requests go over the shared keep-alive session (5s timeouts to prevent watchdog resets),
+  // connected to the cached server address (dns_cache.h)
   HTTPClient http;
+  int httpCode = 0;
   
-  // Configure SSL client with shorter timeout to prevent watchdog resets
-  client->setInsecure();  // Skip certificate validation
-  client->setTimeout(5000); // 5 second timeout (reduced from 10s to prevent watchdog)
-  client->setHandshakeTimeout(5000); // 5 second SSL handshake timeout
-  
-  // Build URL using hostname (DNS is now resolved)
   // Strategy: Try deviceId first (most reliable, never changes), then fallback to pairingCode
   // This ensures we can reconnect even if pairing code changed but deviceId is still valid
   
   bool triedDeviceId = false;
-  bool triedPairingCode = false;
   
   // Try deviceId first if available
-  if (ganamosConfig.deviceId.length() > 0) {
+  if (strlen(deviceId) > 0) {
     triedDeviceId = true;
-    String url = "https://www.ganamos.earth/api/device/config?deviceId=" + ganamosConfig.deviceId;
-    
-    delay(100);
-    if (http.begin(*client, url)) {
-      http.setTimeout(5000);
-      http.setFollowRedirects(HTTPC_FORCE_FOLLOW_REDIRECTS);
-      http.setReuse(false);
-      http.addHeader("Connection", "close");
-      
-      lastHttpCode = 0;
-      int httpCode = http.GET();
-      lastHttpCode = httpCode;
+    String path = "/api/device/config?deviceId=" + String(deviceId);
+    if (apiBegin(http, path)) {
+      httpCode = getConfig(http, path, doc);
       
-      if (httpCode == 200) {
-        goto process_success;
+      if (httpCode == 200 || httpCode == HTTP_CODE_NOT_MODIFIED) {
+        apiEnd(http, true);
+        return httpCode;
       } else if (httpCode == 404) {
-        http.end();
-        // Continue to try pairing code
+        apiEnd(http, true);
+        // Continue to try pairing code (reuses the same connection)
       } else {
-        http.end();
-        client->stop();
-        delete client;
-        return false;
+        apiEnd(http, httpCode > 0);
+        return httpCode;
       }
     }
   }
   
   // Fallback: Try pairingCode if deviceId failed or wasn't available
-  if (pairingCode.length() > 0 && (!triedDeviceId || lastHttpCode == 404)) {
-    triedPairingCode = true;
-    String url = "https://www.ganamos.earth/api/device/config?pairingCode=" + pairingCode;
-    
-    http.end();
-    client->stop();
-    delete client;
-    
-    client = new WiFiClientSecure;
-    if (!client) {
-      return false;
+  if (strlen(pairingCode) > 0 && (!triedDeviceId || httpCode == 404)) {
+    String path = "/api/device/config?pairingCode=" + String(pairingCode);
+    if (!apiBegin(http, path)) {
+      return httpCode;
     }
-    client->setInsecure();
-    client->setTimeout(5000);
-    client->setHandshakeTimeout(5000);
-    
-    delay(100);
-    if (!http.begin(*client, url)) {
-      delete client;
-      return false;
-    }
-    
-    http.setTimeout(5000);
-    http.setFollowRedirects(HTTPC_FORCE_FOLLOW_REDIRECTS);
-    http.setReuse(false);
-    http.addHeader("Connection", "close");
-    
-    lastHttpCode = 0;
-    int httpCode = http.GET();
-    lastHttpCode = httpCode;
     
-    if (httpCode == 200) {
-      goto process_success;
-    } else {
-      http.end();
-      client->stop();
-      delete client;
-      return false;
-    }
+    httpCode = getConfig(http, path, doc);
+    apiEnd(http, httpCode > 0);
   }
   
-  http.end();
-  client->stop();
-  delete client;
-  return false;
+  return httpCode;
+}
 
-process_success:
-  // Process successful response (200 OK)
-  int httpCode = lastHttpCode;
-    String payload = http.getString();
-    
-    StaticJsonDocument<1024> doc;
-    DeserializationError error = deserializeJson(doc, payload);
-    
-    if (error) {
-      http.end();
-      delete client;
-      return false;
-    }
-    
+// UI task side: copy a parsed 200 config response into ganamosConfig
+static bool applyGanamosConfig(JsonDocument &doc) {
     if (!doc["success"]) {
-      http.end();
-      delete client;
       return false;
     }
     
     JsonObject config = doc["config"];
-    ganamosConfig.deviceId = config["deviceId"].as<String>();
-    ganamosConfig.petName = config["petName"].as<String>();
-    ganamosConfig.petType = config["petType"].as<String>();
-    ganamosConfig.userName = config["userName"].as<String>();
+    int previousBalance = ganamosConfig.balance;
+    FixedString<39> previousRejectionId = ganamosConfig.lastRejectionId;
+    ganamosConfig.deviceId = config["deviceId"].as<const char*>();
+    ganamosConfig.petName = config["petName"].as<const char*>();
+    ganamosConfig.petType = config["petType"].as<const char*>();
+    ganamosConfig.petKind = parsePetType(ganamosConfig.petType);
+    ganamosConfig.userName = config["userName"].as<const char*>();
     ganamosConfig.balance = config["balance"];
     ganamosConfig.coins = config["coins"] | 0; // Default to 0 if not present (deprecated)
     ganamosConfig.btcPrice = config["btcPrice"];
     ganamosConfig.pollInterval = config["pollInterval"];
-    ganamosConfig.serverUrl = config["serverUrl"].as<String>();
-    ganamosConfig.lastMessage = config["lastMessage"].as<String>();
-    ganamosConfig.lastMessageType = config["lastMessageType"].as<String>();
-    ganamosConfig.lastPostTitle = config["lastPostTitle"].as<String>();
-    ganamosConfig.lastSenderName = config["lastSenderName"].as<String>();
+    ganamosConfig.serverUrl = config["serverUrl"].as<const char*>();
+    ganamosConfig.lastMessage = config["lastMessage"].as<const char*>();
+    ganamosConfig.lastMessageType = config["lastMessageType"].as<const char*>();
+    ganamosConfig.lastPostTitle = config["lastPostTitle"].as<const char*>();
+    ganamosConfig.lastSenderName = config["lastSenderName"].as<const char*>();
     // Pet care costs (with defaults)
     ganamosConfig.gameCost = config["gameCost"] | 100;
     ganamosConfig.gameReward = config["gameReward"] | 15;
     
     // Parse fix rejection data
-    ganamosConfig.lastRejectionId = config["lastRejectionId"].as<String>();
-    ganamosConfig.rejectionMessage = config["rejectionMessage"].as<String>();
-    ganamosConfig.rejectionPostTitle = config["rejectionPostTitle"].as<String>();
+    ganamosConfig.lastRejectionId = config["lastRejectionId"].as<const char*>();
+    ganamosConfig.rejectionMessage = config["rejectionMessage"].as<const char*>();
+    ganamosConfig.rejectionPostTitle = config["rejectionPostTitle"].as<const char*>();
+
+    // Server feature flags
+    ganamosConfig.batchSyncSupported = config["batchSync"] | false;
+    ganamosConfig.pushSupported = config["pushEvents"] | false;
+    ganamosConfig.metricsSupported = config["metrics"] | false;
 
     // Economy parameters (with defaults)
     if (config.containsKey("hungerDecayPer24h")) {
@@ -341,14 +381,42 @@ process_success:
       }
     }
     
+    lastConfigChanged = ganamosConfig.balance != previousBalance || coinsEarned > 0 || hasNewJob ||
+                        ganamosConfig.lastRejectionId != previousRejectionId;
     consecutiveFailures = 0;
     
-    http.end();
-    client->stop();
-    delete client;
     return true;
 }
 
+bool applyConfigResult(const NetResult &result) {
+  lastConfigChanged = false;
+  lastHttpCode = result.httpCode == NET_NO_WIFI ? 0 : result.httpCode;
+  metricIncrement(METRIC_CONFIG_POLLS);
+  if (result.httpCode == HTTP_CODE_NOT_MODIFIED) {
+    consecutiveFailures = 0;
+    return true;  // Same config as last time - nothing to parse
+  }
+  if (result.httpCode != 200 || !result.doc || !applyGanamosConfig(*result.doc)) {
+    metricIncrement(METRIC_CONFIG_FAILURES);
+    return false;
+  }
+  return true;
+}
+
+bool fetchGanamosConfig() {
+  NetRequest req;
+  NetResult result;
+  netRequestInit(req, NET_REQ_CONFIG_POLL);
+  lastHttpCode = 0;
+  if (!netTransact(req, result)) {
+    return false;
+  }
+  
+  bool success = applyConfigResult(result);
+  netFreeResult(result);
+  return success;
+}
+
 String pairingCode = "";
 
 String generatePairingCode() {
@@ -404,6 +472,7 @@ bool loadDeviceConfig() {
     ganamosConfig.deviceId = storedDeviceId;
     ganamosConfig.petName = preferences.getString("petName", "");
     ganamosConfig.petType = preferences.getString("petType", "");
+    ganamosConfig.petKind = parsePetType(ganamosConfig.petType);
     pairingCode = storedPairingCode;
     // Load last known balance, coins, and BTC price to prevent false celebrations and show $0
     ganamosConfig.balance = storedBalance;
@@ -419,6 +488,80 @@ bool loadDeviceConfig() {
   return false;
 }
 
+// Copy of what loadDeviceConfig() restores (plus the server-tuned numbers),
+// kept in RTC memory so a deep-sleep wake doesn't read flash. Plain arrays,
+// not FixedStrings: a member with a constructor gives the struct one, and
+// static constructors run on every boot - a wake would clear the copy.
+struct RetainedConfig {
+  bool valid;
+  char deviceId[40];
+  char petName[33];
+  char petType[17];
+  char pairingCode[8];
+  int balance;
+  int coins;
+  float btcPrice;
+  int pollInterval;
+  int gameCost;
+  int gameReward;
+  bool batchSyncSupported;
+  bool metricsSupported;
+  EconomyConfig economy;
+};
+RTC_DATA_ATTR static RetainedConfig retainedConfig;
+
+static bool retainString(char *dest, size_t size, const char *value, size_t length) {
+  if (length >= size) {
+    return false;
+  }
+  memcpy(dest, value, length + 1);
+  return true;
+}
+
+void retainDeviceConfig() {
+  RetainedConfig &r = retainedConfig;
+  const GanamosConfig &c = ganamosConfig;
+  r.valid = retainString(r.pairingCode, sizeof(r.pairingCode), pairingCode.c_str(),
+                         pairingCode.length()) &&
+            retainString(r.deviceId, sizeof(r.deviceId), c.deviceId, c.deviceId.length()) &&
+            retainString(r.petName, sizeof(r.petName), c.petName, c.petName.length()) &&
+            retainString(r.petType, sizeof(r.petType), c.petType, c.petType.length());
+  r.balance = ganamosConfig.balance;
+  r.coins = ganamosConfig.coins;
+  r.btcPrice = ganamosConfig.btcPrice;
+  r.pollInterval = ganamosConfig.pollInterval;
+  r.gameCost = ganamosConfig.gameCost;
+  r.gameReward = ganamosConfig.gameReward;
+  r.batchSyncSupported = ganamosConfig.batchSyncSupported;
+  r.metricsSupported = ganamosConfig.metricsSupported;
+  r.economy = economyConfig;
+  if (!r.valid) {
+    Serial.println(F("⚠️ Pairing too long to retain - next wake does a full boot"));
+  }
+}
+
+bool resumeDeviceConfig() {
+  const RetainedConfig &r = retainedConfig;
+  if (!r.valid) {
+    return false;
+  }
+  ganamosConfig.deviceId = r.deviceId;
+  ganamosConfig.petName = r.petName;
+  ganamosConfig.petType = r.petType;
+  ganamosConfig.petKind = parsePetType(ganamosConfig.petType);
+  pairingCode = r.pairingCode;
+  ganamosConfig.balance = r.balance;
+  ganamosConfig.coins = r.coins;
+  ganamosConfig.btcPrice = r.btcPrice;
+  ganamosConfig.pollInterval = r.pollInterval;
+  ganamosConfig.gameCost = r.gameCost;
+  ganamosConfig.gameReward = r.gameReward;
+  ganamosConfig.batchSyncSupported = r.batchSyncSupported;
+  ganamosConfig.metricsSupported = r.metricsSupported;
+  economyConfig = r.economy;
+  return true;
+}
+
 void clearDeviceConfig() {
   preferences.begin("satoshi-pet", false);
   preferences.clear();
@@ -433,86 +576,80 @@ int loadLastKnownBalance() {
 }
 
 void saveLastKnownBalance(int balance) {
+  ProfileScope scope(PROFILE_NVS);
+  HeapScope heapScope(HEAP_SITE_NVS);
   preferences.begin("satoshi-pet", false);
   preferences.putInt("lastBalance", balance);
   preferences.end();
 }
 
 void saveLastKnownCoins(int coins) {
+  ProfileScope scope(PROFILE_NVS);
+  HeapScope heapScope(HEAP_SITE_NVS);
   preferences.begin("satoshi-pet", false);
   preferences.putInt("lastCoins", coins);
   preferences.end();
 }
 
-bool spendCoins(int amount, String action) {
-  if (WiFi.status() != WL_CONNECTED) {
-    return false;
-  }
-  
-  IPAddress serverIP;
-  if (!WiFi.hostByName("www.ganamos.earth", serverIP) || serverIP[0] == 0) {
-    serverIP = IPAddress(66, 33, 60, 35);
-  }
-  
-  WiFiClientSecure *client = new WiFiClientSecure;
-  if (!client) {
-    return false;
-  }
-  
+// Removed spendCoinsAsync() - replaced by offline economy system (spendCoinsLocal)
+
+static const char *const SCORE_FIELDS[] = {
+  "success", "isNewHighScore", "isPersonalBest", "personalBest", "yourRank", "currentScoreRank"
+};
+static const char *const SCORE_ENTRY_FIELDS[] = { "rank", "petName", "score", "isYou" };
+static StaticJsonDocument<JSON_OBJECT_SIZE(8) + JSON_ARRAY_SIZE(1) + JSON_OBJECT_SIZE(4) +
+                          JSON_OBJECT_SIZE(4)> scoreFilter;
+// The server sends its top 10; pet names are up to 20 characters
+#define SCORE_MAX_ENTRIES 10
+#define SCORE_DOC_CAPACITY (JSON_OBJECT_SIZE(8) + JSON_ARRAY_SIZE(SCORE_MAX_ENTRIES) + \
+                            (SCORE_MAX_ENTRIES + 1) * JSON_OBJECT_SIZE(4) + 512)
+
+static const JsonDocument &getScoreFilter() {
+  if (scoreFilter.isNull()) {
+    filterFields(scoreFilter.to<JsonObject>(), SCORE_FIELDS, sizeof(SCORE_FIELDS) / sizeof(SCORE_FIELDS[0]));
+    filterFields(scoreFilter.createNestedArray("leaderboard").createNestedObject(), SCORE_ENTRY_FIELDS, 4);
+    filterFields(scoreFilter.createNestedObject("yourEntry"), SCORE_ENTRY_FIELDS, 3);  // No isYou
+  }
+  return scoreFilter;
+}
+
+// Network task side: POST a score and parse the leaderboard response into doc
+int requestGameScore(const char* deviceId, int score, const FlapLog *flapLog, DynamicJsonDocument *&doc) {
   HTTPClient http;
-  
-  // Configure SSL client
-  client->setInsecure();  // Skip certificate validation
-  client->setTimeout(5000); // 5 second timeout (reduced from 10s)
-  client->setHandshakeTimeout(5000);  // 5 second handshake timeout
-  
-  String url = "https://www.ganamos.earth/api/device/spend-coins?deviceId=" + ganamosConfig.deviceId;
-  
-  lastHttpCode = 0;
-  delay(100);
-  
-  if (!http.begin(*client, url)) {
-    delete client;
-    return false;
+  if (!apiBegin(http, "/api/device/game-score?deviceId=" + String(deviceId))) {
+    return 0;
   }
-  
-  http.setTimeout(5000); // 5 second timeout (reduced from 10s to prevent watchdog)
-  
-  // Create JSON payload
-  StaticJsonDocument<200> doc;
-  doc["amount"] = amount;
-  doc["action"] = action;
-  
-  String payload;
-  serializeJson(doc, payload);
-  
+
   http.addHeader("Content-Type", "application/json");
-  int httpCode = http.POST(payload);
-  
-  if (httpCode == 200) {
-    String payload = http.getString();
-    
-    StaticJsonDocument<200> responseDoc;
-    DeserializationError error = deserializeJson(responseDoc, payload);
-    
-    if (!error && responseDoc["success"]) {
-      ganamosConfig.coins = responseDoc["newCoinBalance"];
-      http.end();
-      client->stop();
-      delete client;
-      return true;
-    }
+
+  StaticJsonDocument<192> payloadDoc;
+  payloadDoc["score"] = score;
+  String flaps;  // Referenced by the document, so it has to live until serialized
+  if (flapLog) {
+    flaps = base64::encode(flapLog->data, flapLog->length);
+    JsonObject proof = payloadDoc.createNestedObject("proof");
+    proof["v"] = FLAP_LOG_VERSION;
+    proof["hz"] = FLAPPY_TICK_HZ;
+    proof["seed"] = flapLog->seed;
+    proof["ticks"] = flapLog->endTick;
+    proof["flaps"] = flaps.c_str();
   }
-  
-  http.end();
-  client->stop();
-  delete client;
-  return false;
-}
+  String payload;
+  serializeJson(payloadDoc, payload);
 
-// Removed spendCoinsAsync() - replaced by offline economy system (spendCoinsLocal)
+  int httpCode = apiPost(http, payload);
 
-bool submitGameScore(int score, GameScoreResponse &response) {
+  if (httpCode != 200) {
+    apiEnd(http, httpCode > 0);
+    return httpCode;
+  }
+
+  doc = apiParse(http, SCORE_DOC_CAPACITY, getScoreFilter());
+  apiEnd(http, true);
+  return httpCode;
+}
+
+bool submitGameScore(int score, const FlapLog &flapLog, GameScoreResponse &response) {
   response.success = false;
   response.isNewHighScore = false;
   response.isPersonalBest = false;
@@ -538,61 +675,23 @@ bool submitGameScore(int score, GameScoreResponse &response) {
     return false;
   }
 
-  IPAddress serverIP;
-  if (!WiFi.hostByName("www.ganamos.earth", serverIP) || serverIP[0] == 0) {
-    serverIP = IPAddress(66, 33, 60, 35);
-  }
-
-  WiFiClientSecure *client = new WiFiClientSecure;
-  if (!client) {
+  NetRequest req;
+  NetResult result;
+  netRequestInit(req, NET_REQ_SUBMIT_SCORE);
+  req.score = score;
+  req.flapLog = flapLog.overflow ? nullptr : &flapLog;
+  if (!netTransact(req, result)) {
+    metricIncrement(METRIC_SCORE_FAILURES);
     return false;
   }
-  client->setInsecure();
-  client->setTimeout(5000);
-  client->setHandshakeTimeout(5000);
 
-  HTTPClient http;
-  String url = "https://www.ganamos.earth/api/device/game-score?deviceId=" + ganamosConfig.deviceId;
-
-  if (!http.begin(*client, url)) {
-    delete client;
-    return false;
-  }
-
-  http.addHeader("Content-Type", "application/json");
-
-  StaticJsonDocument<128> payloadDoc;
-  payloadDoc["score"] = score;
-  String payload;
-  serializeJson(payloadDoc, payload);
-
-  int httpCode = http.POST(payload);
-
-  if (httpCode != 200) {
-    http.end();
-    client->stop();
-    delete client;
-    return false;
-  }
-
-  String body = http.getString();
-
-  // Safety checks
-  if (body.length() > 3000 || !body.startsWith("{")) {
-    http.end();
-    client->stop();
-    delete client;
-    return false;
-  }
-
-  DynamicJsonDocument doc(2048);
-  DeserializationError error = deserializeJson(doc, body);
-  if (error) {
-    http.end();
-    client->stop();
-    delete client;
+  // The filter keeps the document bounded, so there's no body size cap
+  if (!result.doc || !result.doc->is<JsonObject>()) {
+    metricIncrement(METRIC_SCORE_FAILURES);
+    netFreeResult(result);
     return false;
   }
+  JsonDocument &doc = *result.doc;
 
   response.success = doc["success"] | false;
   response.isNewHighScore = doc["isNewHighScore"] | false;
@@ -614,10 +713,10 @@ bool submitGameScore(int score, GameScoreResponse &response) {
       LeaderboardEntry &slot = response.leaderboard[idx];
       slot.rank = entry["rank"] | (idx + 1);
       
-      // Safety: Limit pet name length to prevent buffer issues
+      // Long names are cut to the slot (20 bytes, whole characters)
       const char* name = entry["petName"].as<const char*>();
       if (name && strlen(name) > 0) {
-        slot.petName = String(name).substring(0, 20); // Max 20 chars
+        slot.petName = name;
       } else {
         slot.petName = "Pet";
       }
@@ -634,62 +733,43 @@ bool submitGameScore(int score, GameScoreResponse &response) {
     if (!personal.isNull()) {
       response.hasPersonalEntry = true;
       response.personalEntry.rank = personal["rank"] | response.yourRank;
-      response.personalEntry.petName = personal["petName"].as<const char*>() ? personal["petName"].as<const char*>() : ganamosConfig.petName;
+      response.personalEntry.petName = personal["petName"].as<const char*>() ? personal["petName"].as<const char*>() : ganamosConfig.petName.c_str();
       response.personalEntry.score = personal["score"] | response.personalBest;
       response.personalEntry.isYou = true;
     }
   }
 
-  http.end();
-  client->stop();
-  delete client;
+  netFreeResult(result);
+  metricIncrement(response.success ? METRIC_SCORES_SUBMITTED : METRIC_SCORE_FAILURES);
   return response.success;
 }
 
+bool getLastConfigChanged() {
+  return lastConfigChanged;
+}
+
 int getLastHttpCode() {
   return lastHttpCode;
 }
 
 // Mark a job as complete - sends request to server which emails the poster
-bool markJobComplete(String jobId) {
+// (network task side; success is set from the response body)
+int requestJobComplete(const char* deviceId, const char* jobId, bool &success) {
+  success = false;
+  
   // Check WiFi status first
   if (WiFi.status() != WL_CONNECTED) {
     Serial.println("markJobComplete: WiFi not connected");
-    return false;
-  }
-  
-  if (ganamosConfig.deviceId.length() == 0) {
-    Serial.println("markJobComplete: No deviceId");
-    return false;
-  }
-  
-  if (jobId.length() == 0) {
-    Serial.println("markJobComplete: No jobId");
-    return false;
-  }
-  
-  WiFiClientSecure *client = new WiFiClientSecure;
-  if (!client) {
-    return false;
+    return NET_NO_WIFI;
   }
   
   HTTPClient http;
   
-  client->setInsecure();
-  client->setTimeout(5000);
-  client->setHandshakeTimeout(5000);
-  
-  String url = "https://www.ganamos.earth/api/device/job-complete?deviceId=" + ganamosConfig.deviceId;
-  
-  delay(100);
-  if (!http.begin(*client, url)) {
-    delete client;
-    return false;
+  if (!apiBegin(http, "/api/device/job-complete?deviceId=" + String(deviceId))) {
+    return 0;
   }
   
-  http.setTimeout(5000);
   http.addHeader("Content-Type", "application/json");
-  http.addHeader("Connection", "close");
   
   // Build JSON payload
   StaticJsonDocument<128> doc;
@@ -698,20 +778,16 @@ bool markJobComplete(String jobId) {
   String payload;
   serializeJson(doc, payload);
   
-  Serial.println("📋 Marking job complete: " + jobId);
+  Serial.println("📋 Marking job complete: " + String(jobId));
   
-  int httpCode = http.POST(payload);
-  
-  bool success = false;
+  int httpCode = apiPost(http, payload);
   
   if (httpCode == 200) {
-    String response = http.getString();
-    
-    StaticJsonDocument<256> responseDoc;
-    DeserializationError error = deserializeJson(responseDoc, response);
+    DynamicJsonDocument *responseDoc = apiParse(http, API_ACK_CAPACITY, apiAckFilter());
+    success = responseDoc && (*responseDoc)["success"];
+    delete responseDoc;
     
-    if (!error && responseDoc["success"]) {
-      success = true;
+    if (success) {
       Serial.println("✅ Job marked complete - notification sent to poster");
     } else {
       Serial.println("❌ Server returned error for job completion");
@@ -720,9 +796,30 @@ bool markJobComplete(String jobId) {
     Serial.println("❌ Job complete request failed (HTTP " + String(httpCode) + ")");
   }
   
-  http.end();
-  client->stop();
-  delete client;
+  apiEnd(http, httpCode > 0);
   
-  return success;
-}
\ No newline at end of file
+  return httpCode;
+}
+
+bool markJobComplete(String jobId) {
+  if (ganamosConfig.deviceId.length() == 0) {
+    Serial.println("markJobComplete: No deviceId");
+    return false;
+  }
+  
+  if (jobId.length() == 0) {
+    Serial.println("markJobComplete: No jobId");
+    return false;
+  }
+  
+  NetRequest req;
+  NetResult result;
+  netRequestInit(req, NET_REQ_JOB_COMPLETE);
+  strncpy(req.jobId, jobId.c_str(), sizeof(req.jobId) - 1);
+  if (!netTransact(req, result)) {
+    return false;
+  }
+  
+  netFreeResult(result);
+  return result.ok;
+}
@@ -4,6 +4,8 @@
 
 
 #include <ArduinoJson.h>
+#include "fixed_string.h"
+#include "game_replay.h"
 
 struct DeviceConfig {
   String pet;
@@ -22,37 +24,79 @@ bool saveDeviceConfig();
 bool loadDeviceConfig();
 bool markJobComplete(String jobId);
 void clearDeviceConfig();
+
+// Deep sleep: copy the loaded config into RTC memory before powering down,
+// and restore it on wake. resume returns false if nothing valid was kept.
+void retainDeviceConfig();
+bool resumeDeviceConfig();
 int fetchBTCPrice();
 int fetchSatoshiBalance(String lnurl);
 
+// Pet species, parsed once from the petType string when config is loaded
+// (indexes the sprite table in pet_sprites_simple.h)
+enum PetType : uint8_t {
+  PET_CAT,
+  PET_DOG,
+  PET_SQUIRREL,
+  PET_TURTLE,
+  PET_BUNNY,     // "rabbit" or "bunny"
+  PET_OWL,
+  PET_TYPE_COUNT
+};
+
+// Unknown types fall back to the cat
+PetType parsePetType(const char *petType);
+
+// Text fields are fixed-size and truncated on assignment (fixed_string.h)
 struct GanamosConfig {
-  String deviceId;
-  String petName;
-  String petType;
-  String userName;
+  FixedString<39> deviceId;  // UUID
+  FixedString<32> petName;
+  FixedString<16> petType;
+  FixedString<32> userName;
   int balance;
   int coins;           // Pet coins for pet care (separate from balance)
   float btcPrice;
   int pollInterval;
-  String serverUrl;
-  String lastMessage;  // Message from last transaction
-  String lastMessageType;    // "fix" for fix rewards, "transfer" for internal transfers
-  String lastPostTitle;      // Post title for fix rewards
-  String lastSenderName;     // Sender name for internal transfers
+  FixedString<64> serverUrl;
+  FixedString<96> lastMessage;        // Message from last transaction
+  FixedString<16> lastMessageType;    // "fix" for fix rewards, "transfer" for internal transfers
+  FixedString<64> lastPostTitle;      // Post title for fix rewards
+  FixedString<32> lastSenderName;     // Sender name for internal transfers
   // Pet care costs (loaded from server but food uses FoodOption costs, heal unused)
   int gameCost;        // Coins per game attempt (default: 100)
   int gameReward;      // Happiness increase per successful game (default: 15)
-  String lastRejectionId;    // ID of last rejected fix (to detect new rejections)
-  String rejectionMessage;   // Message to show on rejection
-  String rejectionPostTitle; // Post title for rejected fix
+  FixedString<39> lastRejectionId;    // ID of last rejected fix (to detect new rejections)
+  FixedString<96> rejectionMessage;   // Message to show on rejection
+  FixedString<64> rejectionPostTitle; // Post title for rejected fix
+  bool batchSyncSupported;   // Server accepts /economy/sync-batch (all pending spends in one POST)
+  bool pushSupported;        // Server offers the /api/device/events push stream
+  bool metricsSupported;     // Server collects telemetry batches (metrics.h)
+  PetType petKind;           // petType as an enum - use this for per-frame lookups
 };
 
 extern GanamosConfig ganamosConfig;
 bool fetchGanamosConfig(); // Returns false on 404 (device not found)
+
+// Apply a NET_REQ_CONFIG_POLL result from the network task (UI task only)
+struct NetResult;
+bool applyConfigResult(const NetResult &result);
 int getLastHttpCode(); // Get last HTTP response code (0 = connection error, 200 = success, 404 = not found, etc)
+bool getLastConfigChanged(); // Last applied poll changed the balance, coins, jobs or rejection
+
+// Config polls since boot. Polls send the last ETag as If-None-Match; a 304
+// (or a 200 with the same body and no coin or job events, when the server
+// sends no ETag) is applied as success with nothing changed, and
+// getLastHttpCode() returns 304.
+struct ConfigPollStats {
+  uint32_t full;         // 200 responses
+  uint32_t notModified;  // 304 responses
+  uint32_t unchanged;    // 200s whose body matched the last one (no ETag, no events)
+  uint32_t bytes;        // Config body bytes received
+};
+ConfigPollStats getConfigPollStats();
 
 struct LeaderboardEntry {
-  String petName;
+  FixedString<20> petName;
   int score;
   bool isYou;
   int rank;
@@ -71,16 +115,14 @@ struct GameScoreResponse {
   LeaderboardEntry personalEntry;
 };
 
-bool submitGameScore(int score, GameScoreResponse &response);
+// flapLog goes along as proof of the score unless it overflowed
+bool submitGameScore(int score, const FlapLog &flapLog, GameScoreResponse &response);
 
 // Balance and coins persistence to prevent false celebrations on restart
 int loadLastKnownBalance();
 void saveLastKnownBalance(int balance);
 void saveLastKnownCoins(int coins);
 
-// Pet care functions
-bool spendCoins(int amount, String action); // Spend coins for feed/heal/game actions
-
 // Economy config parameters
 struct EconomyConfig {
   // Decay rates (points per 24 hours)
@@ -94,12 +136,12 @@ extern EconomyConfig economyConfig;
 #define MAX_JOBS 10
 
 struct Job {
-  String id;
-  String title;       // Full title for detail view
-  int reward;         // Reward in sats
-  String location;    // Location string
-  String createdAt;   // ISO date string
-  String groupName;   // Group name for context
+  FixedString<39> id;
+  FixedString<96> title;      // Full title for detail view
+  int reward;                 // Reward in sats
+  FixedString<48> location;   // Location string
+  FixedString<31> createdAt;  // ISO date string
+  FixedString<32> groupName;  // Group name for context
 };
 
 extern Job cachedJobs[MAX_JOBS];
@@ -109,6 +151,15 @@ extern String lastSeenJobId;  // Track newest job for notifications
 // Fetch jobs from server - returns true if successful
 bool fetchJobs();
 
+// Network task side of the requests above. These only do HTTP and hand back
+// the response parsed into a filtered document (nullptr unless 200 and valid
+// JSON, caller deletes); call them from net_task.cpp, never from the UI task.
+int requestGanamosConfig(const char* deviceId, const char* pairingCode, DynamicJsonDocument *&doc);
+void forgetConfigValidator();  // Next config poll is a full GET (result was lost)
+int requestJobs(const char* deviceId, DynamicJsonDocument *&doc);
+int requestGameScore(const char* deviceId, int score, const FlapLog *flapLog, DynamicJsonDocument *&doc);
+int requestJobComplete(const char* deviceId, const char* jobId, bool &success);
+
 // Format sats with k/M suffix (e.g., 1500 -> "1.5k", 2000000 -> "2M")
 String formatSatsShort(int sats);
 
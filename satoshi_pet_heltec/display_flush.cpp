@@ -0,0 +1,156 @@
+#include "display_flush.h"
+#include "profiler.h"
+#include <Wire.h>
+
+// SSD1306 commands used for windowed writes
+#define SSD1306_COLUMNADDR 0x21
+#define SSD1306_PAGEADDR   0x22
+
+// I2C control bytes: 0x00 = command stream, 0x40 = data stream
+#define I2C_CONTROL_COMMAND 0x00
+#define I2C_CONTROL_DATA    0x40
+
+// ESP32 Wire buffers 128 bytes per transmission; 16 data bytes per chunk matches
+// what the display library itself uses and keeps each transaction short
+#define I2C_DATA_CHUNK 16
+
+static uint16_t lastFlushBytes = 0;
+static uint8_t lastFlushPages = 0;
+static uint32_t totalFlushBytes = 0;
+static uint32_t totalFlushCount = 0;
+
+// Press-to-pixel latency (0 = no input waiting for a frame)
+static uint32_t pendingInputUs = 0;
+static uint32_t latencyLastUs = 0;
+static uint32_t latencyMaxUs = 0;
+static uint64_t latencyTotalUs = 0;
+static uint32_t latencyCount = 0;
+
+DirtyTrackingDisplay::DirtyTrackingDisplay(uint8_t address, uint32_t freq, int sda, int scl,
+                                           DISPLAY_GEOMETRY g, int8_t rst)
+  : SSD1306Wire(address, freq, sda, scl, g, rst), _address(address), shadowValid(false) {
+}
+
+bool DirtyTrackingDisplay::init() {
+  invalidate();
+  return SSD1306Wire::init();
+}
+
+void DirtyTrackingDisplay::invalidate() {
+  shadowValid = false;
+}
+
+void DirtyTrackingDisplay::sendCommands(const uint8_t* cmds, uint8_t count) {
+  Wire.beginTransmission(_address);
+  Wire.write(I2C_CONTROL_COMMAND);
+  for (uint8_t i = 0; i < count; i++) {
+    Wire.write(cmds[i]);
+  }
+  Wire.endTransmission();
+  lastFlushBytes += count + 1;
+}
+
+void DirtyTrackingDisplay::sendData(const uint8_t* data, uint16_t count) {
+  uint16_t sent = 0;
+  while (sent < count) {
+    uint16_t chunk = min((uint16_t)I2C_DATA_CHUNK, (uint16_t)(count - sent));
+    Wire.beginTransmission(_address);
+    Wire.write(I2C_CONTROL_DATA);
+    Wire.write(data + sent, chunk);
+    Wire.endTransmission();
+    lastFlushBytes += chunk + 1;
+    sent += chunk;
+  }
+}
+
+void DirtyTrackingDisplay::display() {
+  ProfileScope scope(PROFILE_FLUSH);
+  const uint16_t panelWidth = min((uint16_t)OLED_MAX_WIDTH, width());
+  const uint8_t pages = min((uint16_t)OLED_MAX_PAGES, (uint16_t)(height() / 8));
+  const uint8_t xOffset = (128 - panelWidth) / 2;
+
+  lastFlushBytes = 0;
+  lastFlushPages = 0;
+
+  for (uint8_t page = 0; page < pages; page++) {
+    const uint8_t* row = buffer + (page * panelWidth);
+    uint8_t* shadowRow = shadow + (page * panelWidth);
+
+    // Find the changed column span in this page
+    int16_t minX = -1;
+    int16_t maxX = -1;
+    if (!shadowValid) {
+      minX = 0;
+      maxX = panelWidth - 1;
+    } else {
+      for (uint16_t x = 0; x < panelWidth; x++) {
+        if (row[x] != shadowRow[x]) {
+          if (minX < 0) minX = x;
+          maxX = x;
+        }
+      }
+    }
+
+    if (minX < 0) {
+      continue; // Page unchanged
+    }
+
+    const uint8_t window[] = {
+      SSD1306_COLUMNADDR, (uint8_t)(xOffset + minX), (uint8_t)(xOffset + maxX),
+      SSD1306_PAGEADDR, page, page
+    };
+    sendCommands(window, sizeof(window));
+    sendData(row + minX, maxX - minX + 1);
+
+    memcpy(shadowRow + minX, row + minX, maxX - minX + 1);
+    lastFlushPages++;
+  }
+
+  shadowValid = true;
+  totalFlushBytes += lastFlushBytes;
+  totalFlushCount++;
+
+  // First frame with visible changes after a button edge
+  if (pendingInputUs != 0 && lastFlushPages > 0) {
+    latencyLastUs = micros() - pendingInputUs;
+    latencyMaxUs = max(latencyMaxUs, latencyLastUs);
+    latencyTotalUs += latencyLastUs;
+    latencyCount++;
+    pendingInputUs = 0;
+  }
+}
+
+uint16_t getLastFlushBytes() {
+  return lastFlushBytes;
+}
+
+uint8_t getLastFlushPages() {
+  return lastFlushPages;
+}
+
+uint32_t getTotalFlushBytes() {
+  return totalFlushBytes;
+}
+
+uint32_t getTotalFlushCount() {
+  return totalFlushCount;
+}
+
+void markInputForLatency(uint32_t eventUs) {
+  // Keep the oldest unanswered edge - that is what the user is waiting on
+  if (pendingInputUs == 0) {
+    pendingInputUs = eventUs ? eventUs : 1;
+  }
+}
+
+uint32_t getInputLatencyLastUs() {
+  return latencyLastUs;
+}
+
+uint32_t getInputLatencyMaxUs() {
+  return latencyMaxUs;
+}
+
+uint32_t getInputLatencyAvgUs() {
+  return latencyCount > 0 ? (uint32_t)(latencyTotalUs / latencyCount) : 0;
+}
@@ -0,0 +1,61 @@
+#ifndef DISPLAY_FLUSH_H
+#define DISPLAY_FLUSH_H
+
+#include <Arduino.h>
+#include "HT_SSD1306Wire.h"
+
+// SSD1306 panel geometry (128x64 = 8 pages of 8 pixel rows, 1 byte per column per page)
+#define OLED_MAX_WIDTH 128
+#define OLED_MAX_PAGES 8
+
+// Drop-in replacement for SSD1306Wire that only sends changed bytes over I2C.
+//
+// The stock display() pushes the whole 1 KB framebuffer on every call. This
+// version keeps a shadow copy of what the panel currently shows, finds the
+// changed column span in each 8-pixel page, and sends just those bytes using
+// the SSD1306 column/page address commands. Every screen benefits without
+// changes to the render code because display() is virtual.
+class DirtyTrackingDisplay : public SSD1306Wire {
+public:
+  DirtyTrackingDisplay(uint8_t address, uint32_t freq, int sda, int scl,
+                       DISPLAY_GEOMETRY g = GEOMETRY_128_64, int8_t rst = -1);
+
+  // Re-initialize the panel. Panel RAM is lost on a Vext power cycle, so the
+  // next flush resends everything.
+  bool init();
+
+  // Flush only the dirty regions of the framebuffer
+  void display() override;
+
+  // Force the next display() to resend the full framebuffer
+  void invalidate();
+
+private:
+  void sendCommands(const uint8_t* cmds, uint8_t count);
+  void sendData(const uint8_t* data, uint16_t count);
+
+  uint8_t _address;
+  uint8_t shadow[OLED_MAX_WIDTH * OLED_MAX_PAGES];
+  bool shadowValid;
+};
+
+// Bytes written to the I2C bus by the most recent display() (commands + pixel data)
+uint16_t getLastFlushBytes();
+
+// Number of pages touched by the most recent display() (0 = nothing changed)
+uint8_t getLastFlushPages();
+
+// Running totals since boot (for comparing against full-frame flushes)
+uint32_t getTotalFlushBytes();
+uint32_t getTotalFlushCount();
+
+// Press-to-pixel latency: record an input edge (micros() timestamp from the
+// button interrupt); the next flush that changes pixels closes the measurement
+void markInputForLatency(uint32_t eventUs);
+
+// Latency stats in microseconds since boot
+uint32_t getInputLatencyLastUs();
+uint32_t getInputLatencyMaxUs();
+uint32_t getInputLatencyAvgUs();
+
+#endif
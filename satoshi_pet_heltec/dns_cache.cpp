@@ -0,0 +1,102 @@
+#include "dns_cache.h"
+#include "api_client.h"
+#include "power_manager.h"
+#include <Preferences.h>
+#include <WiFi.h>
+#include <freertos/FreeRTOS.h>
+
+// Read by the network and push tasks, written by the network task. In RTC
+// memory so a deep-sleep wake still has the entry and its age.
+static portMUX_TYPE cacheMux = portMUX_INITIALIZER_UNLOCKED;
+RTC_DATA_ATTR static uint32_t cachedIp = 0;   // 0 = nothing cached
+RTC_DATA_ATTR static bool fresh = false;      // Resolved within the TTL
+RTC_DATA_ATTR static unsigned long resolvedAt = 0;
+
+// Network task only
+static unsigned long lastAttempt = 0;
+static bool attempted = false;
+
+void dnsCacheBegin() {
+  Preferences prefs;
+  prefs.begin("dns-cache", true);
+  uint32_t ip = prefs.getUInt("ip", 0);
+  prefs.end();
+
+  portENTER_CRITICAL(&cacheMux);
+  cachedIp = ip;
+  fresh = false;
+  portEXIT_CRITICAL(&cacheMux);
+  attempted = false;  // Resolve on the first idle pass
+
+  if (ip != 0) {
+    Serial.println("🌐 DNS: " GANAMOS_API_HOST " -> " + IPAddress(ip).toString() + " (saved)");
+  }
+}
+
+void dnsCacheResume() {
+  portENTER_CRITICAL(&cacheMux);
+  resolvedAt = powerRebaseMs(resolvedAt);
+  portEXIT_CRITICAL(&cacheMux);
+  attempted = false;
+}
+
+bool dnsCacheLookup(IPAddress &ip) {
+  portENTER_CRITICAL(&cacheMux);
+  uint32_t cached = cachedIp;
+  portEXIT_CRITICAL(&cacheMux);
+  if (cached == 0) {
+    return false;
+  }
+  ip = IPAddress(cached);
+  return true;
+}
+
+void dnsCacheInvalidate() {
+  portENTER_CRITICAL(&cacheMux);
+  bool had = cachedIp != 0;
+  cachedIp = 0;
+  fresh = false;
+  portEXIT_CRITICAL(&cacheMux);
+  attempted = false;  // Resolve on the next idle pass, not after the retry delay
+  if (had) {
+    Serial.println(F("🌐 DNS: cached address not answering - dropped"));
+  }
+}
+
+void dnsCacheMaintain() {
+  unsigned long now = millis();
+  portENTER_CRITICAL(&cacheMux);
+  bool stale = !fresh || now - resolvedAt > DNS_CACHE_TTL_MS;
+  uint32_t previous = cachedIp;
+  portEXIT_CRITICAL(&cacheMux);
+
+  if (!stale || WiFi.status() != WL_CONNECTED) {
+    return;
+  }
+  if (attempted && now - lastAttempt < DNS_CACHE_RETRY_MS) {
+    return;
+  }
+  attempted = true;
+  lastAttempt = now;
+
+  IPAddress resolved;
+  if (!WiFi.hostByName(GANAMOS_API_HOST, resolved) || (uint32_t)resolved == 0) {
+    Serial.println(F("🌐 DNS: lookup failed - keeping the cached address"));
+    return;
+  }
+
+  portENTER_CRITICAL(&cacheMux);
+  cachedIp = (uint32_t)resolved;
+  fresh = true;
+  resolvedAt = millis();
+  portEXIT_CRITICAL(&cacheMux);
+
+  // Flash only sees a write when the address actually moves
+  if ((uint32_t)resolved != previous) {
+    Preferences prefs;
+    prefs.begin("dns-cache", false);
+    prefs.putUInt("ip", (uint32_t)resolved);
+    prefs.end();
+    Serial.println("🌐 DNS: " GANAMOS_API_HOST " -> " + resolved.toString());
+  }
+}
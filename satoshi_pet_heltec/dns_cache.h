@@ -0,0 +1,36 @@
+#ifndef DNS_CACHE_H
+#define DNS_CACHE_H
+
+#include <Arduino.h>
+#include <IPAddress.h>
+
+// Cached address of the API host (GANAMOS_API_HOST).
+//
+// Connections are opened to the cached address rather than resolving the
+// hostname for every request (TLS still sends the hostname for SNI). Once
+// the entry is older than DNS_CACHE_TTL_MS it keeps being served while the
+// network task resolves again between requests (stale-while-revalidate).
+// The last good address is kept in NVS, so a reboot starts with it - as
+// stale, since its age isn't known. The entry itself lives in RTC memory,
+// so a deep-sleep wake keeps it, age included, without touching NVS.
+
+#define DNS_CACHE_TTL_MS 3600000UL     // Re-resolve hourly
+#define DNS_CACHE_RETRY_MS 60000UL     // After a failed lookup
+
+// Load the persisted address (cold boot)
+void dnsCacheBegin();
+
+// After a deep-sleep wake (powerResume() true) - the entry is still in RTC
+// memory, so this only rebases its age
+void dnsCacheResume();
+
+// Address to connect to. False if nothing is cached - connect by name then.
+bool dnsCacheLookup(IPAddress &ip);
+
+// The cached address didn't answer - resolve again before the next request
+void dnsCacheInvalidate();
+
+// Network task, between requests: resolve if the entry is stale or missing
+void dnsCacheMaintain();
+
+#endif
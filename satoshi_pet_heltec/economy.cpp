@@ -1,30 +1,118 @@
 #include "economy.h"
+#include "economy_journal.h"
 #include "config.h"
+#include "api_client.h"
+#include "profiler.h"
+#include "heap_monitor.h"
 #include <Preferences.h>
 #include <HTTPClient.h>
 #include <WiFi.h>
-#include <WiFiClientSecure.h>
 #include <ArduinoJson.h>
 #include <esp_task_wdt.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 
 static Preferences economyPrefs;
-static PendingSpend pendingSpends[MAX_PENDING_SPENDS];
-static int pendingSpendCount = 0;
-static int localCoinBalance = 0;
 
-// Generate a simple UUID (not cryptographically secure, but unique enough for our use)
-static void generateUUID(char* uuidStr) {
-  sprintf(uuidStr, "%08lx-%04x-%04x-%04x-%012lx",
-    (unsigned long)random(0xFFFFFFFF),
-    (unsigned int)random(0xFFFF),
-    (unsigned int)(0x4000 | random(0x0FFF)), // Version 4
-    (unsigned int)(0x8000 | random(0x3FFF)), // Variant
-    (unsigned long)random(0xFFFFFFFF) | ((unsigned long)random(0xFFFF) << 32)
-  );
+// In RTC memory so a deep-sleep wake can skip replaying the journal (see
+// resumeEconomy). Every other boot re-initializes them and reloads from NVS.
+RTC_DATA_ATTR static PendingSpend pendingSpends[MAX_PENDING_SPENDS];
+RTC_DATA_ATTR static int pendingSpendCount = 0;
+RTC_DATA_ATTR static int localCoinBalance = 0;
+
+// NVS writes the old rewrite-everything scheme would have issued for the same
+// changes (localCoins + spendCount + every spend_N key), for comparison
+static uint32_t legacyWriteEquivalent = 0;
+
+// Spends are queued on the UI task and synced on the network task. The lock
+// covers the queue, the balance and NVS writes, but never an HTTP request.
+static SemaphoreHandle_t economyMutex = NULL;
+
+static void lockEconomy() {
+  if (economyMutex) {
+    xSemaphoreTake(economyMutex, portMAX_DELAY);
+  }
 }
 
-void initEconomy() {
-  // Load pending spends from NVS
+static void unlockEconomy() {
+  if (economyMutex) {
+    xSemaphoreGive(economyMutex);
+  }
+}
+
+// Generate a random UUID v4 (not cryptographically secure, but unique enough for our use)
+static void generateUUID(uint8_t* id) {
+  for (int i = 0; i < SPEND_ID_SIZE; i++) {
+    id[i] = (uint8_t)random(256);
+  }
+  id[6] = (id[6] & 0x0F) | 0x40; // Version 4
+  id[8] = (id[8] & 0x3F) | 0x80; // Variant
+}
+
+void formatSpendId(const uint8_t* id, char* out) {
+  static const char hex[] = "0123456789abcdef";
+  for (int i = 0; i < SPEND_ID_SIZE; i++) {
+    if (i == 4 || i == 6 || i == 8 || i == 10) {
+      *out++ = '-';
+    }
+    *out++ = hex[id[i] >> 4];
+    *out++ = hex[id[i] & 0x0F];
+  }
+  *out = '\0';
+}
+
+static int hexValue(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+bool parseSpendId(const char* str, uint8_t* id) {
+  if (!str) {
+    return false;
+  }
+  for (int i = 0; i < SPEND_ID_SIZE; i++) {
+    if ((i == 4 || i == 6 || i == 8 || i == 10) && *str++ != '-') {
+      return false;
+    }
+    int hi = hexValue(*str);
+    if (hi < 0) {
+      return false;
+    }
+    int lo = hexValue(*++str);
+    if (lo < 0) {
+      return false;
+    }
+    str++;
+    id[i] = (uint8_t)((hi << 4) | lo);
+  }
+  return *str == '\0';
+}
+
+static const char* const SPEND_ACTION_NAMES[] = {
+  "unknown", "game", "feed", "food_lettuce", "food_eggs", "food_steak"
+};
+
+const char* spendActionName(SpendAction action) {
+  if (action >= sizeof(SPEND_ACTION_NAMES) / sizeof(SPEND_ACTION_NAMES[0])) {
+    return SPEND_ACTION_NAMES[SPEND_ACTION_UNKNOWN];
+  }
+  return SPEND_ACTION_NAMES[action];
+}
+
+// Only needed to migrate the old string records
+static SpendAction spendActionFromName(const char* name) {
+  for (uint8_t i = 0; i < sizeof(SPEND_ACTION_NAMES) / sizeof(SPEND_ACTION_NAMES[0]); i++) {
+    if (strcmp(name, SPEND_ACTION_NAMES[i]) == 0) {
+      return (SpendAction)i;
+    }
+  }
+  return SPEND_ACTION_UNKNOWN;
+}
+
+// Load the queue from the pipe-delimited spend_N keys used before the journal
+static void loadLegacySpends() {
   economyPrefs.begin("economy", true); // read-only
   
   pendingSpendCount = economyPrefs.getInt("spendCount", 0);
@@ -34,7 +122,9 @@ void initEconomy() {
   
   Serial.println("💰 Economy: Loading " + String(pendingSpendCount) + " pending spends");
   
-  for (int i = 0; i < pendingSpendCount; i++) {
+  int legacyCount = pendingSpendCount;
+  pendingSpendCount = 0;
+  for (int i = 0; i < legacyCount; i++) {
     String key = "spend_" + String(i);
     String data = economyPrefs.getString(key.c_str(), "");
     
@@ -46,75 +136,110 @@ void initEconomy() {
       int pipe4 = data.indexOf('|', pipe3 + 1);
       
       if (pipe1 > 0 && pipe2 > 0 && pipe3 > 0 && pipe4 > 0) {
-        String id = data.substring(0, pipe1);
-        unsigned long timestamp = data.substring(pipe1 + 1, pipe2).toInt();
-        int amount = data.substring(pipe2 + 1, pipe3).toInt();
-        String action = data.substring(pipe3 + 1, pipe4);
-        bool synced = data.substring(pipe4 + 1).toInt();
-        
-        strncpy(pendingSpends[i].id, id.c_str(), 36);
-        pendingSpends[i].id[36] = '\0';
-        pendingSpends[i].timestamp = timestamp;
-        pendingSpends[i].amount = amount;
-        strncpy(pendingSpends[i].action, action.c_str(), 31);
-        pendingSpends[i].action[31] = '\0';
-        pendingSpends[i].synced = synced;
+        PendingSpend& spend = pendingSpends[pendingSpendCount];
+        if (!parseSpendId(data.substring(0, pipe1).c_str(), spend.id)) {
+          generateUUID(spend.id);
+        }
+        spend.timestamp = data.substring(pipe1 + 1, pipe2).toInt();
+        spend.amount = data.substring(pipe2 + 1, pipe3).toInt();
+        spend.action = spendActionFromName(data.substring(pipe3 + 1, pipe4).c_str());
+        spend.synced = data.substring(pipe4 + 1).toInt();
+        pendingSpendCount++;
         
-        Serial.println("  Loaded: " + String(pendingSpends[i].action) + " (" + String(amount) + " coins)");
+        Serial.println("  Loaded: " + String(spendActionName(spend.action)) + " (" + String(spend.amount) + " coins)");
       }
     }
   }
   
   localCoinBalance = economyPrefs.getInt("localCoins", 0);
-  Serial.println("💰 Economy: Local balance = " + String(localCoinBalance) + " coins");
   
   economyPrefs.end();
 }
 
-static void savePendingSpends() {
-  Serial.println("💰 [REBOOT DEBUG] savePendingSpends() START - count=" + String(pendingSpendCount));
+// Drop the old keys once the journal snapshot holds the queue
+static void removeLegacySpends() {
+  economyPrefs.begin("economy", true); // read-only
+  int count = min(economyPrefs.getInt("spendCount", 0), MAX_PENDING_SPENDS);
+  economyPrefs.end();
   
+
   economyPrefs.begin("economy", false); // read-write
-  
-  // Safety: Validate pendingSpendCount before saving
-  if (pendingSpendCount < 0 || pendingSpendCount > MAX_PENDING_SPENDS) {
-    Serial.println("⚠️ [SAFETY] Invalid pendingSpendCount: " + String(pendingSpendCount) + " - clamping to safe range");
-    pendingSpendCount = min(max(0, pendingSpendCount), MAX_PENDING_SPENDS);
+  for (int i = 0; i < count; i++) {
+    String key = "spend_" + String(i);
+    economyPrefs.remove(key.c_str());
+  }
+  economyPrefs.remove("spendCount");
+  economyPrefs.remove("localCoins");
+  economyPrefs.end();
+}
+
+// The pre-journal keys, if this device still has them
+static bool hasLegacySpends() {
+  bool found = economyPrefs.begin("economy", true) &&  // read-only
+               (economyPrefs.isKey("spendCount") || economyPrefs.isKey("localCoins"));
+  economyPrefs.end();
+  return found;
+}
+
+void initEconomy() {
+  if (!economyMutex) {
+    economyMutex = xSemaphoreCreateMutex();
   }
   
-  // CRITICAL: Save localCoins FIRST before pending spends!
-  // If device loses power mid-save, the balance will still be correct.
-  // Pending spends can be re-created, but losing coin balance is worse.
-  Serial.println("💰 [REBOOT DEBUG] Saving localCoins=" + String(localCoinBalance));
-  economyPrefs.putInt("localCoins", localCoinBalance);
-  
-  Serial.println("💰 [REBOOT DEBUG] Saving count=" + String(pendingSpendCount));
-  economyPrefs.putInt("spendCount", pendingSpendCount);
+  JournalLoadResult loaded = journalLoad(pendingSpends, pendingSpendCount, localCoinBalance);
+  if (loaded == JOURNAL_EMPTY) {
+    // First boot with the journal - migrate the old keys (if any) into a snapshot
+    bool legacy = hasLegacySpends();
+    if (legacy) {
+      loadLegacySpends();
+    }
+    if (journalCompact(pendingSpends, pendingSpendCount, localCoinBalance) && legacy) {
+      removeLegacySpends();
+      Serial.println("💰 Economy: Migrated " + String(pendingSpendCount) + " spends to the journal");
+    }
+  } else if (loaded == JOURNAL_UNREADABLE) {
+    // Run from an empty queue; the server resends the balance on the next poll
+    Serial.println(F("⚠️ Economy: Spend journal unreadable - not saving spends this boot"));
+  }
   
-  for (int i = 0; i < pendingSpendCount && i < MAX_PENDING_SPENDS; i++) {
-    // Safety: Ensure strings are null-terminated before using them
-    pendingSpends[i].id[36] = '\0';     // Force null termination
-    pendingSpends[i].action[31] = '\0'; // Force null termination
-    
-    String data = String(pendingSpends[i].id) + "|" +
-                  String(pendingSpends[i].timestamp) + "|" +
-                  String(pendingSpends[i].amount) + "|" +
-                  String(pendingSpends[i].action) + "|" +
-                  String(pendingSpends[i].synced ? 1 : 0);
-    
-    String key = "spend_" + String(i);
-    economyPrefs.putString(key.c_str(), data);
+  Serial.println("💰 Economy: Local balance = " + String(localCoinBalance) + " coins");
+}
+
+void resumeEconomy() {
+  if (!economyMutex) {
+    economyMutex = xSemaphoreCreateMutex();
   }
   
-  economyPrefs.end();
+  // Queue, balance and journal position were kept in RTC memory
+  Serial.print(F("💰 Economy: Resumed ("));
+  Serial.print(localCoinBalance);
+  Serial.print(F(" coins, "));
+  Serial.print(pendingSpendCount);
+  Serial.println(F(" queued spends)"));
+}
+
+// Journal one change, compacting once the record slots run out or a record
+// can't be written. Caller holds the lock.
+static void journalChange(JournalRecordType type, const PendingSpend* spend) {
+  legacyWriteEquivalent += 2 + pendingSpendCount;
   
-  Serial.println("💰 [REBOOT DEBUG] savePendingSpends() COMPLETE");
+  // A record that didn't make it to flash is covered by a fresh snapshot
+  if (!journalAppend(type, spend, localCoinBalance) || journalNeedsCompaction()) {
+    journalCompact(pendingSpends, pendingSpendCount, localCoinBalance);
+  }
 }
 
-bool spendCoinsLocal(int amount, const char* action) {
+bool spendCoinsLocal(int amount, SpendAction action) {
+  lockEconomy();
+  
   // Check if we have enough coins
   if (localCoinBalance < amount) {
-    Serial.println("❌ Economy: Insufficient coins (" + String(localCoinBalance) + " < " + String(amount) + ")");
+    Serial.print(F("❌ Economy: Insufficient coins ("));
+    Serial.print(localCoinBalance);
+    Serial.print(F(" < "));
+    Serial.print(amount);
+    Serial.println(F(")"));
+    unlockEconomy();
     return false;
   }
   
@@ -127,23 +252,30 @@ bool spendCoinsLocal(int amount, const char* action) {
     generateUUID(spend.id);
     spend.timestamp = millis();
     spend.amount = amount;
-    strncpy(spend.action, action, 31);
-    spend.action[31] = '\0';
+    spend.action = action;
     spend.synced = false;
     
     pendingSpendCount++;
     
-    Serial.println("💰 Economy: Spent " + String(amount) + " coins on " + String(action) + 
-                   " (balance: " + String(localCoinBalance) + ", pending: " + String(pendingSpendCount) + ")");
+    Serial.print(F("💰 Economy: Spent "));
+    Serial.print(amount);
+    Serial.print(F(" coins on "));
+    Serial.print(spendActionName(action));
+    Serial.print(F(" (balance: "));
+    Serial.print(localCoinBalance);
+    Serial.print(F(", pending: "));
+    Serial.print(pendingSpendCount);
+    Serial.println(F(")"));
     
-    // Save to NVS
-    savePendingSpends();
+    journalChange(JOURNAL_SPEND_APPENDED, &spend);
     
+    unlockEconomy();
     return true;
   } else {
     Serial.println("⚠️ Economy: Pending queue full, dropping spend");
     // Still deduct coins (already happened above) but warn
-    savePendingSpends();
+    journalChange(JOURNAL_BALANCE_SET, nullptr);
+    unlockEconomy();
     return true;
   }
 }
@@ -153,107 +285,118 @@ int getLocalCoins() {
 }
 
 void setLocalCoins(int coins) {
-  localCoinBalance = coins;
-  savePendingSpends();
+  lockEconomy();
+  if (coins != localCoinBalance) {
+    localCoinBalance = coins;
+    journalChange(JOURNAL_BALANCE_SET, nullptr);
+  }
+  unlockEconomy();
 }
 
-int syncPendingSpends() {
-  if (pendingSpendCount == 0) {
-    return 0;
-  }
-  
-  extern GanamosConfig ganamosConfig;
-  
-  // Check WiFi
-  if (WiFi.status() != WL_CONNECTED) {
-    Serial.println("⚠️ Economy: Cannot sync - no WiFi");
-    return 0;
+// Server advertised batch support but the endpoint was missing - stay on
+// per-item sync until reboot instead of failing a batch every poll
+static bool batchEndpointMissing = false;
+
+// Mark malformed entries as synced so they drop out of the queue
+static bool isValidSpend(int i) {
+  static const uint8_t nilId[SPEND_ID_SIZE] = { 0 };
+  if (pendingSpends[i].amount <= 0 || memcmp(pendingSpends[i].id, nilId, SPEND_ID_SIZE) == 0) {
+    Serial.println("⚠️ Economy: Skipping invalid spend at index " + String(i) + 
+                  " (amount=" + String(pendingSpends[i].amount) + ")");
+    pendingSpends[i].synced = true; // Mark as synced to remove it
+    journalChange(JOURNAL_SPEND_ACKED, &pendingSpends[i]);
+    return false;
   }
-  
-  if (ganamosConfig.deviceId.length() == 0) {
-    Serial.println("⚠️ Economy: Cannot sync - no device ID");
-    return 0;
+  return true;
+}
+
+// Mark the entry with this id as synced (the queue may have grown since the
+// request was built, so match by id). Caller holds the lock.
+static bool markSpendSynced(const uint8_t* spendId) {
+  for (int i = 0; i < pendingSpendCount; i++) {
+    if (!pendingSpends[i].synced && memcmp(pendingSpends[i].id, spendId, SPEND_ID_SIZE) == 0) {
+      pendingSpends[i].synced = true;
+      journalChange(JOURNAL_SPEND_ACKED, &pendingSpends[i]);
+      return true;
+    }
   }
-  
+  return false;
+}
+
+// POST each spend separately (legacy endpoint)
+static int syncSpendsIndividually(const char* deviceId) {
   int syncedCount = 0;
   
-  // Create client ONCE and reuse (reduces heap fragmentation)
-  WiFiClientSecure* client = new WiFiClientSecure;
-  if (!client) {
-    Serial.println("❌ Economy: Failed to create HTTP client");
-    return 0;
-  }
-  
-  client->setInsecure();
-  client->setTimeout(5000);
-  client->setHandshakeTimeout(5000);
-  
-  for (int i = 0; i < pendingSpendCount; i++) {
+  // All spends go over the shared keep-alive session (one TLS handshake for the batch)
+  for (int i = 0; ; i++) {
     // Feed watchdog at start of each sync attempt
     esp_task_wdt_reset();
     
-    if (pendingSpends[i].synced) {
-      continue; // Already synced
+    // Copy the entry out so the HTTP request runs without holding the lock
+    lockEconomy();
+    if (i >= pendingSpendCount) {
+      unlockEconomy();
+      break;
     }
+    bool skip = pendingSpends[i].synced || !isValidSpend(i);
+    PendingSpend spend = pendingSpends[i];
+    unlockEconomy();
     
-    // Validate spend data before syncing
-    if (pendingSpends[i].amount <= 0 || strlen(pendingSpends[i].id) < 10) {
-      Serial.println("⚠️ Economy: Skipping invalid spend at index " + String(i) + 
-                    " (amount=" + String(pendingSpends[i].amount) + ", id=" + String(pendingSpends[i].id) + ")");
-      pendingSpends[i].synced = true; // Mark as synced to remove it
-      continue;
+    if (skip) {
+      continue; // Already synced or invalid
     }
     
+    char spendId[SPEND_ID_STR_SIZE];
+    formatSpendId(spend.id, spendId);
+    
     HTTPClient http;
-    String url = "https://www.ganamos.earth/api/device/economy/sync?deviceId=" + ganamosConfig.deviceId;
     
-    if (!http.begin(*client, url)) {
+    if (!apiBegin(http, "/api/device/economy/sync?deviceId=" + String(deviceId))) {
       Serial.println("❌ Economy: http.begin() failed for spend " + String(i));
       continue;
     }
     
-    http.setTimeout(5000);
     http.addHeader("Content-Type", "application/json");
-    http.addHeader("Connection", "close");
     
     // Build JSON payload
     StaticJsonDocument<256> doc;
-    doc["spendId"] = pendingSpends[i].id;
-    doc["timestamp"] = pendingSpends[i].timestamp;
-    doc["amount"] = pendingSpends[i].amount;
-    doc["action"] = pendingSpends[i].action;
+    doc["spendId"] = spendId;
+    doc["timestamp"] = spend.timestamp;
+    doc["amount"] = spend.amount;
+    doc["action"] = spendActionName(spend.action);
     
     String payload;
     serializeJson(doc, payload);
     
     Serial.println("💰 Syncing spend: " + payload);
     
-    int httpCode = http.POST(payload);
+    int httpCode = apiPost(http, payload);
     
     if (httpCode == 200) {
-      String response = http.getString();
+      DynamicJsonDocument *responseDoc = apiParse(http, API_ACK_CAPACITY, apiAckFilter());
       
-      StaticJsonDocument<512> responseDoc;
-      DeserializationError error = deserializeJson(responseDoc, response);
-      
-      if (!error && responseDoc["success"]) {
-        pendingSpends[i].synced = true;
-        syncedCount++;
+      if (responseDoc && (*responseDoc)["success"]) {
+        lockEconomy();
+        if (markSpendSynced(spend.id)) {
+          syncedCount++;
+        }
+        unlockEconomy();
         
         // Update local balance from server response
-        if (responseDoc.containsKey("newCoinBalance")) {
-          int serverBalance = responseDoc["newCoinBalance"];
-          Serial.println("✅ Economy: Synced spend " + String(pendingSpends[i].id) + 
+        if (responseDoc->containsKey("newCoinBalance")) {
+          int serverBalance = (*responseDoc)["newCoinBalance"];
+          Serial.println("✅ Economy: Synced spend " + String(spendId) + 
                         ", server balance: " + String(serverBalance));
         }
       } else {
-        Serial.println("❌ Economy: Server rejected spend " + String(pendingSpends[i].id));
+        Serial.println("❌ Economy: Server rejected spend " + String(spendId));
       }
+      delete responseDoc;
     } else {
       Serial.println("❌ Economy: Sync failed (HTTP " + String(httpCode) + ")");
     }
     
-    http.end();
+    apiEnd(http, httpCode > 0);
     
     // Small delay between requests to prevent overwhelming
     delay(50);
@@ -262,26 +405,176 @@ int syncPendingSpends() {
     esp_task_wdt_reset();
   }
   
-  // Clean up client ONCE at the end
-  client->stop();
-  delete client;
-  client = nullptr;
+  return syncedCount;
+}
+
+// Network task only: the batch response fields we read, built on first use
+static StaticJsonDocument<JSON_OBJECT_SIZE(3) + JSON_ARRAY_SIZE(1) + JSON_OBJECT_SIZE(2)> batchAckFilter;
+
+static const JsonDocument &getBatchAckFilter() {
+  if (batchAckFilter.isNull()) {
+    batchAckFilter["success"] = true;
+    batchAckFilter["newCoinBalance"] = true;
+    JsonObject result = batchAckFilter.createNestedArray("results").createNestedObject();
+    result["spendId"] = true;
+    result["success"] = true;
+  }
+  return batchAckFilter;
+}
+
+// POST the whole unsynced queue as one array and apply the per-item acks.
+// Request:  {"spends":[{"spendId","timestamp","amount","action"}, ...]}
+// Response: {"success":true,"results":[{"spendId":"...","success":true}, ...],"newCoinBalance":N}
+// Returns number synced, or -1 if the server doesn't have the batch endpoint.
+static int syncSpendsBatch(const char* deviceId) {
+  lockEconomy();
+  
+  int batchCount = 0;
+  for (int i = 0; i < pendingSpendCount; i++) {
+    if (!pendingSpends[i].synced && isValidSpend(i)) {
+      batchCount++;
+    }
+  }
+  if (batchCount == 0) {
+    unlockEconomy();
+    return 0;
+  }
+  
+  // Build JSON payload. Ids are formatted into a stack buffer, so ArduinoJson
+  // copies them (non-const char*); action names are static and referenced.
+  String payload;
+  {
+    DynamicJsonDocument doc(JSON_OBJECT_SIZE(1) + JSON_ARRAY_SIZE(batchCount) +
+                            batchCount * (JSON_OBJECT_SIZE(4) + JSON_STRING_SIZE(SPEND_ID_STR_SIZE - 1)));
+    char spendId[SPEND_ID_STR_SIZE];
+    JsonArray spends = doc.createNestedArray("spends");
+    for (int i = 0; i < pendingSpendCount; i++) {
+      if (pendingSpends[i].synced) {
+        continue;
+      }
+      JsonObject item = spends.createNestedObject();
+      formatSpendId(pendingSpends[i].id, spendId);
+      item["spendId"] = spendId;
+      item["timestamp"] = pendingSpends[i].timestamp;
+      item["amount"] = pendingSpends[i].amount;
+      item["action"] = spendActionName(pendingSpends[i].action);
+    }
+    serializeJson(doc, payload);
+  }
+  unlockEconomy();
+  
+  HTTPClient http;
+  if (!apiBegin(http, "/api/device/economy/sync-batch?deviceId=" + String(deviceId))) {
+    Serial.println("❌ Economy: http.begin() failed for batch sync");
+    return 0;
+  }
+  http.addHeader("Content-Type", "application/json");
+  
+  Serial.println("💰 Syncing " + String(batchCount) + " spends in one batch (" + String(payload.length()) + " bytes)");
+  
+  esp_task_wdt_reset();
+  int httpCode = apiPost(http, payload);
+  esp_task_wdt_reset();
+  
+  if (httpCode == 404 || httpCode == 405) {
+    Serial.println("⚠️ Economy: Batch endpoint not available (HTTP " + String(httpCode) + ") - using per-item sync");
+    apiEnd(http, true);
+    return -1;
+  }
+  
+  if (httpCode != 200) {
+    Serial.println("❌ Economy: Batch sync failed (HTTP " + String(httpCode) + ")");
+    apiEnd(http, httpCode > 0);
+    return 0;
+  }
+  
+  // Filtered to the acks, so fields the server adds don't count against the
+  // capacity (the key names are stored once, hence the slack)
+  DynamicJsonDocument *responseDoc = apiParse(http, JSON_OBJECT_SIZE(3) + JSON_ARRAY_SIZE(batchCount) +
+                                              batchCount * (JSON_OBJECT_SIZE(2) + JSON_STRING_SIZE(SPEND_ID_STR_SIZE - 1)) + 64,
+                                              getBatchAckFilter());
+  apiEnd(http, true);
+  if (!responseDoc || !(*responseDoc)["success"]) {
+    Serial.println("❌ Economy: Server rejected batch");
+    delete responseDoc;
+    return 0;
+  }
+  
+  // Apply acknowledgements by spendId - anything not acked stays queued
+  int syncedCount = 0;
+  JsonArray results = (*responseDoc)["results"].as<JsonArray>();
+  lockEconomy();
+  for (JsonVariant result : results) {
+    const char* spendId = result["spendId"] | "";
+    bool accepted = result["success"] | false;
+    if (!accepted) {
+      Serial.println("❌ Economy: Server rejected spend " + String(spendId));
+      continue;
+    }
+    uint8_t id[SPEND_ID_SIZE];
+    if (parseSpendId(spendId, id) && markSpendSynced(id)) {
+      syncedCount++;
+    }
+  }
+  unlockEconomy();
+  
+  if (responseDoc->containsKey("newCoinBalance")) {
+    int serverBalance = (*responseDoc)["newCoinBalance"];
+    Serial.println("✅ Economy: Batch acked " + String(syncedCount) + "/" + String(batchCount) +
+                  ", server balance: " + String(serverBalance));
+  }
+  delete responseDoc;
+  
+  return syncedCount;
+}
+
+int syncPendingSpends(const char* deviceId, bool batchSupported) {
+  if (pendingSpendCount == 0) {
+    return 0;
+  }
+  
+  // Check WiFi
+  if (WiFi.status() != WL_CONNECTED) {
+    Serial.println("⚠️ Economy: Cannot sync - no WiFi");
+    return 0;
+  }
+  
+  if (strlen(deviceId) == 0) {
+    Serial.println("⚠️ Economy: Cannot sync - no device ID");
+    return 0;
+  }
+  
+  int syncedCount = -1;
+  
+  // Use the batch endpoint only when the server advertises it in the config response
+  if (batchSupported && !batchEndpointMissing) {
+    syncedCount = syncSpendsBatch(deviceId);
+    if (syncedCount < 0) {
+      batchEndpointMissing = true;
+    }
+  }
+  
+  if (syncedCount < 0) {
+    syncedCount = syncSpendsIndividually(deviceId);
+  }
   
   if (syncedCount > 0) {
+    // Each ack was journaled as it arrived
     Serial.println("✅ Economy: Synced " + String(syncedCount) + " spends");
-    savePendingSpends();
   }
   
   return syncedCount;
 }
 
 int getPendingSpendCount() {
+  lockEconomy();
   int unsynced = 0;
   for (int i = 0; i < pendingSpendCount; i++) {
     if (!pendingSpends[i].synced) {
       unsynced++;
     }
   }
+  unlockEconomy();
   return unsynced;
 }
 
@@ -289,6 +582,7 @@ void clearSyncedSpends() {
   // Feed watchdog before potentially slow operation
   esp_task_wdt_reset();
   
+  lockEconomy();
   Serial.println("💰 clearSyncedSpends() START - count=" + String(pendingSpendCount));
   
   // Safety: Validate pendingSpendCount before clearing
@@ -302,9 +596,6 @@ void clearSyncedSpends() {
   for (int readIdx = 0; readIdx < pendingSpendCount && readIdx < MAX_PENDING_SPENDS; readIdx++) {
     if (!pendingSpends[readIdx].synced) {
       if (writeIdx != readIdx) {
-        // Safety: Ensure null termination before copying
-        pendingSpends[readIdx].id[36] = '\0';
-        pendingSpends[readIdx].action[31] = '\0';
         pendingSpends[writeIdx] = pendingSpends[readIdx];
       }
       writeIdx++;
@@ -320,64 +611,84 @@ void clearSyncedSpends() {
     // Feed watchdog before NVS write
     esp_task_wdt_reset();
     
-    savePendingSpends();
+    // The acks are already journaled; a fresh snapshot drops the synced
+    // entries and frees the record slots
+    legacyWriteEquivalent += 2 + pendingSpendCount;
+    journalCompact(pendingSpends, pendingSpendCount, localCoinBalance);
   }
   
+  unlockEconomy();
   Serial.println("💰 clearSyncedSpends() COMPLETE");
 }
 
 void clearEconomyData() {
+  lockEconomy();
   economyPrefs.begin("economy", false);
   economyPrefs.clear();
   economyPrefs.end();
   
   pendingSpendCount = 0;
   localCoinBalance = 0;
+  journalUnlock();  // An unreadable snapshot was just erased with the rest
+  journalCompact(pendingSpends, 0, 0);  // Empty snapshot, so the next boot doesn't migrate
+  unlockEconomy();
   
   Serial.println("🗑️ Economy: All data cleared");
 }
 
+uint32_t getEconomyNvsWrites() {
+  return getJournalWriteCount();
+}
+
+uint32_t getEconomyLegacyNvsWrites() {
+  return legacyWriteEquivalent;
+}
+
 // === Game Score Queueing Implementation ===
 
 static PendingGameScore pendingScores[MAX_PENDING_SCORES];
 static int pendingScoreCount = 0;
 static Preferences scorePrefs;
 
+// Whole queue in one blob: version:u8 count:u8 reserved:u16, then per score
+// id[16] timestamp:u32 score:i32 synced:u8 (little-endian, no padding)
+#define SCORES_KEY "pending"
+#define SCORES_VERSION 1
+#define SCORES_HEADER_SIZE 4
+#define SCORE_RECORD_SIZE 25
+
 static void savePendingScores() {
-  scorePrefs.begin("scores", false); // read-write
-  
   if (pendingScoreCount < 0 || pendingScoreCount > MAX_PENDING_SCORES) {
     pendingScoreCount = min(max(0, pendingScoreCount), MAX_PENDING_SCORES);
   }
   
-  scorePrefs.putInt("scoreCount", pendingScoreCount);
-  
-  for (int i = 0; i < pendingScoreCount && i < MAX_PENDING_SCORES; i++) {
-    pendingScores[i].id[36] = '\0';
-    
-    String data = String(pendingScores[i].id) + "|" +
-                  String(pendingScores[i].timestamp) + "|" +
-                  String(pendingScores[i].score) + "|" +
-                  String(pendingScores[i].synced ? 1 : 0);
-    
-    String key = "score_" + String(i);
-    scorePrefs.putString(key.c_str(), data);
+  uint8_t buf[SCORES_HEADER_SIZE + MAX_PENDING_SCORES * SCORE_RECORD_SIZE];
+  uint8_t* p = buf;
+  *p++ = SCORES_VERSION;
+  *p++ = (uint8_t)pendingScoreCount;
+  *p++ = 0;
+  *p++ = 0;
+  for (int i = 0; i < pendingScoreCount; i++) {
+    memcpy(p, pendingScores[i].id, SPEND_ID_SIZE);
+    memcpy(p + 16, &pendingScores[i].timestamp, 4);  // ESP32 is little-endian
+    memcpy(p + 20, &pendingScores[i].score, 4);
+    p[24] = pendingScores[i].synced ? 1 : 0;
+    p += SCORE_RECORD_SIZE;
   }
   
+  ProfileScope scope(PROFILE_NVS);
+  HeapScope heapScope(HEAP_SITE_NVS);
+  scorePrefs.begin("scores", false); // read-write
+  scorePrefs.putBytes(SCORES_KEY, buf, p - buf);
   scorePrefs.end();
 }
 
-static void loadPendingScores() {
-  scorePrefs.begin("scores", true); // read-only
+// Read the pipe-delimited score_N keys used before the binary blob
+static void loadLegacyScores() {
+  int legacyCount = min(scorePrefs.getInt("scoreCount", 0), MAX_PENDING_SCORES);
   
-  pendingScoreCount = scorePrefs.getInt("scoreCount", 0);
-  if (pendingScoreCount > MAX_PENDING_SCORES) {
-    pendingScoreCount = MAX_PENDING_SCORES;
-  }
-  
-  Serial.println("🎮 Scores: Loading " + String(pendingScoreCount) + " pending scores");
-  
-  for (int i = 0; i < pendingScoreCount; i++) {
+  pendingScoreCount = 0;
+  for (int i = 0; i < legacyCount; i++) {
     String key = "score_" + String(i);
     String data = scorePrefs.getString(key.c_str(), "");
     
@@ -387,25 +698,69 @@ static void loadPendingScores() {
       int pipe3 = data.indexOf('|', pipe2 + 1);
       
       if (pipe1 > 0 && pipe2 > 0 && pipe3 > 0) {
-        String id = data.substring(0, pipe1);
-        unsigned long timestamp = data.substring(pipe1 + 1, pipe2).toInt();
-        int score = data.substring(pipe2 + 1, pipe3).toInt();
-        bool synced = data.substring(pipe3 + 1).toInt();
-        
-        strncpy(pendingScores[i].id, id.c_str(), 36);
-        pendingScores[i].id[36] = '\0';
-        pendingScores[i].timestamp = timestamp;
-        pendingScores[i].score = score;
-        pendingScores[i].synced = synced;
-        
-        if (!synced) {
-          Serial.println("  Pending score: " + String(score));
+        PendingGameScore& entry = pendingScores[pendingScoreCount++];
+        if (!parseSpendId(data.substring(0, pipe1).c_str(), entry.id)) {
+          generateUUID(entry.id);
         }
+        entry.timestamp = data.substring(pipe1 + 1, pipe2).toInt();
+        entry.score = data.substring(pipe2 + 1, pipe3).toInt();
+        entry.synced = data.substring(pipe3 + 1).toInt();
       }
     }
   }
+}
+
+static void removeLegacyScores() {
+  scorePrefs.begin("scores", false); // read-write
+  int legacyCount = min(scorePrefs.getInt("scoreCount", 0), MAX_PENDING_SCORES);
+  for (int i = 0; i < legacyCount; i++) {
+    String key = "score_" + String(i);
+    scorePrefs.remove(key.c_str());
+  }
+  scorePrefs.remove("scoreCount");
+  scorePrefs.end();
+}
+
+static void loadPendingScores() {
+  uint8_t buf[SCORES_HEADER_SIZE + MAX_PENDING_SCORES * SCORE_RECORD_SIZE];
   
+  scorePrefs.begin("scores", true); // read-only
+  size_t len = scorePrefs.getBytesLength(SCORES_KEY);
+  bool haveBlob = len >= SCORES_HEADER_SIZE && len <= sizeof(buf) &&
+                  scorePrefs.getBytes(SCORES_KEY, buf, len) == len;
+  bool migrate = !haveBlob && scorePrefs.isKey("scoreCount");
+  if (migrate) {
+    loadLegacyScores();
+  }
   scorePrefs.end();
+  
+  if (migrate) {
+    savePendingScores();
+    removeLegacyScores();
+    Serial.print(F("🎮 Scores: Migrated "));
+    Serial.print(pendingScoreCount);
+    Serial.println(F(" scores to the binary format"));
+  } else if (haveBlob) {
+    int count = buf[1];
+    if (buf[0] != SCORES_VERSION || count > MAX_PENDING_SCORES ||
+        len != SCORES_HEADER_SIZE + (size_t)count * SCORE_RECORD_SIZE) {
+      Serial.println(F("⚠️ Scores: Unreadable score queue - starting empty"));
+      count = 0;
+    }
+    const uint8_t* p = buf + SCORES_HEADER_SIZE;
+    for (int i = 0; i < count; i++) {
+      memcpy(pendingScores[i].id, p, SPEND_ID_SIZE);
+      memcpy(&pendingScores[i].timestamp, p + 16, 4);
+      memcpy(&pendingScores[i].score, p + 20, 4);
+      pendingScores[i].synced = p[24] != 0;
+      p += SCORE_RECORD_SIZE;
+    }
+    pendingScoreCount = count;
+  }
+  
+  Serial.print(F("🎮 Scores: Loaded "));
+  Serial.print(pendingScoreCount);
+  Serial.println(F(" pending scores"));
 }
 
 bool queueGameScoreLocal(int score) {
@@ -425,14 +780,7 @@ bool queueGameScoreLocal(int score) {
   if (pendingScoreCount < MAX_PENDING_SCORES) {
     PendingGameScore& entry = pendingScores[pendingScoreCount];
     
-    // Generate UUID
-    sprintf(entry.id, "%08lx-%04x-%04x-%04x-%012lx",
-      (unsigned long)random(0xFFFFFFFF),
-      (unsigned int)random(0xFFFF),
-      (unsigned int)(0x4000 | random(0x0FFF)),
-      (unsigned int)(0x8000 | random(0x3FFF)),
-      (unsigned long)random(0xFFFFFFFF) | ((unsigned long)random(0xFFFF) << 32)
-    );
+    generateUUID(entry.id);
     
     entry.timestamp = millis();
     entry.score = score;
@@ -452,13 +800,7 @@ bool queueGameScoreLocal(int score) {
     }
     
     PendingGameScore& entry = pendingScores[pendingScoreCount - 1];
-    sprintf(entry.id, "%08lx-%04x-%04x-%04x-%012lx",
-      (unsigned long)random(0xFFFFFFFF),
-      (unsigned int)random(0xFFFF),
-      (unsigned int)(0x4000 | random(0x0FFF)),
-      (unsigned int)(0x8000 | random(0x3FFF)),
-      (unsigned long)random(0xFFFFFFFF) | ((unsigned long)random(0xFFFF) << 32)
-    );
+    generateUUID(entry.id);
     entry.timestamp = millis();
     entry.score = score;
     entry.synced = false;
@@ -468,106 +810,6 @@ bool queueGameScoreLocal(int score) {
   }
 }
 
-int syncPendingGameScores() {
-  // Load scores on first call
-  static bool scoresLoaded = false;
-  if (!scoresLoaded) {
-    loadPendingScores();
-    scoresLoaded = true;
-  }
-  
-  if (pendingScoreCount == 0) {
-    return 0;
-  }
-  
-  extern GanamosConfig ganamosConfig;
-  
-  if (WiFi.status() != WL_CONNECTED) {
-    Serial.println("⚠️ Scores: Cannot sync - no WiFi");
-    return 0;
-  }
-  
-  if (ganamosConfig.deviceId.length() == 0) {
-    Serial.println("⚠️ Scores: Cannot sync - no device ID");
-    return 0;
-  }
-  
-  int syncedCount = 0;
-  
-  for (int i = 0; i < pendingScoreCount; i++) {
-    if (pendingScores[i].synced) {
-      continue;
-    }
-    
-    if (pendingScores[i].score < 0) {
-      pendingScores[i].synced = true;
-      continue;
-    }
-    
-    WiFiClientSecure* client = new WiFiClientSecure;
-    if (!client) {
-      Serial.println("❌ Scores: Failed to create HTTP client");
-      break;
-    }
-    
-    client->setInsecure();
-    client->setTimeout(5000);
-    client->setHandshakeTimeout(5000);
-    
-    HTTPClient http;
-    String url = "https://www.ganamos.earth/api/device/game-score?deviceId=" + ganamosConfig.deviceId;
-    
-    if (!http.begin(*client, url)) {
-      delete client;
-      Serial.println("❌ Scores: http.begin() failed");
-      continue;
-    }
-    
-    http.setTimeout(5000);
-    http.addHeader("Content-Type", "application/json");
-    
-    StaticJsonDocument<128> doc;
-    doc["score"] = pendingScores[i].score;
-    
-    String payload;
-    serializeJson(doc, payload);
-    
-    Serial.println("🎮 Syncing score: " + String(pendingScores[i].score));
-    
-    int httpCode = http.POST(payload);
-    
-    if (httpCode == 200) {
-      String response = http.getString();
-      
-      StaticJsonDocument<512> responseDoc;
-      DeserializationError error = deserializeJson(responseDoc, response);
-      
-      if (!error && responseDoc["success"]) {
-        pendingScores[i].synced = true;
-        syncedCount++;
-        Serial.println("✅ Scores: Synced score " + String(pendingScores[i].score));
-      } else {
-        Serial.println("❌ Scores: Server rejected score");
-      }
-    } else {
-      Serial.println("❌ Scores: Sync failed (HTTP " + String(httpCode) + ")");
-    }
-    
-    http.end();
-    client->stop();
-    delete client;
-    
-    delay(100);
-  }
-  
-  if (syncedCount > 0) {
-    Serial.println("✅ Scores: Synced " + String(syncedCount) + " scores");
-    savePendingScores();
-  }
-  
-  return syncedCount;
-}
-
 int getPendingGameScoreCount() {
   int unsynced = 0;
   for (int i = 0; i < pendingScoreCount; i++) {
@@ -578,24 +820,3 @@ int getPendingGameScoreCount() {
   return unsynced;
 }
 
-void clearSyncedGameScores() {
-  int writeIdx = 0;
-  for (int readIdx = 0; readIdx < pendingScoreCount && readIdx < MAX_PENDING_SCORES; readIdx++) {
-    if (!pendingScores[readIdx].synced) {
-      if (writeIdx != readIdx) {
-        pendingScores[readIdx].id[36] = '\0';
-        pendingScores[writeIdx] = pendingScores[readIdx];
-      }
-      writeIdx++;
-    }
-  }
-  
-  int removed = pendingScoreCount - writeIdx;
-  pendingScoreCount = writeIdx;
-  
-  if (removed > 0) {
-    Serial.println("🎮 Scores: Cleared " + String(removed) + " synced scores");
-    savePendingScores();
-  }
-}
-
@@ -7,27 +7,47 @@
 #define MAX_PENDING_SPENDS 50
 #define MAX_PENDING_SCORES 10
 
+#define SPEND_ID_SIZE 16       // Binary UUID
+#define SPEND_ID_STR_SIZE 37   // Formatted UUID (36 chars + null terminator)
+
+// What the coins were spent on. Stored as one byte; the server gets the name.
+enum SpendAction : uint8_t {
+  SPEND_ACTION_UNKNOWN = 0,
+  SPEND_ACTION_GAME = 1,
+  SPEND_ACTION_FEED = 2,
+  SPEND_ACTION_FOOD_LETTUCE = 3,
+  SPEND_ACTION_FOOD_EGGS = 4,
+  SPEND_ACTION_FOOD_STEAK = 5
+};
+
+// In NVS these are stored as fixed little-endian layouts (see
+// economy_journal.cpp and the scores blob in economy.cpp), not as the
+// in-memory struct, so adding a field means bumping the stored version.
 struct PendingSpend {
-  char id[37];           // UUID string (36 chars + null terminator)
-  unsigned long timestamp; // millis() when spend occurred
-  int amount;            // coins spent
-  char action[32];       // "game", "food_lettuce", "food_eggs", "food_steak"
+  uint8_t id[SPEND_ID_SIZE]; // UUID v4
+  uint32_t timestamp;    // millis() when spend occurred
+  int32_t amount;        // coins spent
+  SpendAction action;
   bool synced;           // true if successfully synced to backend
 };
 
 struct PendingGameScore {
-  char id[37];           // UUID string (36 chars + null terminator)
-  unsigned long timestamp; // millis() when game ended
-  int score;             // game score
+  uint8_t id[SPEND_ID_SIZE]; // UUID v4
+  uint32_t timestamp;    // millis() when game ended
+  int32_t score;         // game score
   bool synced;           // true if successfully synced to backend
 };
 
 // Initialize economy system (load pending spends from NVS)
 void initEconomy();
 
+// After a deep-sleep wake (powerResume() true) - the queue is still in RTC
+// memory, so this only sets up the lock
+void resumeEconomy();
+
 // Spend coins locally (immediate deduction, queued for sync)
 // Returns true if spend succeeded (had enough coins)
-bool spendCoinsLocal(int amount, const char* action);
+bool spendCoinsLocal(int amount, SpendAction action);
 
 // Get current local coin balance
 int getLocalCoins();
@@ -35,9 +55,9 @@ int getLocalCoins();
 // Set local coin balance (called after server sync)
 void setLocalCoins(int coins);
 
-// Sync pending spends to backend (call when WiFi available)
+// Sync pending spends to backend (network task only - see net_task.h)
 // Returns number of spends successfully synced
-int syncPendingSpends();
+int syncPendingSpends(const char* deviceId, bool batchSupported);
 
 // Get count of pending (unsynced) spends
 int getPendingSpendCount();
@@ -48,21 +68,28 @@ void clearSyncedSpends();
 // Clear all economy data (use for debugging/reset)
 void clearEconomyData();
 
+// NVS writes issued by the spend journal since boot, and what the old
+// rewrite-the-whole-queue scheme would have issued for the same changes
+uint32_t getEconomyNvsWrites();
+uint32_t getEconomyLegacyNvsWrites();
+
+// Name sent to the server for an action ("game", "feed", ...)
+const char* spendActionName(SpendAction action);
+
+// Format a binary UUID as 8-4-4-4-12 hex (out must hold SPEND_ID_STR_SIZE)
+void formatSpendId(const uint8_t* id, char* out);
+
+// Parse a formatted UUID. Returns false if it isn't one.
+bool parseSpendId(const char* str, uint8_t* id);
+
 // === Game Score Queueing (offline-first) ===
 
 // Queue a game score locally (for sync when online)
 // Returns true if queued successfully
 bool queueGameScoreLocal(int score);
 
-// Sync pending game scores to backend (call when WiFi available)
-// Returns number of scores successfully synced
-int syncPendingGameScores();
-
 // Get count of pending (unsynced) game scores
 int getPendingGameScoreCount();
 
-// Clear all synced game scores from queue
-void clearSyncedGameScores();
-
 #endif
 
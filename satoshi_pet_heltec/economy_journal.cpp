@@ -0,0 +1,329 @@
+#include "economy_journal.h"
+#include "profiler.h"
+#include "heap_monitor.h"
+#include <Preferences.h>
+
+#define JOURNAL_NAMESPACE "economy"   // Shared with the old spend_N keys
+#define JOURNAL_SNAPSHOT_KEY "jsnap"
+#define JOURNAL_SNAPSHOT_MAGIC 0x4A4E4C53  // "SLNJ"
+#define JOURNAL_VERSION 2                  // Bump when the byte layout changes
+
+// Byte layouts (little-endian, no padding):
+//
+//   spend:    id[16] timestamp:u32 amount:i32 action:u8 synced:u8     26 bytes
+//   record:   version:u8 type:u8 slot:u16 generation:u32 balance:i32
+//             payload crc:u32
+//               SPEND_APPENDED payload = spend, SPEND_ACKED = id[16],
+//               BALANCE_SET = none
+//   snapshot: magic:u32 version:u8 reserved:u8 count:u16 generation:u32
+//             balance:i32 spend*count crc:u32
+//
+// Records are sized by type, so an ack or a balance change fits in a single
+// NVS data entry.
+#define SPEND_RECORD_SIZE 26
+#define RECORD_HEADER_SIZE 12
+#define SNAPSHOT_HEADER_SIZE 16
+#define CRC_SIZE 4
+#define RECORD_MAX_SIZE (RECORD_HEADER_SIZE + SPEND_RECORD_SIZE + CRC_SIZE)
+#define SNAPSHOT_MAX_SIZE (SNAPSHOT_HEADER_SIZE + MAX_PENDING_SPENDS * SPEND_RECORD_SIZE + CRC_SIZE)
+
+static Preferences journalPrefs;
+
+// Journal position survives deep sleep along with the queue in economy.cpp
+RTC_DATA_ATTR static uint32_t generation = 0;
+RTC_DATA_ATTR static uint16_t nextSlot = 0;
+RTC_DATA_ATTR static bool locked = false;  // Snapshot unreadable - don't write over it
+static uint32_t writeCount = 0;
+static uint32_t bytesWritten = 0;
+
+// Compaction and boot run on different tasks, but both under the economy lock
+static uint8_t snapshotBuf[SNAPSHOT_MAX_SIZE];
+
+// Bitwise CRC-32 (IEEE) - records are small and written a few at a time
+static uint32_t crc32Update(uint32_t crc, const void *data, size_t len) {
+  const uint8_t *bytes = (const uint8_t*)data;
+  crc = ~crc;
+  while (len--) {
+    crc ^= *bytes++;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+    }
+  }
+  return ~crc;
+}
+
+// The ESP32 is little-endian, so a plain copy gives the stored byte order
+static uint8_t *putU16(uint8_t *p, uint16_t v) { memcpy(p, &v, 2); return p + 2; }
+static uint8_t *putU32(uint8_t *p, uint32_t v) { memcpy(p, &v, 4); return p + 4; }
+static const uint8_t *getU16(const uint8_t *p, uint16_t &v) { memcpy(&v, p, 2); return p + 2; }
+static const uint8_t *getU32(const uint8_t *p, uint32_t &v) { memcpy(&v, p, 4); return p + 4; }
+
+static uint8_t *encodeSpend(uint8_t *p, const PendingSpend &spend) {
+  memcpy(p, spend.id, SPEND_ID_SIZE);
+  p = putU32(p + SPEND_ID_SIZE, spend.timestamp);
+  p = putU32(p, (uint32_t)spend.amount);
+  *p++ = spend.action;
+  *p++ = spend.synced ? 1 : 0;
+  return p;
+}
+
+static const uint8_t *decodeSpend(const uint8_t *p, PendingSpend &spend) {
+  uint32_t amount;
+  memcpy(spend.id, p, SPEND_ID_SIZE);
+  p = getU32(p + SPEND_ID_SIZE, spend.timestamp);
+  p = getU32(p, amount);
+  spend.amount = (int32_t)amount;
+  spend.action = (SpendAction)*p++;
+  spend.synced = *p++ != 0;
+  return p;
+}
+
+static size_t payloadSize(uint8_t type) {
+  switch (type) {
+    case JOURNAL_SPEND_APPENDED: return SPEND_RECORD_SIZE;
+    case JOURNAL_SPEND_ACKED: return SPEND_ID_SIZE;
+    default: return 0;
+  }
+}
+
+static void slotKey(uint16_t slot, char *key) {
+  snprintf(key, 8, "j%u", (unsigned)slot);
+}
+
+static JournalLoadResult loadSnapshot(PendingSpend *spends, int &count, int &balance) {
+  size_t len = journalPrefs.getBytesLength(JOURNAL_SNAPSHOT_KEY);
+  if (len == 0) {
+    return JOURNAL_EMPTY;
+  }
+  if (len < SNAPSHOT_HEADER_SIZE + CRC_SIZE || len > sizeof(snapshotBuf)) {
+    Serial.println(F("⚠️ Journal: Snapshot has a bad length - leaving it alone"));
+    return JOURNAL_UNREADABLE;
+  }
+  journalPrefs.getBytes(JOURNAL_SNAPSHOT_KEY, snapshotBuf, len);
+
+  uint32_t magic, snapGeneration, snapBalance, storedCrc;
+  uint16_t snapCount;
+  const uint8_t *p = getU32(snapshotBuf, magic);
+  uint8_t version = *p;
+  p = getU16(p + 2, snapCount);
+  p = getU32(p, snapGeneration);
+  p = getU32(p, snapBalance);
+  getU32(snapshotBuf + len - CRC_SIZE, storedCrc);
+
+  // Either way the balance may only be in here - never replace it
+  if (magic != JOURNAL_SNAPSHOT_MAGIC || version != JOURNAL_VERSION) {
+    Serial.print(F("⚠️ Journal: Snapshot layout "));
+    Serial.print(version);
+    Serial.println(F(" is unknown - leaving it alone"));
+    return JOURNAL_UNREADABLE;
+  }
+  if (snapCount > MAX_PENDING_SPENDS ||
+      len != SNAPSHOT_HEADER_SIZE + (size_t)snapCount * SPEND_RECORD_SIZE + CRC_SIZE ||
+      storedCrc != crc32Update(0, snapshotBuf, len - CRC_SIZE)) {
+    Serial.println(F("⚠️ Journal: Snapshot is corrupt - leaving it alone"));
+    return JOURNAL_UNREADABLE;
+  }
+
+  for (int i = 0; i < snapCount; i++) {
+    p = decodeSpend(p, spends[i]);
+  }
+  count = snapCount;
+  balance = (int32_t)snapBalance;
+  generation = snapGeneration;
+  return JOURNAL_LOADED;
+}
+
+// Validate one stored record and apply it to the in-memory queue
+static bool replayRecord(const uint8_t *buf, size_t len, uint16_t slot,
+                         PendingSpend *spends, int &count, int &balance) {
+  if (len < RECORD_HEADER_SIZE + CRC_SIZE) {
+    return false;
+  }
+
+  uint8_t version = buf[0];
+  uint8_t type = buf[1];
+  uint16_t recSlot;
+  uint32_t recGeneration, recBalance, storedCrc;
+  const uint8_t *p = getU16(buf + 2, recSlot);
+  p = getU32(p, recGeneration);
+  p = getU32(p, recBalance);
+  getU32(buf + len - CRC_SIZE, storedCrc);
+
+  if (version != JOURNAL_VERSION || recGeneration != generation || recSlot != slot ||
+      len != RECORD_HEADER_SIZE + payloadSize(type) + CRC_SIZE ||
+      storedCrc != crc32Update(0, buf, len - CRC_SIZE)) {
+    return false;
+  }
+
+  switch (type) {
+    case JOURNAL_SPEND_APPENDED:
+      if (count < MAX_PENDING_SPENDS) {
+        decodeSpend(p, spends[count++]);
+      }
+      break;
+
+    case JOURNAL_SPEND_ACKED:
+      for (int i = 0; i < count; i++) {
+        if (memcmp(spends[i].id, p, SPEND_ID_SIZE) == 0) {
+          spends[i].synced = true;
+          break;
+        }
+      }
+      break;
+  }
+  balance = (int32_t)recBalance;
+  return true;
+}
+
+JournalLoadResult journalLoad(PendingSpend *spends, int &count, int &balance) {
+  journalPrefs.begin(JOURNAL_NAMESPACE, true); // read-only
+
+  count = 0;
+  balance = 0;
+  JournalLoadResult result = loadSnapshot(spends, count, balance);
+  locked = result == JOURNAL_UNREADABLE;
+  if (result != JOURNAL_LOADED) {
+    journalPrefs.end();
+    count = 0;
+    balance = 0;
+    return result;
+  }
+
+  // Replay up to the last valid record
+  uint16_t slot = 0;
+  char key[8];
+  uint8_t buf[RECORD_MAX_SIZE];
+  for (; slot < JOURNAL_MAX_RECORDS; slot++) {
+    slotKey(slot, key);
+    size_t len = journalPrefs.getBytesLength(key);
+    if (len == 0 || len > sizeof(buf) || journalPrefs.getBytes(key, buf, len) != len ||
+        !replayRecord(buf, len, slot, spends, count, balance)) {
+      break;
+    }
+  }
+  nextSlot = slot;
+
+  journalPrefs.end();
+
+  Serial.print(F("📒 Journal: Snapshot gen "));
+  Serial.print(generation);
+  Serial.print(F(" + "));
+  Serial.print(nextSlot);
+  Serial.print(F(" records ("));
+  Serial.print(count);
+  Serial.print(F(" spends, balance "));
+  Serial.print(balance);
+  Serial.println(F(")"));
+  return JOURNAL_LOADED;
+}
+
+void journalUnlock() {
+  locked = false;
+}
+
+bool journalAppend(JournalRecordType type, const PendingSpend *spend, int balance) {
+  if (locked || nextSlot >= JOURNAL_MAX_RECORDS || (payloadSize(type) > 0 && !spend)) {
+    return false;
+  }
+
+  uint8_t buf[RECORD_MAX_SIZE];
+  uint8_t *p = buf;
+  *p++ = JOURNAL_VERSION;
+  *p++ = type;
+  p = putU16(p, nextSlot);
+  p = putU32(p, generation);
+  p = putU32(p, (uint32_t)balance);
+  if (type == JOURNAL_SPEND_APPENDED) {
+    p = encodeSpend(p, *spend);
+  } else if (type == JOURNAL_SPEND_ACKED) {
+    memcpy(p, spend->id, SPEND_ID_SIZE);
+    p += SPEND_ID_SIZE;
+  }
+  p = putU32(p, crc32Update(0, buf, p - buf));
+  size_t len = p - buf;
+
+  char key[8];
+  slotKey(nextSlot, key);
+
+  size_t written;
+  {
+    ProfileScope scope(PROFILE_NVS);
+    HeapScope heapScope(HEAP_SITE_NVS);
+    journalPrefs.begin(JOURNAL_NAMESPACE, false); // read-write
+    written = journalPrefs.putBytes(key, buf, len);
+    journalPrefs.end();
+  }
+
+  writeCount++;
+  bytesWritten += written;
+  if (written != len) {
+    Serial.print(F("❌ Journal: Failed to write record "));
+    Serial.println(key);
+    return false;
+  }
+
+  nextSlot++;
+  return true;
+}
+
+bool journalNeedsCompaction() {
+  return nextSlot >= JOURNAL_MAX_RECORDS;
+}
+
+bool journalCompact(const PendingSpend *spends, int count, int balance) {
+  if (locked) {
+    return false;
+  }
+  count = min(max(0, count), MAX_PENDING_SPENDS);
+
+  // The new generation retires every record written so far - no need to
+  // erase the old keys, they fail the generation check and get overwritten
+  uint32_t newGeneration = generation + 1;
+  uint8_t *p = putU32(snapshotBuf, JOURNAL_SNAPSHOT_MAGIC);
+  *p++ = JOURNAL_VERSION;
+  *p++ = 0;
+  p = putU16(p, count);
+  p = putU32(p, newGeneration);
+  p = putU32(p, (uint32_t)balance);
+  for (int i = 0; i < count; i++) {
+    p = encodeSpend(p, spends[i]);
+  }
+  p = putU32(p, crc32Update(0, snapshotBuf, p - snapshotBuf));
+  size_t len = p - snapshotBuf;
+
+  size_t written;
+  {
+    ProfileScope scope(PROFILE_NVS);
+    HeapScope heapScope(HEAP_SITE_NVS);
+    journalPrefs.begin(JOURNAL_NAMESPACE, false); // read-write
+    written = journalPrefs.putBytes(JOURNAL_SNAPSHOT_KEY, snapshotBuf, len);
+    journalPrefs.end();
+  }
+
+  writeCount++;
+  bytesWritten += written;
+  if (written != len) {
+    // Old snapshot and records are still intact
+    Serial.println(F("❌ Journal: Failed to write snapshot"));
+    return false;
+  }
+
+  generation = newGeneration;
+  nextSlot = 0;
+  Serial.print(F("📒 Journal: Compacted to gen "));
+  Serial.print(generation);
+  Serial.print(F(" ("));
+  Serial.print(count);
+  Serial.print(F(" spends, "));
+  Serial.print((unsigned int)len);
+  Serial.println(F(" bytes)"));
+  return true;
+}
+
+uint32_t getJournalWriteCount() {
+  return writeCount;
+}
+
+uint32_t getJournalBytesWritten() {
+  return bytesWritten;
+}
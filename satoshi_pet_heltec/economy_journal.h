@@ -0,0 +1,56 @@
+#ifndef ECONOMY_JOURNAL_H
+#define ECONOMY_JOURNAL_H
+
+#include <Arduino.h>
+#include "economy.h"
+
+// Append-only NVS journal for the spend queue.
+//
+// Every change is one small CRC-protected record in its own key (j0, j1, ...)
+// instead of rewriting the whole queue. Records sit on top of a snapshot
+// ("jsnap"); compaction writes a fresh snapshot with a new generation, which
+// retires every older record at once. On boot the snapshot is loaded and
+// records are replayed until the first missing, stale or corrupt one, so a
+// write torn by a power cut only loses that last record.
+
+enum JournalRecordType : uint8_t {
+  JOURNAL_SPEND_APPENDED = 1,  // New spend queued
+  JOURNAL_SPEND_ACKED = 2,     // Spend synced (or dropped as invalid)
+  JOURNAL_BALANCE_SET = 3      // Balance changed without a queue entry
+};
+
+// Records before the queue is compacted into a new snapshot
+#define JOURNAL_MAX_RECORDS 32
+
+enum JournalLoadResult : uint8_t {
+  JOURNAL_LOADED = 0,      // Snapshot and records replayed
+  JOURNAL_EMPTY = 1,       // No snapshot yet (first boot, or still on the old spend_N keys)
+  JOURNAL_UNREADABLE = 2   // Snapshot corrupt or from an unknown layout
+};
+
+// Load the snapshot and replay the records after it. Unless it returns
+// JOURNAL_LOADED, count and balance come back as 0. After JOURNAL_UNREADABLE
+// the journal refuses to write, so the snapshot is never overwritten by an
+// empty queue; journalUnlock() lifts that.
+JournalLoadResult journalLoad(PendingSpend *spends, int &count, int &balance);
+
+// Allow writes over an unreadable snapshot (the user cleared the economy data)
+void journalUnlock();
+
+// Append one record. spend may be null for JOURNAL_BALANCE_SET.
+// balance is the balance after this change. False if the record wasn't
+// stored (slots used up, flash error, or locked after an unreadable load).
+bool journalAppend(JournalRecordType type, const PendingSpend *spend, int balance);
+
+// True once the record slots are used up
+bool journalNeedsCompaction();
+
+// Write the whole queue as a new snapshot and start over at j0. False if
+// nothing was written; the previous snapshot and records are then intact.
+bool journalCompact(const PendingSpend *spends, int count, int balance);
+
+// NVS writes and bytes issued by the journal since boot
+uint32_t getJournalWriteCount();
+uint32_t getJournalBytesWritten();
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef FIXED_STRING_H
+#define FIXED_STRING_H
+
+#include <Arduino.h>
+
+// Fixed-capacity string stored inline (no heap).
+//
+// Used for fields that are rewritten on every config poll, so a poll doesn't
+// free and reallocate a dozen Strings. Assigning copies into the inline
+// buffer and truncates at N bytes, backing off to a whole UTF-8 character.
+// Reads go through c_str() or the const char* conversion; wrap in String()
+// where a String is needed (concatenation, String parameters).
+template <size_t N>
+class FixedString {
+ public:
+  FixedString() {
+    buffer[0] = '\0';
+  }
+
+  FixedString(const char *value) {
+    assign(value, value ? strlen(value) : 0);
+  }
+
+  FixedString &operator=(const char *value) {
+    assign(value, value ? strlen(value) : 0);
+    return *this;
+  }
+
+  FixedString &operator=(const String &value) {
+    assign(value.c_str(), value.length());
+    return *this;
+  }
+
+  template <size_t M>
+  FixedString &operator=(const FixedString<M> &value) {
+    assign(value.c_str(), value.length());
+    return *this;
+  }
+
+  const char *c_str() const {
+    return buffer;
+  }
+
+  operator const char *() const {
+    return buffer;
+  }
+
+  size_t length() const {
+    return strlen(buffer);
+  }
+
+  static constexpr size_t capacity() {
+    return N;
+  }
+
+  bool operator==(const char *other) const {
+    return strcmp(buffer, other ? other : "") == 0;
+  }
+
+  bool operator!=(const char *other) const {
+    return !(*this == other);
+  }
+
+  bool operator==(const String &other) const {
+    return *this == other.c_str();
+  }
+
+  bool operator!=(const String &other) const {
+    return !(*this == other.c_str());
+  }
+
+  template <size_t M>
+  bool operator==(const FixedString<M> &other) const {
+    return *this == other.c_str();
+  }
+
+  template <size_t M>
+  bool operator!=(const FixedString<M> &other) const {
+    return !(*this == other.c_str());
+  }
+
+ private:
+  void assign(const char *value, size_t len) {
+    if (len > N) {
+      len = N;
+      // Don't leave half a multi-byte character at the end
+      while (len > 0 && ((uint8_t)value[len] & 0xC0) == 0x80) {
+        len--;
+      }
+    }
+    if (len > 0) {
+      memmove(buffer, value, len);  // value may point into this buffer
+    }
+    buffer[len] = '\0';
+  }
+
+  char buffer[N + 1];
+};
+
+#endif
@@ -0,0 +1,156 @@
+#include "flappy_engine.h"
+
+// Tuning, in the game's original per-frame units (x FLAPPY_SUBPX)
+#define GRAVITY 250                    // Per frame, per frame
+#define FLAP_VELOCITY (-3500)          // Smaller jump, several taps to reach the top
+#define MAX_FALL_SPEED 5000
+#define INITIAL_SPEED 900
+#define SPEED_INCREASE 25              // Per wall passed
+#define SINGLE_WALL_START_SCORE 15     // Upper-only or lower-only walls
+#define COMBINED_WALL_START_SCORE 30   // Upper and lower walls together
+
+#define TICKS_PER_FRAME (FLAPPY_TICK_HZ / 60)
+
+static int32_t px(int32_t subpx) {
+  return subpx / FLAPPY_SUBPX;  // Truncates toward zero, like the old (int) casts
+}
+
+// xorshift32: same sequence on every platform, unlike random()
+static int32_t nextRandom(FlappyState &state, int32_t minValue, int32_t maxValue) {
+  uint32_t x = state.rngState;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  state.rngState = x;
+  return minValue + (int32_t)(x % (uint32_t)(maxValue - minValue));
+}
+
+static int32_t clampValue(int32_t value, int32_t low, int32_t high) {
+  return value < low ? low : (value > high ? high : value);
+}
+
+// New heights for a wall that just wrapped around to the right
+static void rollWall(FlappyState &state, FlappyWall &wall) {
+  int score = state.score;
+
+  // Lower walls get taller as the score climbs
+  int maxHeight = 18 + score / 2 < 30 ? 18 + score / 2 : 30;
+  int minHeight = 12 - score / 8 > 10 ? 12 - score / 8 : 10;
+
+  if (score < SINGLE_WALL_START_SCORE) {
+    // Early game: lower walls only
+    wall.wallHeight = nextRandom(state, minHeight, maxHeight + 1);
+    wall.topWallHeight = 0;
+  } else if (score < COMBINED_WALL_START_SCORE) {
+    // Mid game: either an upper or a lower wall
+    if (nextRandom(state, 0, 2) == 0) {
+      wall.wallHeight = 0;
+      wall.topWallHeight = nextRandom(state, 12, 24);
+    } else {
+      wall.wallHeight = nextRandom(state, minHeight, maxHeight + 1);
+      wall.topWallHeight = 0;
+    }
+  } else {
+    // Late game: both, leaving a 40-47px gap for the 16px pet
+    const int MIN_GAP = 40;
+    const int MAX_WALL_HEIGHT = 18;
+    int gapSize = nextRandom(state, MIN_GAP, MIN_GAP + 8);
+    int wallMax = (FLAPPY_SCREEN_HEIGHT - gapSize) / 2;
+    if (wallMax > MAX_WALL_HEIGHT) {
+      wallMax = MAX_WALL_HEIGHT;
+    }
+    wall.wallHeight = nextRandom(state, 8, wallMax + 1);
+    wall.topWallHeight = nextRandom(state, 6, wallMax + 1);
+  }
+  wall.passed = false;
+}
+
+static bool hitsWall(const FlappyState &state) {
+  int32_t petTop = px(state.petY);
+  int32_t petBottom = petTop + FLAPPY_PET_SIZE;
+
+  for (int i = 0; i < FLAPPY_WALL_COUNT; i++) {
+    const FlappyWall &wall = state.walls[i];
+    int32_t wallLeft = px(wall.x);
+    if (FLAPPY_PET_X + FLAPPY_PET_SIZE <= wallLeft || FLAPPY_PET_X >= wallLeft + FLAPPY_WALL_WIDTH) {
+      continue;
+    }
+    if (wall.wallHeight > 0 && petBottom > FLAPPY_SCREEN_HEIGHT - wall.wallHeight) {
+      return true;
+    }
+    if (wall.topWallHeight > 0 && petTop < wall.topWallHeight) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void flappyInit(FlappyState &state, uint32_t seed) {
+  state.petY = 32 * FLAPPY_SUBPX;
+  state.petVelocity = 0;
+  state.wallSpeed = INITIAL_SPEED;
+  state.score = 0;
+  state.gameOver = false;
+  state.ticks = 0;
+  state.rngState = seed ? seed : 0x9E3779B9;  // xorshift sticks at 0
+
+  // Low lower walls to start - the pet's bottom edge sits at y=48, so a 12px
+  // wall (top at y=52) is cleared without flapping
+  for (int i = 0; i < FLAPPY_WALL_COUNT; i++) {
+    FlappyWall &wall = state.walls[i];
+    wall.x = (FLAPPY_SCREEN_WIDTH + i * FLAPPY_WALL_SPACING) * FLAPPY_SUBPX;
+    if (i == 0) {
+      wall.wallHeight = 12;
+    } else if (i == 1) {
+      wall.wallHeight = nextRandom(state, 12, 18);
+    } else if (i == 2) {
+      wall.wallHeight = nextRandom(state, 15, 22);
+    } else {
+      wall.wallHeight = nextRandom(state, 18, 28);
+    }
+    wall.topWallHeight = 0;
+    wall.passed = false;
+  }
+}
+
+void flappyStep(FlappyState &state, bool flap) {
+  if (state.gameOver) {
+    return;
+  }
+  state.ticks++;
+
+  if (flap) {
+    state.petVelocity = FLAP_VELOCITY;
+  }
+  state.petVelocity += GRAVITY / TICKS_PER_FRAME;
+  state.petVelocity = clampValue(state.petVelocity, -MAX_FALL_SPEED, MAX_FALL_SPEED);
+  state.petY += state.petVelocity / TICKS_PER_FRAME;
+
+  // Edges aren't deadly - allow a small overshoot and hold there
+  state.petY = clampValue(state.petY, -8 * FLAPPY_SUBPX,
+                          (FLAPPY_SCREEN_HEIGHT - FLAPPY_PET_SIZE + 8) * FLAPPY_SUBPX);
+
+  for (int i = 0; i < FLAPPY_WALL_COUNT; i++) {
+    FlappyWall &wall = state.walls[i];
+    wall.x -= state.wallSpeed / TICKS_PER_FRAME;
+
+    if (!wall.passed && wall.x + FLAPPY_WALL_WIDTH * FLAPPY_SUBPX < FLAPPY_PET_X * FLAPPY_SUBPX) {
+      wall.passed = true;
+      state.score++;
+      state.wallSpeed += SPEED_INCREASE;
+    }
+
+    if (wall.x + FLAPPY_WALL_WIDTH * FLAPPY_SUBPX < 0) {
+      int32_t rightmostX = state.walls[0].x;
+      for (int j = 1; j < FLAPPY_WALL_COUNT; j++) {
+        if (state.walls[j].x > rightmostX) {
+          rightmostX = state.walls[j].x;
+        }
+      }
+      wall.x = rightmostX + FLAPPY_WALL_SPACING * FLAPPY_SUBPX;
+      rollWall(state, wall);
+    }
+  }
+
+  state.gameOver = hitsWall(state);
+}
@@ -0,0 +1,58 @@
+#ifndef FLAPPY_ENGINE_H
+#define FLAPPY_ENGINE_H
+
+#include <stdint.h>
+
+// Flappy Pet simulation, stepped at a fixed rate.
+//
+// The game loop in pet_blob.cpp runs flappyStep() once per FLAPPY_TICK_US of
+// real time and draws whatever the display can keep up with, interpolating
+// between the last two ticks. Nothing here reads the clock, the buttons or
+// the display, and walls come from a seeded xorshift32 generator, so a run
+// is fully decided by the seed and the ticks on which the player flapped -
+// the same inputs always give the same score, on the device or on a host
+// (see game_replay.h).
+//
+// Positions and speeds are integers in 1/1000 px (no float rounding
+// differences between compilers). Speeds are per 60 Hz frame, the unit the
+// game was tuned in.
+
+#define FLAPPY_TICK_HZ 120
+#define FLAPPY_TICK_US (1000000UL / FLAPPY_TICK_HZ)
+#define FLAPPY_MAX_CATCHUP_US 100000UL  // Longest stall made up in one pass
+#define FLAPPY_SUBPX 1000          // Sub-pixel units per pixel
+
+#define FLAPPY_SCREEN_WIDTH 128
+#define FLAPPY_SCREEN_HEIGHT 64
+#define FLAPPY_PET_X 25
+#define FLAPPY_PET_SIZE 16         // Sprite is square
+#define FLAPPY_WALL_WIDTH 8
+#define FLAPPY_WALL_SPACING 120
+#define FLAPPY_WALL_COUNT 4
+
+struct FlappyWall {
+  int32_t x;               // Left edge, sub-pixels
+  int16_t wallHeight;      // Lower wall, from the bottom (0 = none)
+  int16_t topWallHeight;   // Upper wall, from the top (0 = none)
+  bool passed;
+};
+
+struct FlappyState {
+  int32_t petY;            // Sprite top, sub-pixels
+  int32_t petVelocity;     // Sub-pixels per frame, positive = down
+  int32_t wallSpeed;       // Sub-pixels per frame
+  int score;
+  bool gameOver;
+  uint32_t ticks;          // Steps taken since flappyInit()
+  FlappyWall walls[FLAPPY_WALL_COUNT];
+  uint32_t rngState;       // Wall generator, never 0
+};
+
+// Fresh game: pet mid-screen, first walls just off the right edge
+void flappyInit(FlappyState &state, uint32_t seed);
+
+// Advance one tick. flap = the player pressed since the previous tick.
+// Does nothing once gameOver is set.
+void flappyStep(FlappyState &state, bool flap);
+
+#endif
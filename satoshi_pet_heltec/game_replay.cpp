@@ -0,0 +1,82 @@
+#include "game_replay.h"
+#include "flappy_engine.h"
+
+void flapLogBegin(FlapLog &log, uint32_t seed) {
+  log.seed = seed;
+  log.endTick = 0;
+  log.lastTick = 0;
+  log.flaps = 0;
+  log.length = 0;
+  log.overflow = false;
+}
+
+void flapLogAdd(FlapLog &log, uint32_t tick) {
+  if (log.overflow) {
+    return;
+  }
+  uint32_t delta = tick - log.lastTick;
+  uint8_t encoded[5];
+  uint8_t size = 0;
+  do {
+    uint8_t byte = delta & 0x7F;
+    delta >>= 7;
+    encoded[size++] = delta ? (byte | 0x80) : byte;
+  } while (delta);
+
+  if (log.length + size > FLAP_LOG_MAX_BYTES) {
+    log.overflow = true;
+    return;
+  }
+  for (uint8_t i = 0; i < size; i++) {
+    log.data[log.length++] = encoded[i];
+  }
+  log.lastTick = tick;
+  log.flaps++;
+}
+
+void flapLogEnd(FlapLog &log, uint32_t endTick) {
+  log.endTick = endTick;
+}
+
+int flapLogReplay(const FlapLog &log) {
+  if (log.overflow) {
+    return -1;
+  }
+
+  FlappyState game;
+  flappyInit(game, log.seed);
+
+  uint16_t pos = 0;
+  uint32_t nextFlap = 0;  // Tick of the next logged flap
+  bool haveFlap = false;
+
+  while (!game.gameOver && game.ticks < log.endTick) {
+    if (!haveFlap && pos < log.length) {
+      uint32_t delta = 0;
+      uint8_t shift = 0;
+      uint8_t byte;
+      do {
+        if (pos >= log.length || shift > 28) {
+          return -1;
+        }
+        byte = log.data[pos++];
+        delta |= (uint32_t)(byte & 0x7F) << shift;
+        shift += 7;
+      } while (byte & 0x80);
+      nextFlap += delta;
+      haveFlap = true;
+    }
+
+    bool flap = haveFlap && nextFlap == game.ticks + 1;
+    flappyStep(game, flap);
+    if (flap) {
+      haveFlap = false;
+    }
+  }
+
+  // Every flap used, and the pet hit a wall on exactly the recorded tick
+  if (!game.gameOver || game.ticks != log.endTick || haveFlap || pos != log.length) {
+    return -1;
+  }
+  return game.score;
+}
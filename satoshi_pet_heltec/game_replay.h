@@ -0,0 +1,44 @@
+#ifndef GAME_REPLAY_H
+#define GAME_REPLAY_H
+
+#include <stdint.h>
+
+// Flap log for a Flappy Pet run, sent with the score as evidence.
+//
+// A run is decided by its wall seed and the ticks the player flapped on
+// (see flappy_engine.h), so recording just those lets the server - or
+// anyone with flappy_engine.cpp - play the game again and check the score.
+//
+// Each flap is stored as the number of ticks since the previous flap (the
+// first since tick 0) in unsigned LEB128: 7 bits per byte, low bits first,
+// high bit set on every byte but the last. Flaps under a second apart take
+// one byte, so a typical run fits in a couple of hundred bytes.
+//
+// Submitted as "proof": {"v": FLAP_LOG_VERSION, "hz": FLAPPY_TICK_HZ,
+// "seed": seed, "ticks": endTick, "flaps": base64(data)}
+
+#define FLAP_LOG_VERSION 1
+#define FLAP_LOG_MAX_BYTES 512
+
+struct FlapLog {
+  uint32_t seed;
+  uint32_t endTick;        // Tick the game ended on
+  uint32_t lastTick;       // Tick of the most recent flap
+  uint16_t flaps;
+  uint16_t length;         // Bytes used in data
+  bool overflow;           // Out of room - the log can't prove the score
+  uint8_t data[FLAP_LOG_MAX_BYTES];
+};
+
+void flapLogBegin(FlapLog &log, uint32_t seed);
+
+// The player flapped on this tick (ticks only go up)
+void flapLogAdd(FlapLog &log, uint32_t tick);
+
+void flapLogEnd(FlapLog &log, uint32_t endTick);
+
+// Play the run again from the log. Returns the score, or -1 if the log is
+// truncated or the replay doesn't end on endTick.
+int flapLogReplay(const FlapLog &log);
+
+#endif
@@ -0,0 +1,218 @@
+#include "heap_monitor.h"
+#include "metrics.h"
+
+#define HEAP_MAX_TASKS 6
+
+#ifndef CONFIG_ARDUINO_LOOP_STACK_SIZE
+#define CONFIG_ARDUINO_LOOP_STACK_SIZE 8192
+#endif
+
+struct WatchedTask {
+  TaskHandle_t handle;
+  uint32_t stackBytes;
+  uint32_t headroom;   // Bytes never touched so far (ESP-IDF reports bytes)
+};
+
+static const char *const SITE_NAMES[HEAP_SITE_COUNT] = {
+  "fetch", "sync", "render", "nvs"
+};
+
+static WatchedTask tasks[HEAP_MAX_TASKS];
+static uint8_t taskCount = 0;
+static HeapSiteStats sites[HEAP_SITE_COUNT];
+static portMUX_TYPE heapMux = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t bootFree = 0;
+static uint8_t bootFragmentation = 0;
+static uint8_t fragmentation = 0;
+static uint32_t minStackHeadroom = UINT32_MAX;
+static bool checked = false;
+static unsigned long lastCheck = 0;
+static unsigned long lastTrendLog = 0;
+static bool heapAlarm = false;
+static bool stackAlarm = false;
+
+static uint8_t fragmentationOf(uint32_t freeBytes, uint32_t largestBlock) {
+  if (freeBytes == 0 || largestBlock >= freeBytes) {
+    return 0;
+  }
+  return 100 - (uint8_t)((uint64_t)largestBlock * 100 / freeBytes);
+}
+
+static void logHeapLine(const __FlashStringHelper *label) {
+  Serial.print(label);
+  Serial.print(F(" free "));
+  Serial.print(ESP.getFreeHeap());
+  Serial.print(F(" B, largest block "));
+  Serial.print(ESP.getMaxAllocHeap());
+  Serial.print(F(" B, min ever "));
+  Serial.print(ESP.getMinFreeHeap());
+  Serial.print(F(" B, fragmentation "));
+  Serial.print(fragmentation);
+  Serial.println(F("%"));
+}
+
+void heapMonitorBegin() {
+  bootFree = ESP.getFreeHeap();
+  bootFragmentation = fragmentationOf(bootFree, ESP.getMaxAllocHeap());
+  fragmentation = bootFragmentation;
+  lastTrendLog = millis();
+  heapMonitorWatchTask(xTaskGetCurrentTaskHandle(), CONFIG_ARDUINO_LOOP_STACK_SIZE);
+}
+
+void heapMonitorWatchTask(TaskHandle_t task, uint32_t stackBytes) {
+  if (!task) {
+    return;
+  }
+  portENTER_CRITICAL(&heapMux);
+  if (taskCount < HEAP_MAX_TASKS) {
+    tasks[taskCount].handle = task;
+    tasks[taskCount].stackBytes = stackBytes;
+    tasks[taskCount].headroom = stackBytes;
+    taskCount++;
+  }
+  portEXIT_CRITICAL(&heapMux);
+}
+
+void heapMonitorRecord(HeapSite site, int32_t delta) {
+  if (site >= HEAP_SITE_COUNT) {
+    return;
+  }
+  portENTER_CRITICAL(&heapMux);
+  HeapSiteStats &s = sites[site];
+  s.calls++;
+  s.lastDelta = delta;
+  s.netDelta += delta;
+  if (delta < s.worstDelta) {
+    s.worstDelta = delta;
+  }
+  portEXIT_CRITICAL(&heapMux);
+
+  if (delta <= -HEAP_LEAK_LOG_BYTES) {
+    Serial.print(F("🧠 Heap: "));
+    Serial.print(SITE_NAMES[site]);
+    Serial.print(F(" kept "));
+    Serial.print(-delta);
+    Serial.print(F(" B (free now "));
+    Serial.print(ESP.getFreeHeap());
+    Serial.println(F(" B)"));
+  }
+}
+
+HeapSiteStats getHeapSiteStats(HeapSite site) {
+  HeapSiteStats stats = {};
+  if (site < HEAP_SITE_COUNT) {
+    portENTER_CRITICAL(&heapMux);
+    stats = sites[site];
+    portEXIT_CRITICAL(&heapMux);
+  }
+  return stats;
+}
+
+void heapMonitorCheck() {
+  unsigned long now = millis();
+  if (checked && now - lastCheck < HEAP_CHECK_MS) {
+    return;
+  }
+  checked = true;
+  lastCheck = now;
+
+  uint32_t largestBlock = ESP.getMaxAllocHeap();
+  fragmentation = fragmentationOf(ESP.getFreeHeap(), largestBlock);
+
+  uint32_t lowest = UINT32_MAX;
+  const char *lowestName = "";
+  for (uint8_t i = 0; i < taskCount; i++) {
+    tasks[i].headroom = uxTaskGetStackHighWaterMark(tasks[i].handle);
+    if (tasks[i].headroom < lowest) {
+      lowest = tasks[i].headroom;
+      lowestName = pcTaskGetName(tasks[i].handle);
+    }
+  }
+  minStackHeadroom = lowest;
+
+  metricSet(METRIC_HEAP_FRAGMENTATION, fragmentation);
+  metricSet(METRIC_MIN_STACK_HEADROOM, lowest == UINT32_MAX ? 0 : lowest);
+
+  bool fragmented = fragmentation >= HEAP_FRAG_ALARM_PERCENT && largestBlock < HEAP_BLOCK_ALARM_BYTES;
+  if (fragmented != heapAlarm) {
+    heapAlarm = fragmented;
+    if (fragmented) {
+      metricIncrement(METRIC_HEAP_ALARMS);
+      logHeapLine(F("🚨 Heap fragmented:"));
+    } else {
+      logHeapLine(F("✅ Heap recovered:"));
+    }
+  }
+
+  bool stackLow = lowest < HEAP_STACK_ALARM_BYTES;
+  if (stackLow != stackAlarm) {
+    stackAlarm = stackLow;
+    if (stackLow) {
+      metricIncrement(METRIC_HEAP_ALARMS);
+      Serial.print(F("🚨 Stack: task '"));
+      Serial.print(lowestName);
+      Serial.print(F("' has "));
+      Serial.print(lowest);
+      Serial.println(F(" B left"));
+    }
+  }
+
+  // Slow drift is what a leak or creeping fragmentation looks like
+  if (now - lastTrendLog >= HEAP_TREND_LOG_MS) {
+    lastTrendLog = now;
+    Serial.print(F("🧠 Heap trend: free "));
+    Serial.print((int32_t)ESP.getFreeHeap() - (int32_t)bootFree);
+    Serial.print(F(" B since boot, fragmentation "));
+    Serial.print(bootFragmentation);
+    Serial.print(F("% -> "));
+    Serial.print(fragmentation);
+    Serial.println(F("%"));
+  }
+}
+
+uint8_t getHeapFragmentation() {
+  return fragmentation;
+}
+
+uint32_t getMinStackHeadroom() {
+  return minStackHeadroom;
+}
+
+void heapMonitorDump(Print &out) {
+  checked = false;  // Fresh figures
+  heapMonitorCheck();
+
+  out.print(F("🧠 Heap: free "));
+  out.print(ESP.getFreeHeap());
+  out.print(F(" B (boot "));
+  out.print(bootFree);
+  out.print(F("), largest block "));
+  out.print(ESP.getMaxAllocHeap());
+  out.print(F(" B, min ever "));
+  out.print(ESP.getMinFreeHeap());
+  out.print(F(" B, fragmentation "));
+  out.print(fragmentation);
+  out.print(F("% (boot "));
+  out.print(bootFragmentation);
+  out.println(F("%)"));
+
+  for (uint8_t i = 0; i < taskCount; i++) {
+    char line[48];  // Fits the longest name and values
+    snprintf(line, sizeof(line), "  stack %-8.8s %5lu / %5lu B free", pcTaskGetName(tasks[i].handle),
+             (unsigned long)tasks[i].headroom, (unsigned long)tasks[i].stackBytes);
+    out.println(line);
+  }
+
+  for (uint8_t site = 0; site < HEAP_SITE_COUNT; site++) {
+    HeapSiteStats s = getHeapSiteStats((HeapSite)site);
+    if (s.calls == 0) {
+      continue;
+    }
+    char line[96];  // Fits the longest name and values
+    snprintf(line, sizeof(line), "  site  %-8.8s %6lu calls, last %+6ld, worst %+6ld, net %+7ld B",
+             SITE_NAMES[site], (unsigned long)s.calls, (long)s.lastDelta, (long)s.worstDelta,
+             (long)s.netDelta);
+    out.println(line);
+  }
+}
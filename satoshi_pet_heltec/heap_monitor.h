@@ -0,0 +1,81 @@
+#ifndef HEAP_MONITOR_H
+#define HEAP_MONITOR_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// Heap and stack watermarks, with an alarm for a fragmenting heap.
+//
+// heapMonitorCheck() runs from loop() every HEAP_CHECK_MS and samples free
+// heap, the largest free block, the lowest free heap ever and the stack
+// high-water mark of every registered task. Fragmentation is the share of
+// free heap that isn't in the largest block. An alarm is logged (once, until
+// it clears) when fragmentation crosses HEAP_FRAG_ALARM_PERCENT while the
+// largest block is under HEAP_BLOCK_ALARM_BYTES - a TLS session needs a
+// contiguous ~16 KB buffer, so that's when allocations start failing - or
+// when a task gets within HEAP_STACK_ALARM_BYTES of the end of its stack.
+//
+// A HeapScope around a subsystem call records how much free heap the call
+// gained or lost. Calls that leave HEAP_LEAK_LOG_BYTES or more behind are
+// logged. The figure includes whatever the other tasks allocated meanwhile,
+// so one call means little; a site whose net total keeps growing doesn't.
+//
+// Send 'h' over serial for the full report.
+
+#define HEAP_CHECK_MS 10000
+#define HEAP_FRAG_ALARM_PERCENT 50
+#define HEAP_BLOCK_ALARM_BYTES 20000
+#define HEAP_STACK_ALARM_BYTES 512
+#define HEAP_LEAK_LOG_BYTES 2048
+#define HEAP_TREND_LOG_MS 3600000UL   // Hourly drift line
+
+enum HeapSite : uint8_t {
+  HEAP_SITE_FETCH,    // Network task requests (config, jobs, score, ...)
+  HEAP_SITE_SYNC,     // Spend sync
+  HEAP_SITE_RENDER,   // renderPet
+  HEAP_SITE_NVS,      // Preferences writes
+  HEAP_SITE_COUNT
+};
+
+struct HeapSiteStats {
+  uint32_t calls;
+  int32_t lastDelta;   // Bytes of free heap gained (negative = consumed)
+  int32_t worstDelta;
+  int32_t netDelta;    // Sum over all calls
+};
+
+// Record the baseline and watch the calling (loop) task's stack
+void heapMonitorBegin();
+
+// Watch another task's stack (call after creating it)
+void heapMonitorWatchTask(TaskHandle_t task, uint32_t stackBytes);
+
+// Periodic sample and alarm check (UI task)
+void heapMonitorCheck();
+
+// Free heap the site has gained, for HeapScope
+void heapMonitorRecord(HeapSite site, int32_t delta);
+
+HeapSiteStats getHeapSiteStats(HeapSite site);
+
+// Current fragmentation (0-100) and lowest stack headroom of any watched task
+uint8_t getHeapFragmentation();
+uint32_t getMinStackHeadroom();
+
+// Print heap, fragmentation, per-task stack and per-site figures
+void heapMonitorDump(Print &out);
+
+class HeapScope {
+ public:
+  explicit HeapScope(HeapSite site) : site(site), startFree(ESP.getFreeHeap()) {}
+  ~HeapScope() {
+    heapMonitorRecord(site, (int32_t)ESP.getFreeHeap() - (int32_t)startFree);
+  }
+
+ private:
+  HeapSite site;
+  uint32_t startFree;
+};
+
+#endif
@@ -0,0 +1,205 @@
+#include "metrics.h"
+#include "api_client.h"
+#include "power_manager.h"
+#include "profiler.h"
+#include <ArduinoJson.h>
+#include <WiFi.h>
+#include <esp_system.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#define METRICS_VERSION 1
+// Every counter, gauge, zone and battery sample at once. Names are constant
+// strings, which the document stores as pointers, so no string allowance.
+#define METRICS_DOC_SIZE                                                              \
+  (JSON_OBJECT_SIZE(7) + JSON_OBJECT_SIZE(METRIC_COUNTER_COUNT) +                     \
+   JSON_OBJECT_SIZE(METRIC_GAUGE_COUNT + 4) + JSON_OBJECT_SIZE(PROFILE_ZONE_COUNT) +  \
+   PROFILE_ZONE_COUNT * JSON_ARRAY_SIZE(5) + JSON_OBJECT_SIZE(2) +                    \
+   JSON_ARRAY_SIZE(METRICS_BATTERY_SAMPLES))
+
+static const char *const COUNTER_NAMES[METRIC_COUNTER_COUNT] = {
+  "boots", "wifiReconnectAttempts", "wifiReconnectFailures", "configPolls", "configFailures",
+  "config404s", "spendsSynced", "spendSyncsIncomplete", "scoresSubmitted", "scoreFailures",
+  "slowLoops", "uploadFailures", "heapAlarms"
+};
+
+static const char *const GAUGE_NAMES[METRIC_GAUGE_COUNT] = {
+  "batteryMv", "batteryPct", "consecutiveConfig404s", "heapFragmentation", "minStackHeadroom"
+};
+
+// Kept across deep sleep; every other boot starts from zero
+RTC_DATA_ATTR static uint32_t counters[METRIC_COUNTER_COUNT];  // Not yet in an accepted batch
+RTC_DATA_ATTR static int32_t gauges[METRIC_GAUGE_COUNT];
+RTC_DATA_ATTR static uint16_t batteryCurve[METRICS_BATTERY_SAMPLES];  // Ring, mV
+RTC_DATA_ATTR static uint8_t batteryNext = 0;
+RTC_DATA_ATTR static uint8_t batteryCount = 0;
+RTC_DATA_ATTR static bool batterySampled = false;
+RTC_DATA_ATTR static unsigned long lastBatterySampleMs = 0;
+RTC_DATA_ATTR static bool uploadAttempted = false;
+RTC_DATA_ATTR static bool lastUploadFailed = false;
+RTC_DATA_ATTR static unsigned long lastUploadMs = 0;
+
+static portMUX_TYPE metricsMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Only the network task builds batches
+static StaticJsonDocument<METRICS_DOC_SIZE> batchDoc;
+static StaticJsonDocument<32> responseFilter;
+
+void metricsBegin() {
+  metricIncrement(METRIC_BOOTS);
+}
+
+void metricsResume() {
+  lastBatterySampleMs = powerRebaseMs(lastBatterySampleMs);
+  lastUploadMs = powerRebaseMs(lastUploadMs);
+}
+
+void metricIncrement(MetricCounter counter, uint32_t by) {
+  if (counter >= METRIC_COUNTER_COUNT) {
+    return;
+  }
+  portENTER_CRITICAL(&metricsMux);
+  counters[counter] += by;
+  portEXIT_CRITICAL(&metricsMux);
+}
+
+void metricSet(MetricGauge gauge, int32_t value) {
+  if (gauge >= METRIC_GAUGE_COUNT) {
+    return;
+  }
+  portENTER_CRITICAL(&metricsMux);
+  gauges[gauge] = value;
+  portEXIT_CRITICAL(&metricsMux);
+}
+
+void metricsSampleBattery(int millivolts, int percent) {
+  metricSet(METRIC_BATTERY_MV, millivolts);
+  metricSet(METRIC_BATTERY_PERCENT, percent);
+
+  unsigned long now = millis();
+  if (batterySampled && now - lastBatterySampleMs < METRICS_BATTERY_SAMPLE_MS) {
+    return;
+  }
+  batterySampled = true;
+  lastBatterySampleMs = now;
+
+  // Full ring: the oldest unsent sample makes way
+  portENTER_CRITICAL(&metricsMux);
+  batteryCurve[batteryNext] = (uint16_t)constrain(millivolts, 0, 65535);
+  batteryNext = (batteryNext + 1) % METRICS_BATTERY_SAMPLES;
+  if (batteryCount < METRICS_BATTERY_SAMPLES) {
+    batteryCount++;
+  }
+  portEXIT_CRITICAL(&metricsMux);
+}
+
+// Fill batchDoc from a snapshot of the registry
+static void buildBatch(const uint32_t *sent, const int32_t *gaugeValues,
+                       const uint16_t *curve, uint8_t curveCount) {
+  batchDoc.clear();
+  batchDoc["v"] = METRICS_VERSION;
+  batchDoc["up"] = millis() / 1000;
+  batchDoc["reset"] = (int)esp_reset_reason();
+
+  JsonObject c = batchDoc.createNestedObject("c");
+  for (uint8_t i = 0; i < METRIC_COUNTER_COUNT; i++) {
+    if (sent[i] > 0) {
+      c[COUNTER_NAMES[i]] = sent[i];
+    }
+  }
+
+  JsonObject g = batchDoc.createNestedObject("g");
+  g["heapFree"] = ESP.getFreeHeap();
+  g["heapMin"] = ESP.getMinFreeHeap();
+  g["heapBlock"] = ESP.getMaxAllocHeap();
+  g["rssi"] = WiFi.RSSI();
+  for (uint8_t i = 0; i < METRIC_GAUGE_COUNT; i++) {
+    g[GAUGE_NAMES[i]] = gaugeValues[i];
+  }
+
+  JsonObject h = batchDoc.createNestedObject("h");
+  for (uint8_t zone = 0; zone < PROFILE_ZONE_COUNT; zone++) {
+    ProfileSummary s = profileSummary((ProfileZone)zone);
+    if (s.count == 0) {
+      continue;
+    }
+    JsonArray values = h.createNestedArray(profileZoneName((ProfileZone)zone));
+    values.add(s.count);
+    values.add(s.p50Us);
+    values.add(s.p95Us);
+    values.add(s.p99Us);
+    values.add(s.maxUs);
+  }
+
+  if (curveCount > 0) {
+    JsonObject battery = batchDoc.createNestedObject("battery");
+    battery["every"] = METRICS_BATTERY_SAMPLE_MS / 1000;
+    JsonArray mv = battery.createNestedArray("mv");
+    for (uint8_t i = 0; i < curveCount; i++) {
+      mv.add(curve[i]);
+    }
+  }
+}
+
+bool metricsUploadIfDue(const char *deviceId) {
+  unsigned long now = millis();
+  unsigned long wait = lastUploadFailed ? METRICS_RETRY_MS : METRICS_FLUSH_MS;
+  if (uploadAttempted && now - lastUploadMs < wait) {
+    return true;
+  }
+  uploadAttempted = true;
+  lastUploadMs = now;
+
+  uint32_t sent[METRIC_COUNTER_COUNT];
+  int32_t gaugeValues[METRIC_GAUGE_COUNT];
+  uint16_t curve[METRICS_BATTERY_SAMPLES];
+  uint8_t curveCount;
+  portENTER_CRITICAL(&metricsMux);
+  memcpy(sent, counters, sizeof(sent));
+  memcpy(gaugeValues, gauges, sizeof(gaugeValues));
+  curveCount = batteryCount;
+  for (uint8_t i = 0; i < curveCount; i++) {
+    curve[i] = batteryCurve[(batteryNext + METRICS_BATTERY_SAMPLES - curveCount + i) % METRICS_BATTERY_SAMPLES];
+  }
+  portEXIT_CRITICAL(&metricsMux);
+
+  buildBatch(sent, gaugeValues, curve, curveCount);
+  String payload;
+  payload.reserve(measureJson(batchDoc) + 1);
+  serializeJson(batchDoc, payload);
+
+  bool ok = false;
+  HTTPClient http;
+  if (apiBegin(http, "/api/device/metrics?deviceId=" + String(deviceId))) {
+    http.addHeader("Content-Type", "application/json");
+    int httpCode = apiPost(http, payload);
+    ok = httpCode >= 200 && httpCode < 300;
+    if (ok) {
+      if (responseFilter.isNull()) {
+        responseFilter["success"] = true;
+      }
+      delete apiParse(http, 64, responseFilter);  // Read to the end for keep-alive
+    }
+    apiEnd(http, httpCode > 0);
+
+    Serial.print(F("📈 Metrics: "));
+    Serial.print(payload.length());
+    Serial.print(F(" bytes -> HTTP "));
+    Serial.println(httpCode);
+  }
+
+  lastUploadFailed = !ok;
+  if (!ok) {
+    metricIncrement(METRIC_UPLOAD_FAILURES);
+    return false;
+  }
+
+  // The server has these now; anything counted during the upload stays
+  portENTER_CRITICAL(&metricsMux);
+  for (uint8_t i = 0; i < METRIC_COUNTER_COUNT; i++) {
+    counters[i] -= sent[i];
+  }
+  batteryCount = batteryCount > curveCount ? batteryCount - curveCount : 0;
+  portEXIT_CRITICAL(&metricsMux);
+  return true;
+}
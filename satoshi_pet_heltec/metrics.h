@@ -0,0 +1,77 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+
+// Device metrics for fleet telemetry.
+//
+// Counters are bumped from the code paths they describe (from either task),
+// gauges hold the latest reading, and the timing histograms come from the
+// profiler (profiler.h). Everything lives in fixed arrays in RTC memory, so
+// counts survive deep sleep and the RAM cost never grows.
+//
+// When the server asks for it (metrics in the device config), the network
+// task POSTs one batch to /api/device/metrics every METRICS_FLUSH_MS, right
+// after a config poll while the TLS session is still open. Counters are
+// sent as deltas since the last accepted batch and zero counters are left
+// out, so a quiet device sends well under 1 KB:
+//
+//   {"v":1, "up":s, "reset":esp_reset_reason,
+//    "c":{"wifiReconnectAttempts":2, ...},
+//    "g":{"heapFree":..., "heapMin":..., "heapBlock":..., "rssi":...,
+//         "batteryMv":..., "batteryPct":..., "consecutiveConfig404s":...,
+//         "heapFragmentation":..., "minStackHeadroom":...},
+//    "h":{"loop":[count, p50, p95, p99, max], ...},   // µs, since boot
+//    "battery":{"every":s, "mv":[oldest ... newest]}}
+//
+// A batch that doesn't go through is rebuilt with the newer totals on a
+// later poll.
+
+#define METRICS_FLUSH_MS 900000UL           // 15 minutes between batches
+#define METRICS_RETRY_MS 300000UL           // After a failed upload
+#define METRICS_BATTERY_SAMPLE_MS 300000UL  // Battery curve resolution
+#define METRICS_BATTERY_SAMPLES 12          // One hour of curve per batch
+
+enum MetricCounter : uint8_t {
+  METRIC_BOOTS,                    // Cold boots (not deep-sleep wakes)
+  METRIC_WIFI_RECONNECT_ATTEMPTS,
+  METRIC_WIFI_RECONNECT_FAILURES,
+  METRIC_CONFIG_POLLS,
+  METRIC_CONFIG_FAILURES,
+  METRIC_CONFIG_404S,
+  METRIC_SPENDS_SYNCED,
+  METRIC_SPEND_SYNCS_INCOMPLETE,   // Sync passes that left spends pending
+  METRIC_SCORES_SUBMITTED,
+  METRIC_SCORE_FAILURES,
+  METRIC_SLOW_LOOPS,               // loop() gaps over 500ms
+  METRIC_UPLOAD_FAILURES,          // Telemetry batches that didn't go through
+  METRIC_HEAP_ALARMS,              // Fragmentation or low-stack alarms raised
+  METRIC_COUNTER_COUNT
+};
+
+enum MetricGauge : uint8_t {
+  METRIC_BATTERY_MV,
+  METRIC_BATTERY_PERCENT,
+  METRIC_CONSECUTIVE_CONFIG_404S,
+  METRIC_HEAP_FRAGMENTATION,       // Percent, from heap_monitor.h
+  METRIC_MIN_STACK_HEADROOM,       // Bytes, lowest of the watched tasks
+  METRIC_GAUGE_COUNT
+};
+
+// Count a cold boot (call once from setup())
+void metricsBegin();
+
+// After a deep-sleep wake: move the millis() timestamps into this boot
+void metricsResume();
+
+void metricIncrement(MetricCounter counter, uint32_t by = 1);
+void metricSet(MetricGauge gauge, int32_t value);
+
+// Battery reading from the UI task; also feeds the battery curve
+void metricsSampleBattery(int millivolts, int percent);
+
+// Network task, after a config poll: upload a batch if one is due.
+// Returns false if an upload was attempted and failed.
+bool metricsUploadIfDue(const char *deviceId);
+
+#endif
@@ -0,0 +1,302 @@
+#include "net_task.h"
+#include "config.h"
+#include "economy.h"
+#include "api_client.h"
+#include "dns_cache.h"
+#include "profiler.h"
+#include "metrics.h"
+#include "heap_monitor.h"
+#include <WiFi.h>
+#include <esp_task_wdt.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+
+#define NET_TASK_CORE 0             // Arduino loop() runs on core 1
+#define NET_TASK_STACK 8192         // TLS handshake + ArduinoJson documents
+#define NET_TASK_PRIORITY 1
+#define NET_REQUEST_QUEUE_LEN 6
+#define NET_RESULT_QUEUE_LEN 6
+
+// WiFi reconnection with exponential backoff
+static const int WIFI_MAX_QUICK_RETRIES = 5;  // After 5 quick failures, slow down significantly
+static const unsigned long WIFI_MIN_BACKOFF_MS = 5000;  // Start with 5 seconds between attempts
+static const unsigned long WIFI_MAX_BACKOFF_MS = 300000;  // Max 5 minutes between attempts
+static unsigned long lastWifiReconnectAttempt = 0;
+static int wifiReconnectAttempts = 0;
+
+static TaskHandle_t netTaskHandle = NULL;
+static QueueHandle_t requestQueue = NULL;
+static QueueHandle_t resultQueue = NULL;   // Async results, drained by netReceive()
+static QueueHandle_t replyQueue = NULL;    // Single reply slot for netTransact()
+static uint32_t nextSeq = 1;
+
+// Requests queued or in progress. Counted before the request is queued (and
+// taken back if that fails), so the network task can't finish one before
+// it was counted.
+static portMUX_TYPE pendingMux = portMUX_INITIALIZER_UNLOCKED;
+static uint8_t pendingCount = 0;
+
+static void addPending(int delta) {
+  portENTER_CRITICAL(&pendingMux);
+  pendingCount += delta;
+  portEXIT_CRITICAL(&pendingMux);
+}
+
+// Calculate exponential backoff delay for WiFi reconnection
+static unsigned long getWifiBackoffDelay() {
+  if (wifiReconnectAttempts == 0) return WIFI_MIN_BACKOFF_MS;
+
+  // Exponential backoff: 5s, 10s, 20s, 40s, 80s, then cap at 5 min
+  unsigned long delay = WIFI_MIN_BACKOFF_MS << min(wifiReconnectAttempts, 6);
+  return min(delay, WIFI_MAX_BACKOFF_MS);
+}
+
+// Bring WiFi back up if it dropped. Blocks this task for up to 3s, which is
+// fine here - the UI keeps running on the other core.
+static bool ensureWifi() {
+  if (WiFi.status() == WL_CONNECTED) {
+    if (wifiReconnectAttempts > 0) {
+      wifiReconnectAttempts = 0;
+      Serial.println(F("✅ WiFi connection restored"));
+    }
+    return true;
+  }
+
+  // Not time yet - skip this request
+  unsigned long now = millis();
+  if (lastWifiReconnectAttempt > 0 && now - lastWifiReconnectAttempt < getWifiBackoffDelay()) {
+    return false;
+  }
+
+  wifiReconnectAttempts++;
+  lastWifiReconnectAttempt = now;
+  metricIncrement(METRIC_WIFI_RECONNECT_ATTEMPTS);
+
+  Serial.print(F("📶 WiFi reconnect attempt #"));
+  Serial.print(wifiReconnectAttempts);
+  Serial.print(F(" (next in "));
+  Serial.print(getWifiBackoffDelay() / 1000);
+  Serial.println(F("s)"));
+
+  // After many failures, suggest config portal
+  if (wifiReconnectAttempts >= WIFI_MAX_QUICK_RETRIES && wifiReconnectAttempts % 5 == 0) {
+    Serial.println(F("💡 Tip: Hold PRG button 5 seconds to enter WiFi setup"));
+  }
+
+  WiFi.mode(WIFI_STA);
+  WiFi.begin();  // Try with saved credentials
+
+  unsigned long wifiWaitStart = millis();
+  while (WiFi.status() != WL_CONNECTED && millis() - wifiWaitStart < 3000) {
+    vTaskDelay(pdMS_TO_TICKS(100));
+    esp_task_wdt_reset();
+  }
+
+  if (WiFi.status() == WL_CONNECTED) {
+    Serial.println(F("✅ WiFi reconnected!"));
+    wifiReconnectAttempts = 0;
+    return true;
+  }
+
+  Serial.println(F("❌ WiFi reconnect failed"));
+  metricIncrement(METRIC_WIFI_RECONNECT_FAILURES);
+  WiFi.disconnect(true);
+  WiFi.mode(WIFI_OFF);  // Turn off to save power between attempts
+  return false;
+}
+
+static void runRequest(const NetRequest &req, NetResult &result) {
+  ProfileScope scope(PROFILE_NETWORK);
+  HeapScope heapScope(req.type == NET_REQ_SYNC_SPENDS ? HEAP_SITE_SYNC : HEAP_SITE_FETCH);
+  DynamicJsonDocument *doc = nullptr;
+
+  switch (req.type) {
+    case NET_REQ_CONFIG_POLL:
+      if (!ensureWifi()) {
+        result.httpCode = NET_NO_WIFI;
+        break;
+      }
+      result.httpCode = requestGanamosConfig(req.deviceId, req.pairingCode, doc);
+      // Telemetry rides on the session the poll just used
+      if (req.metrics && result.httpCode > 0) {
+        metricsUploadIfDue(req.deviceId);
+      }
+      break;
+
+    case NET_REQ_FETCH_JOBS:
+      result.httpCode = requestJobs(req.deviceId, doc);
+      break;
+
+    case NET_REQ_SYNC_SPENDS:
+      result.count = syncPendingSpends(req.deviceId, req.batchSync);
+      result.ok = true;
+      break;
+
+    case NET_REQ_SUBMIT_SCORE:
+      result.httpCode = requestGameScore(req.deviceId, req.score, req.flapLog, doc);
+      break;
+
+    case NET_REQ_JOB_COMPLETE:
+      result.httpCode = requestJobComplete(req.deviceId, req.jobId, result.ok);
+      break;
+
+    case NET_REQ_WIFI_OFF:
+      apiDisconnect();
+      WiFi.disconnect(true);
+      WiFi.mode(WIFI_OFF);
+      result.ok = true;
+      break;
+  }
+
+  if (result.httpCode == 200 && doc) {
+    result.doc = doc;
+    result.ok = true;
+  } else {
+    delete doc;
+  }
+}
+
+static void netTask(void *) {
+  esp_task_wdt_add(NULL);
+
+  NetRequest req;
+  for (;;) {
+    esp_task_wdt_reset();
+    if (xQueueReceive(requestQueue, &req, pdMS_TO_TICKS(1000)) != pdTRUE) {
+      dnsCacheMaintain();  // Idle - refresh the server address off the request path
+      continue;
+    }
+
+    NetResult result;
+    result.type = req.type;
+    result.seq = req.seq;
+    result.httpCode = 0;
+    result.ok = false;
+    result.count = 0;
+    result.doc = nullptr;
+
+    unsigned long start = millis();
+    runRequest(req, result);
+    result.elapsedMs = millis() - start;
+    esp_task_wdt_reset();
+
+    QueueHandle_t target = req.blocking ? replyQueue : resultQueue;
+    if (req.blocking) {
+      // A caller that timed out may have left a stale reply behind
+      NetResult stale;
+      while (xQueueReceive(replyQueue, &stale, 0) == pdTRUE) {
+        netFreeResult(stale);
+      }
+    }
+    if (xQueueSend(target, &result, pdMS_TO_TICKS(1000)) != pdTRUE) {
+      Serial.println(F("⚠️ Net: Result queue full - dropping result"));
+      if (result.type == NET_REQ_CONFIG_POLL) {
+        forgetConfigValidator();  // A later 304 would point at a body nobody parsed
+      }
+      netFreeResult(result);
+    }
+
+    addPending(-1);
+  }
+}
+
+void netTaskBegin() {
+  if (requestQueue) {
+    return;
+  }
+
+  requestQueue = xQueueCreate(NET_REQUEST_QUEUE_LEN, sizeof(NetRequest));
+  resultQueue = xQueueCreate(NET_RESULT_QUEUE_LEN, sizeof(NetResult));
+  replyQueue = xQueueCreate(1, sizeof(NetResult));
+
+  xTaskCreatePinnedToCore(netTask, "net", NET_TASK_STACK, NULL, NET_TASK_PRIORITY, &netTaskHandle,
+                          NET_TASK_CORE);
+  heapMonitorWatchTask(netTaskHandle, NET_TASK_STACK);
+  Serial.println(F("📡 Network task started on core 0"));
+}
+
+void netRequestInit(NetRequest &req, NetRequestType type) {
+  memset(&req, 0, sizeof(req));
+  req.type = type;
+  strncpy(req.deviceId, ganamosConfig.deviceId.c_str(), sizeof(req.deviceId) - 1);
+  strncpy(req.pairingCode, pairingCode.c_str(), sizeof(req.pairingCode) - 1);
+  req.batchSync = ganamosConfig.batchSyncSupported;
+  req.metrics = ganamosConfig.metricsSupported;
+}
+
+bool netSubmit(NetRequest &req) {
+  if (!requestQueue) {
+    return false;
+  }
+
+  req.seq = nextSeq++;
+  req.blocking = false;
+  addPending(1);
+  if (xQueueSend(requestQueue, &req, 0) != pdTRUE) {
+    addPending(-1);
+    Serial.println(F("⚠️ Net: Request queue full"));
+    return false;
+  }
+  return true;
+}
+
+bool netReceive(NetResult &result) {
+  if (!resultQueue) {
+    return false;
+  }
+  return xQueueReceive(resultQueue, &result, 0) == pdTRUE;
+}
+
+bool netTransact(NetRequest &req, NetResult &result, uint32_t timeoutMs) {
+  if (!requestQueue) {
+    return false;
+  }
+
+  req.seq = nextSeq++;
+  req.blocking = true;
+  addPending(1);
+  if (xQueueSend(requestQueue, &req, pdMS_TO_TICKS(1000)) != pdTRUE) {
+    addPending(-1);
+    Serial.println(F("⚠️ Net: Request queue full"));
+    return false;
+  }
+
+  unsigned long start = millis();
+  while (millis() - start < timeoutMs) {
+    esp_task_wdt_reset();
+    if (xQueueReceive(replyQueue, &result, pdMS_TO_TICKS(100)) == pdTRUE) {
+      if (result.seq == req.seq) {
+        return true;
+      }
+      netFreeResult(result);  // Reply to an earlier call that timed out
+    }
+  }
+
+  Serial.println(F("⚠️ Net: Timed out waiting for network task"));
+  return false;
+}
+
+void netFreeResult(NetResult &result) {
+  if (result.doc) {
+    delete result.doc;
+    result.doc = nullptr;
+  }
+}
+
+uint8_t getNetPendingCount() {
+  portENTER_CRITICAL(&pendingMux);
+  uint8_t count = pendingCount;
+  portEXIT_CRITICAL(&pendingMux);
+  return count;
+}
+
+bool netIsIdle() {
+  // The count drops once the result is queued, so check the queue too
+  return getNetPendingCount() == 0 && (!resultQueue || uxQueueMessagesWaiting(resultQueue) == 0);
+}
+
+void netResetWifiBackoff() {
+  wifiReconnectAttempts = 0;
+  lastWifiReconnectAttempt = 0;
+}
@@ -0,0 +1,87 @@
+#ifndef NET_TASK_H
+#define NET_TASK_H
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "game_replay.h"
+
+// Network worker task.
+//
+// All WiFi and HTTP work runs on a FreeRTOS task pinned to core 0 (the
+// Arduino loop runs on core 1), so a slow TLS handshake or server never
+// stalls rendering or button handling. The UI posts typed requests through
+// a queue and picks up results with netReceive() on a later loop pass.
+//
+// The worker only does network I/O. Response bodies are parsed straight off
+// the socket into a filtered JSON document and handed back to the UI task,
+// which copies them into ganamosConfig / cachedJobs, so shared state is only
+// ever written from one task.
+
+enum NetRequestType : uint8_t {
+  NET_REQ_CONFIG_POLL,    // GET /api/device/config (reconnects WiFi if needed)
+  NET_REQ_FETCH_JOBS,     // GET /api/device/jobs
+  NET_REQ_SYNC_SPENDS,    // Sync the pending spend queue (economy.cpp)
+  NET_REQ_SUBMIT_SCORE,   // POST /api/device/game-score
+  NET_REQ_JOB_COMPLETE,   // POST /api/device/job-complete
+  NET_REQ_WIFI_OFF        // Close the API session and switch WiFi off
+};
+
+// httpCode reported when the request was skipped because WiFi is down
+#define NET_NO_WIFI -100
+
+struct NetRequest {
+  NetRequestType type;
+  uint32_t seq;             // Filled in by netSubmit()/netTransact()
+  bool blocking;            // Reply goes to the caller of netTransact()
+  // Copied from shared state on the UI task so the worker never reads Strings
+  // that the UI may be reassigning
+  char deviceId[40];
+  char pairingCode[8];
+  bool batchSync;
+  bool metrics;             // NET_REQ_CONFIG_POLL: upload a telemetry batch if due
+  int score;                // NET_REQ_SUBMIT_SCORE
+  const FlapLog *flapLog;   // ...its proof (or nullptr); must outlive the request
+  char jobId[40];           // NET_REQ_JOB_COMPLETE
+};
+
+struct NetResult {
+  NetRequestType type;
+  uint32_t seq;
+  int httpCode;             // Last HTTP status (negative = transport error)
+  bool ok;                  // Request-specific success flag
+  int count;                // NET_REQ_SYNC_SPENDS: number of spends synced
+  DynamicJsonDocument *doc; // Parsed response (200 only), owned by the receiver
+  unsigned long elapsedMs;  // Time the worker spent on the request
+};
+
+// Create the request/result queues and start the worker on core 0
+void netTaskBegin();
+
+// Fill a request of the given type with the current deviceId/pairing code
+void netRequestInit(NetRequest &req, NetRequestType type);
+
+// Queue a request without waiting. The result arrives via netReceive().
+// Returns false if the queue is full.
+bool netSubmit(NetRequest &req);
+
+// Take the next finished async result, if any (never blocks).
+// Call netFreeResult() once done with it.
+bool netReceive(NetResult &result);
+
+// Queue a request and wait for its result (feeds the watchdog while waiting).
+// For user-initiated screens that show a loading message anyway.
+bool netTransact(NetRequest &req, NetResult &result, uint32_t timeoutMs = 20000);
+
+// Release the parsed response
+void netFreeResult(NetResult &result);
+
+// Requests queued or in progress
+uint8_t getNetPendingCount();
+
+// Nothing queued, in progress, or waiting to be picked up by netReceive()
+bool netIsIdle();
+
+// Forget WiFi reconnect failures (after the config portal connects)
+void netResetWifiBackoff();
+
+#endif
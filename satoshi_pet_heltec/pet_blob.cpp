@@ -10,10 +10,19 @@
 #include <esp_task_wdt.h>
 #include "pet_blob.h"
 #include "config.h"
+#include "economy.h"
 #include <WiFi.h>
 #include "pet_sprites_simple.h"
 #include "display_assets.h"
 #include "food_bitmaps.h"
+#include "display_flush.h"
+#include "sound_engine.h"
+#include "button_handler.h"
+#include "power_manager.h"
+#include "flappy_engine.h"
+#include "game_replay.h"
+#include "profiler.h"
+#include "heap_monitor.h"
 // Removed unused animation variables 
 
 // Forward declarations
@@ -49,7 +58,7 @@ int eatAnimLoopsCompleted = 0;
 const int EAT_ANIM_TOTAL_LOOPS = 5;  // Number of eat animation cycles
 
    const uint8_t* getCurrentPetSprite(String animation) {
-     return getPetSprite(ganamosConfig.petType, ANIM_DEFAULT, 0); // Use default animation frame 0 for static contexts
+     return getPetSprite(ganamosConfig.petKind, ANIM_DEFAULT, 0); // Use default animation frame 0 for static contexts
    }
 
 struct FoodOption {
@@ -106,19 +115,12 @@ static int clampFoodIndex(int index) {
 static const FoodOption* getPetFoodOptions() {
   extern GanamosConfig ganamosConfig;
   
-  if (ganamosConfig.petType == "cat") {
-    return CAT_FOOD_OPTIONS;
-  } else if (ganamosConfig.petType == "dog") {
-    return DOG_FOOD_OPTIONS;
-  } else if (ganamosConfig.petType == "rabbit") {
-    return RABBIT_FOOD_OPTIONS;
-  } else if (ganamosConfig.petType == "squirrel") {
-    return SQUIRREL_FOOD_OPTIONS;
-  } else if (ganamosConfig.petType == "turtle") {
-    return TURTLE_FOOD_OPTIONS;
-  } else {
-    // Default to cat food if pet type is unknown
-    return CAT_FOOD_OPTIONS;
+  switch (ganamosConfig.petKind) {
+    case PET_DOG: return DOG_FOOD_OPTIONS;
+    case PET_BUNNY: return RABBIT_FOOD_OPTIONS;
+    case PET_SQUIRREL: return SQUIRREL_FOOD_OPTIONS;
+    case PET_TURTLE: return TURTLE_FOOD_OPTIONS;
+    default: return CAT_FOOD_OPTIONS; // Cat, and pets without their own menu
   }
 }
 
@@ -158,7 +160,7 @@ void triggerCelebration(int earnedSats, String message = "") {
   extern unsigned long lastButtonPress;
   extern bool isScreensaverActive;
   extern uint8_t NORMAL_BRIGHTNESS;
-  extern SSD1306Wire display;
+  extern DirtyTrackingDisplay display;
   
   lastButtonPress = millis();
   extern bool isDisplayOff;
@@ -190,7 +192,7 @@ void triggerNewJobNotification(String title, int reward) {
   extern bool isScreensaverActive;
   extern bool isDisplayOff;
   extern bool isBitcoinFactsActive;
-  extern SSD1306Wire display;
+  extern DirtyTrackingDisplay display;
   
   lastButtonPress = millis();
   
@@ -263,7 +265,7 @@ void triggerRejection(String message) {
   lastButtonPress = millis();
   if (isScreensaverActive) {
     isScreensaverActive = false;
-    extern SSD1306Wire display;
+    extern DirtyTrackingDisplay display;
     extern void setOLEDContrast(uint8_t);
     setOLEDContrast(NORMAL_BRIGHTNESS);
   }
@@ -292,7 +294,7 @@ void renderRejection(SSD1306Wire &display) {
   // Context message: "for [post title]"
   String contextMsg;
   if (ganamosConfig.rejectionPostTitle.length() > 0) {
-    contextMsg = "for " + ganamosConfig.rejectionPostTitle;
+    contextMsg = "for " + String(ganamosConfig.rejectionPostTitle);
   } else if (rejectionMessage.length() > 0) {
     contextMsg = rejectionMessage;
   } else {
@@ -343,13 +345,8 @@ void renderScreensaver(SSD1306Wire &display, int satoshis) {
   
   // Draw pet sprite centered and moved up
   int spriteFrame = (screensaverFrame / 2) % 3;
-  const uint8_t* sprite = getPetSprite(ganamosConfig.petType, ANIM_DEFAULT, spriteFrame);
-  
-  // Handle bunny's different dimensions (default is 50x50)
-  int spriteWidth = (ganamosConfig.petType == "bunny" || ganamosConfig.petType == "rabbit") ? BUNNY_DEFAULT_WIDTH : SPRITE_WIDTH;
-  int spriteHeight = (ganamosConfig.petType == "bunny" || ganamosConfig.petType == "rabbit") ? BUNNY_DEFAULT_HEIGHT : SPRITE_HEIGHT;
-  
-  display.drawXbm(34, 6, spriteWidth, spriteHeight, sprite);
+  const SpriteAnimation& anim = getPetAnimation(ganamosConfig.petKind, ANIM_DEFAULT);
+  display.drawXbm(34, 6, anim.width, anim.height, anim.frames[spriteFrame % anim.count]);
   
   // Draw floating bitcoin coins at different positions
   int coinFrame = screensaverFrame % 4;
@@ -418,16 +415,16 @@ void renderCelebration(SSD1306Wire &display) {
   
   if (isFixReward && ganamosConfig.lastPostTitle.length() > 0) {
     // Fix reward: show "fix: [post title]"
-    contextMsg = "fix: " + ganamosConfig.lastPostTitle;
+    contextMsg = "fix: " + String(ganamosConfig.lastPostTitle);
   } else if (isTransfer && ganamosConfig.lastSenderName.length() > 0) {
     // Internal transfer: show "sent from [sender name]"
-    contextMsg = "sent from " + ganamosConfig.lastSenderName;
+    contextMsg = "sent from " + String(ganamosConfig.lastSenderName);
   } else if (celebrationMessage.length() > 0 && celebrationMessage != "null") {
     // Fallback to celebration message
     contextMsg = celebrationMessage;
   } else {
     // Default fallback
-    contextMsg = ganamosConfig.petName + " is happy!";
+    contextMsg = String(ganamosConfig.petName) + " is happy!";
   }
   
   // Truncate long messages to fit on screen
@@ -444,7 +441,7 @@ void renderCelebration(SSD1306Wire &display) {
   display.drawXbm(110, 36, 8, 8, bitcoin_spin_frames[(frame + 3) % 4]);
   
   // Additional happy message at bottom
-  display.drawString(64, 48, ganamosConfig.petName + " is happy!");
+  display.drawString(64, 48, String(ganamosConfig.petName) + " is happy!");
   
   display.display();
 }
@@ -469,7 +466,8 @@ void updatePetMood(int price, int sats) {
   lastPrice = price;
 }
 
-PetStats petStats = {50, 50, 0, false, 0, 0, 0}; // happiness, fullness, age, sleeping, lastFeed, lastActivity, lastUpdate (7 values total)
+// In RTC memory so deep sleep doesn't lose it (see resumePetStats)
+RTC_DATA_ATTR PetStats petStats = {50, 50, 0, false, 0, 0, 0}; // happiness, fullness, age, sleeping, lastFeed, lastActivity, lastUpdate (7 values total)
 
 void updatePetStats(int newBalance, int oldBalance) {
   unsigned long now = millis();
@@ -525,10 +523,12 @@ String getPetAnimation() {
 }
 
 void renderPet(SSD1306Wire &display, int btcPrice, int satoshis, int batteryPercent) {
-  unsigned long funcStart = millis();
-  static int oldBalance = -1; // Initialize to -1 to detect first balance
-  static bool firstRun = true;
-  static bool firstSyncAfterBoot = true; // Skip celebration on first sync after boot
+  uint32_t funcStartUs = micros();
+  HeapScope heapScope(HEAP_SITE_RENDER);
+  // Kept across deep sleep - sats earned while asleep still get celebrated
+  RTC_DATA_ATTR static int oldBalance = -1; // Initialize to -1 to detect first balance
+  RTC_DATA_ATTR static bool firstRun = true;
+  RTC_DATA_ATTR static bool firstSyncAfterBoot = true; // Skip celebration on first sync after boot
   static unsigned long lastFrameUpdate = 0;
   static int currentAnimFrame = 0;
   
@@ -575,7 +575,7 @@ void renderPet(SSD1306Wire &display, int btcPrice, int satoshis, int batteryPerc
       int earned = satoshis - oldBalance;
       // Normal operation - celebrate the earnings!
       Serial.println("🎉 BALANCE INCREASED! Old: " + String(oldBalance) + " New: " + String(satoshis) + " Earned: " + String(earned));
-      triggerCelebration(earned, ganamosConfig.lastMessage);
+      triggerCelebration(earned, ganamosConfig.lastMessage.c_str());
     }
     
     // ALWAYS save the current balance and coins to flash (not just on increases)
@@ -632,11 +632,7 @@ void renderPet(SSD1306Wire &display, int btcPrice, int satoshis, int batteryPerc
     // Handle eat animation looping (3 complete loops then back to default/sad)
     if (currentAnimState == ANIM_EAT) {
       // Get frame count for current pet's eat animation
-      int maxFrames = (ganamosConfig.petType == "cat") ? CAT_EAT_FRAMES :
-                      (ganamosConfig.petType == "dog") ? DOG_EAT_FRAMES :
-                      (ganamosConfig.petType == "squirrel") ? SQUIRREL_EAT_FRAMES :
-                      (ganamosConfig.petType == "turtle") ? TURTLE_EAT_FRAMES :
-                      (ganamosConfig.petType == "rabbit" || ganamosConfig.petType == "bunny") ? BUNNY_EAT_FRAMES : 8;
+      int maxFrames = getPetAnimation(ganamosConfig.petKind, ANIM_EAT).count;
       
       if (currentAnimFrame >= maxFrames) {
         eatAnimLoopsCompleted++;
@@ -658,15 +654,10 @@ void renderPet(SSD1306Wire &display, int btcPrice, int satoshis, int batteryPerc
     lastFrameUpdate = now;
   }
   
-  unsigned long preDrawTime = millis() - funcStart;
-  if (preDrawTime > 50) {
-    Serial.print(F("Pre-draw logic took "));
-    Serial.print(preDrawTime);
-    Serial.println(F("ms"));
-  }
+  profileRecord(PROFILE_PHYSICS, micros() - funcStartUs);
   
   // Normal display
-  unsigned long drawStart = millis();
+  uint32_t drawStartUs = micros();
   display.clear();
   display.setFont(ArialMT_Plain_10);
 
@@ -674,7 +665,7 @@ void renderPet(SSD1306Wire &display, int btcPrice, int satoshis, int batteryPerc
   display.setTextAlignment(TEXT_ALIGN_LEFT);
   
   // Top left: Pet name
-  display.drawString(0, 0, ganamosConfig.petName);
+  display.drawString(0, 0, ganamosConfig.petName.c_str());
   
   // // Top right: Lightning bolt icon + Battery percentage (above pet sprite which starts at y=12)
   // // Calculate position: text is right-aligned, icon is to the left of text
@@ -766,50 +757,12 @@ void renderPet(SSD1306Wire &display, int btcPrice, int satoshis, int batteryPerc
   // Right side: Draw pet sprite - position varies by pet type (60x51px, bunny varies)
   display.setTextAlignment(TEXT_ALIGN_CENTER);
   
-  // Get the appropriate sprite for the pet type with animation frame
-  const uint8_t* sprite = getPetSprite(ganamosConfig.petType, currentAnimState, currentAnimFrame);
-  
-    // Determine sprite dimensions based on pet type and animation state
-  int spriteWidth, spriteHeight, spriteX;
-  if (ganamosConfig.petType == "bunny" || ganamosConfig.petType == "rabbit") {
-    // Bunny: default is 50x50, eat/sad/die are 55x55
-    if (currentAnimState == ANIM_DEFAULT) {
-      spriteWidth = BUNNY_DEFAULT_WIDTH;   // 50
-      spriteHeight = BUNNY_DEFAULT_HEIGHT; // 50
-    } else {
-      spriteWidth = BUNNY_SPRITE_WIDTH;   // 55
-      spriteHeight = BUNNY_SPRITE_HEIGHT; // 55
-    }
-    spriteX = 64; // Bunny position (moved 8px left from 72)
-  } else if (ganamosConfig.petType == "owl") {
-    // Owl: all animations are 50x50
-    spriteWidth = 50;
-    spriteHeight = 50;
-    spriteX = 64; // Same position as bunny (fits similar size)
-  } else {
-    // Cat, dog, squirrel, turtle are all 60x51
-    spriteWidth = SPRITE_WIDTH;   // 60
-    spriteHeight = SPRITE_HEIGHT; // 51
-    spriteX = 54; // Other pets position (moved 8px left from 62)
-  }
-  
-  display.drawXbm(spriteX, 12, spriteWidth, spriteHeight, sprite);
+  // Sprite, size and position for this pet and animation state
+  const SpriteAnimation& anim = getPetAnimation(ganamosConfig.petKind, currentAnimState);
+  display.drawXbm(anim.x, 12, anim.width, anim.height, anim.frames[currentAnimFrame % anim.count]);
 
-  unsigned long drawTime = millis() - drawStart;
-  if (drawTime > 50) {
-    Serial.print(F("Draw commands took "));
-    Serial.print(drawTime);
-    Serial.println(F("ms"));
-  }
-  
-  unsigned long dispStart = millis();
+  profileRecord(PROFILE_DRAW, micros() - drawStartUs);
   display.display();
-  unsigned long dispTime = millis() - dispStart;
-  if (dispTime > 50) {
-    Serial.print(F("display.display() took "));
-    Serial.print(dispTime);
-    Serial.println(F("ms"));
-  }
 }
 
 void renderMenu(SSD1306Wire &display, int menuOption) {
@@ -910,7 +863,7 @@ void renderJobsList(SSD1306Wire &display, int selectedJob, int scrollOffset) {
     }
     
     Job& job = cachedJobs[i];
-    String title = job.title;
+    String title = job.title.c_str();
     
     // Marquee scrolling for selected job if title is too long
     if (isSelected && title.length() > maxTitleChars) {
@@ -977,7 +930,7 @@ void renderJobDetail(SSD1306Wire &display, int jobIndex) {
   display.setTextAlignment(TEXT_ALIGN_LEFT);
   
   // Title - word wrap up to 3 lines
-  String title = job.title;
+  String title = job.title.c_str();
   int titleY = 0;
   int maxCharsPerLine = 21;  // ~128px / 6px per char
   int linesUsed = 0;
@@ -1009,11 +962,11 @@ void renderJobDetail(SSD1306Wire &display, int jobIndex) {
   
   // Location and date on bottom line
   display.setFont(ArialMT_Plain_10);
-  String location = job.location;
+  String location = job.location.c_str();
   if (location.length() > 14) {
     location = location.substring(0, 12) + "..";
   }
-  String dateStr = formatJobDate(job.createdAt);
+  String dateStr = formatJobDate(job.createdAt.c_str());
   // Show location/date OR instruction (alternate or just show instruction)
   display.drawString(0, 54, "Press:Back  Hold:Done");  
   display.display();
@@ -1049,8 +1002,7 @@ void handleJobsMenu(SSD1306Wire &display) {
   int scrollOffset = 0;  // Which job is at the top of the visible list
   bool inJobsMenu = true;
   unsigned long lastJobCycle = millis();
-  bool buttonPressed = false;
-  unsigned long buttonPressTime = 0;
+  ButtonState jobButtons = {};
   
   // Reset marquee state
   jobsMarqueeOffset = 0;
@@ -1073,19 +1025,9 @@ void handleJobsMenu(SSD1306Wire &display) {
       break;
     }
     
-    // Read buttons
-    bool prgState = digitalRead(0) == LOW;      // BUTTON_PIN_PRG
-    bool externalState = digitalRead(2) == LOW;  // BUTTON_PIN_EXTERNAL
-    bool currentState = prgState || externalState;
-    
-    if (currentState && !buttonPressed) {
-      buttonPressed = true;
-      buttonPressTime = millis();
-    }
-    
-    if (!currentState && buttonPressed) {
-      unsigned long pressDuration = millis() - buttonPressTime;
-      buttonPressed = false;
+    // Read buttons (edges queued by the GPIO interrupts)
+    if (updateButtonState(jobButtons) && !jobButtons.pressed) {
+      unsigned long pressDuration = getPressDuration(jobButtons);
       lastJobCycle = millis();
       
       bool isShort = pressDuration <= SHORT_PRESS_MAX;
@@ -1132,25 +1074,14 @@ void handleJobsMenu(SSD1306Wire &display) {
         // Short press = back to list
         // Long press = mark as complete
         delay(300);  // Debounce
-        bool detailButtonPressed = false;
-        unsigned long detailButtonPressTime = 0;
+        ButtonState detailButtons = {};
         unsigned long detailStart = millis();
         bool inDetailView = true;
         
         while (inDetailView && (millis() - detailStart < 30000)) {  // 30s timeout
           esp_task_wdt_reset();
-          bool detailPrgState = digitalRead(0) == LOW;
-          bool detailExtState = digitalRead(2) == LOW;
-          bool detailState = detailPrgState || detailExtState;
-          
-          if (detailState && !detailButtonPressed) {
-            detailButtonPressed = true;
-            detailButtonPressTime = millis();
-          }
-          
-          if (!detailState && detailButtonPressed) {
-            unsigned long detailPressDuration = millis() - detailButtonPressTime;
-            detailButtonPressed = false;
+          if (updateButtonState(detailButtons) && !detailButtons.pressed) {
+            unsigned long detailPressDuration = getPressDuration(detailButtons);
             
             if (detailPressDuration >= HOLD_PRESS_MIN) {
               // Long press - show confirmation for marking complete
@@ -1169,24 +1100,13 @@ void handleJobsMenu(SSD1306Wire &display) {
               
               // Wait for confirmation
               delay(300);
-              bool confirmPressed = false;
-              unsigned long confirmPressTime = 0;
+              ButtonState confirmButtons = {};
               unsigned long confirmStart = millis();
               
               while (millis() - confirmStart < 10000) {  // 10s timeout for confirm
                 esp_task_wdt_reset(); 
-                bool confirmPrgState = digitalRead(0) == LOW;
-                bool confirmExtState = digitalRead(2) == LOW;
-                bool confirmState = confirmPrgState || confirmExtState;
-                
-                if (confirmState && !confirmPressed) {
-                  confirmPressed = true;
-                  confirmPressTime = millis();
-                }
-                
-                if (!confirmState && confirmPressed) {
-                  unsigned long confirmDuration = millis() - confirmPressTime;
-                  confirmPressed = false;
+                if (updateButtonState(confirmButtons) && !confirmButtons.pressed) {
+                  unsigned long confirmDuration = getPressDuration(confirmButtons);
                   
                   if (confirmDuration < SHORT_PRESS_MAX) {
                     // Short press = Confirm!
@@ -1203,7 +1123,7 @@ void handleJobsMenu(SSD1306Wire &display) {
 
                     // Call the API
                     extern bool markJobComplete(String jobId);
-                    bool success = markJobComplete(cachedJobs[selectedJob].id);
+                    bool success = markJobComplete(cachedJobs[selectedJob].id.c_str());
                     
                     // Show result
                     display.clear();
@@ -1276,7 +1196,7 @@ void renderFeedResult(SSD1306Wire &display, bool success, int foodIndex, bool ha
     
     // Pet name loves food message
     display.setFont(ArialMT_Plain_10);
-    String loveMessage = ganamosConfig.petName + " loves " + String(option.name);
+    String loveMessage = String(ganamosConfig.petName) + " loves " + String(option.name);
     display.drawString(64, 30, loveMessage);
     
     // Cost and fullness on one line with interpunct
@@ -1363,25 +1283,13 @@ static void flashRgbLed(int times, int onMs, int offMs) {
 }
 
 static void playHighScoreCelebrationTone() {
-  int melody[] = { 988, 1175, 1319, 1568 };
-  int durations[] = { 120, 120, 150, 220 };
-
-  for (int i = 0; i < 4; i++) {
-    tone(BUZZER_PIN, melody[i], durations[i]);
-    delay(durations[i] + 40);
-    noTone(BUZZER_PIN);
-  }
+  static const Note melody[] = { {988, 120, 40}, {1175, 120, 40}, {1319, 150, 40}, {1568, 220, 40} };
+  soundPlay(melody, 4, SOUND_PRIORITY_EVENT);
 }
 
 static void playGameOverWomp() {
-  int melody[] = { 392, 330, 262 };
-  int durations[] = { 200, 220, 300 };
-
-  for (int i = 0; i < 3; i++) {
-    tone(BUZZER_PIN, melody[i], durations[i]);
-    delay(durations[i] + 60);
-    noTone(BUZZER_PIN);
-  }
+  static const Note melody[] = { {392, 200, 60}, {330, 220, 60}, {262, 300, 60} };
+  soundPlay(melody, 3, SOUND_PRIORITY_EVENT);
 }
 
 static void renderLeaderboard(SSD1306Wire &display, const GameScoreResponse &response) {
@@ -1401,7 +1309,7 @@ static void renderLeaderboard(SSD1306Wire &display, const GameScoreResponse &res
     if (entry.isYou) {
       line += "You";
     } else {
-      line += entry.petName.length() > 0 ? entry.petName : "Pet";
+      line += entry.petName.length() > 0 ? entry.petName.c_str() : "Pet";
     }
     if (line.length() > 18) {
       line = line.substring(0, 18);
@@ -1448,8 +1356,7 @@ bool handleFeedPet(int foodIndex) {
   }
   
   // Spend coins locally (works offline, syncs when online)
-  extern bool spendCoinsLocal(int amount, const char* action);
-  bool success = spendCoinsLocal(foodCost, "feed");
+  bool success = spendCoinsLocal(foodCost, SPEND_ACTION_FEED);
   
   if (success) {
     int oldFullness = petStats.fullness;
@@ -1502,52 +1409,6 @@ void renderGameScreen(SSD1306Wire &display, int round, int score, unsigned long
   display.display();
 }
 
-struct DebouncedButton {
-  int pin;
-  bool lastStable = true;       // HIGH = not pressed (because of pull-up)
-  bool lastEdgeState = true;
-  unsigned long lastChange = 0;
-  unsigned long graceUntil = 0; // press buffer window (ms)
-  const unsigned long debounceMs = 25;
-  const unsigned long graceMs = 120;
-
-  void begin() {
-    pinMode(pin, INPUT_PULLUP);   // IMPORTANT for GPIO0
-    lastStable   = digitalRead(pin);
-    lastEdgeState = lastStable;
-  }
-
-  // Call every frame. Returns true exactly once per press (on the falling edge).
-  bool justPressed() {
-    bool reading = digitalRead(pin);
-    unsigned long now = millis();
-
-    if (reading != lastStable) {          // input changed -> debounce timer
-      lastChange = now;
-      lastStable = reading;
-    }
-
-    // Accept change only if stable for debounceMs
-    bool edgeFired = false;
-    if (now - lastChange > debounceMs) {
-      // Detect falling edge (HIGH -> LOW) = press
-      if (lastEdgeState == HIGH && lastStable == LOW) {
-        edgeFired = true;
-        graceUntil = now + graceMs;       // make it “hard” to miss while rendering
-      }
-      lastEdgeState = lastStable;
-    }
-
-    // Edge fires immediately; additionally, allow a late consumer to “see” it within grace window
-    if (edgeFired) return true;
-    if (graceUntil && now <= graceUntil) {
-      graceUntil = 0;                     // consume buffered press once
-      return true;
-    }
-    return false;
-  }
-};
-
 void renderInsufficientCoinsForGame(SSD1306Wire &display, int required, int available) {
   display.clear();
   display.setFont(ArialMT_Plain_16);
@@ -1563,6 +1424,43 @@ void renderInsufficientCoinsForGame(SSD1306Wire &display, int required, int avai
   display.display();
 }
 
+// Draw the game between two ticks: alpha256 = how far (0-255) real time has
+// moved from previous toward current
+static void renderFlappyFrame(SSD1306Wire &display, const FlappyState &previous,
+                              const FlappyState &current, uint32_t alpha256) {
+  uint32_t drawStartUs = micros();
+  display.clear();
+  for (int i = 0; i < FLAPPY_WALL_COUNT; i++) {
+    const FlappyWall &wall = current.walls[i];
+    int32_t x = wall.x;
+    // A wall that just wrapped to the right edge is drawn where it is now
+    if (previous.walls[i].x >= wall.x) {
+      x = previous.walls[i].x - (int32_t)((previous.walls[i].x - wall.x) * alpha256 / 256);
+    }
+    int wallX = x / FLAPPY_SUBPX;
+    if (wallX >= -FLAPPY_WALL_WIDTH && wallX < 128) {
+      // Lower wall from the bottom up, upper wall (if any) from the top down
+      display.fillRect(wallX, 64 - wall.wallHeight, FLAPPY_WALL_WIDTH, wall.wallHeight);
+      if (wall.topWallHeight > 0) {
+        display.fillRect(wallX, 0, FLAPPY_WALL_WIDTH, wall.topWallHeight);
+      }
+    }
+  }
+
+  // Same 16x16 game character for every pet type
+  int32_t petY = previous.petY + (int32_t)((current.petY - previous.petY) * (int32_t)alpha256 / 256);
+  int drawY = petY / FLAPPY_SUBPX;
+  if (drawY < 0) drawY = 0;
+  if (drawY + FLAPPY_PET_SIZE > 64) drawY = 64 - FLAPPY_PET_SIZE;
+  display.drawXbm(FLAPPY_PET_X, drawY, FLAPPY_PET_SIZE, FLAPPY_PET_SIZE, game_character_bitmap);
+
+  display.setFont(ArialMT_Plain_10);
+  display.setTextAlignment(TEXT_ALIGN_LEFT);
+  display.drawString(0, 0, "Score: " + String(current.score));
+  profileRecord(PROFILE_DRAW, micros() - drawStartUs);
+  display.display();
+}
+
 int handleLightningGame(SSD1306Wire &display) {
   extern GanamosConfig ganamosConfig;
   extern int getLocalCoins();
@@ -1581,45 +1479,20 @@ int handleLightningGame(SSD1306Wire &display) {
   }
   
   // Spend coins locally (offline-first)
-  extern bool spendCoinsLocal(int amount, const char* action);
   Serial.println("Spending " + String(ganamosConfig.gameCost) + " coins to play game (current coins: " + String(localCoins) + ")");
-  if (!spendCoinsLocal(ganamosConfig.gameCost, "game")) {
+  if (!spendCoinsLocal(ganamosConfig.gameCost, SPEND_ACTION_GAME)) {
     Serial.println("Failed to spend coins locally");
     return 0;
   }
   
   Serial.println("Starting Flappy Pet Game!");
   
-  // ===== Game constants (tuned for easier start, better progression) =====
-  const int PET_X = 25;
-  const int PET_SPRITE_HEIGHT = 16;
-  const int PET_SPRITE_WIDTH  = 16;
-  const float GRAVITY         = 0.25f;   // Reduced from 0.35f - slower falling for better control
-  const float FLAP_VELOCITY   = -3.5f;   // Reduced from -6.0f - smaller jump, need multiple clicks to reach top (like Flappy Bird)
-  const float MAX_FALL_SPEED  = 5.0f;    // Reduced from 6.5f - slower terminal velocity
-  const int   WALL_WIDTH      = 8;
-  const int   WALL_SPACING    = 120;     // Good spacing between walls
-  const float INITIAL_SPEED   = 0.9f;    // Increased from 0.5f for faster start
-  const float SPEED_INCREASE  = 0.025f;  // Gradual difficulty increase
-  const int   SINGLE_WALL_START_SCORE = 15;  // Start single upper or lower walls
-  const int   COMBINED_WALL_START_SCORE = 30; // Start combined upper+lower walls
-  
-// ===== Button init =====
-  DebouncedButton flapBtnExternal;
-  flapBtnExternal.pin = BUTTON_PIN_EXTERNAL;
-  flapBtnExternal.begin();
-
-  DebouncedButton flapBtnPrg;
-  flapBtnPrg.pin = BUTTON_PIN_PRG;
-  flapBtnPrg.begin();
-
-  // ===== Game state =====
-  float petY = 32.0f;
-  float petVelocity = 0.0f;
-  int   score = 0;
-  float wallSpeed = INITIAL_SPEED;
-  unsigned long lastFrameTime = millis();
-  bool gameOver = false;
+  // The seed and flaps go with the score so the server can replay the run
+  static FlapLog flapLog;  // 0.5 KB, kept off the loop task's stack
+  uint32_t seed = esp_random();
+  FlappyState game;
+  flappyInit(game, seed);
+  flapLogBegin(flapLog, seed);
   
     // Ready screen (non-blocking release; don’t hold PRG to auto-flap)
   display.clear();
@@ -1631,187 +1504,50 @@ int handleLightningGame(SSD1306Wire &display) {
   display.display();
   delay(800);
 
-  // Ensure the first press after ready is counted once
-  // (call once here to clear any residual edge)
-  (void)flapBtnExternal.justPressed();
-  (void)flapBtnPrg.justPressed();
-
-  // ===== Walls init - Single lower wall only (top walls added after score >= 20) =====
-  struct Wall { 
-    float x; 
-    int wallHeight;  // Height of lower wall (from bottom)
-    int topWallHeight;  // Height of top wall (from top) - 0 means no top wall
-    bool passed; 
-  };
-  Wall walls[4];
-  for (int i = 0; i < 4; i++) {
-    walls[i].x = 128 + (i * WALL_SPACING);
-    // Wall height varies - start very easy, get gradually harder
-    // Pet starts at y=32, sprite height=16, so pet bottom is at y=48
-    // Screen is 64 pixels tall
-    // Wall height determines how much clearance: lower wall = easier to clear
-    // Wall top Y = 64 - wallHeight, so wallHeight=12 means wall top at y=52 (pet clears by 4px)
-    if (i == 0) {
-      walls[i].wallHeight = 12;  // First wall: very low (12px) - wall top at y=52, pet at y=48 clears easily
-      walls[i].topWallHeight = 0;  // No top wall initially
-    } else if (i == 1) {
-      walls[i].wallHeight = random(12, 18);  // Second wall: 12-17px (still easy)
-      walls[i].topWallHeight = 0;  // No top wall initially
-    } else if (i == 2) {
-      walls[i].wallHeight = random(15, 22);  // Third wall: 15-21px (medium)
-      walls[i].topWallHeight = 0;  // No top wall initially
-    } else {
-      walls[i].wallHeight = random(18, 28);  // Later walls: 18-27px (harder but jumpable)
-      walls[i].topWallHeight = 0;  // No top wall initially
-    }
-    walls[i].passed = false;
-  }
-  
-  // ===== Main loop =====
-  while (!gameOver) {
-    unsigned long now = millis();
-    float deltaTime = (now - lastFrameTime) / 16.6667f;   // ~frames
-    if (deltaTime < 0.25f) deltaTime = 0.25f;             // guard slow clocks
-    if (deltaTime > 2.0f)  deltaTime = 2.0f;              // guard hiccups
-    lastFrameTime = now;
-
-    // ---- INPUT FIRST (edge + grace) ----
-    if (flapBtnExternal.justPressed() || flapBtnPrg.justPressed()) {
-      petVelocity = FLAP_VELOCITY;                        // immediate impulse
-    }
-
-    // ---- PHYSICS ----
-    petVelocity += GRAVITY * deltaTime;
-    if (petVelocity >  MAX_FALL_SPEED) petVelocity =  MAX_FALL_SPEED;
-    if (petVelocity < -MAX_FALL_SPEED) petVelocity = -MAX_FALL_SPEED;
-
-    petY += petVelocity * deltaTime;
-
-    // Clamp for drawing (not a death at edges)
-    if (petY < -8) petY = -8;                             // allow small overshoot
-    if (petY > 64 - PET_SPRITE_HEIGHT + 8) petY = 64 - PET_SPRITE_HEIGHT + 8;
-
-    // ---- WALLS / SCORING (same as yours) ----
-    for (int i = 0; i < 4; i++) {
-      walls[i].x -= wallSpeed * deltaTime;
-
-      if (!walls[i].passed && walls[i].x + WALL_WIDTH < PET_X) {
-        walls[i].passed = true;
-        score++;
-        wallSpeed += SPEED_INCREASE;
-      }
-
-      if (walls[i].x + WALL_WIDTH < 0) {
-        float rightmostX = walls[0].x;
-        for (int j = 1; j < 4; j++) rightmostX = max(rightmostX, walls[j].x);
-        walls[i].x = rightmostX + WALL_SPACING;
-        // Progressive difficulty: walls get taller as score increases
-        int maxHeight = min(30, 18 + (score / 2));
-        int minHeight = max(10, 12 - (score / 8));
-        
-        if (score < SINGLE_WALL_START_SCORE) {
-          // Early game: lower walls only
-          walls[i].wallHeight = random(minHeight, maxHeight + 1);
-          walls[i].topWallHeight = 0;
-        }
-        else if (score < COMBINED_WALL_START_SCORE) {
-          // Mid game (15-29): mix of upper-only and lower-only walls
-          bool upperOnly = random(0, 2) == 0; // 50% chance
-          if (upperOnly) {
-            walls[i].wallHeight = 0; // No lower wall
-            walls[i].topWallHeight = random(12, 24); // Upper wall only
-          } else {
-            walls[i].wallHeight = random(minHeight, maxHeight + 1); // Lower wall only
-            walls[i].topWallHeight = 0; // No upper wall
-          }
-        }
-        else {
-          // Late game (30+): combined upper+lower walls
-          // Screen is 64px, pet is 16px, so gap needs to be at least 20px for playability
-          const int MIN_GAP = 40;  // Minimum gap size (comfortable for 16px pet)
-          const int MAX_WALL_HEIGHT = 18;  // Max height for each wall
-          
-          // First, decide the gap size (28-36 pixels)
-          int gapSize = random(MIN_GAP, MIN_GAP + 8);
-          
-          // Then allocate remaining space to walls
-          int availableForWalls = 64 - gapSize;  // e.g., 64 - 30 = 34 pixels for both walls
-          
-          // Split available space between top and bottom walls
-          int bottomWallMax = min(MAX_WALL_HEIGHT, availableForWalls / 2);
-          int topWallMax = min(MAX_WALL_HEIGHT, availableForWalls / 2);
-          
-          walls[i].wallHeight = random(8, bottomWallMax + 1);  // Bottom wall
-          walls[i].topWallHeight = random(6, topWallMax + 1);  // Top wall
-        }
-        
-        walls[i].passed = false;
-      }
+  // Drop any edge left over from the menu press so the first flap is deliberate
+  clearButtonEvents();
+
+  // ===== Main loop - fixed-rate simulation, render as fast as the panel allows =====
+  FlappyState previous = game;
+  bool flapPending = false;
+  unsigned long lastMicros = micros();
+  unsigned long pendingUs = 0;
+
+  while (!game.gameOver) {
+    unsigned long nowUs = micros();
+    pendingUs += nowUs - lastMicros;
+    lastMicros = nowUs;
+    // After a long stall (WiFi, flash write) slow the game down rather than
+    // fast-forwarding it into a wall the player never saw
+    if (pendingUs > FLAPPY_MAX_CATCHUP_US) {
+      pendingUs = FLAPPY_MAX_CATCHUP_US;
     }
 
-    // ---- COLLISION - Check both lower wall and top wall (if present) ----
-    int petLeft = PET_X, petRight = PET_X + PET_SPRITE_WIDTH;
-    int petTop = (int)petY, petBottom = (int)petY + PET_SPRITE_HEIGHT;
-
-    for (int i = 0; i < 4; i++) {
-      int wallLeft = (int)walls[i].x;
-      int wallRight = wallLeft + WALL_WIDTH;
-      
-      // Check horizontal overlap
-      if (petRight > wallLeft && petLeft < wallRight) {
-        // Check lower wall collision (if lower wall exists)
-        if (walls[i].wallHeight > 0) {
-          int lowerWallTop = 64 - walls[i].wallHeight;  // Wall starts from bottom, extends upward
-          if (petBottom > lowerWallTop) {  // Pet's bottom overlaps with lower wall top
-            gameOver = true;
-            break;
-          }
-        }
-        
-        // Check top wall collision (if top wall exists)
-        if (walls[i].topWallHeight > 0) {
-          int topWallBottom = walls[i].topWallHeight;  // Top wall extends from top (y=0) downward
-          if (petTop < topWallBottom) {  // Pet's top overlaps with top wall bottom
-            gameOver = true;
-            break;
-          }
-        }
-      }
+    // A press lands on the next tick even if this pass runs none
+    if (takeButtonPress()) {
+      flapPending = true;
     }
-    if (gameOver) break;
 
-    // ---- RENDER - Draw lower walls and top walls (if present) ----
-    display.clear();
-    for (int i = 0; i < 4; i++) {
-      int wallX = (int)walls[i].x;
-      if (wallX >= -WALL_WIDTH && wallX < 128) {
-        // Draw lower wall from bottom upward (wall extends from y = 64 - wallHeight to y = 64)
-        int wallTopY = 64 - walls[i].wallHeight;
-        display.fillRect(wallX, wallTopY, WALL_WIDTH, walls[i].wallHeight);
-        
-        // Draw top wall if present (wall extends from y = 0 to y = topWallHeight)
-        if (walls[i].topWallHeight > 0) {
-          display.fillRect(wallX, 0, WALL_WIDTH, walls[i].topWallHeight);
-        }
+    uint32_t physicsStartUs = micros();
+    while (pendingUs >= FLAPPY_TICK_US && !game.gameOver) {
+      previous = game;
+      flappyStep(game, flapPending);
+      if (flapPending) {
+        flapLogAdd(flapLog, game.ticks);
+        flapPending = false;
       }
+      pendingUs -= FLAPPY_TICK_US;
     }
+    profileRecord(PROFILE_PHYSICS, micros() - physicsStartUs);
+    if (game.gameOver) break;
 
-    // Always use cat sprite in game regardless of pet type
-    // Use dedicated 16x16 game character (same for all pet types)
-    const uint8_t* petSprite = game_character_bitmap;
-    int drawY = (int)petY;
-    if (drawY < 0) drawY = 0;
-    if (drawY + PET_SPRITE_HEIGHT > 64) drawY = 64 - PET_SPRITE_HEIGHT;
-    display.drawXbm(PET_X, drawY, PET_SPRITE_WIDTH, PET_SPRITE_HEIGHT, petSprite);
-
-    display.setFont(ArialMT_Plain_10);
-    display.setTextAlignment(TEXT_ALIGN_LEFT);
-    display.drawString(0, 0, "Score: " + String(score));
-    display.display();
+    renderFlappyFrame(display, previous, game, pendingUs * 256 / FLAPPY_TICK_US);
 
     esp_task_wdt_reset(); // Feed watchdog during game loop
-    delay(16); // ~60 FPS
+    delay(1);
   }
+  int score = game.score;
+  flapLogEnd(flapLog, game.ticks);
   
   // Base happiness reward for playing the game (always get +10 for playing)
   int happinessIncrease = 10;
@@ -1846,7 +1582,7 @@ int handleLightningGame(SSD1306Wire &display) {
   bool leaderboardSuccess = false;
 
   if (ganamosConfig.deviceId.length() > 0) {
-    leaderboardSuccess = submitGameScore(score, leaderboardResponse);
+    leaderboardSuccess = submitGameScore(score, flapLog, leaderboardResponse);
   } else {
     Serial.println("Skipping leaderboard submission - missing deviceId");
   }
@@ -1980,6 +1716,8 @@ void loadPetStats() {
 
 void savePetStats() {
   extern Preferences preferences;
+  ProfileScope scope(PROFILE_NVS);
+  HeapScope heapScope(HEAP_SITE_NVS);
   preferences.begin("satoshi-pet", false);
   
   // Get current epoch time (10ms timeout to prevent blocking when offline)
@@ -2002,6 +1740,17 @@ void savePetStats() {
   Serial.println("  Timestamp: " + String((unsigned long)now));
 }
 
+void resumePetStats() {
+  // Stats stayed in RTC memory; only the millis() timestamps need moving
+  // into this boot's timebase so decay keeps counting through the sleep
+  petStats.lastFeed = powerRebaseMs(petStats.lastFeed);
+  petStats.lastActivity = powerRebaseMs(petStats.lastActivity);
+  petStats.lastUpdate = powerRebaseMs(petStats.lastUpdate);
+  petStats.lastFeedTimestamp = powerRebaseMs(petStats.lastFeedTimestamp);
+  petStats.lastPlayTimestamp = powerRebaseMs(petStats.lastPlayTimestamp);
+  petStats.lastDecayUpdate = powerRebaseMs(petStats.lastDecayUpdate);
+}
+
 void applyTimeBasedDecay() {
   // Time-based decay is handled by updatePetStats when rendering
   // This stub exists for compatibility
@@ -47,6 +47,7 @@ void updatePetMood(int price, int sats);
 void applyTimeBasedDecay(); // Apply fullness/happiness decay based on elapsed time
 void savePetStats(); // Save stats to NVS
 void loadPetStats(); // Load stats from NVS
+void resumePetStats(); // After deep sleep: stats are still in RTC memory
 void renderPet(SSD1306Wire &display, int btcPrice, int satoshis, int batteryPercent);
 void renderScreensaver(SSD1306Wire &display, int satoshis);
 void renderMenu(SSD1306Wire &display, int menuOption); // 0=Home, 1=Play, 2=Feed
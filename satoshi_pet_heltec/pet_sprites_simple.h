@@ -1,5 +1,7 @@
 #pragma once
 
+#include "config.h"  // PetType
+
 #define SPRITE_WIDTH 60
 #define SPRITE_HEIGHT 51
 #define BUNNY_SPRITE_WIDTH 55
@@ -7,43 +9,13 @@
 #define BUNNY_DEFAULT_WIDTH 50
 #define BUNNY_DEFAULT_HEIGHT 50
 
-// Animation frame counts per sequence
-#define CAT_DEFAULT_FRAMES 6
-#define CAT_EAT_FRAMES 8
-#define CAT_SAD_FRAMES 8
-#define CAT_DIE_FRAMES 8
-
-#define DOG_DEFAULT_FRAMES 6
-#define DOG_EAT_FRAMES 8
-#define DOG_SAD_FRAMES 8
-#define DOG_DIE_FRAMES 8
-
-#define SQUIRREL_DEFAULT_FRAMES 5
-#define SQUIRREL_EAT_FRAMES 8
-#define SQUIRREL_SAD_FRAMES 7
-#define SQUIRREL_DIE_FRAMES 7
-
-#define TURTLE_DEFAULT_FRAMES 6
-#define TURTLE_EAT_FRAMES 8
-#define TURTLE_SAD_FRAMES 6
-#define TURTLE_DIE_FRAMES 8
-
-#define BUNNY_DEFAULT_FRAMES 6
-#define BUNNY_EAT_FRAMES 8
-#define BUNNY_SAD_FRAMES 7
-#define BUNNY_DIE_FRAMES 8
-
-#define OWL_DEFAULT_FRAMES 7
-#define OWL_EAT_FRAMES 8
-#define OWL_SAD_FRAMES 7
-#define OWL_DIE_FRAMES 8
-
 // Animation state enum
 enum PetAnimationState {
   ANIM_DEFAULT,
   ANIM_EAT,
   ANIM_SAD,
-  ANIM_DIE
+  ANIM_DIE,
+  ANIM_STATE_COUNT
 };
 
 // Game character sprite - 16x16px (used in Flappy Bird game)
@@ -5299,170 +5271,172 @@ const unsigned char epd_bitmap_owl_dies8 [] PROGMEM = {
 //   0x00, 0x00, 0x00, 0x00   // Row 32
 // };
 
-// Sprite lookup function with animation frame support
-const uint8_t* getPetSprite(String petType, PetAnimationState animState, int frameIndex) {
-  if (petType == "cat") {
-    if (animState == ANIM_EAT) {
-      const unsigned char* cat_eat_frames[] = {
-        epd_bitmap_cat_eat_1, epd_bitmap_cat_eat_2, epd_bitmap_cat_eat_3, epd_bitmap_cat_eat_4,
-        epd_bitmap_cat_eat_5, epd_bitmap_cat_eat_6, epd_bitmap_cat_eat_7, epd_bitmap_cat_eat_8
-      };
-      return cat_eat_frames[frameIndex % CAT_EAT_FRAMES];
-    } else if (animState == ANIM_SAD) {
-      const unsigned char* cat_sad_frames[] = {
-        epd_bitmap_cat_sad_1, epd_bitmap_cat_sad_2, epd_bitmap_cat_sad_3, epd_bitmap_cat_sad_4,
-        epd_bitmap_cat_sad_5, epd_bitmap_cat_sad_6, epd_bitmap_cat_sad_7, epd_bitmap_cat_sad_8
-      };
-      return cat_sad_frames[frameIndex % CAT_SAD_FRAMES];
-    } else if (animState == ANIM_DIE) {
-      const unsigned char* cat_die_frames[] = {
-        epd_bitmap_cat_dies_1, epd_bitmap_cat_dies_2, epd_bitmap_cat_dies_3, epd_bitmap_cat_dies_4,
-        epd_bitmap_cat_dies_5, epd_bitmap_cat_dies_6, epd_bitmap_cat_dies_7, epd_bitmap_cat_dies_8
-      };
-      return cat_die_frames[frameIndex % CAT_DIE_FRAMES];
-    } else { // ANIM_DEFAULT
-      const unsigned char* cat_default_frames[] = {
-        epd_bitmap_cat_d_1, epd_bitmap_cat_d_2, epd_bitmap_cat_d_3,
-        epd_bitmap_cat_d_4, epd_bitmap_cat_d_5, epd_bitmap_cat_d_6
-      };
-      return cat_default_frames[frameIndex % CAT_DEFAULT_FRAMES];
-    }
-  }
-  else if (petType == "dog") {
-    if (animState == ANIM_EAT) {
-      const unsigned char* dog_eat_frames[] = {
-        epd_bitmap_dog_eat_1, epd_bitmap_dog_eat_2, epd_bitmap_dog_eat_3, epd_bitmap_dog_eat_4,
-        epd_bitmap_dog_eat_5, epd_bitmap_dog_eat_6, epd_bitmap_dog_eat_7, epd_bitmap_dog_eat_8
-      };
-      return dog_eat_frames[frameIndex % DOG_EAT_FRAMES];
-    } else if (animState == ANIM_SAD) {
-      const unsigned char* dog_sad_frames[] = {
-        epd_bitmap_dog_sad_1, epd_bitmap_dog_sad_2, epd_bitmap_dog_sad_3, epd_bitmap_dog_sad_4,
-        epd_bitmap_dog_sad_5, epd_bitmap_dog_sad_6, epd_bitmap_dog_sad_7, epd_bitmap_dog_sad_8
-      };
-      return dog_sad_frames[frameIndex % DOG_SAD_FRAMES];
-    } else if (animState == ANIM_DIE) {
-      const unsigned char* dog_die_frames[] = {
-        epd_bitmap_dog_dies_1, epd_bitmap_dog_dies_2, epd_bitmap_dog_dies_3, epd_bitmap_dog_dies_4,
-        epd_bitmap_dog_dies_5, epd_bitmap_dog_dies_6, epd_bitmap_dog_dies_7, epd_bitmap_dog_dies_8
-      };
-      return dog_die_frames[frameIndex % DOG_DIE_FRAMES];
-    } else { // ANIM_DEFAULT
-      const unsigned char* dog_default_frames[] = {
-        epd_bitmap_dog_default_1, epd_bitmap_dog_default_2, epd_bitmap_dog_default_3,
-        epd_bitmap_dog_default_4, epd_bitmap_dog_default_5, epd_bitmap_dog_default_6
-      };
-      return dog_default_frames[frameIndex % DOG_DEFAULT_FRAMES];
-    }
-  }
-  else if (petType == "squirrel") {
-    if (animState == ANIM_EAT) {
-      const unsigned char* squirrel_eat_frames[] = {
-        epd_bitmap_squirrel_eats_1, epd_bitmap_squirrel_eats_2, epd_bitmap_squirrel_eats_3, epd_bitmap_squirrel_eats_4,
-        epd_bitmap_squirrel_eats_5, epd_bitmap_squirrel_eats_6, epd_bitmap_squirrel_eats_7, epd_bitmap_squirrel_eats_8
-      };
-      return squirrel_eat_frames[frameIndex % SQUIRREL_EAT_FRAMES];
-    } else if (animState == ANIM_SAD) {
-      const unsigned char* squirrel_sad_frames[] = {
-        epd_bitmap_squirrel_sad_1, epd_bitmap_squirrel_sad_2, epd_bitmap_squirrel_sad_3, epd_bitmap_squirrel_sad_4,
-        epd_bitmap_squirrel_sad_5, epd_bitmap_squirrel_sad_6, epd_bitmap_squirrel_sad_7, 
-      };
-      return squirrel_sad_frames[frameIndex % SQUIRREL_SAD_FRAMES];
-    } else if (animState == ANIM_DIE) {
-      const unsigned char* squirrel_die_frames[] = {
-        epd_bitmap_squirrel_dies_1, epd_bitmap_squirrel_dies_2, epd_bitmap_squirrel_dies_3, epd_bitmap_squirrel_dies_4,
-        epd_bitmap_squirrel_dies_5, epd_bitmap_squirrel_dies_6, epd_bitmap_squirrel_dies_7
-      };
-      return squirrel_die_frames[frameIndex % SQUIRREL_DIE_FRAMES];
-    } else { // ANIM_DEFAULT
-      const unsigned char* squirrel_default_frames[] = {
-        epd_bitmap_squirrel_default_1, epd_bitmap_squirrel_default_2, epd_bitmap_squirrel_default_3,
-        epd_bitmap_squirrel_default_4, epd_bitmap_squirrel_default_5
-      };
-      return squirrel_default_frames[frameIndex % SQUIRREL_DEFAULT_FRAMES];
-    }
-  }
-  else if (petType == "turtle") {
-    if (animState == ANIM_EAT) {
-      const unsigned char* turtle_eat_frames[] = {
-        epd_bitmap_turtle_eats_1, epd_bitmap_turtle_eats_2, epd_bitmap_turtle_eats_3, epd_bitmap_turtle_eats_4,
-        epd_bitmap_turtle_eats_5, epd_bitmap_turtle_eats_6, epd_bitmap_turtle_eats_7, epd_bitmap_turtle_eats_8
-      };
-      return turtle_eat_frames[frameIndex % TURTLE_EAT_FRAMES];
-    } else if (animState == ANIM_SAD) {
-      const unsigned char* turtle_sad_frames[] = {
-        epd_bitmap_turtle_sad_1, epd_bitmap_turtle_sad_2, epd_bitmap_turtle_sad_3,
-        epd_bitmap_turtle_sad_4, epd_bitmap_turtle_sad_5, epd_bitmap_turtle_sad_6
-      };
-      return turtle_sad_frames[frameIndex % TURTLE_SAD_FRAMES];
-    } else if (animState == ANIM_DIE) {
-      const unsigned char* turtle_die_frames[] = {
-        epd_bitmap_turtle_die_1, epd_bitmap_turtle_die_2, epd_bitmap_turtle_die_3, epd_bitmap_turtle_die_4,
-        epd_bitmap_turtle_die_5, epd_bitmap_turtle_die_6, epd_bitmap_turtle_die_7, epd_bitmap_turtle_die_8
-      };
-      return turtle_die_frames[frameIndex % TURTLE_DIE_FRAMES];
-    } else { // ANIM_DEFAULT
-      const unsigned char* turtle_default_frames[] = {
-        epd_bitmap_turtle_default_1, epd_bitmap_turtle_default_2, epd_bitmap_turtle_default_3,
-        epd_bitmap_turtle_default_4, epd_bitmap_turtle_default_5, epd_bitmap_turtle_default_6
-      };
-      return turtle_default_frames[frameIndex % TURTLE_DEFAULT_FRAMES];
-    }
-  }
-  else if (petType == "rabbit" || petType == "bunny") {
-    if (animState == ANIM_EAT) {
-      const unsigned char* bunny_eat_frames[] = {
-        epd_bitmap_bunny_eat_1, epd_bitmap_bunny_eat_2, epd_bitmap_bunny_eat_3, epd_bitmap_bunny_eat_4,
-        epd_bitmap_bunny_eat_5, epd_bitmap_bunny_eat_6, epd_bitmap_bunny_eat_7, epd_bitmap_bunny_eat_8
-      };
-      return bunny_eat_frames[frameIndex % BUNNY_EAT_FRAMES];
-    } else if (animState == ANIM_SAD) {
-      const unsigned char* bunny_sad_frames[] = {
-        epd_bitmap_bunny_sad_1, epd_bitmap_bunny_sad_2, epd_bitmap_bunny_sad_3, epd_bitmap_bunny_sad_4,
-        epd_bitmap_bunny_sad_5, epd_bitmap_bunny_sad_6, epd_bitmap_bunny_sad_7, 
-      };
-      return bunny_sad_frames[frameIndex % BUNNY_SAD_FRAMES];
-    } else if (animState == ANIM_DIE) {
-      const unsigned char* bunny_die_frames[] = {
-        epd_bitmap_bunny_die_1, epd_bitmap_bunny_die_2, epd_bitmap_bunny_die_3, epd_bitmap_bunny_die_4,
-        epd_bitmap_bunny_die_5, epd_bitmap_bunny_die_6, epd_bitmap_bunny_die_7
-      };
-      return bunny_die_frames[frameIndex % BUNNY_DIE_FRAMES];
-    } else { // ANIM_DEFAULT
-      const unsigned char* bunny_default_frames[] = {
-        epd_bitmap_bunny_default_1, epd_bitmap_bunny_default_2, epd_bitmap_bunny_default_3,
-        epd_bitmap_bunny_default_4, epd_bitmap_bunny_default_5, epd_bitmap_bunny_default_6
-      };
-      return bunny_default_frames[frameIndex % BUNNY_DEFAULT_FRAMES];
-    }
-  }
-  else if (petType == "owl") {
-    if (animState == ANIM_EAT) {
-      const unsigned char* owl_eat_frames[] = {
-        epd_bitmap_owl_e1, epd_bitmap_owl_e2, epd_bitmap_owl_e3, epd_bitmap_owl_e4,
-        epd_bitmap_owl_e5, epd_bitmap_owl_e6, epd_bitmap_owl_e7, epd_bitmap_owl_e8
-      };
-      return owl_eat_frames[frameIndex % OWL_EAT_FRAMES];
-    } else if (animState == ANIM_SAD) {
-      const unsigned char* owl_sad_frames[] = {
-        epd_bitmap_owl_s1, epd_bitmap_owl_s2, epd_bitmap_owl_s3, epd_bitmap_owl_s4,
-        epd_bitmap_owl_s5, epd_bitmap_owl_s6, epd_bitmap_owl_s7
-      };
-      return owl_sad_frames[frameIndex % OWL_SAD_FRAMES];
-    } else if (animState == ANIM_DIE) {
-      const unsigned char* owl_die_frames[] = {
-        epd_bitmap_owl_dies1, epd_bitmap_owl_dies2, epd_bitmap_owl_dies3, epd_bitmap_owl_dies4,
-        epd_bitmap_owl_dies5, epd_bitmap_owl_dies6, epd_bitmap_owl_dies7, epd_bitmap_owl_dies8
-      };
-      return owl_die_frames[frameIndex % OWL_DIE_FRAMES];
-    } else { // ANIM_DEFAULT
-      const unsigned char* owl_default_frames[] = {
-        epd_bitmap_owl_d1, epd_bitmap_owl_d2, epd_bitmap_owl_d3, epd_bitmap_owl_d4,
-        epd_bitmap_owl_d5, epd_bitmap_owl_d6, epd_bitmap_owl_d7
-      };
-      return owl_default_frames[frameIndex % OWL_DEFAULT_FRAMES];
-    }
+// ===== Sprite table =====
+// Frame sequences per pet and animation. Counts come from the arrays
+// themselves, so a sequence can't be shorter than the count used to index it.
+
+constexpr const unsigned char* CAT_DEFAULT_SEQ[] = {
+  epd_bitmap_cat_d_1, epd_bitmap_cat_d_2, epd_bitmap_cat_d_3,
+  epd_bitmap_cat_d_4, epd_bitmap_cat_d_5, epd_bitmap_cat_d_6
+};
+constexpr const unsigned char* CAT_EAT_SEQ[] = {
+  epd_bitmap_cat_eat_1, epd_bitmap_cat_eat_2, epd_bitmap_cat_eat_3, epd_bitmap_cat_eat_4,
+  epd_bitmap_cat_eat_5, epd_bitmap_cat_eat_6, epd_bitmap_cat_eat_7, epd_bitmap_cat_eat_8
+};
+constexpr const unsigned char* CAT_SAD_SEQ[] = {
+  epd_bitmap_cat_sad_1, epd_bitmap_cat_sad_2, epd_bitmap_cat_sad_3, epd_bitmap_cat_sad_4,
+  epd_bitmap_cat_sad_5, epd_bitmap_cat_sad_6, epd_bitmap_cat_sad_7, epd_bitmap_cat_sad_8
+};
+constexpr const unsigned char* CAT_DIE_SEQ[] = {
+  epd_bitmap_cat_dies_1, epd_bitmap_cat_dies_2, epd_bitmap_cat_dies_3, epd_bitmap_cat_dies_4,
+  epd_bitmap_cat_dies_5, epd_bitmap_cat_dies_6, epd_bitmap_cat_dies_7, epd_bitmap_cat_dies_8
+};
+
+constexpr const unsigned char* DOG_DEFAULT_SEQ[] = {
+  epd_bitmap_dog_default_1, epd_bitmap_dog_default_2, epd_bitmap_dog_default_3,
+  epd_bitmap_dog_default_4, epd_bitmap_dog_default_5, epd_bitmap_dog_default_6
+};
+constexpr const unsigned char* DOG_EAT_SEQ[] = {
+  epd_bitmap_dog_eat_1, epd_bitmap_dog_eat_2, epd_bitmap_dog_eat_3, epd_bitmap_dog_eat_4,
+  epd_bitmap_dog_eat_5, epd_bitmap_dog_eat_6, epd_bitmap_dog_eat_7, epd_bitmap_dog_eat_8
+};
+constexpr const unsigned char* DOG_SAD_SEQ[] = {
+  epd_bitmap_dog_sad_1, epd_bitmap_dog_sad_2, epd_bitmap_dog_sad_3, epd_bitmap_dog_sad_4,
+  epd_bitmap_dog_sad_5, epd_bitmap_dog_sad_6, epd_bitmap_dog_sad_7, epd_bitmap_dog_sad_8
+};
+constexpr const unsigned char* DOG_DIE_SEQ[] = {
+  epd_bitmap_dog_dies_1, epd_bitmap_dog_dies_2, epd_bitmap_dog_dies_3, epd_bitmap_dog_dies_4,
+  epd_bitmap_dog_dies_5, epd_bitmap_dog_dies_6, epd_bitmap_dog_dies_7, epd_bitmap_dog_dies_8
+};
+
+constexpr const unsigned char* SQUIRREL_DEFAULT_SEQ[] = {
+  epd_bitmap_squirrel_default_1, epd_bitmap_squirrel_default_2, epd_bitmap_squirrel_default_3,
+  epd_bitmap_squirrel_default_4, epd_bitmap_squirrel_default_5
+};
+constexpr const unsigned char* SQUIRREL_EAT_SEQ[] = {
+  epd_bitmap_squirrel_eats_1, epd_bitmap_squirrel_eats_2, epd_bitmap_squirrel_eats_3, epd_bitmap_squirrel_eats_4,
+  epd_bitmap_squirrel_eats_5, epd_bitmap_squirrel_eats_6, epd_bitmap_squirrel_eats_7, epd_bitmap_squirrel_eats_8
+};
+constexpr const unsigned char* SQUIRREL_SAD_SEQ[] = {
+  epd_bitmap_squirrel_sad_1, epd_bitmap_squirrel_sad_2, epd_bitmap_squirrel_sad_3, epd_bitmap_squirrel_sad_4,
+  epd_bitmap_squirrel_sad_5, epd_bitmap_squirrel_sad_6, epd_bitmap_squirrel_sad_7
+};
+constexpr const unsigned char* SQUIRREL_DIE_SEQ[] = {
+  epd_bitmap_squirrel_dies_1, epd_bitmap_squirrel_dies_2, epd_bitmap_squirrel_dies_3, epd_bitmap_squirrel_dies_4,
+  epd_bitmap_squirrel_dies_5, epd_bitmap_squirrel_dies_6, epd_bitmap_squirrel_dies_7
+};
+
+constexpr const unsigned char* TURTLE_DEFAULT_SEQ[] = {
+  epd_bitmap_turtle_default_1, epd_bitmap_turtle_default_2, epd_bitmap_turtle_default_3,
+  epd_bitmap_turtle_default_4, epd_bitmap_turtle_default_5, epd_bitmap_turtle_default_6
+};
+constexpr const unsigned char* TURTLE_EAT_SEQ[] = {
+  epd_bitmap_turtle_eats_1, epd_bitmap_turtle_eats_2, epd_bitmap_turtle_eats_3, epd_bitmap_turtle_eats_4,
+  epd_bitmap_turtle_eats_5, epd_bitmap_turtle_eats_6, epd_bitmap_turtle_eats_7, epd_bitmap_turtle_eats_8
+};
+constexpr const unsigned char* TURTLE_SAD_SEQ[] = {
+  epd_bitmap_turtle_sad_1, epd_bitmap_turtle_sad_2, epd_bitmap_turtle_sad_3,
+  epd_bitmap_turtle_sad_4, epd_bitmap_turtle_sad_5, epd_bitmap_turtle_sad_6
+};
+constexpr const unsigned char* TURTLE_DIE_SEQ[] = {
+  epd_bitmap_turtle_die_1, epd_bitmap_turtle_die_2, epd_bitmap_turtle_die_3, epd_bitmap_turtle_die_4,
+  epd_bitmap_turtle_die_5, epd_bitmap_turtle_die_6, epd_bitmap_turtle_die_7, epd_bitmap_turtle_die_8
+};
+
+constexpr const unsigned char* BUNNY_DEFAULT_SEQ[] = {
+  epd_bitmap_bunny_default_1, epd_bitmap_bunny_default_2, epd_bitmap_bunny_default_3,
+  epd_bitmap_bunny_default_4, epd_bitmap_bunny_default_5, epd_bitmap_bunny_default_6
+};
+constexpr const unsigned char* BUNNY_EAT_SEQ[] = {
+  epd_bitmap_bunny_eat_1, epd_bitmap_bunny_eat_2, epd_bitmap_bunny_eat_3, epd_bitmap_bunny_eat_4,
+  epd_bitmap_bunny_eat_5, epd_bitmap_bunny_eat_6, epd_bitmap_bunny_eat_7, epd_bitmap_bunny_eat_8
+};
+constexpr const unsigned char* BUNNY_SAD_SEQ[] = {
+  epd_bitmap_bunny_sad_1, epd_bitmap_bunny_sad_2, epd_bitmap_bunny_sad_3, epd_bitmap_bunny_sad_4,
+  epd_bitmap_bunny_sad_5, epd_bitmap_bunny_sad_6, epd_bitmap_bunny_sad_7
+};
+constexpr const unsigned char* BUNNY_DIE_SEQ[] = {
+  epd_bitmap_bunny_die_1, epd_bitmap_bunny_die_2, epd_bitmap_bunny_die_3, epd_bitmap_bunny_die_4,
+  epd_bitmap_bunny_die_5, epd_bitmap_bunny_die_6, epd_bitmap_bunny_die_7
+};
+
+constexpr const unsigned char* OWL_DEFAULT_SEQ[] = {
+  epd_bitmap_owl_d1, epd_bitmap_owl_d2, epd_bitmap_owl_d3, epd_bitmap_owl_d4,
+  epd_bitmap_owl_d5, epd_bitmap_owl_d6, epd_bitmap_owl_d7
+};
+constexpr const unsigned char* OWL_EAT_SEQ[] = {
+  epd_bitmap_owl_e1, epd_bitmap_owl_e2, epd_bitmap_owl_e3, epd_bitmap_owl_e4,
+  epd_bitmap_owl_e5, epd_bitmap_owl_e6, epd_bitmap_owl_e7, epd_bitmap_owl_e8
+};
+constexpr const unsigned char* OWL_SAD_SEQ[] = {
+  epd_bitmap_owl_s1, epd_bitmap_owl_s2, epd_bitmap_owl_s3, epd_bitmap_owl_s4,
+  epd_bitmap_owl_s5, epd_bitmap_owl_s6, epd_bitmap_owl_s7
+};
+constexpr const unsigned char* OWL_DIE_SEQ[] = {
+  epd_bitmap_owl_dies1, epd_bitmap_owl_dies2, epd_bitmap_owl_dies3, epd_bitmap_owl_dies4,
+  epd_bitmap_owl_dies5, epd_bitmap_owl_dies6, epd_bitmap_owl_dies7, epd_bitmap_owl_dies8
+};
+
+struct SpriteAnimation {
+  const unsigned char* const* frames;
+  uint8_t count;
+  uint8_t width;
+  uint8_t height;
+  uint8_t x;        // Left edge on the main pet screen
+};
+
+#define SPRITE_ANIM(seq, w, h, x) { seq, sizeof(seq) / sizeof(seq[0]), w, h, x }
+
+// [PetType][PetAnimationState]. Cat, dog, squirrel and turtle are 60x51;
+// the bunny is 50x50 idle and 55x55 otherwise; the owl is 50x50 throughout.
+constexpr SpriteAnimation PET_SPRITES[PET_TYPE_COUNT][ANIM_STATE_COUNT] = {
+  { // PET_CAT
+    SPRITE_ANIM(CAT_DEFAULT_SEQ, SPRITE_WIDTH, SPRITE_HEIGHT, 54),
+    SPRITE_ANIM(CAT_EAT_SEQ, SPRITE_WIDTH, SPRITE_HEIGHT, 54),
+    SPRITE_ANIM(CAT_SAD_SEQ, SPRITE_WIDTH, SPRITE_HEIGHT, 54),
+    SPRITE_ANIM(CAT_DIE_SEQ, SPRITE_WIDTH, SPRITE_HEIGHT, 54)
+  },
+  { // PET_DOG
+    SPRITE_ANIM(DOG_DEFAULT_SEQ, SPRITE_WIDTH, SPRITE_HEIGHT, 54),
+    SPRITE_ANIM(DOG_EAT_SEQ, SPRITE_WIDTH, SPRITE_HEIGHT, 54),
+    SPRITE_ANIM(DOG_SAD_SEQ, SPRITE_WIDTH, SPRITE_HEIGHT, 54),
+    SPRITE_ANIM(DOG_DIE_SEQ, SPRITE_WIDTH, SPRITE_HEIGHT, 54)
+  },
+  { // PET_SQUIRREL
+    SPRITE_ANIM(SQUIRREL_DEFAULT_SEQ, SPRITE_WIDTH, SPRITE_HEIGHT, 54),
+    SPRITE_ANIM(SQUIRREL_EAT_SEQ, SPRITE_WIDTH, SPRITE_HEIGHT, 54),
+    SPRITE_ANIM(SQUIRREL_SAD_SEQ, SPRITE_WIDTH, SPRITE_HEIGHT, 54),
+    SPRITE_ANIM(SQUIRREL_DIE_SEQ, SPRITE_WIDTH, SPRITE_HEIGHT, 54)
+  },
+  { // PET_TURTLE
+    SPRITE_ANIM(TURTLE_DEFAULT_SEQ, SPRITE_WIDTH, SPRITE_HEIGHT, 54),
+    SPRITE_ANIM(TURTLE_EAT_SEQ, SPRITE_WIDTH, SPRITE_HEIGHT, 54),
+    SPRITE_ANIM(TURTLE_SAD_SEQ, SPRITE_WIDTH, SPRITE_HEIGHT, 54),
+    SPRITE_ANIM(TURTLE_DIE_SEQ, SPRITE_WIDTH, SPRITE_HEIGHT, 54)
+  },
+  { // PET_BUNNY
+    SPRITE_ANIM(BUNNY_DEFAULT_SEQ, BUNNY_DEFAULT_WIDTH, BUNNY_DEFAULT_HEIGHT, 64),
+    SPRITE_ANIM(BUNNY_EAT_SEQ, BUNNY_SPRITE_WIDTH, BUNNY_SPRITE_HEIGHT, 64),
+    SPRITE_ANIM(BUNNY_SAD_SEQ, BUNNY_SPRITE_WIDTH, BUNNY_SPRITE_HEIGHT, 64),
+    SPRITE_ANIM(BUNNY_DIE_SEQ, BUNNY_SPRITE_WIDTH, BUNNY_SPRITE_HEIGHT, 64)
+  },
+  { // PET_OWL
+    SPRITE_ANIM(OWL_DEFAULT_SEQ, 50, 50, 64),
+    SPRITE_ANIM(OWL_EAT_SEQ, 50, 50, 64),
+    SPRITE_ANIM(OWL_SAD_SEQ, 50, 50, 64),
+    SPRITE_ANIM(OWL_DIE_SEQ, 50, 50, 64)
   }
-  // Default fallback
-  return epd_bitmap_cat_d_1;
+};
+
+// Sprite sequence for a pet and animation state
+inline const SpriteAnimation& getPetAnimation(PetType petType, PetAnimationState animState) {
+  if (petType >= PET_TYPE_COUNT) petType = PET_CAT;
+  if (animState >= ANIM_STATE_COUNT) animState = ANIM_DEFAULT;
+  return PET_SPRITES[petType][animState];
+}
+
+// Sprite lookup with animation frame support (frameIndex wraps)
+inline const uint8_t* getPetSprite(PetType petType, PetAnimationState animState, int frameIndex) {
+  const SpriteAnimation& anim = getPetAnimation(petType, animState);
+  return anim.frames[(unsigned)frameIndex % anim.count];
 }
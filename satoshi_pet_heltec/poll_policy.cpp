@@ -0,0 +1,111 @@
+#include "poll_policy.h"
+
+// Kept across deep sleep so a sleeping device doesn't forget its backoff
+RTC_DATA_ATTR static unsigned long baseMs = POLL_DEFAULT_MS;
+RTC_DATA_ATTR static uint8_t backoffLevel = 0;
+RTC_DATA_ATTR static int16_t jitterPermille = 0;
+RTC_DATA_ATTR static bool jitterRolled = false;
+RTC_DATA_ATTR static uint32_t pollCount = 0;
+RTC_DATA_ATTR static uint32_t changedCount = 0;
+static bool pushConnected = false;  // The stream doesn't survive deep sleep
+
+// random() draws from the hardware RNG, so devices don't share a sequence
+static void rollJitter() {
+  jitterPermille = (int16_t)random(-POLL_JITTER_PERMILLE, POLL_JITTER_PERMILLE + 1);
+  jitterRolled = true;
+}
+
+static unsigned long intervalFor(bool idle) {
+  unsigned long interval = baseMs << backoffLevel;
+  if (idle) {
+    interval = max(interval, (unsigned long)POLL_IDLE_MIN_MS);
+    interval = min(interval, max(baseMs, (unsigned long)POLL_MAX_IDLE_MS));
+  } else {
+    interval = min(interval, max(baseMs, (unsigned long)POLL_MAX_ACTIVE_MS));
+    if (pushConnected) {
+      interval = max(interval, (unsigned long)POLL_PUSH_MIN_MS);
+    }
+  }
+  return interval + (long)interval * jitterPermille / 1000;
+}
+
+static void logDecision(const char *reason) {
+  Serial.print(F("📡 Poll policy: "));
+  Serial.print(reason);
+  Serial.print(F(" -> next in "));
+  Serial.print(intervalFor(false) / 1000);
+  Serial.print(F("s active / "));
+  Serial.print(intervalFor(true) / 1000);
+  Serial.print(F("s idle (base "));
+  Serial.print(baseMs / 1000);
+  Serial.print(F("s x"));
+  Serial.print(1 << backoffLevel);
+  Serial.print(F(", jitter "));
+  Serial.print(jitterPermille / 10);
+  Serial.println(F("%)"));
+}
+
+void pollSetServerHint(long hintMs) {
+  if (hintMs <= 0) {
+    return;
+  }
+  unsigned long ms = (unsigned long)hintMs;
+  ms = max(ms, (unsigned long)POLL_MIN_MS);
+  ms = min(ms, (unsigned long)POLL_MAX_HINT_MS);
+  if (ms != baseMs) {
+    baseMs = ms;
+    logDecision("server hint");
+  }
+}
+
+void pollOnResult(bool success, bool changed) {
+  pollCount++;
+  const char *reason;
+  if (success && changed) {
+    changedCount++;
+    backoffLevel = 0;
+    reason = "changed";
+  } else {
+    if (backoffLevel < POLL_MAX_BACKOFF) {
+      backoffLevel++;
+    }
+    reason = success ? "unchanged" : "failed";
+  }
+  rollJitter();
+  logDecision(reason);
+}
+
+void pollOnActivity() {
+  if (backoffLevel == 0) {
+    return;
+  }
+  backoffLevel = 0;
+  rollJitter();
+  logDecision("activity");
+}
+
+void pollSetPushConnected(bool connected) {
+  if (connected == pushConnected) {
+    return;
+  }
+  pushConnected = connected;
+  logDecision(connected ? "push up" : "push down");
+}
+
+unsigned long pollIntervalMs(bool idle) {
+  // Devices powered on together would otherwise share the first interval
+  if (!jitterRolled) {
+    rollJitter();
+  }
+  return intervalFor(idle);
+}
+
+PollStats getPollStats() {
+  PollStats stats;
+  stats.polls = pollCount;
+  stats.changed = changedCount;
+  stats.backoffLevel = backoffLevel;
+  stats.jitterPermille = jitterPermille;
+  stats.baseMs = baseMs;
+  return stats;
+}
@@ -0,0 +1,53 @@
+#ifndef POLL_POLICY_H
+#define POLL_POLICY_H
+
+#include <Arduino.h>
+
+// Adaptive config-poll interval.
+//
+// Starts from the server's pollInterval hint, doubles after each poll that
+// brought nothing new and snaps back after a button press or a balance
+// change. While the screensaver is up polls never run faster than
+// POLL_IDLE_MIN_MS. Every interval carries up to ±10% jitter so a room full
+// of devices that booted together drifts apart instead of polling in lockstep.
+
+#define POLL_DEFAULT_MS 20000       // No hint from the server yet
+#define POLL_MIN_MS 10000           // Floor for the server hint
+#define POLL_MAX_HINT_MS 3600000    // Ceiling for the server hint
+#define POLL_MAX_ACTIVE_MS 160000   // Backoff cap while the pet is on screen
+#define POLL_IDLE_MIN_MS 300000     // Screensaver / display off
+#define POLL_MAX_IDLE_MS 1200000    // Backoff cap while idle (20 minutes)
+#define POLL_MAX_BACKOFF 6          // Doublings before the caps take over
+#define POLL_JITTER_PERMILLE 100    // ±10%
+#define POLL_PUSH_MIN_MS 120000     // Safety-net rate while the push stream is up
+
+struct PollStats {
+  uint32_t polls;          // Poll results seen since the last cold boot
+  uint32_t changed;        // ...of which brought something new
+  uint8_t backoffLevel;    // Doublings applied to the base interval
+  int16_t jitterPermille;  // Jitter applied to the current interval
+  unsigned long baseMs;    // Server hint (or the default)
+};
+
+// Server's pollInterval from the config response, in milliseconds like
+// the config default. Clamped to POLL_MIN_MS..POLL_MAX_HINT_MS; 0 means
+// no hint.
+void pollSetServerHint(long hintMs);
+
+// A poll finished. changed = something the user would notice (balance,
+// coins, new job, rejection).
+void pollOnResult(bool success, bool changed);
+
+// The user pressed a button - poll at the base rate again
+void pollOnActivity();
+
+// The push stream (push_channel.h) came up or went down. While it's up
+// changes arrive as events, so polls drop to a slow safety net.
+void pollSetPushConnected(bool connected);
+
+// Time from the last poll to the next one
+unsigned long pollIntervalMs(bool idle);
+
+PollStats getPollStats();
+
+#endif
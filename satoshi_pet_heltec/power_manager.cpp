@@ -0,0 +1,239 @@
+#include "power_manager.h"
+#include "button_handler.h"
+#include "net_task.h"
+#include "sound_engine.h"
+#include <WiFi.h>
+#include <esp_sleep.h>
+#include <esp_task_wdt.h>
+#include <driver/gpio.h>
+#include <driver/rtc_io.h>
+#include <sys/time.h>
+
+#define POWER_MIN_SLEEP_MS 20        // Shorter waits aren't worth the wake-up cost
+#define POWER_MAX_SLEEP_MS 10000     // Well inside the 15s watchdog
+#define POWER_DEEP_SLEEP_MIN_MS 15000 // Below this a reboot costs more than light sleep saves
+#define POWER_RETAINED_MAGIC 0x50574B31 // "1KWP"
+
+static bool hasDeadline = false;
+static unsigned long nextDeadline = 0;
+static bool deepSleepAllowed = false;
+static unsigned long lastSleepMs = 0;
+static void (*beforeDeepSleepHook)() = nullptr;
+static bool resumed = false;
+static unsigned long rebaseOffset = 0;
+static uint64_t wakePinMask = 0;
+
+// Kept in RTC slow memory across deep sleep. The loader re-initializes
+// these on every other kind of boot.
+RTC_DATA_ATTR static uint32_t retainedMagic = 0;
+RTC_DATA_ATTR static unsigned long sleepStartMs = 0;  // millis() going down
+RTC_DATA_ATTR static int64_t sleepStartUs = 0;        // RTC-backed clock at the same moment
+RTC_DATA_ATTR static unsigned long accountingStart = 0;
+RTC_DATA_ATTR static uint32_t timerWakes = 0;
+RTC_DATA_ATTR static uint32_t buttonWakes = 0;
+RTC_DATA_ATTR static uint32_t skippedSleeps = 0;
+RTC_DATA_ATTR static uint32_t deepSleeps = 0;
+RTC_DATA_ATTR static uint32_t sleptMs = 0;
+RTC_DATA_ATTR static uint32_t deepSleptMs = 0;
+
+static const gpio_num_t wakePins[2] = {
+  (gpio_num_t)BUTTON_PIN_PRG,
+  (gpio_num_t)BUTTON_PIN_EXTERNAL
+};
+
+// The system clock keeps counting through deep sleep, millis() doesn't
+static int64_t clockUs() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (int64_t)tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+// gpio_wakeup_enable() replaces the pin's interrupt type with a level
+// trigger. Mask the edge ISR while it's armed (a held button would fire it
+// continuously on wake) and put the edge trigger back afterwards. The press
+// that woke us is picked up from the pin level by the button handler.
+static void armButtonWake() {
+  for (uint8_t i = 0; i < 2; i++) {
+    gpio_intr_disable(wakePins[i]);
+    gpio_wakeup_enable(wakePins[i], GPIO_INTR_LOW_LEVEL);
+  }
+  esp_sleep_enable_gpio_wakeup();
+}
+
+static void disarmButtonWake() {
+  for (uint8_t i = 0; i < 2; i++) {
+    gpio_wakeup_disable(wakePins[i]);
+    gpio_set_intr_type(wakePins[i], GPIO_INTR_ANYEDGE);
+    gpio_intr_enable(wakePins[i]);
+  }
+}
+
+static void enterDeepSleep(long waitMs) {
+  if (beforeDeepSleepHook) {
+    beforeDeepSleepHook();
+  }
+
+  Serial.print(F("💤 Deep sleep for "));
+  Serial.print(waitMs / 1000);
+  Serial.println(F("s"));
+  Serial.flush();
+
+  // The digital pull-ups are off in deep sleep - hold the buttons high from
+  // the RTC domain so EXT1 sees a press as the only low level
+  uint64_t mask = 0;
+  for (uint8_t i = 0; i < 2; i++) {
+    rtc_gpio_pullup_en(wakePins[i]);
+    rtc_gpio_pulldown_dis(wakePins[i]);
+    mask |= 1ULL << wakePins[i];
+  }
+  esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_PERIPH, ESP_PD_OPTION_ON);
+  esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_GPIO);  // Light-sleep only
+  esp_sleep_enable_ext1_wakeup(mask, ESP_EXT1_WAKEUP_ANY_LOW);
+  esp_sleep_enable_timer_wakeup((uint64_t)waitMs * 1000ULL);
+
+  sleepStartMs = millis();
+  sleepStartUs = clockUs();
+  retainedMagic = POWER_RETAINED_MAGIC;
+  esp_deep_sleep_start();
+}
+
+bool powerResume() {
+  esp_sleep_wakeup_cause_t cause = esp_sleep_get_wakeup_cause();
+  bool ours = retainedMagic == POWER_RETAINED_MAGIC &&
+              (cause == ESP_SLEEP_WAKEUP_TIMER || cause == ESP_SLEEP_WAKEUP_EXT1);
+  retainedMagic = 0;  // One resume per sleep
+  resumed = ours;
+  wakePinMask = 0;
+
+  if (!ours) {
+    accountingStart = 0;
+    timerWakes = buttonWakes = skippedSleeps = deepSleeps = 0;
+    sleptMs = deepSleptMs = 0;
+    return false;
+  }
+
+  // Back to plain GPIOs for the edge interrupts
+  for (uint8_t i = 0; i < 2; i++) {
+    rtc_gpio_deinit(wakePins[i]);
+  }
+
+  // Everything before this boot's millis() started counts as asleep
+  unsigned long elapsedMs = (unsigned long)((clockUs() - sleepStartUs) / 1000);
+  unsigned long now = millis();
+  rebaseOffset = now - (sleepStartMs + elapsedMs);
+  deepSleptMs += elapsedMs > now ? elapsedMs - now : 0;
+  deepSleeps++;
+
+  if (cause == ESP_SLEEP_WAKEUP_EXT1) {
+    wakePinMask = esp_sleep_get_ext1_wakeup_status();
+    buttonWakes++;
+  } else {
+    timerWakes++;
+  }
+  return true;
+}
+
+uint64_t powerWakePins() {
+  return wakePinMask;
+}
+
+unsigned long powerRebaseMs(unsigned long ms) {
+  return resumed ? ms + rebaseOffset : ms;
+}
+
+void powerBegin(void (*beforeDeepSleep)()) {
+  beforeDeepSleepHook = beforeDeepSleep;
+  if (resumed) {
+    accountingStart = powerRebaseMs(accountingStart);
+    return;
+  }
+  accountingStart = millis();
+  Serial.println(F("💤 Idle sleep enabled (light sleep between passes, deep sleep when display is off)"));
+}
+
+void powerWakeBy(unsigned long dueMs) {
+  if (!hasDeadline || (long)(dueMs - nextDeadline) < 0) {
+    nextDeadline = dueMs;
+    hasDeadline = true;
+  }
+}
+
+void powerAllowDeepSleep() {
+  deepSleepAllowed = true;
+}
+
+void powerIdle() {
+  lastSleepMs = 0;
+  unsigned long now = millis();
+  long waitMs = (long)(nextDeadline - now);
+  bool scheduled = hasDeadline;
+  bool deepAllowed = deepSleepAllowed;
+  hasDeadline = false;
+  deepSleepAllowed = false;
+
+  // A pass that registered nothing gets no sleep rather than a guess
+  if (!scheduled || waitMs < POWER_MIN_SLEEP_MS) {
+    return;
+  }
+
+  if (!netIsIdle() || soundIsPlaying() ||
+      digitalRead(BUTTON_PIN_PRG) == LOW || digitalRead(BUTTON_PIN_EXTERNAL) == LOW) {
+    skippedSleeps++;
+    return;
+  }
+
+  // A reboot drops the WiFi association anyway, so only light sleep
+  // (which would leave it half-alive) waits for the radio to be off
+  if (deepAllowed && waitMs >= POWER_DEEP_SLEEP_MIN_MS) {
+    enterDeepSleep(waitMs);
+  }
+  if (WiFi.getMode() != WIFI_OFF) {
+    skippedSleeps++;
+    return;
+  }
+
+  if (waitMs > POWER_MAX_SLEEP_MS) {
+    waitMs = POWER_MAX_SLEEP_MS;
+  }
+
+  Serial.flush();  // The UART clock stops during sleep
+  esp_sleep_enable_timer_wakeup((uint64_t)waitMs * 1000ULL);
+  armButtonWake();
+  esp_light_sleep_start();
+  disarmButtonWake();
+  esp_task_wdt_reset();
+
+  lastSleepMs = millis() - now;
+  sleptMs += lastSleepMs;
+  if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO) {
+    buttonWakes++;
+  } else {
+    timerWakes++;
+  }
+}
+
+unsigned long getPowerLastSleepMs() {
+  return lastSleepMs;
+}
+
+PowerStats getPowerStats() {
+  PowerStats stats;
+  uint32_t totalMs = millis() - accountingStart;
+  uint32_t asleepMs = sleptMs + deepSleptMs;
+  stats.timerWakes = timerWakes;
+  stats.buttonWakes = buttonWakes;
+  stats.skippedSleeps = skippedSleeps;
+  stats.deepSleeps = deepSleeps;
+  stats.sleptMs = sleptMs;
+  stats.deepSleptMs = deepSleptMs;
+  stats.awakeMs = totalMs > asleepMs ? totalMs - asleepMs : 0;
+  if (totalMs > 0) {
+    stats.sleepPercent = (uint8_t)(100.0f * asleepMs / totalMs);
+    stats.averageMa = (stats.awakeMs * POWER_ACTIVE_MA + sleptMs * POWER_LIGHT_SLEEP_MA +
+                       deepSleptMs * POWER_DEEP_SLEEP_MA) / totalMs;
+  } else {
+    stats.sleepPercent = 0;
+    stats.averageMa = POWER_ACTIVE_MA;
+  }
+  return stats;
+}
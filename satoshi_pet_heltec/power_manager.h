@@ -0,0 +1,66 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <Arduino.h>
+
+// Light-sleep idle scheduler.
+//
+// Each pass of loop() registers the times it next needs to run (poll,
+// decay tick, animation frame, notification timeout) with powerWakeBy().
+// powerIdle() at the end of the pass sleeps until the earliest one, or
+// until either button is pressed. It stays awake while the network task,
+// the buzzer or WiFi still need the CPU.
+//
+// When loop() allows it (display off, nothing on screen) and the wait is
+// long, powerIdle() deep-sleeps instead. State that must survive lives in
+// RTC slow memory (RTC_DATA_ATTR) in the module that owns it; setup() calls
+// powerResume() first and skips the cold boot when it returns true.
+
+// Current draw used for the battery estimate (Heltec V3 board, display off)
+#define POWER_ACTIVE_MA 42.0f      // CPU at 240 MHz, WiFi off
+#define POWER_LIGHT_SLEEP_MA 1.2f  // Light sleep incl. regulator and LED leakage
+#define POWER_DEEP_SLEEP_MA 0.05f  // Deep sleep, RTC memory and button pull-ups on
+
+struct PowerStats {
+  uint32_t timerWakes;      // Woke because a deadline came up
+  uint32_t buttonWakes;     // Woke because a button went down
+  uint32_t skippedSleeps;   // Idle but something still needed the CPU
+  uint32_t deepSleeps;      // Of the wakes above, how many were from deep sleep
+  uint32_t sleptMs;         // Total time spent in light sleep
+  uint32_t deepSleptMs;     // Total time spent in deep sleep
+  uint32_t awakeMs;         // Total time awake since the last cold boot
+  uint8_t sleepPercent;     // Share of that period spent asleep
+  float averageMa;          // Estimated average draw from the awake/asleep split
+};
+
+// Call first thing in setup(). True when waking from powerIdle()'s deep
+// sleep with the RTC state intact (not a power-on, reset or crash).
+bool powerResume();
+
+// Buttons that woke the chip from deep sleep (bit per GPIO, 0 for a timer)
+uint64_t powerWakePins();
+
+// Translate a millis() timestamp saved before deep sleep into this boot's
+// timebase (unchanged unless powerResume() returned true)
+unsigned long powerRebaseMs(unsigned long ms);
+
+// Start accounting. beforeDeepSleep runs just before the chip powers down,
+// to copy anything that isn't already kept in RTC memory.
+void powerBegin(void (*beforeDeepSleep)() = nullptr);
+
+// This pass needs loop() to run again by dueMs (millis() time)
+void powerWakeBy(unsigned long dueMs);
+
+// Nothing this pass would be lost by powering down until the next deadline
+void powerAllowDeepSleep();
+
+// Sleep until the earliest registered deadline, if nothing else is running.
+// Clears the deadlines and the deep-sleep permission for the next pass.
+void powerIdle();
+
+// Length of the last light sleep (0 if the last pass didn't sleep)
+unsigned long getPowerLastSleepMs();
+
+PowerStats getPowerStats();
+
+#endif
@@ -0,0 +1,126 @@
+#include "profiler.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+struct ZoneHistogram {
+  uint16_t buckets[PROFILE_BUCKETS];  // Halved together when one fills up
+  uint32_t count;
+  uint32_t maxUs;
+};
+
+static ZoneHistogram zones[PROFILE_ZONE_COUNT];
+static portMUX_TYPE profileMux = portMUX_INITIALIZER_UNLOCKED;
+
+static const char *const ZONE_NAMES[PROFILE_ZONE_COUNT] = {
+  "loop", "input", "physics", "draw", "flush", "network", "nvs"
+};
+
+const char *profileZoneName(ProfileZone zone) {
+  return zone < PROFILE_ZONE_COUNT ? ZONE_NAMES[zone] : "?";
+}
+
+// Values below 4 get a bucket each; above that, 4 buckets per power of two
+static uint8_t bucketFor(uint32_t us) {
+  if (us < 4) {
+    return us;
+  }
+  uint8_t msb = 31 - __builtin_clz(us);
+  uint16_t index = (msb - 1) * 4 + ((us >> (msb - 2)) & 3);
+  return index < PROFILE_BUCKETS ? index : PROFILE_BUCKETS - 1;
+}
+
+// Smallest value that no longer falls in the bucket
+static uint32_t bucketLimit(uint8_t index) {
+  if (index < 4) {
+    return index + 1;
+  }
+  uint8_t msb = index / 4 + 1;
+  return (uint32_t)(5 + index % 4) << (msb - 2);
+}
+
+void profileRecord(ProfileZone zone, uint32_t us) {
+  if (zone >= PROFILE_ZONE_COUNT) {
+    return;
+  }
+  ZoneHistogram &h = zones[zone];
+  uint8_t index = bucketFor(us);
+
+  portENTER_CRITICAL(&profileMux);
+  if (h.buckets[index] == UINT16_MAX) {
+    // Keep the shape, let recent samples count for more
+    for (uint8_t i = 0; i < PROFILE_BUCKETS; i++) {
+      h.buckets[i] /= 2;
+    }
+  }
+  h.buckets[index]++;
+  h.count++;
+  if (us > h.maxUs) {
+    h.maxUs = us;
+  }
+  portEXIT_CRITICAL(&profileMux);
+}
+
+ProfileSummary profileSummary(ProfileZone zone) {
+  ProfileSummary summary = {};
+  if (zone >= PROFILE_ZONE_COUNT) {
+    return summary;
+  }
+
+  ZoneHistogram h;
+  portENTER_CRITICAL(&profileMux);
+  h = zones[zone];
+  portEXIT_CRITICAL(&profileMux);
+
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < PROFILE_BUCKETS; i++) {
+    total += h.buckets[i];
+  }
+  summary.count = h.count;
+  summary.maxUs = h.maxUs;
+  if (total == 0) {
+    return summary;
+  }
+
+  // Report the top of the bucket each percentile falls in (capped at the
+  // max). The last bucket has no top - anything past ~33 s - so it's the max.
+  const uint8_t percents[3] = {50, 95, 99};
+  uint32_t *targets[3] = {&summary.p50Us, &summary.p95Us, &summary.p99Us};
+  uint32_t seen = 0;
+  uint8_t next = 0;
+  for (uint8_t i = 0; i < PROFILE_BUCKETS && next < 3; i++) {
+    seen += h.buckets[i];
+    while (next < 3 && (uint64_t)seen * 100 >= (uint64_t)total * percents[next]) {
+      *targets[next] = i == PROFILE_BUCKETS - 1 ? h.maxUs : min(bucketLimit(i), h.maxUs);
+      next++;
+    }
+  }
+  return summary;
+}
+
+void profileDump(Print &out) {
+  out.println(F("⏱️ Profile since boot or last reset (ms):"));
+  out.println(F("  zone        count     p50     p95     p99     max"));
+  for (uint8_t zone = 0; zone < PROFILE_ZONE_COUNT; zone++) {
+    ProfileSummary s = profileSummary((ProfileZone)zone);
+    if (s.count == 0) {
+      continue;
+    }
+    char line[24];
+    snprintf(line, sizeof(line), "  %-8s %8lu", ZONE_NAMES[zone], (unsigned long)s.count);
+    out.print(line);
+    uint32_t values[4] = {s.p50Us, s.p95Us, s.p99Us, s.maxUs};
+    for (uint8_t i = 0; i < 4; i++) {
+      char cell[12];
+      snprintf(cell, sizeof(cell), "%6lu.%lu", (unsigned long)(values[i] / 1000),
+               (unsigned long)((values[i] / 100) % 10));
+      out.print(cell);
+    }
+    out.println();
+  }
+}
+
+void profileReset() {
+  portENTER_CRITICAL(&profileMux);
+  memset(zones, 0, sizeof(zones));
+  portEXIT_CRITICAL(&profileMux);
+}
@@ -0,0 +1,64 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+
+// Timing histograms for named zones.
+//
+// Put a ProfileScope at the top of a block and its duration lands in that
+// zone's histogram when the block exits. Each zone keeps fixed log-linear
+// buckets (4 per power of two, so a percentile is within ~19% of the true
+// value) from 1 µs to ~30 s - about 200 bytes per zone, no allocation.
+// Recording costs two micros() calls and a short critical section, so it
+// can stay on in release builds.
+//
+// Send 'p' over serial for a p50/p95/p99 table, 'P' to dump and reset
+// (see handleSerialCommands() in the .ino).
+
+enum ProfileZone : uint8_t {
+  PROFILE_LOOP,      // One awake pass of loop() (light sleep excluded)
+  PROFILE_INPUT,     // Button polling and edge handling
+  PROFILE_PHYSICS,   // Game ticks, pet animation and state updates
+  PROFILE_DRAW,      // Building a frame in the framebuffer
+  PROFILE_FLUSH,     // display() - I2C transfer to the panel
+  PROFILE_NETWORK,   // One network task request, end to end
+  PROFILE_NVS,       // Preferences writes
+  PROFILE_ZONE_COUNT
+};
+
+#define PROFILE_BUCKETS 96
+
+struct ProfileSummary {
+  uint32_t count;
+  uint32_t p50Us;
+  uint32_t p95Us;
+  uint32_t p99Us;
+  uint32_t maxUs;
+};
+
+// Add one sample (callable from any task)
+void profileRecord(ProfileZone zone, uint32_t us);
+
+ProfileSummary profileSummary(ProfileZone zone);
+
+// Short name for logs and telemetry ("loop", "draw", ...)
+const char *profileZoneName(ProfileZone zone);
+
+// Print one line per zone that has samples
+void profileDump(Print &out);
+
+void profileReset();
+
+class ProfileScope {
+ public:
+  explicit ProfileScope(ProfileZone zone) : zone(zone), startUs(micros()) {}
+  ~ProfileScope() {
+    profileRecord(zone, micros() - startUs);
+  }
+
+ private:
+  ProfileZone zone;
+  uint32_t startUs;
+};
+
+#endif
@@ -0,0 +1,185 @@
+#include "push_channel.h"
+#include "api_client.h"
+#include "config.h"
+#include "dns_cache.h"
+#include "heap_monitor.h"
+#include <WiFi.h>
+#include <WiFiClientSecure.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#define PUSH_TASK_CORE 0              // Next to the network task
+#define PUSH_TASK_STACK 8192          // TLS handshake
+#define PUSH_TASK_PRIORITY 1
+#define PUSH_IDLE_TIMEOUT_MS 75000    // Server sends a keep-alive comment every 30s
+#define PUSH_MIN_BACKOFF_MS 5000
+#define PUSH_MAX_BACKOFF_MS 300000
+
+static TaskHandle_t pushTaskHandle = NULL;
+
+// Shared with the UI task
+static portMUX_TYPE pushMux = portMUX_INITIALIZER_UNLOCKED;
+static char wantedDeviceId[40] = "";  // Empty = stream not wanted
+static volatile bool streamOpen = false;
+static volatile uint32_t eventCount = 0;
+static volatile uint32_t connectCount = 0;
+
+// UI task only
+static uint32_t takenEventCount = 0;
+
+// Push task only
+static WiFiClientSecure client;
+static HTTPClient http;
+static String eventName;
+
+static bool openStream(const char *deviceId) {
+  client.setInsecure();  // Skip certificate validation, as the API session does
+  client.setHandshakeTimeout(API_TIMEOUT_MS);
+  // Connect to the cached address; HTTPClient picks up the open socket (or
+  // connects by name if this failed)
+  IPAddress ip;
+  if (dnsCacheLookup(ip)) {
+    client.connect(ip, 443, GANAMOS_API_HOST, NULL, NULL, NULL);
+  }
+  if (!http.begin(client, String(GANAMOS_API_BASE_URL) + "/api/device/events?deviceId=" + deviceId)) {
+    return false;
+  }
+  http.setTimeout(API_TIMEOUT_MS);
+  http.setReuse(false);
+  // An HTTP/1.0 request gets a plain body that runs until the server closes,
+  // with no chunked framing to strip from the raw stream
+  http.useHTTP10(true);
+  http.addHeader("Accept", "text/event-stream");
+
+  connectCount++;
+  int httpCode = http.GET();
+  if (httpCode != 200) {
+    Serial.println("⚠️ Push: event stream unavailable (HTTP " + String(httpCode) + ")");
+    http.end();
+    return false;
+  }
+
+  Serial.println(F("⚡ Push: event stream connected"));
+  eventName = "";
+  streamOpen = true;
+  return true;
+}
+
+static void closeStream(const __FlashStringHelper *reason) {
+  http.end();
+  client.stop();
+  streamOpen = false;
+  Serial.print(F("⚡ Push: event stream closed ("));
+  Serial.print(reason);
+  Serial.println(F(") - polling only"));
+}
+
+// One line of the stream. A blank line ends an event.
+static void handleLine(String &line) {
+  line.trim();  // Drops the \r of a CRLF line ending
+  if (line.length() == 0) {
+    if (eventName == "balance" || eventName == "job" || eventName == "rejection") {
+      Serial.println("⚡ Push: " + eventName + " event");
+      portENTER_CRITICAL(&pushMux);
+      eventCount++;
+      portEXIT_CRITICAL(&pushMux);
+    }
+    eventName = "";
+  } else if (line.startsWith("event:")) {
+    eventName = line.substring(6);
+    eventName.trim();
+  }
+  // "data:" carries the event's details, which the config poll it triggers
+  // fetches anyway; ":" lines are keep-alive comments
+}
+
+static void pushTask(void *) {
+  unsigned long backoffMs = PUSH_MIN_BACKOFF_MS;
+  unsigned long nextAttempt = 0;
+  unsigned long lastHeard = 0;
+  char deviceId[sizeof(wantedDeviceId)];
+
+  for (;;) {
+    portENTER_CRITICAL(&pushMux);
+    memcpy(deviceId, wantedDeviceId, sizeof(deviceId));
+    portEXIT_CRITICAL(&pushMux);
+
+    if (deviceId[0] == '\0' || WiFi.status() != WL_CONNECTED) {
+      if (streamOpen) {
+        closeStream(deviceId[0] == '\0' ? F("not wanted") : F("WiFi down"));
+      }
+      vTaskDelay(pdMS_TO_TICKS(500));
+      continue;
+    }
+
+    if (!streamOpen) {
+      if ((long)(millis() - nextAttempt) < 0) {
+        vTaskDelay(pdMS_TO_TICKS(500));
+        continue;
+      }
+      if (!openStream(deviceId)) {
+        nextAttempt = millis() + backoffMs;
+        backoffMs = min(backoffMs * 2, (unsigned long)PUSH_MAX_BACKOFF_MS);
+        continue;
+      }
+      backoffMs = PUSH_MIN_BACKOFF_MS;
+      lastHeard = millis();
+    }
+
+    while (client.available() > 0) {
+      String line = client.readStringUntil('\n');
+      handleLine(line);
+      lastHeard = millis();
+    }
+
+    if (!client.connected()) {
+      closeStream(F("server closed"));
+      nextAttempt = millis() + backoffMs;
+    } else if (millis() - lastHeard > PUSH_IDLE_TIMEOUT_MS) {
+      closeStream(F("silent"));
+      nextAttempt = millis() + backoffMs;
+    } else {
+      vTaskDelay(pdMS_TO_TICKS(100));
+    }
+  }
+}
+
+void pushBegin() {
+  if (pushTaskHandle) {
+    return;
+  }
+  xTaskCreatePinnedToCore(pushTask, "push", PUSH_TASK_STACK, NULL, PUSH_TASK_PRIORITY,
+                          &pushTaskHandle, PUSH_TASK_CORE);
+  heapMonitorWatchTask(pushTaskHandle, PUSH_TASK_STACK);
+}
+
+void pushSetWanted(bool wanted) {
+  portENTER_CRITICAL(&pushMux);
+  if (wanted) {
+    strncpy(wantedDeviceId, ganamosConfig.deviceId.c_str(), sizeof(wantedDeviceId) - 1);
+  } else {
+    wantedDeviceId[0] = '\0';
+  }
+  portEXIT_CRITICAL(&pushMux);
+}
+
+bool pushTakeEvent() {
+  uint32_t count = eventCount;
+  if (count == takenEventCount) {
+    return false;
+  }
+  takenEventCount = count;
+  return true;
+}
+
+bool pushIsConnected() {
+  return streamOpen;
+}
+
+uint32_t getPushEventCount() {
+  return eventCount;
+}
+
+uint32_t getPushConnectCount() {
+  return connectCount;
+}
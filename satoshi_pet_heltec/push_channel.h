@@ -0,0 +1,36 @@
+#ifndef PUSH_CHANNEL_H
+#define PUSH_CHANNEL_H
+
+#include <Arduino.h>
+
+// Server push (Server-Sent Events) for instant celebrations.
+//
+// While the display is on and the server advertises it (pushEvents in the
+// device config), a task on core 0 holds a GET /api/device/events stream
+// open. A "balance", "job" or "rejection" event makes loop() poll the config
+// straight away, so the usual celebration, new-job and rejection paths fire
+// within a second of the payment instead of at the next poll.
+//
+// Polling carries on underneath at a relaxed rate (see poll_policy.h) and
+// takes over completely whenever the stream is down. The stream uses its
+// own TLS session (~40 KB of heap while connected), separate from the
+// shared API session.
+
+// Start the push task (idle until pushSetWanted(true))
+void pushBegin();
+
+// Call every loop pass. The stream is opened when wanted and WiFi is up,
+// and closed as soon as wanted goes false.
+void pushSetWanted(bool wanted);
+
+// True once per batch of events received since the last call
+bool pushTakeEvent();
+
+// Stream open and heard from recently
+bool pushIsConnected();
+
+// Events received / connections made since boot
+uint32_t getPushEventCount();
+uint32_t getPushConnectCount();
+
+#endif
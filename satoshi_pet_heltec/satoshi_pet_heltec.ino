@@ -9,7 +9,20 @@
   #include "economy.h"
   #include "button_handler.h"
   #include "display_assets.h"
+  #include "display_flush.h"
+  #include "api_client.h"
+  #include "dns_cache.h"
+  #include "net_task.h"
+  #include "sound_engine.h"
+  #include "battery_monitor.h"
+  #include "power_manager.h"
+  #include "poll_policy.h"
+  #include "push_channel.h"
+  #include "profiler.h"
+  #include "metrics.h"
+  #include "heap_monitor.h"
   #include <esp_task_wdt.h>  // Watchdog timer support (framework auto-initializes)
+  #include <driver/gpio.h>
 
   // Debug logging - comment out to disable verbose logs and save memory
   // #define DEBUG_LOGGING
@@ -21,9 +34,9 @@
   #define BUZZER_PIN 48         // Piezo buzzer pin
   #define ADC_CTRL 37           // GPIO37 - Control pin to enable battery voltage divider
   #define VBAT_PIN 1            // GPIO1 - Battery voltage ADC reading pin (ADC1_CH0)
-  // Heltec WiFi Kit 32 V3 (ESP32-S3) voltage divider: 100kΩ/390kΩ = multiply by 4.9
 
-  SSD1306Wire display(0x3c, 500000, SDA_OLED, SCL_OLED, GEOMETRY_128_64, RST_OLED);
+  // Dirty-region flushing: display() only sends the bytes that changed since the last frame
+  DirtyTrackingDisplay display(0x3c, 500000, SDA_OLED, SCL_OLED, GEOMETRY_128_64, RST_OLED);
 
   // Function to dim OLED display (SSD1306 commands)
   // Based on Heltec forum: contrast control may not work well on V2.0+ boards
@@ -63,19 +76,18 @@
 
   bool isPaired = false;  
   unsigned long lastUpdate = 0;
-  const unsigned long UPDATE_INTERVAL = 20000; // 20 seconds for better responsiveness
+  unsigned long lastDecayCheck = 0;
+  String lastSeenRejectionId = "";
   bool buttonPressed = false;
   unsigned long buttonPressTime = 0;
   unsigned long lastButtonPress = 0;
   bool hadSavedConfigOnBoot = false; // Track if we loaded saved config on boot
   int consecutiveConfig404s = 0;
   const int CONFIG_404_THRESHOLD = 3;
-  // WiFi reconnection with exponential backoff
-  unsigned long lastWifiReconnectAttempt = 0;
-  int wifiReconnectAttempts = 0;
-  const int WIFI_MAX_QUICK_RETRIES = 5;  // After 5 quick failures, slow down significantly
-  const unsigned long WIFI_MIN_BACKOFF_MS = 5000;  // Start with 5 seconds between attempts
-  const unsigned long WIFI_MAX_BACKOFF_MS = 300000;  // Max 5 minutes between attempts
+  bool configPollInFlight = false;  // Config poll queued on the network task
+  bool configPollAgain = false;  // Push event not yet answered by a poll
+  unsigned long bootWifiStart = 0;  // Background connect started by a fast boot (0 = none)
+  bool timeSyncStarted = false;
   bool wifiConfigPortalRequested = false;  // Flag to enter WiFi setup mode
   enum ButtonSource {
     BUTTON_SOURCE_NONE,
@@ -115,156 +127,42 @@
   const unsigned long HOLD_PRESS_MIN = 700;
   const unsigned long VERY_LONG_PRESS = 10000; // 10 seconds to prevent accidental factory reset
 
+  // Battery readings come from the sampler task (battery_monitor.h) - these
+  // just copy its latest snapshot and never touch the ADC
   int getBatteryPercentage() {
-    float voltage = getBatteryVoltage();
-    
-    // Non-linear LiPo discharge curve (more accurate than simple linear mapping)
-    // Based on typical single-cell LiPo discharge characteristics
-    int percentage;
-    
-    if (voltage >= 4.15) {
-      percentage = 100;  // 4.15V+ = 100%
-    } else if (voltage >= 4.0) {
-      // 4.0-4.15V = 85-100% (top 15% is rapid)
-      percentage = 85 + (int)((voltage - 4.0) / 0.15 * 15);
-    } else if (voltage >= 3.85) {
-      // 3.85-4.0V = 60-85% (gradual decline)
-      percentage = 60 + (int)((voltage - 3.85) / 0.15 * 25);
-    } else if (voltage >= 3.7) {
-      // 3.7-3.85V = 40-60% (mid range, flatter curve)
-      percentage = 40 + (int)((voltage - 3.7) / 0.15 * 20);
-    } else if (voltage >= 3.5) {
-      // 3.5-3.7V = 15-40% (steeper drop)
-      percentage = 15 + (int)((voltage - 3.5) / 0.2 * 25);
-    } else if (voltage >= 3.2) {
-      // 3.2-3.5V = 5-15% (getting low)
-      percentage = 5 + (int)((voltage - 3.2) / 0.3 * 10);
-    } else if (voltage >= 3.0) {
-      // 3.0-3.2V = 0-5% (critical low)
-      percentage = (int)((voltage - 3.0) / 0.2 * 5);
-    } else {
-      percentage = 0;  // Below 3.0V = dead
-    }
-    
-    // Clamp between 0-100
-    if (percentage > 100) percentage = 100;
-    if (percentage < 0) percentage = 0;
-    
-    // Log if voltage seems inconsistent
-    if (voltage > 4.3) {
-      Serial.println("⚠️  Warning: Voltage > 4.3V - may be charging or ADC issue");
-    }
-    if (voltage < 3.0 && voltage > 0.1) {
-      Serial.println("⚠️  Warning: Voltage < 3.0V - battery critically low");
-    }
-    
-    return percentage;
+    return getBatterySnapshot().percent;
   }
 
   // Returns battery level 0-3 for icon display
   int getBatteryLevel() {
-    float voltage = getBatteryVoltage();
-    if (voltage >= 3.9) return 3;      // Full
-    else if (voltage >= 3.7) return 2; // Medium  
-    else if (voltage >= 3.5) return 1; // Low
-    else return 0;                     // Critical
+    return getBatterySnapshot().level;
   }
 
   // Returns true if battery appears to be charging (USB connected)
   bool isBatteryCharging() {
-    float voltage = getBatteryVoltage();
-    // If voltage >= 4.1V, likely charging or nearly full on USB power
-    return voltage >= 4.1;
-  }
-
-  // Helper function to read battery once
-  float readVbatOnce() {
-    // Use calibrated analogReadMilliVolts for better accuracy
-    float v_meas = analogReadMilliVolts(VBAT_PIN) / 1000.0;
-    return v_meas * 4.9;  // 100kΩ/(100kΩ+390kΩ) divider = multiply by 4.9
+    return getBatterySnapshot().charging;
   }
 
   float getBatteryVoltage() {
-    // Brief wait for voltage to settle after any WiFi transmission
-    delay(10);
-    
-    // Re-initialize ADC config (can reset after WiFi init or deep sleep)
-    analogReadResolution(12);
-    analogSetAttenuation(ADC_11db);
-    
-    // Use ADC_CTRL HIGH consistently (tested to work reliably)
-    pinMode(ADC_CTRL, OUTPUT);
-    digitalWrite(ADC_CTRL, LOW);
-    delay(5);
-    
-    // Debug: Read raw ADC values
-    int rawADC = analogRead(VBAT_PIN);
-    int rawMillivolts = analogReadMilliVolts(VBAT_PIN);
-    
-    Serial.println("🔋 ADC Debug: pin=" + String(VBAT_PIN) + " ctrl=" + String(ADC_CTRL));
-    Serial.println("   Raw ADC value: " + String(rawADC) + " (0-4095 range)");
-    Serial.println("   Raw millivolts: " + String(rawMillivolts) + " mV");
-    Serial.println("   After 4.9x multiplier: " + String(rawMillivolts / 1000.0 * 4.9, 2) + " V");
-    
-    // Average 4 samples for stable reading (reduced from 8 for faster response)
-    float sum = 0;
-    for (int i = 0; i < 4; i++) {
-      sum += readVbatOnce();
-      delay(1);
-    }
-    float rawVoltage = sum / 4.0;
-    
-    // Apply Exponential Moving Average (EMA) filter for stable readings
-    static float smoothedVoltage = 0;
-    if (smoothedVoltage == 0) {
-      // First reading - initialize with current value
-      smoothedVoltage = rawVoltage;
-    } else {
-      // EMA: 85% old value + 15% new value (smooth but responsive)
-      smoothedVoltage = (0.85 * smoothedVoltage) + (0.15 * rawVoltage);
-    }
-    
-    float voltage = smoothedVoltage;
-    
-    // Sanity check for disconnected battery or bad reading
-    if (voltage < 0.1) {
-      Serial.println("⚠️  Warning: Battery read near 0 V – check cable or battery health.");
-    } else if (voltage < 3.0 && voltage > 0.1) {
-      Serial.println("⚠️  Warning: Voltage < 3.0V - battery critically low");
-    }
-    
-    Serial.println("Battery: Raw=" + String(rawVoltage, 2) + "V Smoothed=" + String(voltage, 2) + "V");
-    
-    if (voltage > 4.15) {
-      Serial.println("ℹ️  Battery appears nearly full - charging LED may be off due to charge complete");
-    }
-    
-    return voltage;
+    return getBatterySnapshot().voltage;
   }
 
+  // Melodies play on the sound task (sound_engine.h) - these calls return immediately
   void playSatsEarnedSound() {
     // Uplifting 8-bit style melody for earning sats
-    int melody[] = {523, 587, 659, 784, 880, 1047};
-    int durations[] = {100, 100, 100, 150, 150, 300};
-    
-    for (int i = 0; i < 6; i++) {
-      tone(BUZZER_PIN, melody[i], durations[i]);
-      delay(durations[i] + 20);
-      noTone(BUZZER_PIN);
-    }
+    static const Note melody[] = {
+      {523, 100, 20}, {587, 100, 20}, {659, 100, 20}, {784, 150, 20}, {880, 150, 20}, {1047, 300, 20}
+    };
+    soundPlay(melody, 6, SOUND_PRIORITY_EVENT);
   }
 
   void playFixRejectedSound() {
     if (isQuietHours()) return;  // Silent during quiet hours
     // Sad descending tone - opposite of the celebration melody
-    int melody[] = {880, 784, 659, 587, 523, 392};
-    int durations[] = {150, 150, 150, 200, 200, 400};
-    
-    for (int i = 0; i < 6; i++) {
-      tone(BUZZER_PIN, melody[i], durations[i]);
-      delay(durations[i] + 30);
-      noTone(BUZZER_PIN);
-    }
+    static const Note melody[] = {
+      {880, 150, 30}, {784, 150, 30}, {659, 150, 30}, {587, 200, 30}, {523, 200, 30}, {392, 400, 30}
+    };
+    soundPlay(melody, 6, SOUND_PRIORITY_ALERT);
   }
 
   void displayPairingCode() {
@@ -372,15 +270,6 @@
   #endif
   }
 
-  // Calculate exponential backoff delay for WiFi reconnection
-  unsigned long getWifiBackoffDelay() {
-    if (wifiReconnectAttempts == 0) return WIFI_MIN_BACKOFF_MS;
-    
-    // Exponential backoff: 5s, 10s, 20s, 40s, 80s, then cap at 5 min
-    unsigned long delay = WIFI_MIN_BACKOFF_MS << min(wifiReconnectAttempts, 6);
-    return min(delay, WIFI_MAX_BACKOFF_MS);
-  }
-
   // Enter WiFi config portal to connect to a new network
   void enterWifiConfigPortal() {
     Serial.println(F("📶 Entering WiFi config portal..."));
@@ -405,8 +294,14 @@
     display.drawString(64, 42, "SatoshiPet-Setup");
     display.display();
     
-    // Disconnect from any existing connection
-    WiFi.disconnect(true);
+    // Disconnect from any existing connection (waits for the network task
+    // to finish its current request so nothing else touches WiFi meanwhile)
+    NetRequest wifiOff;
+    NetResult wifiOffResult;
+    netRequestInit(wifiOff, NET_REQ_WIFI_OFF);
+    if (netTransact(wifiOff, wifiOffResult)) {
+      netFreeResult(wifiOffResult);
+    }
     delay(100);
     
     WiFiManager wm;
@@ -418,8 +313,7 @@
     
     if (connected) {
       Serial.println(F("✅ WiFi connected via config portal!"));
-      wifiReconnectAttempts = 0;
-      lastWifiReconnectAttempt = 0;
+      netResetWifiBackoff();
       
       display.clear();
       display.setFont(ArialMT_Plain_16);
@@ -438,21 +332,231 @@
     Serial.println(F("🐕 Watchdog re-enabled"));
   }
 
-  void setup() {
-    Serial.begin(115200);
+  // Queue a config poll on the network task (at most one in flight).
+  // Returns false if one is already in flight or the queue is full.
+  bool requestConfigPoll() {
+    if (configPollInFlight) {
+      return false;
+    }
+    metricSet(METRIC_CONSECUTIVE_CONFIG_404S, consecutiveConfig404s);  // As of this batch
+    NetRequest req;
+    netRequestInit(req, NET_REQ_CONFIG_POLL);
+    configPollInFlight = netSubmit(req);
+    return configPollInFlight;
+  }
+
+  // Close the API session and switch WiFi off once queued requests are done
+  void requestWifiOff() {
+    NetRequest req;
+    netRequestInit(req, NET_REQ_WIFI_OFF);
+    netSubmit(req);
+  }
+
+  // Spend sync finished on the network task - drop synced entries and
+  // reconcile the local coin balance with the server
+  void handleSpendSyncResult(int synced) {
+    extern int getLocalCoins();
+    extern void setLocalCoins(int coins);
+    extern void clearSyncedSpends();
+    extern int getPendingSpendCount();
     
-    // ESP32 Arduino framework already initializes watchdog timer (5s default)
-    // DISABLED: Watchdog registration causing boot loop
-    // esp_task_wdt_add(NULL); // Add loop() task to watchdog
+    int serverCoins = ganamosConfig.coins;
+    int localCoins = getLocalCoins();
     
-    VextON();
-    delay(100);
+    if (synced > 0) {
+      Serial.println("✅ Synced " + String(synced) + " pending spends");
+      clearSyncedSpends();
+      metricIncrement(METRIC_SPENDS_SYNCED, synced);
+    }
+    
+    // Check how many pending spends are still unsynced
+    int remainingPending = getPendingSpendCount();
+    if (remainingPending > 0) {
+      metricIncrement(METRIC_SPEND_SYNCS_INCOMPLETE);
+    }
+    
+    // After sync attempt, reconcile local balance with server
+    // BUT only trust server if we have NO pending spends - otherwise our offline
+    // spending hasn't been acknowledged by the server yet!
+    if (serverCoins != localCoins) {
+      int diff = localCoins - serverCoins;
+      
+      if (remainingPending > 0) {
+        // DON'T trust server - we have unsynced spends that server doesn't know about
+        Serial.println("⏳ Balance mismatch but " + String(remainingPending) + " pending spends not synced yet");
+        Serial.println("   Local: " + String(localCoins) + ", Server: " + String(serverCoins));
+        Serial.println("   Keeping local balance until spends sync successfully");
+        // Don't call setLocalCoins - keep local balance as-is
+      } else if (diff > 0) {
+        // No pending spends, but local is higher - this shouldn't happen normally
+        // Could be corrupted data, so trust server
+        Serial.println("⚠️ Local balance higher than server by " + String(diff) + " coins (no pending spends)");
+        Serial.println("   This may indicate corrupted data - trusting server balance");
+        setLocalCoins(serverCoins);
+      } else {
+        // Server is higher - user earned coins while offline, safe to update
+        Serial.println("💰 Server balance higher by " + String(-diff) + " coins (earned while offline)");
+        setLocalCoins(serverCoins);
+      }
+    }
+  }
 
-    display.init();
+  // Drain finished network requests. Returns true when a config poll
+  // completed this pass, with fetchSuccess set from its result.
+  bool takeConfigPollResult(bool &fetchSuccess) {
+    bool polled = false;
+    NetResult result;
+    
+    while (netReceive(result)) {
+      switch (result.type) {
+        case NET_REQ_CONFIG_POLL:
+          configPollInFlight = false;
   #ifdef DEBUG_LOGGING
-    Serial.println(F("Display initialized"));
+          Serial.println("📡 Config poll: HTTP " + String(result.httpCode) + " in " + String(result.elapsedMs) + "ms");
   #endif
+          // No WiFi yet (reconnect pending) - try again next interval
+          if (result.httpCode != NET_NO_WIFI) {
+            fetchSuccess = applyConfigResult(result);
+            polled = true;
+          }
+          break;
+        case NET_REQ_SYNC_SPENDS:
+          handleSpendSyncResult(result.count);
+          break;
+        default:
+          break;
+      }
+      netFreeResult(result);
+    }
     
+    return polled;
+  }
+
+  // Boot timing, logged at the end of setup() to track time-to-first-frame
+  #define BOOT_PHASE_MAX 10
+  struct BootPhase {
+    const char *name;
+    unsigned long atMs;
+  };
+  BootPhase bootPhases[BOOT_PHASE_MAX];
+  uint8_t bootPhaseCount = 0;
+
+  void markBootPhase(const char *name) {
+    if (bootPhaseCount < BOOT_PHASE_MAX) {
+      bootPhases[bootPhaseCount].name = name;
+      bootPhases[bootPhaseCount].atMs = millis();
+      bootPhaseCount++;
+    }
+  }
+
+  void logBootPhases() {
+    Serial.println(F("⏱️ Boot phases (ms since power-on):"));
+    unsigned long previous = 0;
+    for (uint8_t i = 0; i < bootPhaseCount; i++) {
+      Serial.printf("  %-12s %6lu  (+%lu)\n", bootPhases[i].name, bootPhases[i].atMs,
+                    bootPhases[i].atMs - previous);
+      previous = bootPhases[i].atMs;
+    }
+  }
+
+  // Loop state that has to survive deep sleep. millis() restarts from zero
+  // on every wake, so the timestamps are rebased when they're restored.
+  struct RetainedLoopState {
+    unsigned long lastUpdate;
+    unsigned long lastDecayCheck;
+    unsigned long lastButtonPress;
+    bool isScreensaverActive;
+    bool isBitcoinFactsActive;
+    bool lowBatteryAlertPlayed;
+    char lastSeenRejectionId[40];
+  };
+  RTC_DATA_ATTR RetainedLoopState retainedLoop;
+
+  void startWatchdog() {
+    // Configure watchdog with 15 second timeout
+    esp_task_wdt_config_t wdt_config = {
+      .timeout_ms = 15000,           // 15 second timeout
+      .idle_core_mask = 0,           // Don't watch idle tasks
+      .trigger_panic = true          // Panic (reset) on timeout
+    };
+    esp_task_wdt_reconfigure(&wdt_config);  // Reconfigure existing watchdog
+    esp_task_wdt_add(NULL);                  // Add current task (main loop)
+    Serial.println("🐕 Watchdog initialized (15s timeout)");
+  }
+
+  // Needs the network stack up - call once WiFi is connected
+  void startTimeSync() {
+    if (timeSyncStarted) {
+      return;
+    }
+    timeSyncStarted = true;
+    // Initialize NTP for real time (for sleep cycle)
+    configTime(-8 * 3600, 0, "pool.ntp.org", "time.nist.gov"); // PST timezone, adjust as needed
+    Serial.println("NTP time sync initiated...");
+  }
+
+  // Runs just before deep sleep - economy and pet stats already live in RTC memory
+  void retainForDeepSleep() {
+    retainDeviceConfig();
+    retainedLoop.lastUpdate = lastUpdate;
+    retainedLoop.lastDecayCheck = lastDecayCheck;
+    retainedLoop.lastButtonPress = lastButtonPress;
+    retainedLoop.isScreensaverActive = isScreensaverActive;
+    retainedLoop.isBitcoinFactsActive = isBitcoinFactsActive;
+    retainedLoop.lowBatteryAlertPlayed = lowBatteryAlertPlayed;
+    strncpy(retainedLoop.lastSeenRejectionId, lastSeenRejectionId.c_str(), sizeof(retainedLoop.lastSeenRejectionId) - 1);
+    retainedLoop.lastSeenRejectionId[sizeof(retainedLoop.lastSeenRejectionId) - 1] = '\0';
+
+    // Pins float in deep sleep - latch Vext high so the display stays unpowered
+    gpio_hold_en((gpio_num_t)Vext);
+    gpio_deep_sleep_hold_en();
+  }
+
+  // Deep-sleep wake: everything the cold boot loads is still in RTC memory,
+  // so skip the splash screens, the WiFi connect and the NVS reads
+  bool resumeFromDeepSleep() {
+    if (!resumeDeviceConfig()) {
+      Serial.println(F("⚠️ No retained config - doing a full boot"));
+      return false;
+    }
+
+    pinMode(RGB_LED, OUTPUT);
+    digitalWrite(RGB_LED, LOW);
+    pinMode(BUZZER_PIN, OUTPUT);
+    digitalWrite(BUZZER_PIN, LOW);
+    soundBegin(BUZZER_PIN);
+    batteryMonitorBegin(VBAT_PIN, ADC_CTRL);
+
+    resumeEconomy();
+    resumePetStats();
+    metricsResume();
+    dnsCacheResume();
+    netTaskBegin();  // The push task waits until the display is on again
+
+    lastUpdate = powerRebaseMs(retainedLoop.lastUpdate);
+    lastDecayCheck = powerRebaseMs(retainedLoop.lastDecayCheck);
+    lastButtonPress = powerRebaseMs(retainedLoop.lastButtonPress);
+    isScreensaverActive = retainedLoop.isScreensaverActive;
+    isBitcoinFactsActive = retainedLoop.isBitcoinFactsActive;
+    isDisplayOff = true;
+    lowBatteryAlertPlayed = retainedLoop.lowBatteryAlertPlayed;
+    lastSeenRejectionId = retainedLoop.lastSeenRejectionId;
+    isPaired = true;
+    hadSavedConfigOnBoot = true;
+
+    uint64_t wakePins = powerWakePins();
+    initButtons(wakePins);
+    startWatchdog();
+    powerBegin(retainForDeepSleep);
+
+    Serial.print(F("⚡ Resumed from deep sleep in "));
+    Serial.print(millis());
+    Serial.println(wakePins ? F("ms (button)") : F("ms (timer)"));
+    return true;
+  }
+
+  // Logo and tagline - only shown while setting up an unpaired device
+  void showSplashScreens() {
     // Show splash screen logo (128x64 full screen)
     display.clear();
     display.drawXbm(0, 0, 128, 64, epd_bitmap_g_logo);
@@ -472,6 +576,46 @@
     display.drawXbm(42, 36, 72, 17, epd_bitmap_bitcoin_72);
     display.display();
     delay(2500); // Show tagline for 2.5 seconds
+  }
+
+  void setup() {
+    Serial.begin(115200);
+    heapMonitorBegin();
+
+    // Release the display power latch from deep sleep, keeping it off
+    pinMode(Vext, OUTPUT);
+    digitalWrite(Vext, HIGH);
+    gpio_hold_dis((gpio_num_t)Vext);
+
+    if (powerResume() && resumeFromDeepSleep()) {
+      return;
+    }
+    metricsBegin();
+    
+    // ESP32 Arduino framework already initializes watchdog timer (5s default)
+    // DISABLED: Watchdog registration causing boot loop
+    // esp_task_wdt_add(NULL); // Add loop() task to watchdog
+    
+    VextON();
+    delay(100);
+
+    display.init();
+  #ifdef DEBUG_LOGGING
+    Serial.println(F("Display initialized"));
+  #endif
+    
+    markBootPhase("display");
+
+    // FIRST: Check if device is already paired (before WiFi setup)
+    // Paired devices skip the splash screens and connect to WiFi in the background
+    hadSavedConfigOnBoot = loadDeviceConfig();
+    logCurrentPairingState();
+    markBootPhase("config");
+
+    if (!hadSavedConfigOnBoot) {
+      showSplashScreens();
+      markBootPhase("splash");
+    }
     
     display.setFont(ArialMT_Plain_10);
     display.setTextAlignment(TEXT_ALIGN_LEFT);
@@ -479,44 +623,42 @@
     digitalWrite(RGB_LED, LOW);  // Start with LED off
     pinMode(BUZZER_PIN, OUTPUT);  // Enable buzzer
     digitalWrite(BUZZER_PIN, LOW);  // Start with buzzer off
+    soundBegin(BUZZER_PIN);
+    batteryMonitorBegin(VBAT_PIN, ADC_CTRL);
     
     // Configure ADC for battery reading
     analogReadResolution(12);  // 12-bit resolution (0-4095)
     analogSetAttenuation(ADC_11db);  // Full scale ~3.3V
-
-      // FIRST: Check if device is already paired (before WiFi setup)
-    // This determines whether we need mandatory WiFi setup or can try quick reconnect
-    hadSavedConfigOnBoot = loadDeviceConfig();
-    logCurrentPairingState();
-    
-    WiFiManager wm;
-    wm.setCustomHeadElement("<style>"
-      "body { font-family: -apple-system, BlinkMacSystemFont, 'Segoe UI', Roboto, sans-serif; "
-      "background: #f5f5f5; margin: 0; padding: 20px; }"
-      ".c { background: white; border-radius: 16px; padding: 40px; "
-      "box-shadow: 0 2px 20px rgba(0,0,0,0.08); max-width: 400px; margin: 40px auto; }"
-      "h1 { color: #1a1a1a; font-size: 32px; margin-bottom: 8px; font-weight: 600; }"
-      "h3 { color: #666; font-weight: 400; margin-bottom: 24px; font-size: 16px; }"
-      ".btn { background: #10b981; "
-      "border: none; color: white; padding: 14px 28px; border-radius: 10px; "
-      "font-size: 16px; font-weight: 500; cursor: pointer; transition: all 0.2s; "
-      "width: 100%; margin: 8px 0; }"
-      ".btn:hover { background: #059669; transform: translateY(-1px); "
-      "box-shadow: 0 4px 12px rgba(16, 185, 129, 0.3); }"
-      "input { border: 2px solid #e5e7eb; border-radius: 8px; padding: 12px; "
-      "font-size: 15px; width: 100%; margin: 8px 0; transition: border 0.2s; }"
-      "input:focus { outline: none; border-color: #10b981; }"
-      "label { color: #374151; font-weight: 500; font-size: 14px; }"
-      "</style>");
-    
-    wm.setTitle("Satoshi Pet Setup");
-    wm.setConnectTimeout(10);        // 10 seconds to connect to saved network
-    wm.setWiFiAutoReconnect(true);   // Auto-reconnect if connection drops
+    markBootPhase("peripherals");
 
     if (!hadSavedConfigOnBoot) {
       // ===== UNPAIRED DEVICE: WiFi setup is REQUIRED before pairing =====
       Serial.println(F("No saved config - WiFi setup required for pairing"));
       
+      WiFiManager wm;
+      wm.setCustomHeadElement("<style>"
+        "body { font-family: -apple-system, BlinkMacSystemFont, 'Segoe UI', Roboto, sans-serif; "
+        "background: #f5f5f5; margin: 0; padding: 20px; }"
+        ".c { background: white; border-radius: 16px; padding: 40px; "
+        "box-shadow: 0 2px 20px rgba(0,0,0,0.08); max-width: 400px; margin: 40px auto; }"
+        "h1 { color: #1a1a1a; font-size: 32px; margin-bottom: 8px; font-weight: 600; }"
+        "h3 { color: #666; font-weight: 400; margin-bottom: 24px; font-size: 16px; }"
+        ".btn { background: #10b981; "
+        "border: none; color: white; padding: 14px 28px; border-radius: 10px; "
+        "font-size: 16px; font-weight: 500; cursor: pointer; transition: all 0.2s; "
+        "width: 100%; margin: 8px 0; }"
+        ".btn:hover { background: #059669; transform: translateY(-1px); "
+        "box-shadow: 0 4px 12px rgba(16, 185, 129, 0.3); }"
+        "input { border: 2px solid #e5e7eb; border-radius: 8px; padding: 12px; "
+        "font-size: 15px; width: 100%; margin: 8px 0; transition: border 0.2s; }"
+        "input:focus { outline: none; border-color: #10b981; }"
+        "label { color: #374151; font-weight: 500; font-size: 14px; }"
+        "</style>");
+    
+      wm.setTitle("Satoshi Pet Setup");
+      wm.setConnectTimeout(10);        // 10 seconds to connect to saved network
+      wm.setWiFiAutoReconnect(true);   // Auto-reconnect if connection drops
+      
       // Show "Connect to WiFi" message on display
       display.clear();
       display.setFont(ArialMT_Plain_10);
@@ -546,34 +688,10 @@
         delay(3000);
         ESP.restart();
       }
-    } else {
-      // ===== PAIRED DEVICE: Try quick reconnect, offline is OK =====
-      Serial.println(F("Device paired - trying quick WiFi reconnect..."));
-      WiFi.mode(WIFI_STA);
-      WiFi.setAutoReconnect(false);
-      WiFi.begin();
-      
-      // Wait up to 10 seconds for connection
-      unsigned long wifiStart = millis();
-      while (WiFi.status() != WL_CONNECTED && (millis() - wifiStart) < 10000) {
-        delay(250);
-        yield();
-      }
-      
-      if (WiFi.status() == WL_CONNECTED) {
-        Serial.print(F("WiFi connected: "));
-        Serial.println(WiFi.localIP());
-      } else {
-        Serial.println(F("WiFi unavailable - continuing offline"));
-        WiFi.disconnect(true);
-        WiFi.mode(WIFI_OFF);
-      }
+      startTimeSync();
+      markBootPhase("wifi");
     }
 
-    // Initialize NTP for real time (for sleep cycle)
-    configTime(-8 * 3600, 0, "pool.ntp.org", "time.nist.gov"); // PST timezone, adjust as needed
-    Serial.println("NTP time sync initiated...");
-
     initPet("default");
     
     // Initialize economy system
@@ -592,13 +710,19 @@
       clearEconomyData();
     }
     
+    // All HTTP from here on runs on the network task (core 0)
+    dnsCacheBegin();
+    netTaskBegin();
+    pushBegin();
+    
     loadPetStats();
+    markBootPhase("state");
     
     // Now handle pairing - WiFi is guaranteed to be connected for unpaired devices
     if (hadSavedConfigOnBoot) {
       Serial.println("Found saved config! Device already paired.");
-      Serial.println("Device ID: " + ganamosConfig.deviceId);
-      Serial.println("Pet name: " + ganamosConfig.petName);
+      Serial.println("Device ID: " + String(ganamosConfig.deviceId));
+      Serial.println("Pet name: " + String(ganamosConfig.petName));
       Serial.println("Pairing code: " + pairingCode);
       Serial.println("Last known balance from config: " + String(ganamosConfig.balance) + " sats");
       Serial.println("Last known coins from config (server): " + String(ganamosConfig.coins) + " coins");
@@ -608,7 +732,19 @@
       Serial.println("Actual local coin balance: " + String(getLocalCoins()) + " coins");
       
       isPaired = true;
-      Serial.println("Will fetch data in main loop...");
+
+      // Show the pet from cached state straight away, then connect in the
+      // background - loop() polls as soon as WiFi comes up
+      setOLEDContrast(NORMAL_BRIGHTNESS);
+      renderPet(display, ganamosConfig.btcPrice, ganamosConfig.balance, getBatteryPercentage());
+      markBootPhase("first frame");
+
+      Serial.println(F("Device paired - connecting to WiFi in the background"));
+      WiFi.mode(WIFI_STA);
+      WiFi.setAutoReconnect(false);
+      WiFi.begin();
+      bootWifiStart = millis();
+      markBootPhase("wifi start");
     } else {
       // WiFi is now connected - safe to generate and display pairing code
       Serial.println(F("WiFi connected - generating pairing code"));
@@ -621,37 +757,27 @@
     // Initialize buttons using button_handler module
     initButtons();
     
-    // Quick battery test before main loop starts
-    Serial.println("\n=== Battery Quick Test ===");
-    float testVoltage = getBatteryVoltage();
-    Serial.printf("Voltage: %.2f V\n", testVoltage);
-    Serial.println("==========================\n");
-    
     // Initialize lastButtonPress to prevent immediate screensaver activation
     lastButtonPress = millis();
     setOLEDContrast(NORMAL_BRIGHTNESS); // Start at full brightness (direct I2C command)
     display.setContrast(NORMAL_BRIGHTNESS); // Also try library method
     
-      // Register main loop task with watchdog (15 second timeout)
-    // Configure watchdog with 15 second timeout
-    esp_task_wdt_config_t wdt_config = {
-      .timeout_ms = 15000,           // 15 second timeout
-      .idle_core_mask = 0,           // Don't watch idle tasks
-      .trigger_panic = true          // Panic (reset) on timeout
-    };
-    esp_task_wdt_reconfigure(&wdt_config);  // Reconfigure existing watchdog
-    esp_task_wdt_add(NULL);                  // Add current task (main loop)
-    Serial.println("🐕 Watchdog initialized (15s timeout)");
+    // Register main loop task with watchdog (15 second timeout)
+    startWatchdog();
+
+    powerBegin(retainForDeepSleep);
 
+    markBootPhase("setup");
+    logBootPhases();
     Serial.println("Setup complete!");
   }
 
   void logCurrentPairingState() {
     Serial.println("🔍 Current pairing snapshot:");
-    Serial.println("  deviceId: " + ganamosConfig.deviceId);
+    Serial.println("  deviceId: " + String(ganamosConfig.deviceId));
     Serial.println("  pairingCode: " + pairingCode);
-    Serial.println("  petName: " + ganamosConfig.petName);
-    Serial.println("  petType: " + ganamosConfig.petType);
+    Serial.println("  petName: " + String(ganamosConfig.petName));
+    Serial.println("  petType: " + String(ganamosConfig.petType));
     Serial.println("  balance: " + String(ganamosConfig.balance));
     Serial.println("  coins: " + String(ganamosConfig.coins));
   }
@@ -660,13 +786,40 @@
     // DISABLED: Watchdog feed causing boot loop
     // esp_task_wdt_reset();
       esp_task_wdt_reset();  // Feed watchdog at start of every loop iteration
+    uint32_t passStartUs = micros();
+    handleSerialCommands();
+    heapMonitorCheck();
+    // Fast boot started WiFi in the background - poll as soon as it's up,
+    // or give up after the 10s the blocking connect used to allow
+    if (bootWifiStart > 0) {
+      if (WiFi.status() == WL_CONNECTED) {
+        Serial.print(F("⏱️ WiFi connected at "));
+        Serial.print(millis());
+        Serial.print(F("ms (+"));
+        Serial.print(millis() - bootWifiStart);
+        Serial.print(F(" after WiFi start): "));
+        Serial.println(WiFi.localIP());
+        bootWifiStart = 0;
+        lastUpdate = millis();
+        requestConfigPoll();
+      } else if (millis() - bootWifiStart > 10000) {
+        Serial.println(F("WiFi unavailable - continuing offline"));
+        bootWifiStart = 0;
+        requestWifiOff();
+      }
+    }
+
+    // NTP needs the network stack, so it starts the first time WiFi is up
+    if (!timeSyncStarted && WiFi.status() == WL_CONNECTED) {
+      startTimeSync();
+    }
+
     // Ensure WiFi stays off if we're in offline mode (prevents background blocking)
     static bool wifiDisabled = false;
-    if (!wifiDisabled && WiFi.status() != WL_CONNECTED) {
+    if (bootWifiStart == 0 && !wifiDisabled && WiFi.status() != WL_CONNECTED) {
       if (WiFi.getMode() != WIFI_OFF) {
         Serial.println(F("Forcing WiFi OFF to prevent blocking"));
-        WiFi.disconnect(true);
-        WiFi.mode(WIFI_OFF);
+        requestWifiOff();
       }
       wifiDisabled = true;
     }
@@ -675,10 +828,13 @@
     static unsigned long lastLoopTime = 0;
     unsigned long now = millis();
     
-    // Warn if loop is running slowly (taking more than 500ms between iterations)
-    if (lastLoopTime > 0 && (now - lastLoopTime) > 500) {
+    // Warn if loop is running slowly (taking more than 500ms between iterations,
+    // not counting time spent in light sleep)
+    unsigned long loopGap = now - lastLoopTime - getPowerLastSleepMs();
+    if (lastLoopTime > 0 && loopGap > 500) {
+      metricIncrement(METRIC_SLOW_LOOPS);
       Serial.print(F("SLOW LOOP: "));
-      Serial.print(now - lastLoopTime);
+      Serial.print(loopGap);
       Serial.println(F("ms since last iteration"));
     }
     lastLoopTime = now;
@@ -702,6 +858,7 @@
     if (cachedBatteryPct < 0 || (now - lastBatteryCheck > 60000)) { 
       cachedBatteryPct = getBatteryPercentage();
       lastBatteryCheck = now;
+      metricsSampleBattery((int)(getBatteryVoltage() * 1000), cachedBatteryPct);
       
       // Trigger low battery warning at 10% (only once per charge cycle)
       if (cachedBatteryPct <= 10 && !lowBatteryAlertPlayed && !isLowBatteryWarningActive) {
@@ -731,6 +888,11 @@
         renderLowBatteryWarning(display, cachedBatteryPct);
       }
     }
+    // With the display off the check waits for the next poll or button
+    // wake-up rather than ending every deep sleep after a minute
+    if (!isDisplayOff) {
+      powerWakeBy(lastBatteryCheck + 60000);
+    }
     
     // Handle low battery warning timeout (60 seconds) - return to normal mode
     if (isLowBatteryWarningActive && (now - lowBatteryWarningStartTime > 60000)) {
@@ -740,6 +902,9 @@
       int batteryPct = getBatteryPercentage();
       renderPet(display, ganamosConfig.btcPrice, ganamosConfig.balance, batteryPct);
     }
+    if (isLowBatteryWarningActive) {
+      powerWakeBy(lowBatteryWarningStartTime + 60000);
+    }
     
     // Enter ultra-low-power mode only at 5% (critical battery)
     // BUT only if user hasn't interacted recently - let normal screensaver flow handle sleep
@@ -752,8 +917,7 @@
         isScreensaverActive = true;
         isDisplayOff = true;
         VextOFF();
-        WiFi.disconnect(true);
-        WiFi.mode(WIFI_OFF);
+        requestWifiOff();
         // Will only wake for button press or poll every 5 minutes
       }
     }
@@ -797,12 +961,20 @@
       VextOFF();  // Turn display OFF completely to save power
       
       // Disconnect WiFi to save significant power
-      WiFi.disconnect(true);
-      WiFi.mode(WIFI_OFF);
+      requestWifiOff();
   #ifdef DEBUG_LOGGING
       Serial.println(F("Display OFF, WiFi OFF (power saving)"));
   #endif
     }
+
+    // Next stage of the sleep transition
+    if (!isScreensaverActive) {
+      powerWakeBy(lastButtonPress + SCREENSAVER_TIMEOUT);
+    } else if (!isBitcoinFactsActive && !isDisplayOff) {
+      powerWakeBy(lastButtonPress + BITCOIN_FACTS_TIMEOUT);
+    } else if (!isDisplayOff) {
+      powerWakeBy(lastButtonPress + SCREENSAVER_DISPLAY_OFF_TIMEOUT);
+    }
     
     // Debug timing checkpoint
     if (millis() - sectionStart > 100) {
@@ -812,13 +984,25 @@
     }
     sectionStart = millis();
     
+    // Keep the push stream open while someone can see the pet
+    bool pushWanted = isPaired && ganamosConfig.pushSupported && !isDisplayOff;
+    if (pushWanted) {
+      pushBegin();  // Not started on a deep-sleep wake until now
+    }
+    pushSetWanted(pushWanted);
+    pollSetPushConnected(pushIsConnected());
+    
     if (!isPaired) {
-      // Check every 5 seconds if we're now paired
+      // Check every 5 seconds if we're now paired (poll runs on the network task)
       if (now - lastUpdate > 5000) {
         lastUpdate = now;
-        
+        requestConfigPoll();
+      }
+      powerWakeBy(lastUpdate + 5000);
+      
+      bool fetchSuccess = false;
+      if (takeConfigPollResult(fetchSuccess)) {
         extern int getLastHttpCode();
-        bool fetchSuccess = fetchGanamosConfig();
         
         if (fetchSuccess) {
           isPaired = true;
@@ -830,13 +1014,13 @@
           display.setFont(ArialMT_Plain_10);
           display.setTextAlignment(TEXT_ALIGN_CENTER);
           display.drawString(64, 20, "Connected!");
-          display.drawString(64, 35, ganamosConfig.petName);
+          display.drawString(64, 35, ganamosConfig.petName.c_str());
           display.display();
           delay(2000);
           
           // Start onboarding flow
           onboardingStep = 1;
-          renderOnboardingStep(display, onboardingStep, ganamosConfig.petName);
+          renderOnboardingStep(display, onboardingStep, ganamosConfig.petName.c_str());
         } else {
           // Check if we got a 404 - only regenerate if we had saved config that's now invalid
           // If we're starting fresh (no saved config), 404 is expected - don't regenerate code
@@ -845,6 +1029,7 @@
 
           if (got404) {
             consecutiveConfig404s++;
+            metricIncrement(METRIC_CONFIG_404S);
             Serial.println("⚠️ Pairing fetch returned 404 (" + String(consecutiveConfig404s) + "/" + String(CONFIG_404_THRESHOLD) + ")");
           } else {
             consecutiveConfig404s = 0;
@@ -891,86 +1076,93 @@
         Serial.print(F(" dispOff="));
         Serial.print(isDisplayOff);
         Serial.print(F(" celeb="));
-        Serial.println(showCelebration);
+        Serial.print(showCelebration);
+        Serial.print(F(" i2c="));
+        Serial.print(getLastFlushBytes());
+        Serial.print(F("B/frame avg="));
+        Serial.print(getTotalFlushCount() > 0 ? getTotalFlushBytes() / getTotalFlushCount() : 0);
+        Serial.print(F("B tls="));
+        Serial.print(getApiHandshakeCount());
+        Serial.print(F("/"));
+        Serial.print(getApiRequestCount());
+        Serial.print(F(" press2px="));
+        Serial.print(getInputLatencyLastUs() / 1000);
+        Serial.print(F("/"));
+        Serial.print(getInputLatencyAvgUs() / 1000);
+        Serial.print(F("/"));
+        Serial.print(getInputLatencyMaxUs() / 1000);
+        Serial.print(F("ms nvs="));
+        Serial.print(getEconomyNvsWrites());
+        Serial.print(F("/"));
+        Serial.print(getEconomyLegacyNvsWrites());
+        PowerStats power = getPowerStats();
+        Serial.print(F(" sleep="));
+        Serial.print(power.sleepPercent);
+        Serial.print(F("% wakes="));
+        Serial.print(power.timerWakes);
+        Serial.print(F("/"));
+        Serial.print(power.buttonWakes);
+        Serial.print(F(" deep="));
+        Serial.print(power.deepSleeps);
+        PollStats poll = getPollStats();
+        Serial.print(F(" poll="));
+        Serial.print(pollIntervalMs(isScreensaverActive) / 1000);
+        Serial.print(F("s x"));
+        Serial.print(1 << poll.backoffLevel);
+        Serial.print(F(" "));
+        Serial.print(poll.changed);
+        Serial.print(F("/"));
+        Serial.print(poll.polls);
+        ConfigPollStats cfg = getConfigPollStats();
+        Serial.print(F(" cfg=200:"));
+        Serial.print(cfg.full - cfg.unchanged);
+        Serial.print(F("/304:"));
+        Serial.print(cfg.notModified + cfg.unchanged);
+        Serial.print(F(" "));
+        Serial.print(cfg.bytes / 1024);
+        Serial.print(F("kB push="));
+        Serial.print(pushIsConnected() ? F("up ") : F("down "));
+        Serial.print(getPushEventCount());
+        Serial.print(F("/"));
+        Serial.print(getPushConnectCount());
+        Serial.print(F(" ~"));
+        Serial.print(power.averageMa, 1);
+        Serial.println(F("mA"));
         lastStateLog = millis();
       }
       
-      // Normal operation - fetch data less frequently during screensaver to save power
-      unsigned long updateInterval = isScreensaverActive ? 300000 : UPDATE_INTERVAL; // 5 minutes during screensaver, 20s normal
+      // Normal operation - the interval follows the server hint, backs off
+      // while nothing changes and stretches further during the screensaver
+      unsigned long updateInterval = pollIntervalMs(isScreensaverActive);
       
-      if (now - lastUpdate > updateInterval) {
+      // The poll (and any WiFi reconnect) runs on the network task; the result
+      // is picked up on a later pass so rendering never waits on the network.
+      // A push event polls straight away - or, if a poll is already in flight
+      // (it may have left before the change), as soon as that one is back.
+      if (pushTakeEvent()) {
+        configPollAgain = true;
+      }
+      if (configPollAgain || now - lastUpdate > updateInterval) {
         lastUpdate = now;
-        unsigned long fetchStart = millis();
-        
-        // Non-blocking WiFi reconnection during screensaver
-        // WiFi.begin() starts background reconnection, doesn't block
-        // If not connected yet, we skip this fetch and try next cycle
-              if (WiFi.status() != WL_CONNECTED) {
-          unsigned long backoffDelay = getWifiBackoffDelay();
-          
-          // Check if enough time has passed since last attempt
-          if (now - lastWifiReconnectAttempt < backoffDelay) {
-            // Not time yet - just skip this fetch cycle
-            return;
-          }
-          
-          wifiReconnectAttempts++;
-          lastWifiReconnectAttempt = now;
-          
-          Serial.print(F("📶 WiFi reconnect attempt #"));
-          Serial.print(wifiReconnectAttempts);
-          Serial.print(F(" (next in "));
-          Serial.print(getWifiBackoffDelay() / 1000);
-          Serial.println(F("s)"));
-          
-          // After many failures, suggest config portal
-          if (wifiReconnectAttempts >= WIFI_MAX_QUICK_RETRIES && wifiReconnectAttempts % 5 == 0) {
-            Serial.println(F("💡 Tip: Hold PRG button 5 seconds to enter WiFi setup"));
-          }
-          
-          WiFi.mode(WIFI_STA);
-          WiFi.begin();  // Try with saved credentials
-          
-          // Wait briefly to see if connection starts
-          unsigned long wifiWaitStart = millis();
-          while (WiFi.status() != WL_CONNECTED && millis() - wifiWaitStart < 3000) {
-            delay(100);
-            yield();
-          }
-          
-          if (WiFi.status() == WL_CONNECTED) {
-            Serial.println(F("✅ WiFi reconnected!"));
-            wifiReconnectAttempts = 0;
-          } else {
-            Serial.println(F("❌ WiFi reconnect failed"));
-            WiFi.disconnect(true);
-            WiFi.mode(WIFI_OFF);  // Turn off to save power between attempts
-          }
-          
-          return;  // Skip to next loop iteration
-        } else {
-          // Connected - reset retry counter
-          if (wifiReconnectAttempts > 0) {
-            wifiReconnectAttempts = 0;
-            Serial.println(F("✅ WiFi connection restored"));
-          }
+        if (requestConfigPoll()) {
+          configPollAgain = false;
         }
-        
+      }
+      powerWakeBy(lastUpdate + updateInterval);
+      
+      bool fetchSuccess = false;
+      if (takeConfigPollResult(fetchSuccess)) {
         extern int getLastHttpCode();
-        bool fetchSuccess = fetchGanamosConfig();
-        
-        // Log fetch timing
-        unsigned long fetchTime = millis() - fetchStart;
-        if (fetchTime > 100) {
-          Serial.print(F("SLOW FETCH: "));
-          Serial.print(fetchTime);
-          Serial.println(F("ms"));
+        if (fetchSuccess) {
+          pollSetServerHint(ganamosConfig.pollInterval);
         }
+        pollOnResult(fetchSuccess, fetchSuccess && getLastConfigChanged());
         
         // If we got a 404, the saved pairing code is invalid - clear config and reset
         if (!fetchSuccess) {
           if (getLastHttpCode() == 404) {
             consecutiveConfig404s++;
+            metricIncrement(METRIC_CONFIG_404S);
             Serial.println("⚠️ Device config 404 (" + String(consecutiveConfig404s) + "/" + String(CONFIG_404_THRESHOLD) + ")");
             if (consecutiveConfig404s >= CONFIG_404_THRESHOLD) {
               Serial.println("⚠️ Device not found after repeated attempts - clearing saved config");
@@ -998,92 +1190,64 @@
 
         if (fetchSuccess) {
           static int lastBalance = ganamosConfig.balance;
-          
-          // Sync economy: update local balance from server and sync pending spends
-          extern int getLocalCoins();
-          extern void setLocalCoins(int coins);
-          extern int syncPendingSpends();
-          extern void clearSyncedSpends();
-          extern int getPendingSpendCount();
-          
-          int serverCoins = ganamosConfig.coins;
-          int localCoins = getLocalCoins();
-          
-          // Sync pending spends FIRST before reconciling balance
-          int synced = syncPendingSpends();
-          if (synced > 0) {
-            Serial.println("✅ Synced " + String(synced) + " pending spends");
-            clearSyncedSpends();
-          }
-          
-          // Check how many pending spends are still unsynced
-          int remainingPending = getPendingSpendCount();
-          
-          // After sync attempt, reconcile local balance with server
-          // BUT only trust server if we have NO pending spends - otherwise our offline
-          // spending hasn't been acknowledged by the server yet!
-          if (serverCoins != localCoins) {
-            int diff = localCoins - serverCoins;
+
+          if (getLastHttpCode() == HTTP_CODE_NOT_MODIFIED) {
+            // Config unchanged - nothing to parse or reconcile. Spends made
+            // since the last poll still have to reach the server.
+            extern int getPendingSpendCount();
+            if (getPendingSpendCount() > 0) {
+              NetRequest syncReq;
+              netRequestInit(syncReq, NET_REQ_SYNC_SPENDS);
+              netSubmit(syncReq);
+            }
+          } else {
+            // Sync pending spends on the network task; the balance is reconciled
+            // with the server in handleSpendSyncResult() once it finishes
+            NetRequest syncReq;
+            netRequestInit(syncReq, NET_REQ_SYNC_SPENDS);
+            netSubmit(syncReq);
             
-            if (remainingPending > 0) {
-              // DON'T trust server - we have unsynced spends that server doesn't know about
-              Serial.println("⏳ Balance mismatch but " + String(remainingPending) + " pending spends not synced yet");
-              Serial.println("   Local: " + String(localCoins) + ", Server: " + String(serverCoins));
-              Serial.println("   Keeping local balance until spends sync successfully");
-              // Don't call setLocalCoins - keep local balance as-is
-            } else if (diff > 0) {
-              // No pending spends, but local is higher - this shouldn't happen normally
-              // Could be corrupted data, so trust server
-              Serial.println("⚠️ Local balance higher than server by " + String(diff) + " coins (no pending spends)");
-              Serial.println("   This may indicate corrupted data - trusting server balance");
-              setLocalCoins(serverCoins);
-            } else {
-              // Server is higher - user earned coins while offline, safe to update
-              Serial.println("💰 Server balance higher by " + String(-diff) + " coins (earned while offline)");
-              setLocalCoins(serverCoins);
+            // Check for balance increase (wake from screensaver/facts if needed)
+            if (ganamosConfig.balance > lastBalance && (isScreensaverActive || isBitcoinFactsActive)) {
+              // Balance increased! Wake from sleep mode
+              isScreensaverActive = false;
+              isBitcoinFactsActive = false;
+              if (isDisplayOff) {
+                // Display was completely off, turn it back on
+                VextON();  // Turn display back on
+                delay(100);  // Wait for display to stabilize
+                display.init();
+                display.setFont(ArialMT_Plain_10);
+                display.setTextAlignment(TEXT_ALIGN_LEFT);
+                Serial.println("💰 Balance increased - waking from display OFF!");
+              } else {
+                Serial.println("💰 Balance increased - waking from animated screensaver!");
+              }
+              // Disable WiFi power saving for responsive active use
+              if (WiFi.status() == WL_CONNECTED) {
+                WiFi.setSleep(false);
+              }
+              isDisplayOff = false;
+            }
+            lastBalance = ganamosConfig.balance;
+
+            // Check for fix rejection notification
+            if (ganamosConfig.lastRejectionId.length() > 0 && 
+                ganamosConfig.lastRejectionId != lastSeenRejectionId) {
+              // New rejection detected!
+              lastSeenRejectionId = ganamosConfig.lastRejectionId;
+              triggerRejection(ganamosConfig.rejectionMessage.c_str());
             }
           }
-          
-          // Apply time-based decay to pet stats
+
+          // The rest runs on a 304 too: the pet gets hungrier and the battery
+          // drains whether or not the server had news
           extern void applyTimeBasedDecay();
           applyTimeBasedDecay();
           
           updatePetMood(ganamosConfig.btcPrice, ganamosConfig.balance);
           cachedBatteryPct = getBatteryPercentage(); // Update cached battery value
           
-          // Check for balance increase (wake from screensaver/facts if needed)
-            if (ganamosConfig.balance > lastBalance && (isScreensaverActive || isBitcoinFactsActive)) {
-            // Balance increased! Wake from sleep mode
-            isScreensaverActive = false;
-            isBitcoinFactsActive = false;
-            if (isDisplayOff) {
-              // Display was completely off, turn it back on
-              VextON();  // Turn display back on
-              delay(100);  // Wait for display to stabilize
-              display.init();
-              display.setFont(ArialMT_Plain_10);
-              display.setTextAlignment(TEXT_ALIGN_LEFT);
-              Serial.println("💰 Balance increased - waking from display OFF!");
-            } else {
-              Serial.println("💰 Balance increased - waking from animated screensaver!");
-            }
-            // Disable WiFi power saving for responsive active use
-            if (WiFi.status() == WL_CONNECTED) {
-              WiFi.setSleep(false);
-            }
-            isDisplayOff = false;
-          }
-          lastBalance = ganamosConfig.balance;
-
-          // Check for fix rejection notification
-          static String lastSeenRejectionId = "";
-          if (ganamosConfig.lastRejectionId.length() > 0 && 
-              ganamosConfig.lastRejectionId != lastSeenRejectionId) {
-              // New rejection detected!
-              lastSeenRejectionId = ganamosConfig.lastRejectionId;
-              triggerRejection(ganamosConfig.rejectionMessage);
-              }
-          
           // Check for critical pet states (sad/dying) - wake if needed
           extern PetStats petStats;
           if ((isScreensaverActive || isBitcoinFactsActive || isDisplayOff)) {
@@ -1103,7 +1267,7 @@
               // Play death sound and show warning
               extern void playDeathSound();
               playDeathSound();
-              renderDeathWarning(display, ganamosConfig.petName);
+              renderDeathWarning(display, ganamosConfig.petName.c_str());
               
             } else if (petStats.fullness < 20 || petStats.happiness < 20) {
               // Pet became sad! Wake and alert
@@ -1124,9 +1288,9 @@
               
               // Show hunger warning if fullness is low, otherwise sadness warning
               if (petStats.fullness < 20) {
-                renderHungerWarning(display, ganamosConfig.petName, petStats.fullness);
+                renderHungerWarning(display, ganamosConfig.petName.c_str(), petStats.fullness);
               } else {
-                renderSadnessWarning(display, ganamosConfig.petName, petStats.happiness);
+                renderSadnessWarning(display, ganamosConfig.petName.c_str(), petStats.happiness);
               }
             }
           }
@@ -1134,8 +1298,7 @@
           // Disconnect WiFi again after poll to save power (if still in screensaver)
           if (isScreensaverActive && isDisplayOff) {
             Serial.println("📡 Disconnecting WiFi to save power...");
-            WiFi.disconnect(true);
-            WiFi.mode(WIFI_OFF);
+            requestWifiOff();
           }
           
           // Render based on power saving mode
@@ -1157,7 +1320,7 @@
             Serial.println("💤 Screensaver: Balance=" + String(ganamosConfig.balance) + " Battery=" + String(cachedBatteryPct) + "%");
           } else if (onboardingStep > 0) {
             // Onboarding active - render current step (don't overwrite with pet)
-            renderOnboardingStep(display, onboardingStep, ganamosConfig.petName);
+            renderOnboardingStep(display, onboardingStep, ganamosConfig.petName.c_str());
           } else {
             // Normal mode - render pet
             renderPet(display, ganamosConfig.btcPrice, ganamosConfig.balance, cachedBatteryPct);
@@ -1168,13 +1331,16 @@
         // If fetch failed, just continue - pet will show with cached data
       }
       
-      // Apply decay even when offline (every minute)
-      static unsigned long lastDecayCheck = 0;
+      // Apply decay even when offline (every minute). Decay is worked out
+      // from elapsed time, so with the display off it can wait for a wake-up
       if (now - lastDecayCheck > 60000) { // Check every minute
         extern void applyTimeBasedDecay();
         applyTimeBasedDecay();
         lastDecayCheck = now;
       }
+      if (!isDisplayOff) {
+        powerWakeBy(lastDecayCheck + 60000);
+      }
       
       // Keep updating the display based on current mode
       extern bool showCelebration;
@@ -1207,13 +1373,16 @@
         } else if (showNewJobNotification) {
           // New job notification takes priority
           renderNewJobNotification(display);
+          powerWakeBy(now);  // Blinking LED and spinning coins
         } else if (showRejection) {
           // NEW: Rejection notification
           renderRejection(display);
+          powerWakeBy(rejectionStart + 5000);
         } else if (isBitcoinFactsActive) {
           unsigned long timeInFacts = now - bitcoinFactsStartTime;
           int factSlot = (timeInFacts / 20000) % 3;
           renderBitcoinFact(display, bitcoinFactsForSession[factSlot]);
+          powerWakeBy(bitcoinFactsStartTime + (timeInFacts / 20000 + 1) * 20000);
         } else if (isScreensaverActive) {
           if (!isDisplayOff) {
             static unsigned long lastScreensaverUpdate = 0;
@@ -1221,13 +1390,16 @@
               renderScreensaver(display, ganamosConfig.balance);
               lastScreensaverUpdate = now;
             }
+            powerWakeBy(lastScreensaverUpdate + 500);
           }
         } else if (showCelebration) {
           renderPet(display, ganamosConfig.btcPrice, ganamosConfig.balance, cachedBatteryPct);
+          powerWakeBy(now);
         } else if (onboardingStep > 0) {
           // Onboarding active - don't overwrite, let button handler manage it
           // Optionally re-render to keep it on screen:
-          renderOnboardingStep(display, onboardingStep, ganamosConfig.petName);
+          renderOnboardingStep(display, onboardingStep, ganamosConfig.petName.c_str());
+          powerWakeBy(now);
         } else {
           // Normal mode
           static unsigned long lastDisplayUpdate = 0;
@@ -1253,6 +1425,7 @@
             lastDisplayedHappiness = petStats.happiness;
             lastDisplayedBattery = cachedBatteryPct;
           }
+          powerWakeBy(lastDisplayUpdate + 500);
         }
         // Check if rendering took too long
         if (millis() - renderStart > 100) {
@@ -1270,15 +1443,18 @@
       Serial.println(F("ms"));
     }
     
-    // Handle button presses
-    bool prgButtonState = digitalRead(BUTTON_PIN_PRG) == LOW;
-    bool externalButtonState = digitalRead(BUTTON_PIN_EXTERNAL) == LOW;
-    bool currentButtonState = prgButtonState || externalButtonState;
+    // Handle button presses (debounced edges queued by the GPIO interrupts)
+    static ButtonState mainButtons = {};
+    updateButtonState(mainButtons);
+    bool prgButtonState = mainButtons.prgDown;
+    bool externalButtonState = mainButtons.externalDown;
+    bool currentButtonState = mainButtons.pressed;
 
     if (currentButtonState && !buttonPressed) {
       buttonPressed = true;
-      buttonPressTime = millis();
+      buttonPressTime = mainButtons.pressTime;
       lastButtonPress = millis();
+      pollOnActivity();
       if (prgButtonState && externalButtonState) {
         lastButtonSource = BUTTON_SOURCE_BOTH;
         Serial.println(F("Both buttons pressed"));
@@ -1355,7 +1531,7 @@
     }
     
     if (!currentButtonState && buttonPressed) {
-      unsigned long pressDuration = millis() - buttonPressTime;
+      unsigned long pressDuration = mainButtons.releaseTime - buttonPressTime;
       buttonPressed = false;
       ButtonSource triggeredSource = lastButtonSource;
       lastButtonSource = BUTTON_SOURCE_NONE;
@@ -1385,7 +1561,7 @@
             // Advance to next step
             onboardingStep++;
             playButtonChirp();
-            renderOnboardingStep(display, onboardingStep, ganamosConfig.petName);
+            renderOnboardingStep(display, onboardingStep, ganamosConfig.petName.c_str());
           } else {
             // Last step - complete onboarding
             onboardingStep = 0;
@@ -1420,6 +1596,7 @@
             int foodOptionCount = getFoodOptionCount();
             int totalFoodItems = foodOptionCount + 1;  // +1 for Back option
             unsigned long lastFoodCycle = millis();
+            ButtonState foodButtons = {};
             renderFoodSelectionMenu(display, selectedFood);
 
             while (inFoodMenu) {
@@ -1430,18 +1607,8 @@
                 break;
               }
 
-              bool prgStateFood = digitalRead(BUTTON_PIN_PRG) == LOW;
-              bool externalStateFood = digitalRead(BUTTON_PIN_EXTERNAL) == LOW;
-              bool currentStateFood = prgStateFood || externalStateFood;
-
-              if (currentStateFood && !buttonPressed) {
-                buttonPressed = true;
-                buttonPressTime = millis();
-              }
-
-              if (!currentStateFood && buttonPressed) {
-                unsigned long foodPressDuration = millis() - buttonPressTime;
-                buttonPressed = false;
+              if (updateButtonState(foodButtons) && !foodButtons.pressed) {
+                unsigned long foodPressDuration = getPressDuration(foodButtons);
 
                 bool foodShort = foodPressDuration <= SHORT_PRESS_MAX;
                 bool foodHold = (foodPressDuration >= HOLD_PRESS_MIN) && (foodPressDuration < VERY_LONG_PRESS);
@@ -1551,26 +1718,47 @@
         renderMenu(display, currentMenuOption);
         lastMenuRender = millis();
       }
+      powerWakeBy(lastMenuRender + 500);
+      powerWakeBy(lastMenuCycle + 10000);
     }
     
+    // Nothing on screen and no press in progress - safe to power down fully
+    if (isPaired && isDisplayOff && !inMenuMode && !buttonPressed && !isLowBatteryWarningActive) {
+      powerAllowDeepSleep();
+    }
+
+    // Sleep until the earliest deadline registered above (or a button)
+    profileRecord(PROFILE_LOOP, micros() - passStartUs);
+    powerIdle();
+
     // Let system tasks run (prevents WiFi stack from blocking)
     yield();
   }
 
+  // Single-character commands from the serial console
+  void handleSerialCommands() {
+    while (Serial.available() > 0) {
+      int command = Serial.read();
+      if (command == 'p') {
+        profileDump(Serial);
+      } else if (command == 'P') {
+        profileDump(Serial);
+        profileReset();
+        Serial.println(F("⏱️ Profile reset"));
+      } else if (command == 'h') {
+        heapMonitorDump(Serial);
+      }
+    }
+  }
+
   void playButtonChirp() {
-    tone(BUZZER_PIN, 880, 80);
-    delay(60);
-    tone(BUZZER_PIN, 1319, 80);
-    delay(60);
-    noTone(BUZZER_PIN);
+    static const Note chirp[] = { {880, 60, 0}, {1319, 60, 0} };
+    soundPlay(chirp, 2, SOUND_PRIORITY_UI);
   }
 
   void playMenuSelectTone() {
-    tone(BUZZER_PIN, 988, 100);
-    delay(90);
-    tone(BUZZER_PIN, 1319, 160);
-    delay(150);
-    noTone(BUZZER_PIN);
+    static const Note select[] = { {988, 90, 0}, {1319, 150, 0} };
+    soundPlay(select, 2, SOUND_PRIORITY_UI);
   }
 
   // Check if current time is during quiet hours (8pm-8am)
@@ -1588,49 +1776,31 @@
 
   void playSadSound() {
     if (isQuietHours()) return;  // Silent during quiet hours
-    tone(BUZZER_PIN, 659, 200);
-    delay(180);
-    tone(BUZZER_PIN, 587, 200);
-    delay(180);
-    tone(BUZZER_PIN, 523, 300);
-    delay(280);
-    noTone(BUZZER_PIN);
+    static const Note melody[] = { {659, 180, 0}, {587, 180, 0}, {523, 280, 0} };
+    soundPlay(melody, 3, SOUND_PRIORITY_ALERT);
   }
 
   void playDeathSound() {
     if (isQuietHours()) return;  // Silent during quiet hours
-    tone(BUZZER_PIN, 523, 250);
-    delay(230);
-    tone(BUZZER_PIN, 440, 250);
-    delay(230);
-    tone(BUZZER_PIN, 349, 250);
-    delay(230);
-    tone(BUZZER_PIN, 262, 500);
-    delay(480);
-    noTone(BUZZER_PIN);
+    static const Note melody[] = { {523, 230, 0}, {440, 230, 0}, {349, 230, 0}, {262, 480, 0} };
+    soundPlay(melody, 4, SOUND_PRIORITY_CRITICAL);
   }
 
   void playLowBatterySound() {
     if (isQuietHours()) return;  // Silent during quiet hours
-    tone(BUZZER_PIN, 880, 150);
-    delay(140);
-    tone(BUZZER_PIN, 659, 150);
-    delay(140);
-    tone(BUZZER_PIN, 440, 200);
-    delay(190);
-    noTone(BUZZER_PIN);
+    static const Note melody[] = { {880, 140, 0}, {659, 140, 0}, {440, 190, 0} };
+    soundPlay(melody, 3, SOUND_PRIORITY_ALERT);
   }
 
   void playNewJobChirp() {
     if (isQuietHours()) return;  // Silent during quiet hours
     // Distinct attention-getting chirp - two rising tones
-    tone(BUZZER_PIN, 784, 150);  // G5
-    delay(130);
-    tone(BUZZER_PIN, 988, 150);  // B5
-    delay(130);
-    tone(BUZZER_PIN, 1175, 200); // D6
-    delay(180);
-    noTone(BUZZER_PIN);
+    static const Note melody[] = {
+      {784, 130, 0},   // G5
+      {988, 130, 0},   // B5
+      {1175, 180, 0}   // D6
+    };
+    soundPlay(melody, 3, SOUND_PRIORITY_EVENT);
   }
 
   void renderLowBatteryWarning(SSD1306Wire &display, int batteryPercent) {
@@ -1782,29 +1952,21 @@
 
   bool confirmFactoryReset() {
     int selectedOption = 0; // 0 = No (default), 1 = Yes
-    bool confirmButtonPressed = false;
-    unsigned long pressStart = 0;
+    ButtonState confirmButtons = {};
     unsigned long lastInteraction = millis();
     const unsigned long timeoutMs = 15000; // 15 seconds
 
     renderFactoryResetPrompt(selectedOption);
 
     while (millis() - lastInteraction < timeoutMs) {
-      bool externalState = digitalRead(BUTTON_PIN_EXTERNAL) == LOW;
-      bool prgState = digitalRead(BUTTON_PIN_PRG) == LOW;
+      bool changed = updateButtonState(confirmButtons);
 
-      if (prgState) {
+      if (confirmButtons.prgDown) {
         return false;
       }
 
-      if (externalState && !confirmButtonPressed) {
-        confirmButtonPressed = true;
-        pressStart = millis();
-      }
-
-      if (!externalState && confirmButtonPressed) {
-        unsigned long duration = millis() - pressStart;
-        confirmButtonPressed = false;
+      if (changed && !confirmButtons.pressed) {
+        unsigned long duration = getPressDuration(confirmButtons);
         lastInteraction = millis();
 
         bool shortPress = duration <= SHORT_PRESS_MAX;
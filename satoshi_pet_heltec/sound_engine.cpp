@@ -0,0 +1,182 @@
+#include "sound_engine.h"
+#include "heap_monitor.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#define SOUND_TASK_CORE 1        // Same core as loop(); the task sleeps between notes
+#define SOUND_TASK_STACK 2048
+#define SOUND_TASK_PRIORITY 1
+#define SOUND_QUEUE_LEN 4
+
+struct Melody {
+  const Note *notes;
+  uint8_t count;
+  SoundPriority priority;
+};
+
+static uint8_t buzzerPin = 0;
+static TaskHandle_t soundTaskHandle = NULL;
+static portMUX_TYPE soundMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Guarded by soundMux
+static Melody current = { nullptr, 0, SOUND_PRIORITY_UI };
+static uint8_t currentIndex = 0;
+static Melody queued[SOUND_QUEUE_LEN];
+static uint8_t queuedCount = 0;
+static uint32_t generation = 0;  // Bumped whenever the current melody is replaced
+
+// Pick the next queued melody: highest priority first, FIFO within a priority.
+// Caller holds soundMux.
+static bool dequeueNext(Melody &next) {
+  if (queuedCount == 0) {
+    return false;
+  }
+
+  uint8_t best = 0;
+  for (uint8_t i = 1; i < queuedCount; i++) {
+    if (queued[i].priority > queued[best].priority) {
+      best = i;
+    }
+  }
+
+  next = queued[best];
+  for (uint8_t i = best; i + 1 < queuedCount; i++) {
+    queued[i] = queued[i + 1];
+  }
+  queuedCount--;
+  return true;
+}
+
+// Next note to play, moving on to the next queued melody when the current
+// one ends. Returns false when there is nothing left.
+static bool nextNote(Note &note, uint32_t &noteGeneration) {
+  bool found = false;
+
+  portENTER_CRITICAL(&soundMux);
+  if (current.notes && currentIndex >= current.count) {
+    current.notes = nullptr;
+  }
+  if (!current.notes && dequeueNext(current)) {
+    currentIndex = 0;
+  }
+  if (current.notes) {
+    note = current.notes[currentIndex++];
+    found = true;
+  }
+  noteGeneration = generation;
+  portEXIT_CRITICAL(&soundMux);
+
+  return found;
+}
+
+// Wait up to ms, returning early (true) only if the melody was replaced.
+// A notification can arrive just before nextNote() picked up the new melody,
+// so check the generation rather than trusting every wakeup.
+static bool waitPreempted(uint32_t ms, uint32_t noteGeneration) {
+  TickType_t start = xTaskGetTickCount();
+  TickType_t total = pdMS_TO_TICKS(ms);
+  for (;;) {
+    TickType_t elapsed = xTaskGetTickCount() - start;
+    if (elapsed >= total) {
+      return false;
+    }
+    if (ulTaskNotifyTake(pdTRUE, total - elapsed) > 0) {
+      portENTER_CRITICAL(&soundMux);
+      bool replaced = generation != noteGeneration;
+      portEXIT_CRITICAL(&soundMux);
+      if (replaced) {
+        return true;
+      }
+    }
+  }
+}
+
+static void soundTask(void *) {
+  Note note;
+  uint32_t noteGeneration = 0;
+  for (;;) {
+    if (!nextNote(note, noteGeneration)) {
+      noTone(buzzerPin);
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);  // Sleep until soundPlay()
+      continue;
+    }
+
+    if (note.freq > 0) {
+      tone(buzzerPin, note.freq);
+    } else {
+      noTone(buzzerPin);
+    }
+
+    if (waitPreempted(note.durationMs, noteGeneration)) {
+      continue;
+    }
+
+    if (note.gapMs > 0) {
+      noTone(buzzerPin);
+      waitPreempted(note.gapMs, noteGeneration);
+    }
+  }
+}
+
+void soundBegin(uint8_t pin) {
+  if (soundTaskHandle) {
+    return;
+  }
+  buzzerPin = pin;
+  xTaskCreatePinnedToCore(soundTask, "sound", SOUND_TASK_STACK, NULL, SOUND_TASK_PRIORITY,
+                          &soundTaskHandle, SOUND_TASK_CORE);
+  heapMonitorWatchTask(soundTaskHandle, SOUND_TASK_STACK);
+}
+
+bool soundPlay(const Note *notes, uint8_t count, SoundPriority priority) {
+  if (!soundTaskHandle || !notes || count == 0) {
+    return false;
+  }
+
+  bool accepted = true;
+  bool preempt = false;
+
+  portENTER_CRITICAL(&soundMux);
+  bool busy = current.notes != nullptr;
+  if (!busy || priority > current.priority ||
+      (priority == SOUND_PRIORITY_UI && current.priority == SOUND_PRIORITY_UI)) {
+    // Idle, or cut off a lower priority melody (a new chirp replaces the last one)
+    current.notes = notes;
+    current.count = count;
+    current.priority = priority;
+    currentIndex = 0;
+    generation++;
+    preempt = true;
+  } else if (priority == SOUND_PRIORITY_UI) {
+    accepted = false;  // Stale button feedback is worse than none
+  } else if (queuedCount < SOUND_QUEUE_LEN) {
+    queued[queuedCount++] = { notes, count, priority };
+  } else {
+    accepted = false;
+  }
+  portEXIT_CRITICAL(&soundMux);
+
+  if (preempt) {
+    xTaskNotifyGive(soundTaskHandle);
+  }
+  return accepted;
+}
+
+void soundStop() {
+  portENTER_CRITICAL(&soundMux);
+  current.notes = nullptr;
+  queuedCount = 0;
+  generation++;
+  portEXIT_CRITICAL(&soundMux);
+
+  if (soundTaskHandle) {
+    xTaskNotifyGive(soundTaskHandle);
+  }
+}
+
+bool soundIsPlaying() {
+  portENTER_CRITICAL(&soundMux);
+  bool playing = current.notes != nullptr || queuedCount > 0;
+  portEXIT_CRITICAL(&soundMux);
+  return playing;
+}
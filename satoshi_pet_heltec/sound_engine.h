@@ -0,0 +1,40 @@
+#ifndef SOUND_ENGINE_H
+#define SOUND_ENGINE_H
+
+#include <Arduino.h>
+
+// Non-blocking buzzer sequencer.
+//
+// Melodies are note arrays played by a small FreeRTOS task, so loop() keeps
+// rendering and sampling buttons while a sound plays. A higher-priority
+// melody cuts off whatever is playing (a death alert stops a chirp); equal
+// or lower priority melodies wait their turn. UI chirps are never queued -
+// late button feedback is worse than none.
+
+struct Note {
+  uint16_t freq;        // Hz, 0 = rest
+  uint16_t durationMs;  // How long the note sounds
+  uint16_t gapMs;       // Silence after the note
+};
+
+enum SoundPriority : uint8_t {
+  SOUND_PRIORITY_UI = 0,        // Button chirps, menu select
+  SOUND_PRIORITY_EVENT = 1,     // Sats earned, new job, game tones
+  SOUND_PRIORITY_ALERT = 2,     // Low battery, sad pet, fix rejected
+  SOUND_PRIORITY_CRITICAL = 3   // Pet died
+};
+
+// Start the sequencer task for the buzzer on this pin
+void soundBegin(uint8_t pin);
+
+// Play a melody. notes must have static storage (the task reads it while
+// playing). Returns false if the sound was dropped.
+bool soundPlay(const Note *notes, uint8_t count, SoundPriority priority);
+
+// Stop the current melody and drop anything queued
+void soundStop();
+
+// True while a melody is playing or queued
+bool soundIsPlaying();
+
+#endif